@@ -98,7 +98,12 @@ static int com_args_search_short_arg(COM_ARGS_OPTION * ops, const char argv)
 static int com_args_read_value(COM_ARGS_OPTION * ops, const char * argv)
 {
     if(argv == NULL) return -1;
+#if OUTPUT_SINK
+    /* a lone "-" is a value, it names the standard input or output */
+    if(argv[0] == '-' && argv[1] != '\0' && (argv[1] < '0' || argv[1] > '9')) return -1;
+#else
     if(argv[0] == '-' && (argv[1] < '0' || argv[1] > '9')) return -1;
+#endif
     switch(COM_ARGS_GET_CMD_OPT_VAL_TYPE(ops->val_type))
     {
     case ARGS_TYPE_INTEGER:
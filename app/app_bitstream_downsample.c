@@ -32,6 +32,7 @@
 */
 
 #define _CRT_SECURE_NO_WARNINGS
+#define _DEFAULT_SOURCE /* fileno() and fdopen() under -std=c99 */
 
 
 #include <com_typedef.h>
@@ -242,7 +243,12 @@ static void sequence_deinit(DEC_CTX * ctx)
     }
 #endif
 
+#if DBK_EDGE_BITMAP
+    delete_edge_filter_avs2(ctx->edge_filter);
+    ctx->edge_filter = NULL;
+#else
     delete_edge_filter_avs2(ctx->edge_filter, ctx->info.pic_height);
+#endif
 
     if (ctx->pic_sao)
     {
@@ -415,7 +421,13 @@ static int sequence_init(DEC_CTX * ctx, COM_SQH * sqh)
     ret = com_picman_init(&ctx->dpm, MAX_PB_SIZE, MAX_NUM_REF_PICS, &ctx->pa);
     com_assert_g(COM_SUCCEEDED(ret), ERR);
 
+#if DBK_EDGE_BITMAP
+    delete_edge_filter_avs2(ctx->edge_filter);
+    ctx->edge_filter = create_edge_filter_avs2(ctx->info.pic_width, ctx->info.pic_height);
+    com_assert_gv(ctx->edge_filter, ret, COM_ERR_OUT_OF_MEMORY, ERR);
+#else
     create_edge_filter_avs2(ctx->info.pic_width, ctx->info.pic_height, ctx->edge_filter);
+#endif
 
     if (ctx->pic_sao == NULL)
     {
@@ -696,105 +708,6 @@ static int xFindNextStartCode(FILE * fp, int * ruiPacketSize, unsigned char *puc
     }
 
 
-static unsigned int  initParsingConvertPayloadToRBSP(const unsigned int uiBytesRead, unsigned char* pBuffer, unsigned char* pBuffer2)
-{
-    unsigned int uiZeroCount = 0;
-    unsigned int uiBytesReadOffset = 0;
-    unsigned int uiBitsReadOffset = 0;
-    const unsigned char *pucRead = pBuffer;
-    unsigned char *pucWrite = pBuffer2;
-
-    unsigned char ucHeaderType;
-    unsigned int uiWriteOffset = uiBytesReadOffset;
-    ucHeaderType = pucRead[uiBytesReadOffset++]; //HeaderType
-
-
-
-    switch (ucHeaderType)
-    {
-    case 0xb5:
-        if ((pucRead[uiBytesReadOffset] >> 4) == 0x0d)
-        {
-            break;
-        }
-        else
-        {
-        }
-    case 0xb0:
-    case 0xb2:
-        //       initParsing(uiBytesRead);
-        memcpy(pBuffer2, pBuffer, uiBytesRead);
-
-        return uiBytesRead;
-    default:
-        break;
-    }
-    pucWrite[uiWriteOffset] = ucHeaderType;
-
-    uiWriteOffset++;
-
-    unsigned char ucCurByte = pucRead[uiBytesReadOffset];
-
-    for (; uiBytesReadOffset < uiBytesRead; uiBytesReadOffset++)
-    {
-        ucCurByte = pucRead[uiBytesReadOffset];
-
-        if (2 <= uiZeroCount && 0x02 == pucRead[uiBytesReadOffset])
-        {
-            pucWrite[uiWriteOffset] = ((pucRead[uiBytesReadOffset] >> 2) << (uiBitsReadOffset + 2));
-            uiBitsReadOffset += 2;
-            uiZeroCount = 0;
-            //printf("\n error uiBitsReadOffset \n");
-            if (uiBitsReadOffset >= 8)
-            {
-                uiBitsReadOffset = 0;
-                continue;
-            }
-            if (uiBytesReadOffset >= uiBytesRead)
-            {
-                break;
-            }
-        }
-        else if (2 <= uiZeroCount && 0x01 == pucRead[uiBytesReadOffset])
-        {
-            uiBitsReadOffset = 0;
-            pucWrite[uiWriteOffset] = pucRead[uiBytesReadOffset];
-        }
-        else
-        {
-            pucWrite[uiWriteOffset] = (pucRead[uiBytesReadOffset] << uiBitsReadOffset);
-        }
-
-        if (uiBytesReadOffset + 1 < uiBytesRead)
-        {
-            pucWrite[uiWriteOffset] |= (pucRead[uiBytesReadOffset + 1] >> (8 - uiBitsReadOffset));
-
-        }
-        uiWriteOffset++;
-
-        if (0x00 == ucCurByte)
-        {
-            uiZeroCount++;
-        }
-        else
-        {
-            uiZeroCount = 0;
-        }
-    }
-
-    // th just clear the remaining bits in the buffer
-    for (unsigned int ui = uiWriteOffset; ui < uiBytesRead; ui++)
-    {
-        pucWrite[ui] = 0;
-    }
-    //    initParsing(uiWriteOffset);
-    memcpy(pBuffer, pBuffer2, uiWriteOffset);
-
-
-    return uiBytesRead;
-}
-
-
 static int read_a_bs(FILE * fp, int * pos, unsigned char * bs_buf)
 {
     int read_size, bs_size;
@@ -935,7 +848,7 @@ int main(int argc, const char **argv)
 
     unsigned char    * bs_buf = NULL;
     DEC              id = NULL;
-    DEC_CDSC         cdsc;
+    DEC_CDSC         cdsc = { 0 };
     COM_BITB          bitb;
     /*temporal buffer for video bit depth less than 10bit */
     COM_IMGB        * imgb_t = NULL;
@@ -32,6 +32,7 @@
 */
 
 #define _CRT_SECURE_NO_WARNINGS
+#define _DEFAULT_SOURCE /* fileno() and fdopen() under -std=c99 */
 
 #define MERGE_BITSTREAM                 1
 #define BBV_CHECK_BUGFIX                1
@@ -52,6 +53,10 @@
 #include "com_df.h"
 #include "com_sao.h"
 #endif
+#if MERGE_PARSE_ONLY && defined(LINUX)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 int g_CountDOICyCleTime;                    // number to count the DOI cycle time.
 int g_DOIPrev;                              // the doi of previous frm.
@@ -242,7 +247,12 @@ static void sequence_deinit(DEC_CTX * ctx)
     }
 #endif
 
+#if DBK_EDGE_BITMAP
+    delete_edge_filter_avs2(ctx->edge_filter);
+    ctx->edge_filter = NULL;
+#else
     delete_edge_filter_avs2(ctx->edge_filter, ctx->info.pic_height);
+#endif
 
     if (ctx->pic_sao)
     {
@@ -430,7 +440,13 @@ static int sequence_init(DEC_CTX * ctx, COM_SQH * sqh)
     ret = com_picman_init(&ctx->dpm, MAX_PB_SIZE, MAX_NUM_REF_PICS, &ctx->pa);
     com_assert_g(COM_SUCCEEDED(ret), ERR);
 
+#if DBK_EDGE_BITMAP
+    delete_edge_filter_avs2(ctx->edge_filter);
+    ctx->edge_filter = create_edge_filter_avs2(ctx->info.pic_width, ctx->info.pic_height);
+    com_assert_gv(ctx->edge_filter, ret, COM_ERR_OUT_OF_MEMORY, ERR);
+#else
     create_edge_filter_avs2(ctx->info.pic_width, ctx->info.pic_height, ctx->edge_filter);
+#endif
 
     if (ctx->pic_sao == NULL)
     {
@@ -714,9 +730,7 @@ static int xFindNextStartCode(FILE * fp, int * ruiPacketSize, unsigned char *puc
 
 static unsigned int  initParsingConvertPayloadToRBSP(const unsigned int uiBytesRead, unsigned char* pBuffer, unsigned char* pBuffer2)
 {
-    unsigned int uiZeroCount = 0;
     unsigned int uiBytesReadOffset = 0;
-    unsigned int uiBitsReadOffset = 0;
     const unsigned char *pucRead = pBuffer;
     unsigned char *pucWrite = pBuffer2;
 
@@ -748,61 +762,10 @@ static unsigned int  initParsingConvertPayloadToRBSP(const unsigned int uiBytesR
     pucWrite[uiWriteOffset] = ucHeaderType;
 
     uiWriteOffset++;
-
-    unsigned char ucCurByte = pucRead[uiBytesReadOffset];
-
-    for (; uiBytesReadOffset < uiBytesRead; uiBytesReadOffset++)
-    {
-        ucCurByte = pucRead[uiBytesReadOffset];
-
-        if (2 <= uiZeroCount && 0x02 == pucRead[uiBytesReadOffset])
-        {
-            pucWrite[uiWriteOffset] = ((pucRead[uiBytesReadOffset] >> 2) << (uiBitsReadOffset + 2));
-            uiBitsReadOffset += 2;
-            uiZeroCount = 0;
-            //printf("\n error uiBitsReadOffset \n");
-            if (uiBitsReadOffset >= 8)
-            {
-                uiBitsReadOffset = 0;
-                continue;
-            }
-            if (uiBytesReadOffset >= uiBytesRead)
-            {
-                break;
-            }
-        }
-        else if (2 <= uiZeroCount && 0x01 == pucRead[uiBytesReadOffset])
-        {
-            uiBitsReadOffset = 0;
-            pucWrite[uiWriteOffset] = pucRead[uiBytesReadOffset];
-        }
-        else
-        {
-            pucWrite[uiWriteOffset] = (pucRead[uiBytesReadOffset] << uiBitsReadOffset);
-        }
-
-        if (uiBytesReadOffset + 1 < uiBytesRead)
-        {
-            pucWrite[uiWriteOffset] |= (pucRead[uiBytesReadOffset + 1] >> (8 - uiBitsReadOffset));
-
-        }
-        uiWriteOffset++;
-
-        if (0x00 == ucCurByte)
-        {
-            uiZeroCount++;
-        }
-        else
-        {
-            uiZeroCount = 0;
-        }
-    }
+    uiWriteOffset += com_rbsp_extract(pucRead + uiBytesReadOffset, uiBytesRead - uiBytesReadOffset, pucWrite + uiWriteOffset);
 
     // th just clear the remaining bits in the buffer
-    for (unsigned int ui = uiWriteOffset; ui < uiBytesRead; ui++)
-    {
-        pucWrite[ui] = 0;
-    }
+    memset(pucWrite + uiWriteOffset, 0, uiBytesRead - uiWriteOffset);
     //    initParsing(uiWriteOffset);
     memcpy(pBuffer, pBuffer2, uiWriteOffset);
 
@@ -952,11 +915,615 @@ void write_tmp_bs(COM_PIC_HEADER * pic_header, int add_dtr, unsigned char *bs_bu
     fwrite(&tmp_bs, 1, 1, merge_fp);
 }
 
+#if MERGE_PARSE_ONLY
+#if !BUGFIX_CRR_MERGE || !BUGFIX_MULTI_RAP
+#error "MERGE_PARSE_ONLY implements the merge rules of BUGFIX_CRR_MERGE and BUGFIX_MULTI_RAP"
+#endif
+/* input bitstream held as a whole (mapped when possible), packets are returned as spans of it */
+typedef struct _MERGE_BS
+{
+    unsigned char * data;
+    int             size;
+    int             mapped;
+} MERGE_BS;
+
+static int merge_bs_open(MERGE_BS * m, const char * fname)
+{
+    FILE * fp;
+    memset(m, 0, sizeof(MERGE_BS));
+    fp = fopen(fname, "rb");
+    if (fp == NULL)
+    {
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    m->size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+#if defined(LINUX)
+    {
+        /* the bitstream reader looks up to 3 bytes past a packet, so they have to lie in the last mapped page */
+        long page = sysconf(_SC_PAGESIZE);
+        if (m->size > 0 && m->size % page != 0 && m->size % page <= page - 3)
+        {
+            void * p = mmap(NULL, m->size, PROT_READ, MAP_PRIVATE, fileno(fp), 0);
+            if (p != MAP_FAILED)
+            {
+                m->data = (unsigned char *)p;
+                m->mapped = 1;
+                fclose(fp);
+                return 0;
+            }
+        }
+    }
+#endif
+    m->data = (unsigned char *)calloc(m->size + 4, 1);
+    if (m->data == NULL || (int)fread(m->data, 1, m->size, fp) != m->size)
+    {
+        free(m->data);
+        m->data = NULL;
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+    return 0;
+}
+
+static void merge_bs_close(MERGE_BS * m)
+{
+#if defined(LINUX)
+    if (m->mapped)
+    {
+        munmap(m->data, m->size);
+    }
+    else
+#endif
+    {
+        free(m->data);
+    }
+    memset(m, 0, sizeof(MERGE_BS));
+}
+
+/* packet from the start code at pos up to the next sequence header, picture header, slice or end code start
+   code (the boundaries of xFindNextStartCode()), returns its size or -1 when there is none */
+static int merge_bs_read(MERGE_BS * m, int pos, unsigned char ** pkt)
+{
+    unsigned char * p = m->data + pos, * q;
+    int avail = m->size - pos, off = 3;
+
+    if (avail < 3 || p[0] != 0x00 || p[1] != 0x00 || p[2] != 0x01)
+    {
+        v2print("End of file\n");
+        return -1;
+    }
+    *pkt = p;
+    while ((q = off < avail ? (unsigned char *)memchr(p + off, 0x01, avail - off) : NULL) != NULL)
+    {
+        off = (int)(q - p);
+        if (off + 1 < avail && off >= 5 && q[-1] == 0x00 && q[-2] == 0x00 &&
+            (q[1] == 0xb3 || q[1] == 0xb6 || q[1] == 0xb0 || q[1] == 0xb1 || q[1] == 0x00))
+        {
+            return off - 2;
+        }
+        off++;
+    }
+    return avail;
+}
+
+/* what the merge uses of a decoder instance: the bitstream reader and the headers, without the picture
+   buffers, maps and loop filter state sequence_init() allocates */
+typedef struct _MERGE_CTX
+{
+    COM_BSR          bs;
+    DEC_SBAC         sbac_dec;
+    COM_SQH          sqh;
+    COM_PIC_HEADER   pic_header;
+    int              init_flag;
+} MERGE_CTX;
+
+static void merge_ctx_delete(MERGE_CTX * ctx)
+{
+    COM_PIC_HEADER * pic_header = &ctx->pic_header;
+    if (pic_header->alf_picture_param)
+    {
+        for (int i = 0; i < N_C; i++)
+        {
+            if (pic_header->alf_picture_param[i]) free_alf_param(pic_header->alf_picture_param[i], i);
+        }
+        free(pic_header->alf_picture_param);
+    }
+    free(pic_header->pic_alf_on);
+#if ESAO && ESAO_PH_SYNTAX
+    free(pic_header->pic_esao_params);
+#endif
+#if CCSAO && CCSAO_PH_SYNTAX
+    free(pic_header->pic_ccsao_params);
+#endif
+    free(ctx);
+}
+
+static MERGE_CTX * merge_ctx_create(void)
+{
+    MERGE_CTX * ctx = (MERGE_CTX *)calloc(1, sizeof(MERGE_CTX));
+    COM_PIC_HEADER * pic_header;
+    if (ctx == NULL)
+    {
+        return NULL;
+    }
+    pic_header = &ctx->pic_header;
+    pic_header->pic_alf_on = (int *)calloc(N_C, sizeof(int));
+    pic_header->alf_picture_param = (ALF_PARAM **)calloc(N_C, sizeof(ALF_PARAM *));
+#if ESAO && ESAO_PH_SYNTAX
+    pic_header->pic_esao_params = (ESAO_BLK_PARAM *)calloc(N_C, sizeof(ESAO_BLK_PARAM));
+#endif
+#if CCSAO && CCSAO_PH_SYNTAX
+    pic_header->pic_ccsao_params = (CCSAO_BLK_PARAM *)calloc(N_C - 1, sizeof(CCSAO_BLK_PARAM));
+#endif
+    if (pic_header->pic_alf_on == NULL || pic_header->alf_picture_param == NULL
+#if ESAO && ESAO_PH_SYNTAX
+        || pic_header->pic_esao_params == NULL
+#endif
+#if CCSAO && CCSAO_PH_SYNTAX
+        || pic_header->pic_ccsao_params == NULL
+#endif
+        )
+    {
+        merge_ctx_delete(ctx);
+        return NULL;
+    }
+    for (int i = 0; i < N_C; i++)
+    {
+        allocate_alf_param(&pic_header->alf_picture_param[i], i
+#if ALF_SHAPE || ALF_SHIFT
+                           , ALF_MAX_NUM_COEF_SHAPE2 + ALF_SHIFT
+#endif
+        );
+    }
+    return ctx;
+}
+
+/* picture header state sequence_init() takes from the sequence header */
+static void merge_ctx_sequence_init(MERGE_CTX * ctx)
+{
+    ctx->pic_header.low_delay = ctx->sqh.low_delay;
+#if ALF_SHAPE || ALF_IMP || ALF_SHIFT
+    ctx->pic_header.tool_alf_enhance_on = ctx->sqh.adaptive_leveling_filter_enhance_flag;
+#endif
+    ctx->pic_header.tool_alf_on = ctx->sqh.adaptive_leveling_filter_enable_flag;
+    ctx->init_flag = 1;
+}
+
+static void merge_ctx_start(MERGE_CTX * ctx, unsigned char * pkt, int size)
+{
+    com_bsr_init(&ctx->bs, pkt, size, NULL);
+    SET_SBAC_DEC(&ctx->bs, &ctx->sbac_dec);
+}
+
+#if LIBVC_ON
+/* header and first slice of a picture in the library bitstream */
+typedef struct _MERGE_LIBPIC
+{
+    int             library_picture_index;
+    unsigned char * hdr;
+    int             hdr_size;
+    unsigned char * slice;
+    int             slice_size;
+} MERGE_LIBPIC;
+
+/* merges the library bitstream into the sequence bitstream: each RL picture is preceded by the library
+   sequence header, the library picture it references and the sequence header of the main bitstream */
+static int merge_lib_and_seq_bitstream(void)
+{
+    MERGE_BS         in_lib, in_seq;
+    MERGE_CTX      * ctx_lib, * ctx_seq;
+    MERGE_LIBPIC   * libpic = NULL, * lp;
+    COM_PIC_HEADER * sh_seq;
+    FILE           * fp_bs_write;
+    unsigned char  * lib_sqh, * seq_sqh, * pkt;
+    int              lib_sqh_size, seq_sqh_size, size, pos, ret;
+    int              num_libpic = 0, max_libpic = 0;
+    int              last_referenced_library_index = -1;
+
+    setvbuf(stdout, NULL, _IOLBF, 1024);
+    fp_bs_write = fopen(op_fname_out, "wb");
+    if (merge_bs_open(&in_lib, op_fname_inp_lib) || merge_bs_open(&in_seq, op_fname_inp_seq) || fp_bs_write == NULL)
+    {
+        v0print("ERROR: cannot open input or output bitstream file = %s, %s, %s\n", op_fname_inp_lib, op_fname_inp_seq, op_fname_out);
+        print_usage();
+        return -1;
+    }
+    ctx_lib = merge_ctx_create();
+    ctx_seq = merge_ctx_create();
+    if (ctx_lib == NULL || ctx_seq == NULL)
+    {
+        v0print("ERROR: cannot allocate sqh or sh buffer\n");
+        return -1;
+    }
+
+    lib_sqh_size = merge_bs_read(&in_lib, 0, &lib_sqh);
+    if (lib_sqh_size <= 0 || lib_sqh[3] != 0xB0)
+    {
+        v0print("ERROR: The start code of lib bistream is not SPS \n");
+        return -1;
+    }
+    merge_ctx_start(ctx_lib, lib_sqh, lib_sqh_size);
+    ret = dec_eco_sqh(&ctx_lib->bs, &ctx_lib->sqh);
+    com_assert_rv(COM_SUCCEEDED(ret), ret);
+    merge_ctx_sequence_init(ctx_lib);
+
+    seq_sqh_size = merge_bs_read(&in_seq, 0, &seq_sqh);
+    if (seq_sqh_size <= 0 || seq_sqh[3] != 0xB0)
+    {
+        v0print("ERROR: The start code of seq bistream is not SPS \n");
+        return -1;
+    }
+    merge_ctx_start(ctx_seq, seq_sqh, seq_sqh_size);
+    ret = dec_eco_sqh(&ctx_seq->bs, &ctx_seq->sqh);
+    com_assert_rv(COM_SUCCEEDED(ret), ret);
+    merge_ctx_sequence_init(ctx_seq);
+
+    /* index the library pictures once, later sequence headers of the library bitstream are not used */
+    for (pos = lib_sqh_size; pos < in_lib.size; pos += size)
+    {
+        size = merge_bs_read(&in_lib, pos, &pkt);
+        if (size <= 0)
+        {
+            break;
+        }
+        if (pkt[3] == 0xB3 || pkt[3] == 0xB6)
+        {
+            int need_minus_256 = 0;
+            merge_ctx_start(ctx_lib, pkt, size);
+            ret = dec_eco_pic_header(&ctx_lib->bs, &ctx_lib->pic_header, &ctx_lib->sqh, &need_minus_256);
+            com_assert_rv(COM_SUCCEEDED(ret), ret);
+            if (num_libpic == max_libpic)
+            {
+                max_libpic = max_libpic ? max_libpic * 2 : 16;
+                libpic = (MERGE_LIBPIC *)realloc(libpic, max_libpic * sizeof(MERGE_LIBPIC));
+                com_assert_rv(libpic != NULL, COM_ERR_OUT_OF_MEMORY);
+            }
+            lp = &libpic[num_libpic++];
+            lp->library_picture_index = ctx_lib->pic_header.library_picture_index;
+            lp->hdr = pkt;
+            lp->hdr_size = size;
+            lp->slice = NULL;
+            lp->slice_size = 0;
+        }
+        else if (pkt[3] <= 0x8E && num_libpic > 0 && libpic[num_libpic - 1].slice == NULL)
+        {
+            libpic[num_libpic - 1].slice = pkt;
+            libpic[num_libpic - 1].slice_size = size;
+        }
+    }
+
+    sh_seq = &ctx_seq->pic_header;
+    for (pos = seq_sqh_size; pos < in_seq.size; pos += size)
+    {
+        size = merge_bs_read(&in_seq, pos, &pkt);
+        if (size <= 0)
+        {
+            break;
+        }
+        if (pkt[3] == 0xB0)
+        {
+            /* repeated sequence headers are replaced by the one written before each RL and I picture */
+            continue;
+        }
+        if (pkt[3] == 0xB3 || pkt[3] == 0xB6)
+        {
+            int need_minus_256 = 0;//MX: useless here ? no operation to the PM.
+            merge_ctx_start(ctx_seq, pkt, size);
+            ret = dec_eco_pic_header(&ctx_seq->bs, sh_seq, &ctx_seq->sqh, &need_minus_256);
+            com_assert_rv(COM_SUCCEEDED(ret), ret);
+
+            //find the referenced library_picture_index
+            if (sh_seq->is_RLpic_flag && (sh_seq->rpl_l0.ref_pic_active_num > 0 || sh_seq->rpl_l1.ref_pic_active_num > 0))
+            {
+                int referenced_lib_index;
+                if (sh_seq->rpl_l0.ref_pic_active_num > 0)
+                {
+                    referenced_lib_index = sh_seq->rpl_l0.ref_pics_ddoi[0];
+                    for (int i = 1; i < sh_seq->rpl_l0.ref_pic_active_num; i++)
+                    {
+                        if (referenced_lib_index != sh_seq->rpl_l0.ref_pics_ddoi[i])
+                        {
+                            v0print("ERROR: RL_pic can only reference 1 libpic at now \n");
+                            return -1;
+                        }
+                    }
+                    for (int i = 0; i < sh_seq->rpl_l1.ref_pic_active_num; i++)
+                    {
+                        if (referenced_lib_index != sh_seq->rpl_l1.ref_pics_ddoi[i])
+                        {
+                            v0print("ERROR: RL_pic can only reference 1 libpic at now \n");
+                            return -1;
+                        }
+                    }
+                }
+                else
+                {
+                    referenced_lib_index = sh_seq->rpl_l1.ref_pics_ddoi[0];
+                    for (int i = 1; i < sh_seq->rpl_l1.ref_pic_active_num; i++)
+                    {
+                        if (referenced_lib_index != sh_seq->rpl_l1.ref_pics_ddoi[i])
+                        {
+                            v0print("ERROR: RL_pic can only reference 1 libpic at now \n");
+                            return -1;
+                        }
+                    }
+                }
+
+                // when it's the first RL_pic || the referenced_library_picture_index is not same to the last_referenced_library_index
+                if (last_referenced_library_index < 0 || last_referenced_library_index != referenced_lib_index)
+                {
+                    for (lp = libpic; lp < libpic + num_libpic; lp++)
+                    {
+                        if (lp->library_picture_index == referenced_lib_index && lp->slice != NULL)
+                        {
+                            break;
+                        }
+                    }
+                    if (lp == libpic + num_libpic)
+                    {
+                        v0print("ERROR: the referenced lib pic is not in the input lib bitstream! \n");
+                        return -1;
+                    }
+                    //write lib sps, lib sh and lib pic
+                    fwrite(lib_sqh, 1, lib_sqh_size, fp_bs_write);
+                    fwrite(lp->hdr, 1, lp->hdr_size, fp_bs_write);
+                    fwrite(lp->slice, 1, lp->slice_size, fp_bs_write);
+                    last_referenced_library_index = referenced_lib_index;
+                }
+                //write seq sps
+                fwrite(seq_sqh, 1, seq_sqh_size, fp_bs_write);
+            }
+            else if (sh_seq->slice_type == SLICE_I)
+            {
+                //write seq sps
+                fwrite(seq_sqh, 1, seq_sqh_size, fp_bs_write);
+            }
+        }
+        fwrite(pkt, 1, size, fp_bs_write);
+    }
+
+    free(libpic);
+    merge_ctx_delete(ctx_lib);
+    merge_ctx_delete(ctx_seq);
+    merge_bs_close(&in_lib);
+    merge_bs_close(&in_seq);
+    fclose(fp_bs_write);
+    return 0;
+}
+#endif
+
+#if MERGE_BITSTREAM
+/* merges the bitstreams given as every second argument into the last one: pictures after the first RAP picture
+   of each following bitstream get their picture header rewritten with continued POC and decode order */
+static int merge_bitstreams(int argc, const char ** argv)
+{
+    MERGE_BS         in;
+    MERGE_CTX      * ctx;
+    COM_BSR        * bs;
+    COM_SQH        * sqh;
+    COM_PIC_HEADER * pic_header;
+    COM_BSW          new_bs;
+    FILE           * fp_bs_write;
+    unsigned char  * new_bs_buf, * new_bs_buf2, * bs_buf;
+    u8               startcodebuf[3] = { 0x00, 0x00, 0x01 };
+    int              max_bs_num, bs_num, bs_size, bs_read_pos, ret;
+    int              ctype = 0;
+    int              pictureslice = 0;
+    int              pic_cnt = 0;
+    int              bitstreamno = -1;
+    int              i_period = 0;
+    int              i_periodflag = 0;
+    int              max_bframes = 0;
+    int              gopflag = 0;
+    int              isFirstPicAfterSQH = 0;
+    int              same_ISLICE_flag;
+    int              num_i_period_all = 0;
+    int              num_i_period_cur = 0;
+
+    // set line buffering (_IOLBF) for stdout to prevent incomplete logs when app crashed.
+    setvbuf(stdout, NULL, _IOLBF, 1024);
+    max_bs_num = argc - 2;
+    fp_bs_write = fopen(argv[max_bs_num + 1], "wb");
+    new_bs_buf = malloc(MAX_BS_BUF);
+    new_bs_buf2 = malloc(MAX_BS_BUF);
+    if (fp_bs_write == NULL || new_bs_buf == NULL || new_bs_buf2 == NULL)
+    {
+        v0print("ERROR: cannot open output bitstream or allocate bit buffer, size=%d\n", MAX_BS_BUF);
+        return -1;
+    }
+    for (bs_num = 2; bs_num <= max_bs_num; bs_num += 2)
+    {
+        ++bitstreamno;
+        // same_ISLICE_flag '1' means that the former picture is a repeated RAP picture: it is set for the first RAP
+        // picture of a non-first bitstream and cleared once that picture is processed.
+        same_ISLICE_flag = bitstreamno > 0 ? 1 : 0;
+        num_i_period_all += num_i_period_cur;
+        num_i_period_cur = 0;
+        if (merge_bs_open(&in, argv[bs_num]))
+        {
+            v0print("ERROR: cannot open bitstream file = %s\n", argv[bs_num]);
+            print_usage();
+            return -1;
+        }
+        ctx = merge_ctx_create();
+        if (ctx == NULL)
+        {
+            v0print("ERROR: cannot allocate sqh or sh buffer\n");
+            return -1;
+        }
+        bs = &ctx->bs;
+        sqh = &ctx->sqh;
+        pic_header = &ctx->pic_header;
+        bs_read_pos = 0;
+        while (1)
+        {
+            bs_size = merge_bs_read(&in, bs_read_pos, &bs_buf);
+            if (bs_size <= 0)
+            {
+                v0print("ERROR: no start code at %d in bitstream file = %s\n", bs_read_pos, argv[bs_num]);
+                return -1;
+            }
+            bs_read_pos += bs_size;
+            merge_ctx_start(ctx, bs_buf, bs_size);
+
+            if (bs_buf[3] == 0xB0)
+            {
+                ctype = COM_CT_SQH;
+                isFirstPicAfterSQH++;
+            }
+            else if (bs_buf[3] == 0xB3 || bs_buf[3] == 0xB6)
+            {
+                ctype = COM_CT_PICTURE;
+                /* check whether the picture is RL picture or not, picture slice of RL picture should be set as 0 */
+                pictureslice = isFirstPicAfterSQH == 1 ? 0 : 1;
+                isFirstPicAfterSQH = 0;
+                // count the number of intra period in a bitstream.
+                if (pictureslice == 0)
+                {
+                    num_i_period_cur++;
+                }
+            }
+            else if (bs_buf[3] <= 0x8E)
+            {
+                ctype = COM_CT_SLICE;
+            }
+
+            if (ctype == COM_CT_SQH)
+            {
+                ret = dec_eco_sqh(bs, sqh);
+                com_assert_rv(COM_SUCCEEDED(ret), ret);
+                if (!ctx->init_flag)
+                {
+                    merge_ctx_sequence_init(ctx);
+                    g_DOIPrev = g_CountDOICyCleTime = 0;
+                }
+                if (bitstreamno > 0 && same_ISLICE_flag == 1)
+                {
+                    fseek(fp_bs_write, -4, SEEK_CUR);
+                    num_i_period_cur--;
+                }
+                else
+                {
+                    fwrite(bs_buf, 1, bs_size, fp_bs_write);
+                }
+            }
+            else if (ctype == COM_CT_PICTURE)
+            {
+                if (bitstreamno == 0)
+                {
+                    // all the RAP pictures in the first bitstream are written as they are.
+                    if (pictureslice == 0)
+                    {
+                        if (i_periodflag == 0) i_periodflag++;
+                        else if (i_periodflag == 1)
+                        {
+                            int need_minus_256 = 0;
+                            ret = dec_eco_pic_header(bs, pic_header, sqh, &need_minus_256);
+                            com_assert_rv(COM_SUCCEEDED(ret), ret);
+                            i_period = pic_header->poc;
+                            i_periodflag++;
+                            // if the max_b_frames is not set at this moment, the gop_size should be equal to the intra_period
+                            if (max_bframes == 0)
+                            {
+                                max_bframes = pic_header->poc - 1;
+                                gopflag++;
+                            }
+                        }
+                    }
+                    else if (gopflag == 0)
+                    {
+                        int need_minus_256 = 0;
+                        ret = dec_eco_pic_header(bs, pic_header, sqh, &need_minus_256);
+                        com_assert_rv(COM_SUCCEEDED(ret), ret);
+                        max_bframes = pic_header->poc - 1;
+                        gopflag++;
+                    }
+                    fwrite(bs_buf, 1, bs_size, fp_bs_write);
+                }
+                else if (pictureslice == 1 || same_ISLICE_flag == 0)
+                {
+                    COM_RPL * rpl[2] = { &pic_header->rpl_l0, &pic_header->rpl_l1 };
+                    int need_minus_256 = 0;
+                    pic_header->low_delay = sqh->low_delay;
+                    ret = dec_eco_pic_header(bs, pic_header, sqh, &need_minus_256);
+                    com_assert_rv(COM_SUCCEEDED(ret), ret);
+
+                    for (int lidx = 0; lidx < 2; lidx++)
+                    {
+                        for (int j = 0; j < rpl[lidx]->ref_pic_num; j++)
+                        {
+                            if (!rpl[lidx]->library_index_flag[j] && rpl[lidx]->ref_pics_ddoi[j] == pic_header->decode_order_index)
+                            {
+                                rpl[lidx]->ref_pics_ddoi[j] += max_bframes;
+                                pic_header->ref_pic_list_sps_flag[lidx] = 0;
+                                break;
+                            }
+                        }
+                    }
+                    // the poc of pictures in the non-first bitstream is modified.
+                    pic_header->poc = pic_header->poc + i_period * (num_i_period_all - 1);
+                    pic_header->decode_order_index = pic_cnt;
+                    pic_header->picture_output_delay = pic_header->poc - pic_cnt + sqh->output_reorder_delay; //output_delay = POI - DOI + reoder
+
+                    com_bsw_init(&new_bs, new_bs_buf, new_bs_buf2, MAX_BS_BUF, NULL);
+                    ret = enc_eco_pic_header(&new_bs, pic_header, sqh);
+                    com_assert_rv(ret == COM_OK, ret);
+                    fwrite(new_bs.beg, 1, new_bs.cur - new_bs.beg, fp_bs_write);
+#if EXTENSION_USER_DATA && WRITE_MD5_IN_USER_DATA
+                    if (com_bsr_next(bs, 32) == 0x1B2)
+                    {
+                        fwrite(startcodebuf, 1, 3, fp_bs_write);
+                        bs->cur += 3 - bs->leftbits / 8;
+                        fwrite(bs->cur, 1, (bs->end - 3) - bs->cur + 1, fp_bs_write);
+                    }
+#endif
+                }
+            }
+            else if (ctype == COM_CT_SLICE)
+            {
+                if (pictureslice == 0)
+                {
+                    // a RAP picture is written for all RAP pictures of the first bitstream and for all but the
+                    // first one of the other bitstreams.
+                    if (bitstreamno == 0 || same_ISLICE_flag == 0)
+                    {
+                        fwrite(bs_buf, 1, bs_size, fp_bs_write);
+                        pic_cnt++;
+                    }
+                    same_ISLICE_flag = 0;
+                }
+                else
+                {
+                    fwrite(bs_buf, 1, bs_size, fp_bs_write);
+                    pic_cnt++;
+                }
+            }
+
+            if (bs_read_pos == in.size)
+            {
+                pic_cnt--;
+                break;
+            }
+        }
+        merge_ctx_delete(ctx);
+        merge_bs_close(&in);
+    }
+    free(new_bs_buf);
+    free(new_bs_buf2);
+    fclose(fp_bs_write);
+    return 0;
+}
+#endif
+#endif
+
 int main(int argc, const char **argv)
 {
     unsigned char    * bs_buf = NULL;
     DEC              id = NULL;
-    DEC_CDSC         cdsc;
+    DEC_CDSC         cdsc = { 0 };
     COM_BITB          bitb;
     /*temporal buffer for video bit depth less than 10bit */
     COM_IMGB        * imgb_t = NULL;
@@ -996,8 +1563,8 @@ int main(int argc, const char **argv)
     unsigned char      *bs_buf_lib2 = NULL;
     DEC                id_lib = NULL;
     DEC                id_seq = NULL;
-    DEC_CDSC           cdsc_lib;
-    DEC_CDSC           cdsc_seq;
+    DEC_CDSC           cdsc_lib = { 0 };
+    DEC_CDSC           cdsc_seq = { 0 };
     COM_BSR          * bs_lib;
     COM_BSR          * bs_seq;
     COM_SQH          * sqh_lib = NULL;
@@ -1046,6 +1613,11 @@ int main(int argc, const char **argv)
 
     if (op_merge_libandseq_bitstream_flag)
     {
+#if MERGE_PARSE_ONLY
+        ret = merge_lib_and_seq_bitstream();
+        delete_libvcdata(&libvc_data);
+        return ret;
+#else
         //initialize
         int last_referenced_library_index = -1;
 
@@ -1546,6 +2118,7 @@ int main(int argc, const char **argv)
         if (fp_bs_write) fclose(fp_bs_write);
         delete_libvcdata(&libvc_data);
         return 0;
+#endif
     }
     else
 #endif
@@ -2252,6 +2825,9 @@ int main(int argc, const char **argv)
 #endif
 #if MERGE_BITSTREAM
         {
+#if MERGE_PARSE_ONLY
+            return merge_bitstreams(argc, argv);
+#else
             // set line buffering (_IOLBF) for stdout to prevent incomplete logs when app crashed.
             setvbuf(stdout, NULL, _IOLBF, 1024);
             max_bs_num = argc - 2;
@@ -2688,6 +3264,7 @@ int main(int argc, const char **argv)
             }
             if (fp_bs_write) fclose(fp_bs_write);
             return 0;
+#endif
         }
 #else
         {
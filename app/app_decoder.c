@@ -32,6 +32,7 @@
 */
 
 #define _CRT_SECURE_NO_WARNINGS
+#define _DEFAULT_SOURCE /* fileno(), fdopen() and madvise() under -std=c99 */
 
 #define DECODING_TIME_TEST 1
 
@@ -39,6 +40,13 @@
 #include "app_util.h"
 #include "app_args.h"
 #include "dec_def.h"
+#if STREAM_API
+#include "dec_stream.h"
+#endif
+#if BS_READER_MMAP && defined(LINUX)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #if LINUX
 #include <execinfo.h>
 #include <signal.h>
@@ -73,6 +81,9 @@ static int  op_use_pic_signature = 0;
 static int  op_clip_org_size = 0;
 static int  op_bit_depth_output_cfg = 0;
 static int  op_bit_depth_output = 0;
+#if LF_ROW_PARALLEL
+static int  op_threads = 1;
+#endif
 #if LIBVC_ON
 static char op_fname_inp_libpics[256] = "\0"; /* bitstream of libpics */
 static char op_fname_out_libpics[256] = "\0"; /* reconstructed yuv of libpics */
@@ -93,6 +104,9 @@ typedef enum _OP_FLAGS
     OP_FLAG_CLIP_ORG_SIZE,
     OP_FLAG_OUT_BIT_DEPTH,
     OP_FLAG_VERBOSE,
+#if LF_ROW_PARALLEL
+    OP_FLAG_THREADS,
+#endif
 #if LIBVC_ON
     OP_FLAG_FNAME_INP_LIBPICS,
     OP_FLAG_FNAME_OUT_LIBPICS,
@@ -120,6 +134,13 @@ static COM_ARGS_OPTION options[] = \
         "\t 1: frame-level messages (default)\n"
         "\t 2: all messages\n"
     },
+#if LF_ROW_PARALLEL
+    {
+        COM_ARGS_NO_KEY, "threads", ARGS_TYPE_INTEGER,
+        &op_flag[OP_FLAG_THREADS], &op_threads,
+        "number of threads running the in-loop filters (default: 1)"
+    },
+#endif
 #if LIBVC_ON
     {
         COM_ARGS_NO_KEY, "input_libpics", ARGS_TYPE_STRING,
@@ -148,6 +169,170 @@ static void print_usage(void)
     }
 }
 
+#if BS_READER_MMAP
+#define BS_READ_CHUNK              (1 << 20) /* bytes appended to the window when the stream cannot be mapped */
+
+/* bitstream source: the whole file mapped, or a window refilled from a pipe */
+typedef struct _BS_READER
+{
+    FILE          * fp;
+    unsigned char * data;
+    /* valid bytes in data and first byte of the next packet */
+    size_t          size;
+    size_t          pos;
+    /* window capacity, 0 when the file is mapped */
+    size_t          cap;
+    int             eof;
+} BS_READER;
+
+static int bs_reader_open(BS_READER * r, const char * fname)
+{
+    memset(r, 0, sizeof(BS_READER));
+    r->fp = fopen(fname, "rb");
+    if (r->fp == NULL)
+    {
+        return -1;
+    }
+#if defined(LINUX)
+    {
+        struct stat st;
+        void * m;
+        if (!fstat(fileno(r->fp), &st) && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(r->fp), 0);
+            if (m != MAP_FAILED)
+            {
+                madvise(m, st.st_size, MADV_SEQUENTIAL);
+                r->data = (unsigned char *)m;
+                r->size = st.st_size;
+                r->eof = 1;
+                return 0;
+            }
+        }
+    }
+#endif
+    r->cap = BS_READ_CHUNK * 4;
+    r->data = (unsigned char *)malloc(r->cap);
+    return r->data ? 0 : -1;
+}
+
+static void bs_reader_close(BS_READER * r)
+{
+#if defined(LINUX)
+    if (r->cap == 0)
+    {
+        if (r->data) munmap(r->data, r->size);
+    }
+    else
+#endif
+    {
+        free(r->data);
+    }
+    if (r->fp) fclose(r->fp);
+    memset(r, 0, sizeof(BS_READER));
+}
+
+/* drops the consumed bytes from the window and appends the next block, returns 0 at the end of the stream */
+static int bs_reader_fill(BS_READER * r)
+{
+    size_t n;
+    if (r->eof)
+    {
+        return 0;
+    }
+    memmove(r->data, r->data + r->pos, r->size - r->pos);
+    r->size -= r->pos;
+    r->pos = 0;
+    if (r->cap - r->size < BS_READ_CHUNK)
+    {
+        unsigned char * data = (unsigned char *)realloc(r->data, r->cap * 2);
+        if (data == NULL)
+        {
+            r->eof = 1;
+            return 0;
+        }
+        r->data = data;
+        r->cap *= 2;
+    }
+    n = fread(r->data + r->size, 1, BS_READ_CHUNK, r->fp);
+    r->size += n;
+    if (n < BS_READ_CHUNK)
+    {
+        r->eof = 1;
+    }
+    return n > 0;
+}
+
+/* packet from the start code at the read position up to the next sequence header, picture header or
+   first slice start code (or the end of the stream); the span stays valid until the next call */
+static int bs_reader_next(BS_READER * r, unsigned char ** pkt, int * pkt_size)
+{
+    unsigned char * p, * q;
+    size_t avail, off, scan = 3;
+
+    while (r->size - r->pos < 3 && bs_reader_fill(r));
+    p = r->data + r->pos;
+    if (r->size - r->pos < 3 || p[0] != 0x00 || p[1] != 0x00 || p[2] != 0x01)
+    {
+        return -1;
+    }
+    while (1)
+    {
+        p = r->data + r->pos;
+        avail = r->size - r->pos;
+        q = scan < avail ? (unsigned char *)memchr(p + scan, 0x01, avail - scan) : NULL;
+        if (q == NULL || (size_t)(q - p) + 1 >= avail)
+        {
+            /* the start code or its type byte may continue in the next block */
+            scan = q ? (size_t)(q - p) : avail;
+            if (bs_reader_fill(r))
+            {
+                continue;
+            }
+            off = r->size - r->pos;
+            break;
+        }
+        off = q - p;
+        if (off >= 5 && q[-1] == 0x00 && q[-2] == 0x00 && (q[1] == 0xb3 || q[1] == 0xb6 || q[1] == 0xb0 || q[1] == 0x00 || q[1] == 0xb1))
+        {
+            off -= 2;
+            break;
+        }
+        scan = off + 1;
+    }
+    *pkt = r->data + r->pos;
+    *pkt_size = (int)off;
+    r->pos += off;
+    return 0;
+}
+
+#if STREAM_API
+/* next span of the stream for the decoder stream: the mapping in slices of 1 GB, or a block read from a pipe */
+static int bs_reader_block(BS_READER * r, unsigned char ** data, int * size)
+{
+    size_t n;
+    if (r->cap == 0)
+    {
+        n = r->size - r->pos;
+        n = n < (1 << 30) ? n : (1 << 30);
+        *data = r->data + r->pos;
+        r->pos += n;
+    }
+    else
+    {
+        n = r->eof ? 0 : fread(r->data, 1, r->cap, r->fp);
+        if (n < r->cap)
+        {
+            r->eof = 1;
+        }
+        *data = r->data;
+    }
+    *size = (int)n;
+    return n > 0;
+}
+#endif
+
+#else
 static int xFindNextStartCode(FILE * fp, int * ruiPacketSize, unsigned char *pucBuffer)
 {
     unsigned int uiDummy = 0;
@@ -249,73 +434,45 @@ static int xFindNextStartCode(FILE * fp, int * ruiPacketSize, unsigned char *puc
     };
     return 0;
 }
+#endif
 
+#if BS_READER_MMAP
+/* removes the emulation prevention bits of pucRead into pBuffer and terminates it with a start code */
+static unsigned int initParsingConvertPayloadToRBSP(const unsigned int uiBytesRead, const unsigned char* pucRead, unsigned char* pBuffer)
+{
+    unsigned int uiWriteOffset = com_rbsp_extract(pucRead, uiBytesRead, pBuffer);
+#else
 static unsigned int initParsingConvertPayloadToRBSP(const unsigned int uiBytesRead, unsigned char* pBuffer, unsigned char* pBuffer2)
 {
-    unsigned int uiZeroCount = 0;
-    unsigned int uiBytesReadOffset = 0;
-    unsigned int uiBitsReadOffset = 0;
-    const unsigned char *pucRead = pBuffer;
-    unsigned char *pucWrite = pBuffer2;
-    unsigned int uiWriteOffset = uiBytesReadOffset;
-    unsigned char ucCurByte = pucRead[uiBytesReadOffset];
-
-    for (uiBytesReadOffset = 0; uiBytesReadOffset < uiBytesRead; uiBytesReadOffset++)
-    {
-        ucCurByte = pucRead[uiBytesReadOffset];
-        if (2 <= uiZeroCount && 0x02 == pucRead[uiBytesReadOffset])
-        {
-            pucWrite[uiWriteOffset] = ((pucRead[uiBytesReadOffset] >> 2) << (uiBitsReadOffset + 2));
-            uiBitsReadOffset += 2;
-            uiZeroCount = 0;
-            if (uiBitsReadOffset >= 8)
-            {
-                uiBitsReadOffset = 0;
-                continue;
-            }
-            if (uiBytesReadOffset >= uiBytesRead)
-            {
-                break;
-            }
-        }
-        else if (2 <= uiZeroCount && 0x01 == pucRead[uiBytesReadOffset])
-        {
-            uiBitsReadOffset = 0;
-            pucWrite[uiWriteOffset] = pucRead[uiBytesReadOffset];
-        }
-        else
-        {
-            pucWrite[uiWriteOffset] = (pucRead[uiBytesReadOffset] << uiBitsReadOffset);
-        }
-
-        if (uiBytesReadOffset + 1 < uiBytesRead)
-        {
-            pucWrite[uiWriteOffset] |= (pucRead[uiBytesReadOffset + 1] >> (8 - uiBitsReadOffset));
-        }
-        uiWriteOffset++;
-
-        if (0x00 == ucCurByte)
-        {
-            uiZeroCount++;
-        }
-        else
-        {
-            uiZeroCount = 0;
-        }
-    }
-
-    // th just clear the remaining bits in the buffer
-    for (unsigned int ui = uiWriteOffset; ui < uiBytesRead; ui++)
-    {
-        pucWrite[ui] = 0;
-    }
+    unsigned int uiWriteOffset = com_rbsp_extract(pBuffer, uiBytesRead, pBuffer2);
     memcpy(pBuffer, pBuffer2, uiWriteOffset);
+#endif
+    // th just clear the remaining bits in the buffer
+    memset(pBuffer + uiWriteOffset, 0, uiBytesRead - uiWriteOffset);
     pBuffer[uiWriteOffset] = 0x00;
     pBuffer[uiWriteOffset + 1] = 0x00;
     pBuffer[uiWriteOffset + 2] = 0x01;
     return uiBytesRead;
 }
 
+#if BS_READER_MMAP
+static int read_a_bs(BS_READER * r, unsigned char * bs_buf)
+{
+    unsigned char * pkt;
+    int bs_size;
+    if (bs_reader_next(r, &pkt, &bs_size))
+    {
+        v2print("End of file\n");
+        return -1;
+    }
+    if (bs_size + 3 > MAX_BS_BUF)
+    {
+        v0print("Bitstream packet of %d bytes exceeds the bit buffer\n", bs_size);
+        return -1;
+    }
+    return initParsingConvertPayloadToRBSP(bs_size, pkt, bs_buf);
+}
+#else
 static int read_a_bs(FILE * fp, int * pos, unsigned char * bs_buf, unsigned char * bs_buf2)
 {
     int read_size, bs_size;
@@ -340,6 +497,7 @@ static int read_a_bs(FILE * fp, int * pos, unsigned char * bs_buf, unsigned char
     }
     return read_size;
 }
+#endif
 
 static int print_stat(DEC_CTX * ctx, DEC_STAT * stat, int ret)
 {
@@ -560,6 +718,32 @@ static int write_dec_img(DEC id, char * fname, COM_IMGB * img, int bit_depth_int
 )
 {
     COM_IMGB* imgb_t = NULL;
+    DEC_CTX *ctx = (DEC_CTX *)id;
+    if (op_bit_depth_output_cfg == 0)
+    {
+        op_bit_depth_output = bit_depth_internal;
+    }
+    else
+    {
+      op_bit_depth_output = op_bit_depth_output_cfg;
+    }
+#if OUTPUT_SINK
+    {
+        APP_SINK * sink = app_sink_find(fname);
+#if FIELD_CODING & 1
+        if (sink && !ctx->field_coding)
+#else
+        if (sink)
+#endif
+        {
+            if (op_clip_org_size)
+            {
+                return imgb_write_conv(sink, img, op_bit_depth_output, bit_depth_internal, ctx->info.sqh.horizontal_size, ctx->info.sqh.vertical_size);
+            }
+            return imgb_write_conv(sink, img, op_bit_depth_output, bit_depth_internal, img->width[0], img->height[0]);
+        }
+    }
+#endif
     if (imgb_t == NULL)
     {
         imgb_t = imgb_alloc(img->width[0], img->height[0], COM_COLORSPACE_YUV420, bit_depth_internal);
@@ -569,18 +753,8 @@ static int write_dec_img(DEC id, char * fname, COM_IMGB * img, int bit_depth_int
             return -1;
         }
     }
-
-    if (op_bit_depth_output_cfg == 0)
-    {
-        op_bit_depth_output = bit_depth_internal;
-    }
-    else
-    {
-      op_bit_depth_output = op_bit_depth_output_cfg;
-    }
     imgb_cpy_conv_rec(imgb_t, img, op_bit_depth_output, bit_depth_internal);
 
-    DEC_CTX *ctx = (DEC_CTX *)id;
     int dec_width = imgb_t->width[0];
     int dec_height = imgb_t->height[0];
     if (op_clip_org_size)
@@ -622,8 +796,14 @@ static int write_dec_img(DEC id, char * fname, COM_IMGB * img, int bit_depth_int
             unsigned char * p8;
             int             i, j;
             FILE          * fp;
+#if OUTPUT_SINK
+            APP_SINK      * sink = app_sink_find(fname);
+            fp = sink ? NULL : fopen(fname, "ab");
+            if (fp == NULL && sink == NULL)
+#else
             fp = fopen(fname, "ab");
             if (fp == NULL)
+#endif
             {
                 print("cannot open file = %s\n", fname);
                 return -1;
@@ -641,10 +821,20 @@ static int write_dec_img(DEC id, char * fname, COM_IMGB * img, int bit_depth_int
                 }
                 for (j = 0; j < height; j++)
                 {
+#if OUTPUT_SINK
+                    if (sink)
+                    {
+                        app_sink_write(sink, p8, width * scale);
+                    }
+                    else
+#endif
                     fwrite(p8, width * scale, 1, fp);
                     p8 += scale * imgb_t->width[i];
                 }
             }
+#if OUTPUT_SINK
+            if (fp)
+#endif
             fclose(fp);
 
             (*state_output_field) = 0;
@@ -685,7 +875,9 @@ int decode_libpics(DEC_CDSC * cdsc, LibVCData* libvc_data)
 {
     STATES            state_lib = STATE_DECODING;
     unsigned char   * bs_buf_lib = NULL;
+#if !BS_READER_MMAP
     unsigned char   * bs_buf_lib2 = NULL;
+#endif
     DEC               id_lib = NULL;
     COM_BITB          bitb_lib;
     COM_IMGB        * imgb_lib;
@@ -695,7 +887,11 @@ int decode_libpics(DEC_CDSC * cdsc, LibVCData* libvc_data)
     int               bs_cnt_lib, pic_cnt_lib;
     int               bs_size_lib, bs_read_pos_lib = 0;
     int               width_lib, height_lib;
+#if BS_READER_MMAP
+    BS_READER         bsr_lib;
+#else
     FILE            * fp_bs_lib = NULL;
+#endif
 #if LINUX
     signal(SIGSEGV, handler);   // install our handler
 #endif
@@ -704,8 +900,12 @@ int decode_libpics(DEC_CDSC * cdsc, LibVCData* libvc_data)
 #endif
 
     /* open input bitstream */
+#if BS_READER_MMAP
+    if (bs_reader_open(&bsr_lib, op_fname_inp_libpics))
+#else
     fp_bs_lib = fopen(op_fname_inp_libpics, "rb");
     if (fp_bs_lib == NULL)
+#endif
     {
         v0print("ERROR: cannot open libpics bitstream file = %s\n", op_fname_inp_libpics);
         print_usage();
@@ -714,6 +914,14 @@ int decode_libpics(DEC_CDSC * cdsc, LibVCData* libvc_data)
     if (op_flag[OP_FLAG_FNAME_OUT_LIBPICS])
     {
         /* remove decoded file contents if exists */
+#if OUTPUT_SINK
+        if (app_sink_open(op_fname_out_libpics, "wb") == NULL)
+        {
+            v0print("ERROR: cannot create a decoded libpics file\n");
+            print_usage();
+            return -1;
+        }
+#else
         FILE * fp;
         fp = fopen(op_fname_out_libpics, "wb");
         if (fp == NULL)
@@ -723,6 +931,7 @@ int decode_libpics(DEC_CDSC * cdsc, LibVCData* libvc_data)
             return -1;
         }
         fclose(fp);
+#endif
     }
     bs_buf_lib = malloc(MAX_BS_BUF);
     if (bs_buf_lib == NULL)
@@ -731,12 +940,14 @@ int decode_libpics(DEC_CDSC * cdsc, LibVCData* libvc_data)
         return -1;
     }
 
+#if !BS_READER_MMAP
     bs_buf_lib2 = malloc(MAX_BS_BUF);
     if (bs_buf_lib2 == NULL)
     {
         v0print("ERROR: cannot allocate bit buffer, size2=%d\n", MAX_BS_BUF);
         return -1;
     }
+#endif
 
     id_lib = dec_create(cdsc, NULL);
     if (id_lib == NULL)
@@ -759,7 +970,11 @@ int decode_libpics(DEC_CDSC * cdsc, LibVCData* libvc_data)
     {
         if (state_lib == STATE_DECODING)
         {
+#if BS_READER_MMAP
+            bs_size_lib = read_a_bs(&bsr_lib, bs_buf_lib);
+#else
             bs_size_lib = read_a_bs(fp_bs_lib, &bs_read_pos_lib, bs_buf_lib, bs_buf_lib2);
+#endif
             if (bs_size_lib <= 0)
             {
                 state_lib = STATE_BUMPING;
@@ -827,18 +1042,100 @@ END:
     libvc_data->num_lib_pic = pic_cnt_lib;
 
     if (id_lib) dec_delete(id_lib);
+#if OUTPUT_SINK
+    app_sink_close(app_sink_find(op_fname_out_libpics));
+#endif
+#if BS_READER_MMAP
+    bs_reader_close(&bsr_lib);
+#else
     if (fp_bs_lib) fclose(fp_bs_lib);
+#endif
     if (bs_buf_lib) free(bs_buf_lib);
     return 0;
 }
 #endif
 
+#if STREAM_API
+/* counters and output buffers of main() that the decoder stream callbacks update */
+typedef struct _APP_DEC_OUT
+{
+    DEC               id;
+    int             * bs_cnt;
+    int             * pic_cnt;
+#if FIELD_CODING
+    unsigned char  ** temp_buffer_output_field;
+    int             * state_output_field;
+#endif
+} APP_DEC_OUT;
+
+static int app_dec_packet(void * opaque, int size, DEC_STAT * stat, int ret)
+{
+    APP_DEC_OUT * out = (APP_DEC_OUT *)opaque;
+    v1print("[%4d]-th BS (%07dbytes)   --> ", (*out->bs_cnt)++, size);
+    if (stat->ctype == COM_CT_SEQ_END)
+    {
+        v1print("bumping process starting...\n");
+    }
+    else if (COM_SUCCEEDED(ret))
+    {
+        print_stat((DEC_CTX *)out->id, stat, ret);
+    }
+    return 0;
+}
+
+static int app_dec_frame(void * opaque, COM_IMGB * imgb)
+{
+    APP_DEC_OUT * out = (APP_DEC_OUT *)opaque;
+    DEC_CTX * ctx = (DEC_CTX *)out->id;
+    if (op_flag[OP_FLAG_FNAME_OUT])
+    {
+#if FIELD_CODING & 1
+        if (ctx->field_coding)
+        {
+            int scale = 1;
+            if (op_bit_depth_output_cfg == 0)
+            {
+                scale = (ctx->info.bit_depth_internal == 10) ? 2 : 1;
+            }
+            else
+            {
+                scale = (op_bit_depth_output_cfg == 10) ? 2 : 1;
+            }
+            for (int comp = 0; comp < 3; comp++)
+            {
+                if (out->temp_buffer_output_field[comp] == NULL)
+                {
+                    int size_byte = ((imgb->width[0] * (imgb->height[0] << 1)) >> (comp > 0 ? 2 : 0)) * scale;
+                    out->temp_buffer_output_field[comp] = malloc(size_byte);
+                }
+            }
+        }
+#endif
+        write_dec_img(out->id, op_fname_out, imgb, ctx->info.bit_depth_internal
+#if FIELD_CODING
+                        , out->temp_buffer_output_field, out->state_output_field
+#endif
+        );
+    }
+    (*out->pic_cnt)++;
+    return 0;
+}
+#endif
+
 int main(int argc, const char **argv)
 {
     STATES            state = STATE_DECODING;
     unsigned char   * bs_buf = NULL;
+#if !BS_READER_MMAP
     unsigned char   * bs_buf2 = NULL;
+#endif
     DEC               id = NULL;
+#if STREAM_API
+    DEC_STREAM      * stream = NULL;
+    DEC_STREAM_CB     stream_cb;
+    APP_DEC_OUT       out;
+    unsigned char   * bs_data;
+#endif
     DEC_CDSC          cdsc;
     COM_BITB          bitb;
     COM_IMGB        * imgb;
@@ -848,7 +1145,11 @@ int main(int argc, const char **argv)
     int               bs_cnt, pic_cnt;
     int               bs_size = 0, bs_read_pos = 0;
     int               width, height;
+#if BS_READER_MMAP
+    BS_READER         bsr;
+#else
     FILE            * fp_bs = NULL;
+#endif
 #if ENC_DEC_TRACE
     fp_trace = NULL;
 #endif
@@ -868,8 +1169,12 @@ int main(int argc, const char **argv)
         return -1;
     }
     /* open input bitstream */
+#if BS_READER_MMAP
+    if (bs_reader_open(&bsr, op_fname_inp))
+#else
     fp_bs = fopen(op_fname_inp, "rb");
     if(fp_bs == NULL)
+#endif
     {
         v0print("ERROR: cannot open bitstream file = %s\n", op_fname_inp);
         print_usage();
@@ -878,6 +1183,14 @@ int main(int argc, const char **argv)
     if(op_flag[OP_FLAG_FNAME_OUT])
     {
         /* remove decoded file contents if exists */
+#if OUTPUT_SINK
+        if (app_sink_open(op_fname_out, "wb") == NULL)
+        {
+            v0print("ERROR: cannot create a decoded file\n");
+            print_usage();
+            return -1;
+        }
+#else
         FILE * fp;
         fp = fopen(op_fname_out, "wb");
         if(fp == NULL)
@@ -887,6 +1200,7 @@ int main(int argc, const char **argv)
             return -1;
         }
         fclose(fp);
+#endif
     }
     bs_buf = malloc(MAX_BS_BUF);
     if(bs_buf == NULL)
@@ -894,12 +1208,18 @@ int main(int argc, const char **argv)
         v0print("ERROR: cannot allocate bit buffer, size=%d\n", MAX_BS_BUF);
         return -1;
     }
+#if !BS_READER_MMAP
     bs_buf2 = malloc(MAX_BS_BUF);
     if (bs_buf2 == NULL)
     {
         v0print("ERROR: cannot allocate bit buffer, size=%d\n", MAX_BS_BUF);
         return -1;
     }
+#endif
+    memset(&cdsc, 0, sizeof(DEC_CDSC));
+#if LF_ROW_PARALLEL
+    cdsc.threads = op_threads;
+#endif
 #if LIBVC_ON
     LibVCData libvc_data;
     init_libvcdata(&libvc_data);
@@ -915,7 +1235,16 @@ int main(int argc, const char **argv)
         }
     }
 #endif
+#if STREAM_API
+    memset(&stream_cb, 0, sizeof(DEC_STREAM_CB));
+    stream_cb.opaque = &out;
+    stream_cb.packet = app_dec_packet;
+    stream_cb.frame = app_dec_frame;
+    stream = dec_stream_create(&cdsc, &stream_cb, NULL);
+    id = stream ? dec_stream_decoder(stream) : NULL;
+#else
     id = dec_create(&cdsc, NULL);
+#endif
     if(id == NULL)
     {
         v0print("ERROR: cannot create decoder\n");
@@ -947,11 +1276,52 @@ int main(int argc, const char **argv)
         }
     }
 #endif
+#if STREAM_API
+    out.id = id;
+    out.bs_cnt = &bs_cnt;
+    out.pic_cnt = &pic_cnt;
+#if FIELD_CODING
+    out.temp_buffer_output_field = temp_buffer_output_field;
+    out.state_output_field = &state_output_field;
+#endif
+    while (1)
+    {
+#if BS_READER_MMAP
+        if (!bs_reader_block(&bsr, &bs_data, &bs_size))
+        {
+            break;
+        }
+#else
+        bs_size = (int)fread(bs_buf, 1, MAX_BS_BUF, fp_bs);
+        if (bs_size <= 0)
+        {
+            break;
+        }
+        bs_data = bs_buf;
+#endif
+        if (COM_FAILED(dec_stream_push(stream, bs_data, bs_size)))
+        {
+            v0print("failed to decode bitstream\n");
+            return -1;
+        }
+    }
+    v1print("bumping process starting...\n");
+    if (COM_FAILED(dec_stream_flush(stream)))
+    {
+        v0print("failed to decode bitstream\n");
+        return -1;
+    }
+    v1print("bumping process completed\n");
+#else
     while(1)
     {
         if(state == STATE_DECODING)
         {
+#if BS_READER_MMAP
+            bs_size = read_a_bs(&bsr, bs_buf);
+#else
             bs_size = read_a_bs(fp_bs, &bs_read_pos, bs_buf,bs_buf2);
+#endif
             if(bs_size <= 0)
             {
                 state = STATE_BUMPING;
@@ -1047,6 +1417,7 @@ int main(int argc, const char **argv)
             pic_cnt++;
         }
     }
+#endif
 
 #if FIELD_CODING
     if (((DEC_CTX *)id)->field_coding) {
@@ -1059,7 +1430,9 @@ int main(int argc, const char **argv)
     }
 #endif
 
+#if !STREAM_API
 END:
+#endif
 #if DECODING_TIME_TEST
     clk_tot += com_clk_from(clk_beg);
 #endif
@@ -1084,7 +1457,18 @@ END:
         v1print("===========================================================\n");
     }
 
+#if STREAM_API
+    dec_stream_delete(stream);
+#else
     if(id) dec_delete(id);
+#endif
+#if OUTPUT_SINK
+    app_sink_close_all();
+#endif
+#if BS_READER_MMAP
+    bs_reader_close(&bsr);
+    if(bs_buf) free(bs_buf);
+#else
     if(fp_bs) fclose(fp_bs);
     if(bs_buf) free(bs_buf);
     if (bs_buf2)
@@ -1092,6 +1476,7 @@ END:
         free(bs_buf2);
         bs_buf2 = NULL;
     }
+#endif
 #if LIBVC_ON
     delete_libvcdata(&libvc_data);
 #endif
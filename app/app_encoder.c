@@ -31,10 +31,15 @@
 * ====================================================================================================================
 */
 
+#define _DEFAULT_SOURCE /* fileno(), fdopen() and madvise() under -std=c99 */
+
 #include <com_typedef.h>
 #include "app_util.h"
 #include "app_args.h"
 #include "enc_def.h"
+#if STREAM_API
+#include "enc_stream.h"
+#endif
 #include <math.h>
 
 #include <time.h>
@@ -135,6 +140,133 @@ static int PICYUV_TO_IMGB(TF_PIC_YUV * pPicYuv, COM_IMGB * pImgB) {
     }
     return 0;
 }
+
+#if TF_INPUT_RING
+/* main input: with the temporal filter on, every picture is read once into the filter ring, where the
+   encoder takes it from and the filter finds its neighbours */
+typedef struct _TF_INPUT
+{
+    YUV_READER        * fp;
+    TF_CTX            * tf;
+    /* conversion target of the pictures read into the ring */
+    COM_IMGB          * imgb;
+    int                 bit_depth_input;
+    int                 bit_depth_internal;
+#if FIELD_CODING
+    int                 field_coding;
+    int                 is_top_field;
+    short            ** field_buf;
+#endif
+    /* input deeper than the internal depth: the encoder's pictures, rounded down as imgb_read_conv() does;
+       the ring keeps them truncated for the filter, as its own reader did */
+    COM_IMGB          * enc_imgb[MAX_FILTER_LEN];
+    /* pictures read into the ring, next picture and last picture handed to the encoder */
+    int                 cnt;
+    int                 pos;
+    int                 cur;
+} TF_INPUT;
+
+static void tf_input_down(COM_IMGB * dst, COM_IMGB * src, int shift, int bit_depth, int round)
+{
+    const int add = round ? 1 << (shift - 1) : 0;
+    const int maxval = (1 << bit_depth) - 1;
+    int i, j, k;
+    for (i = 0; i < src->np; i++)
+    {
+        short * s = (short *)src->addr_plane[i];
+        short * d = (short *)dst->addr_plane[i];
+        for (j = 0; j < src->height[i]; j++)
+        {
+            for (k = 0; k < src->width[i]; k++)
+            {
+                d[k] = (short)IFVCA_CLIP((s[k] + add) >> shift, 0, maxval);
+            }
+            s = (short *)((unsigned char *)s + src->stride[i]);
+            d = (short *)((unsigned char *)d + dst->stride[i]);
+        }
+    }
+}
+
+/* reads input pictures into the ring until it holds picture idx */
+static int tf_input_fill(TF_INPUT * s, int idx)
+{
+    int bit_depth_read = s->enc_imgb[0] ? s->bit_depth_input : s->bit_depth_internal;
+    while (s->cnt <= idx)
+    {
+#if FIELD_CODING
+        if (imgb_read_conv(s->fp, s->imgb, s->bit_depth_input, bit_depth_read, s->field_coding, s->is_top_field, s->field_buf))
+#else
+        if (imgb_read_conv(s->fp, s->imgb, s->bit_depth_input, bit_depth_read))
+#endif
+        {
+            return -1;
+        }
+#if FIELD_CODING
+        s->is_top_field = !s->is_top_field;
+#endif
+        if (s->enc_imgb[0])
+        {
+            int shift = s->bit_depth_input - s->bit_depth_internal;
+            tf_input_down(s->enc_imgb[POC_TO_FILTER_IDX(s->cnt)], s->imgb, shift, s->bit_depth_internal, 1);
+            tf_input_down(s->imgb, s->imgb, shift, s->bit_depth_internal, 0);
+        }
+        IMGB_TO_PICYUV(s->imgb, &(s->tf->pic_bufs[POC_TO_FILTER_IDX(s->cnt)].org_pic));
+        tf_push_frame(s->tf, s->cnt);
+        s->cnt++;
+    }
+    return 0;
+}
+
+static int tf_input_read(TF_INPUT * s, COM_IMGB * img, int is_top_field)
+{
+    if (s->tf == NULL)
+    {
+#if FIELD_CODING
+        return imgb_read_conv(s->fp, img, s->bit_depth_input, s->bit_depth_internal, s->field_coding, is_top_field, s->field_buf);
+#else
+        return imgb_read_conv(s->fp, img, s->bit_depth_input, s->bit_depth_internal);
+#endif
+    }
+#if FIELD_CODING
+    /* pictures read ahead alternate from the parity of the last one the encoder asked for */
+    if (s->cnt == s->pos)
+    {
+        s->is_top_field = is_top_field;
+    }
+#endif
+    if (tf_input_fill(s, s->pos))
+    {
+        return -1;
+    }
+    if (s->enc_imgb[0])
+    {
+        COM_IMGB * src = s->enc_imgb[POC_TO_FILTER_IDX(s->pos)];
+        int i;
+        for (i = 0; i < src->np; i++)
+        {
+            __imgb_cpy_plane(src->addr_plane[i], img->addr_plane[i], 2 * src->width[i], src->height[i], src->stride[i], img->stride[i]);
+        }
+    }
+    else
+    {
+        PICYUV_TO_IMGB(&(s->tf->pic_bufs[POC_TO_FILTER_IDX(s->pos)].org_pic), img);
+    }
+    s->cur = s->pos++;
+    return 0;
+}
+
+static void tf_input_skip(TF_INPUT * s, COM_IMGB * img, int num_skipped_frames)
+{
+    if (s->tf == NULL)
+    {
+        skip_frames(s->fp, img, num_skipped_frames, s->bit_depth_input);
+    }
+    else if (num_skipped_frames > 0)
+    {
+        s->pos += num_skipped_frames;
+    }
+}
+#endif
 #endif
 
 #if LIB_PIC_UPDATE
@@ -145,7 +277,7 @@ typedef struct _ENC_LIBPIC
     STATES              state_lib;
     unsigned char      *bs_buf_lib;
     unsigned char      *bs_buf_lib2;
-    FILE               *fp_inp_lib;
+    YUV_READER         *fp_inp_lib;
     ENC                 id_lib;
     COM_BITB            bitb_lib;
     COM_IMGB           *imgb_enc_lib;
@@ -173,6 +305,12 @@ typedef struct _ENC_LIBPIC
 #endif
 //functionality
 static char op_fname_cfg[256] = "\0"; /* config file path name */
+#if ENC_PRESET
+static char op_preset[16] = "medium"; /* speed preset name */
+#endif
+#if LF_ROW_PARALLEL
+static int  op_threads = 1; /* threads running the in-loop filters and the temporal filter */
+#endif
 static char op_fname_inp[256] = "\0"; /* input original video */
 static char op_fname_out[256] = "\0"; /* output bitstream */
 static char op_fname_rec[256] = "\0"; /* reconstructed video */
@@ -502,6 +640,12 @@ static int  op_temporal_filter_strength[FILTER_TYPE] = { 95, 150, 0 };
 typedef enum _OP_FLAGS
 {
     OP_FLAG_FNAME_CFG,
+#if ENC_PRESET
+    OP_FLAG_PRESET,
+#endif
+#if LF_ROW_PARALLEL
+    OP_FLAG_THREADS,
+#endif
     OP_FLAG_FNAME_INP,
     OP_FLAG_FNAME_OUT,
     OP_FLAG_FNAME_REC,
@@ -893,6 +1037,135 @@ typedef enum _OP_FLAGS
 
 static int op_flag[OP_FLAG_MAX] = {0};
 
+#if ENC_PRESET
+/* names accepted by --preset, indexed by (ENC_PRESET_ID - ENC_PRESET_PLACEBO) */
+static const char *preset_names[ENC_PRESET_NUM] =
+{
+    "placebo", "slow", "medium", "fast", "veryfast", "ultrafast"
+};
+
+/* tools switched off from preset 'off_from' onwards unless set in the config file or on the command line */
+typedef struct _PRESET_TOOL
+{
+    int   off_from;
+    int   flag_idx;
+    int * tool;
+} PRESET_TOOL;
+
+static PRESET_TOOL preset_tools[] =
+{
+#if OBMC
+    { ENC_PRESET_FAST,      OP_TOOL_OBMC,          &op_tool_obmc          },
+#endif
+#if AFFINE_UMVE
+    { ENC_PRESET_FAST,      OP_TOOL_AFFINE_UMVE,   &op_tool_affine_umve   },
+#endif
+#if AWP_MVR
+    { ENC_PRESET_FAST,      OP_TOOL_AWP_MVR,       &op_tool_awp_mvr       },
+#endif
+#if AWP_ENH
+    { ENC_PRESET_FAST,      OP_TOOL_DAWP,          &op_tool_dawp          },
+#endif
+#if ETMVP
+    { ENC_PRESET_FAST,      OP_TOOL_ETMVP,         &op_tool_etmvp         },
+#endif
+#if IIP
+    { ENC_PRESET_FAST,      OP_TOOL_IIP,           &op_tool_iip           },
+#endif
+#if ASP
+    { ENC_PRESET_FAST,      OP_TOOL_ASP,           &op_tool_asp           },
+#endif
+#if AWP
+    { ENC_PRESET_VERYFAST,  OP_TOOL_AWP,           &op_tool_awp           },
+#endif
+#if AWP_ENH
+    { ENC_PRESET_VERYFAST,  OP_TOOL_AAWP,          &op_tool_aawp          },
+#endif
+#if SAWP
+    { ENC_PRESET_VERYFAST,  OP_TOOL_SAWP,          &op_tool_sawp          },
+#endif
+#if INTER_TM
+    { ENC_PRESET_VERYFAST,  OP_TOOL_TM,            &op_tool_tm            },
+#endif
+#if IPC
+    { ENC_PRESET_VERYFAST,  OP_TOOL_IPC,           &op_tool_ipc           },
+#endif
+#if INTERPF
+    { ENC_PRESET_VERYFAST,  OP_TOOL_INTERPF,       &op_tool_interpf       },
+#endif
+#if BGC
+    { ENC_PRESET_VERYFAST,  OP_TOOL_BGC,           &op_tool_bgc           },
+#endif
+#if SUB_TMVP
+    { ENC_PRESET_VERYFAST,  OP_TOOL_SBTMVP,        &op_tool_sbtmvp        },
+#endif
+#if MVAP
+    { ENC_PRESET_VERYFAST,  OP_TOOL_MVAP,          &op_tool_mvap          },
+#endif
+#if PMC
+    { ENC_PRESET_VERYFAST,  OP_TOOL_PMC,           &op_tool_pmc           },
+#endif
+#if CCNPM
+    { ENC_PRESET_VERYFAST,  OP_TOOL_CCNPM,         &op_tool_ccnpm         },
+#endif
+#if EST
+    { ENC_PRESET_VERYFAST,  OP_TOOL_EST,           &op_tool_est           },
+#endif
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_AFFINE,        &op_tool_affine        },
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_SMVD,          &op_tool_smvd          },
+#if DT_PARTITION
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_DT_INTRA,      &op_tool_dt_intra      },
+#endif
+#if SBT
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_SBT,           &op_tool_sbt           },
+#endif
+#if IST
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_IST,           &op_tool_ist           },
+#endif
+#if OBMC_TEMP
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_OBMC_TEMPLATE, &op_tool_obmc_template },
+#endif
+#if UMVE_ENH
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_UMVE_ENH,      &op_tool_umve_enh      },
+#endif
+#if ESAO
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_ESAO,          &op_tool_esao          },
+#endif
+#if CCSAO
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_CCSAO,         &op_tool_ccsao         },
+#endif
+#if ALF_SHAPE || ALF_IMP || ALF_SHIFT
+    { ENC_PRESET_ULTRAFAST, OP_TOOL_ALF_ENHANCE,   &op_tool_alf_enhance   },
+#endif
+};
+
+/* resolve --preset and apply its tool defaults; returns the ENC_PRESET_ID or ENC_PRESET_NUM if unknown */
+static int set_preset_tools(void)
+{
+    int preset, i;
+    for (preset = 0; preset < ENC_PRESET_NUM; preset++)
+    {
+        if (!strcmp(op_preset, preset_names[preset]))
+        {
+            break;
+        }
+    }
+    if (preset == ENC_PRESET_NUM)
+    {
+        return ENC_PRESET_NUM;
+    }
+    preset += ENC_PRESET_PLACEBO;
+    for (i = 0; i < (int)(sizeof(preset_tools) / sizeof(preset_tools[0])); i++)
+    {
+        if (preset >= preset_tools[i].off_from && !op_flag[preset_tools[i].flag_idx])
+        {
+            *preset_tools[i].tool = 0;
+        }
+    }
+    return preset;
+}
+#endif
+
 static COM_ARGS_OPTION options[] =
 {
     {
@@ -900,6 +1173,21 @@ static COM_ARGS_OPTION options[] =
         &op_flag[OP_FLAG_FNAME_CFG], op_fname_cfg,
         "file name of configuration"
     },
+#if ENC_PRESET
+    {
+        COM_ARGS_NO_KEY, "preset", ARGS_TYPE_STRING,
+        &op_flag[OP_FLAG_PRESET], op_preset,
+        "speed preset: placebo, slow, medium (default), fast, veryfast, ultrafast\n"
+        "\t tools set explicitly in the config file or on the command line are kept"
+    },
+#endif
+#if LF_ROW_PARALLEL
+    {
+        COM_ARGS_NO_KEY, "threads", ARGS_TYPE_INTEGER,
+        &op_flag[OP_FLAG_THREADS], &op_threads,
+        "number of threads running the in-loop filters and the temporal filter (default: 1)"
+    },
+#endif
     {
         'i', "input", ARGS_TYPE_STRING|ARGS_TYPE_MANDATORY,
         &op_flag[OP_FLAG_FNAME_INP], op_fname_inp,
@@ -2249,6 +2537,17 @@ static void print_usage(void)
 static int get_conf(ENC_PARAM * param)
 {
     memset(param, 0, sizeof(ENC_PARAM));
+#if ENC_PRESET
+    param->preset = set_preset_tools();
+    if (param->preset == ENC_PRESET_NUM)
+    {
+        printf("unknown preset: %s\n", op_preset);
+        return -1;
+    }
+#endif
+#if LF_ROW_PARALLEL
+    param->threads = op_threads;
+#endif
 #if PHASE_2_PROFILE
     param->profile = op_profile;
     if (param->profile != 0x22 && param->profile != 0x20
@@ -2948,6 +3247,9 @@ static void print_config(ENC id, ENC_PARAM param)
     print("\tinternal bit depth       : %d\n", param.bit_depth_internal);
     print("\tQP                       : %d\n", param.qp);
     print("\tframes                   : %d\n", op_max_frm_num);
+#if ENC_PRESET
+    print("\tpreset                   : %s\n", preset_names[param.preset - ENC_PRESET_PLACEBO]);
+#endif
 #if HDR_DISPLAY
     if (param.colour_description)
     {
@@ -3644,8 +3946,14 @@ static int write_rec(IMGB_LIST *list, COM_MTIME *ts, int bit_depth_write, int wr
                     unsigned char * p8;
                     int             comp, j;
                     FILE          * fp;
+#if OUTPUT_SINK
+                    APP_SINK      * sink = app_sink_find(filename);
+                    fp = sink ? NULL : fopen(filename, "ab");
+                    if (fp == NULL && sink == NULL)
+#else
                     fp = fopen(filename, "ab");
                     if (fp == NULL)
+#endif
                     {
                         print("cannot open file = %s\n", filename);
                         return -1;
@@ -3661,12 +3969,22 @@ static int write_rec(IMGB_LIST *list, COM_MTIME *ts, int bit_depth_write, int wr
                             width >>= 1;
                             height >>= 1;
                         }
+#if OUTPUT_SINK
+                        if (sink)
+                        {
+                            app_sink_write(sink, p8, width * scale * height);
+                            continue;
+                        }
+#endif
                         for (j = 0; j < height; j++)
                         {
                             fwrite(p8, width * scale, 1, fp);
                             p8 += (width * scale);
                         }
                     }
+#if OUTPUT_SINK
+                    if (fp)
+#endif
                     fclose(fp);
                     //if (imgb_write(filename, temp_buffer_output_field[i], bit_depth_write, dec_width, dec_height))
                     //{
@@ -3870,8 +4188,7 @@ int setup_bumping(ENC id)
 {
     ENC_CTX* ctx = (ENC_CTX *)id;
     v1print("Entering bumping process... \n");
-    ctx->param.force_output = 1;
-    ctx->pic_ticnt = ctx->pic_icnt;
+    enc_setup_bumping(ctx);
 
     return 0;
 }
@@ -3994,7 +4311,7 @@ int run_extract_feature(LibVCData *libvc_data, int candpic_idx, COM_IMGB *imgb_t
 
 int run_decide_libpic_candidate_set_and_extract_feature(ENC_PARAM param_in, LibVCData *libvc_data)
 {
-    FILE            *fp_inp_tmp = NULL;
+    YUV_READER      *fp_inp_tmp = NULL;
     STATES          state_tmp = STATE_ENCODING;
     int             pic_skip_tmp, pic_icnt_tmp;
     int             candpic_cnt;
@@ -4003,7 +4320,7 @@ int run_decide_libpic_candidate_set_and_extract_feature(ENC_PARAM param_in, LibV
     int             pic_height;
     int             ret_tmp;
 
-    fp_inp_tmp = fopen(op_fname_inp, "rb");
+    fp_inp_tmp = yuv_reader_open(op_fname_inp);
     if (fp_inp_tmp == NULL)
     {
         v0print("cannot open original file (%s)\n", op_fname_inp);
@@ -4107,7 +4424,7 @@ int run_decide_libpic_candidate_set_and_extract_feature(ENC_PARAM param_in, LibV
         imgb_free(imgb_tmp);
         imgb_tmp = NULL;
     }
-    if (fp_inp_tmp) fclose(fp_inp_tmp);
+    if (fp_inp_tmp) yuv_reader_close(fp_inp_tmp);
 
     return 0;
 }
@@ -4805,7 +5122,7 @@ int  free_enc_libpic(ENC_LIBPIC *enc_libpic)
     enc_delete(enc_libpic->id_lib, 2);
     imgb_list_free(enc_libpic->ilist_org_lib);
     imgb_list_free(enc_libpic->ilist_rec_lib);
-    if (enc_libpic->fp_inp_lib)  fclose(enc_libpic->fp_inp_lib);
+    if (enc_libpic->fp_inp_lib)  yuv_reader_close(enc_libpic->fp_inp_lib);
     if (enc_libpic->bs_buf_lib)  free(enc_libpic->bs_buf_lib); /* release bitstream buffer */
     if (enc_libpic->bs_buf_lib2) free(enc_libpic->bs_buf_lib2); /* release bitstream buffer */
     return 0;
@@ -4840,6 +5157,13 @@ int enc_prepare_LibVC(ENC_PARAM param_in, LibVCData* libvc_data, ENC_LIBPIC * en
     if (op_flag[OP_FLAG_FNAME_OUT])
     {
         /* libic bitstream file - remove contents and close */
+#if OUTPUT_SINK
+        if (app_sink_open(op_fname_libout, "wb") == NULL)
+        {
+            v0print("cannot open libpic bitstream file (%s)\n", op_fname_libout);
+            return -1;
+        }
+#else
         FILE * fp;
         fp = fopen(op_fname_libout, "wb");
         if (fp == NULL)
@@ -4848,10 +5172,18 @@ int enc_prepare_LibVC(ENC_PARAM param_in, LibVCData* libvc_data, ENC_LIBPIC * en
             return -1;
         }
         fclose(fp);
+#endif
     }
     if (op_flag[OP_FLAG_FNAME_LIBREC])
     {
         /* reconstruction libic file - remove contents and close */
+#if OUTPUT_SINK
+        if (app_sink_open(op_fname_librec, "ab") == NULL)
+        {
+            v0print("cannot open reconstruction libpic file (%s)\n", op_fname_librec);
+            return -1;
+        }
+#else
         FILE * fp;
         fp = fopen(op_fname_librec, "ab");
         if (fp == NULL)
@@ -4860,10 +5192,11 @@ int enc_prepare_LibVC(ENC_PARAM param_in, LibVCData* libvc_data, ENC_LIBPIC * en
             return -1;
         }
         fclose(fp);
+#endif
     }
 
     /* open original file */
-    enc_libpic->fp_inp_lib = fopen(op_fname_inp, "rb");
+    enc_libpic->fp_inp_lib = yuv_reader_open(op_fname_inp);
     if (enc_libpic->fp_inp_lib == NULL)
     {
         v0print("cannot open original file (%s)\n", op_fname_inp);
@@ -5194,7 +5527,7 @@ int encode_libpics(ENC_PARAM param_in, LibVCData* libvc_data)
     STATES              state_lib = STATE_ENCODING;
     unsigned char      *bs_buf_lib = NULL;
     unsigned char      *bs_buf_lib2 = NULL;
-    FILE               *fp_inp_lib = NULL;
+    YUV_READER         *fp_inp_lib = NULL;
     ENC                 id_lib;
     COM_BITB            bitb_lib;
     COM_IMGB           *imgb_enc_lib = NULL;
@@ -5225,6 +5558,13 @@ int encode_libpics(ENC_PARAM param_in, LibVCData* libvc_data)
     if (op_flag[OP_FLAG_FNAME_OUT])
     {
         /* libic bitstream file - remove contents and close */
+#if OUTPUT_SINK
+        if (app_sink_open(op_fname_libout, "wb") == NULL)
+        {
+            v0print("cannot open libpic bitstream file (%s)\n", op_fname_libout);
+            return -1;
+        }
+#else
         FILE * fp;
         fp = fopen(op_fname_libout, "wb");
         if (fp == NULL)
@@ -5233,10 +5573,18 @@ int encode_libpics(ENC_PARAM param_in, LibVCData* libvc_data)
             return -1;
         }
         fclose(fp);
+#endif
     }
     if (op_flag[OP_FLAG_FNAME_LIBREC])
     {
         /* reconstruction libic file - remove contents and close */
+#if OUTPUT_SINK
+        if (app_sink_open(op_fname_librec, "wb") == NULL)
+        {
+            v0print("cannot open reconstruction libpic file (%s)\n", op_fname_librec);
+            return -1;
+        }
+#else
         FILE * fp;
         fp = fopen(op_fname_librec, "wb");
         if (fp == NULL)
@@ -5245,10 +5593,11 @@ int encode_libpics(ENC_PARAM param_in, LibVCData* libvc_data)
             return -1;
         }
         fclose(fp);
+#endif
     }
 
     /* open original file */
-    fp_inp_lib = fopen(op_fname_inp, "rb");
+    fp_inp_lib = yuv_reader_open(op_fname_inp);
     if (fp_inp_lib == NULL)
     {
         v0print("cannot open original file (%s)\n", op_fname_inp);
@@ -5574,7 +5923,7 @@ int encode_libpics(ENC_PARAM param_in, LibVCData* libvc_data)
 #endif
     imgb_list_free(ilist_org_lib);
     imgb_list_free(ilist_rec_lib);
-    if (fp_inp_lib)  fclose(fp_inp_lib);
+    if (fp_inp_lib)  yuv_reader_close(fp_inp_lib);
     if (bs_buf_lib)  free(bs_buf_lib); /* release bitstream buffer */
     if (bs_buf_lib2) free(bs_buf_lib2); /* release bitstream buffer */
     return 0;
@@ -5586,20 +5935,213 @@ ERR:
 #endif
     imgb_list_free(ilist_org_lib);
     imgb_list_free(ilist_rec_lib);
-    if (fp_inp_lib)  fclose(fp_inp_lib);
+    if (fp_inp_lib)  yuv_reader_close(fp_inp_lib);
     if (bs_buf_lib)  free(bs_buf_lib); /* release bitstream buffer */
     if (bs_buf_lib2) free(bs_buf_lib2); /* release bitstream buffer */
     return -1;
 }
 #endif
 
+#if STREAM_API
+/* lists, counters and output buffers of main() that the encoder stream callbacks update */
+typedef struct _APP_ENC_OUT
+{
+    ENC                 id;
+    ENC_PARAM         * param;
+    IMGB_LIST         * ilist_org;
+    IMGB_LIST         * ilist_rec;
+    COM_MTIME         * pic_ocnt;
+    /* start of the coding step in progress */
+    COM_CLK           * clk_beg;
+    COM_CLK           * clk_tot;
+    int                 udata_size;
+    int               * is_first_enc;
+    double            * bitrate;
+#if !CALC_SSIM
+    double            * seq_header_bit;
+#endif
+    double            * psnr_avg;
+#if CALC_SSIM
+    double            * ms_ssim_avg;
+#endif
+#if FIELD_CODING
+    double            * merge[3];
+    unsigned char    *(*temp_buffer_output_field)[3];
+    int               * state_output_field;
+#endif
+#if TEMPORAL_FILTER
+    TF_CTX            * tf_ctx;
+#if TF_INPUT_RING
+    TF_INPUT          * tf_inp;
+#endif
+#endif
+} APP_ENC_OUT;
+
+#if TEMPORAL_FILTER
+/* filters the pushed picture in the encoder buffer */
+static int app_enc_input(void * opaque, COM_IMGB * imgb_enc, int pic_icnt)
+{
+    APP_ENC_OUT * out = (APP_ENC_OUT *)opaque;
+    TF_CTX * tf_ctx = out->tf_ctx;
+    COM_CLK clk_beg = com_clk_get();
+#if TF_INPUT_RING
+    TF_INPUT * tf_inp = out->tf_inp;
+    int tf_skip;
+#endif
+
+    IMGB_TO_PICYUV(imgb_enc, tf_ctx->org_pic);
+#if TF_INPUT_RING
+    /* the window is centred on the input picture being encoded */
+    tf_input_fill(tf_inp, tf_inp->cur + FILTER_RANGE);
+    tf_skip = tf_inp->cur - pic_icnt;
+#if DQP_OPT
+    if (tf_prepare_frames(tf_ctx, pic_icnt, tf_skip, (ENC_CTX *)out->id))
+    {
+        if (tf_filter(tf_ctx, pic_icnt + tf_skip, tf_skip, (ENC_CTX *)out->id))
+        {
+#else
+    if (tf_prepare_frames(tf_ctx, pic_icnt, tf_skip))
+    {
+        if (tf_filter(tf_ctx, pic_icnt + tf_skip, tf_skip))
+        {
+#endif
+#elif DQP_OPT
+    if (tf_prepare_frames(tf_ctx, pic_icnt, op_skip_frames, op_fname_inp, (ENC_CTX *)out->id))
+    {
+        if (tf_filter(tf_ctx, pic_icnt + op_skip_frames, op_skip_frames, (ENC_CTX *)out->id))
+        {
+#else
+    if (tf_prepare_frames(tf_ctx, pic_icnt, op_skip_frames, op_fname_inp))
+    {
+        if (tf_filter(tf_ctx, pic_icnt + op_skip_frames, op_skip_frames))
+        {
+#endif
+            PICYUV_TO_IMGB(tf_ctx->new_pic, imgb_enc);
+        }
+    }
+    *out->clk_tot += com_clk_from(clk_beg);
+    return 0;
+}
+#endif
+
+/* writes a coded unit, and for a picture its reconstruction, PSNR and statistics line */
+static int app_enc_packet(void * opaque, const u8 * data, int size, COM_IMGB * imgb_rec, ENC_STAT * stat)
+{
+    APP_ENC_OUT * out = (APP_ENC_OUT *)opaque;
+    double        psnr[3] = {0, 0, 0};
+#if CALC_SSIM
+    double        ms_ssim[3] = {0, 0, 0};
+#endif
+    IMGB_LIST   * ilist_t;
+    COM_CLK       clk_end;
+    int           i;
+
+    if (op_flag[OP_FLAG_FNAME_OUT] && size > 0)
+    {
+        if (write_data(op_fname_out, (unsigned char *)data, size, NOT_END_OF_VIDEO_SEQUENCE))
+        {
+            v0print("cannot write bitstream\n");
+            return -1;
+        }
+    }
+    if (imgb_rec == NULL)
+    {
+#if !REPEAT_SEQ_HEADER
+        if (stat->ctype == COM_CT_SQH && op_flag[OP_FLAG_FNAME_OUT])
+        {
+#if PRECISE_BS_SIZE
+            *out->bitrate += stat->write;
+#if !CALC_SSIM
+            *out->seq_header_bit = stat->write;
+#endif
+#else
+            *out->bitrate += (stat->write - 4)/* 4-byte prefix (length field of chunk) */;
+#if !CALC_SSIM
+            *out->seq_header_bit = (stat->write - 4)/* 4-byte prefix (length field of chunk) */;
+#endif
+#endif
+        }
+#endif
+        return 0;
+    }
+    clk_end = com_clk_from(*out->clk_beg);
+
+    /* calculate PSNR */
+#if CALC_SSIM
+    if (cal_psnr(out->ilist_org, imgb_rec, imgb_rec->ts[0], psnr, ms_ssim))
+#else
+    if (cal_psnr(out->ilist_org, imgb_rec, imgb_rec->ts[0], psnr))
+#endif
+    {
+        v0print("cannot calculate PSNR\n");
+        return -1;
+    }
+    /* store reconstructed image to list only for writing out */
+    ilist_t = store_rec_img(out->ilist_rec, imgb_rec, imgb_rec->ts[0], out->param->bit_depth_internal);
+    if (ilist_t == NULL)
+    {
+        v0print("cannot put reconstructed image to list\n");
+        return -1;
+    }
+    if (write_rec(out->ilist_rec, out->pic_ocnt, out->param->bit_depth_output, op_flag[OP_FLAG_FNAME_REC], op_fname_rec
+#if FIELD_CODING
+        , out->temp_buffer_output_field, out->state_output_field, out->param->field_coding
+#endif
+    ))
+    {
+        v0print("cannot write reconstruction image\n");
+        return -1;
+    }
+    if (*out->is_first_enc)
+    {
+#if CALC_SSIM
+        print_psnr(stat, psnr, ms_ssim, (stat->write - out->udata_size + (int)*out->bitrate) << 3, clk_end);
+#else
+        print_psnr(stat, psnr, (stat->write - out->udata_size + (int)*out->seq_header_bit) << 3, clk_end);
+#endif
+        *out->is_first_enc = 0;
+    }
+    else
+    {
+#if CALC_SSIM
+        print_psnr(stat, psnr, ms_ssim, (stat->write - out->udata_size) << 3, clk_end);
+#else
+        print_psnr(stat, psnr, (stat->write - out->udata_size) << 3, clk_end);
+#endif
+    }
+    *out->bitrate += (stat->write - out->udata_size);
+    for (i = 0; i < 3; i++) out->psnr_avg[i] += psnr[i];
+#if FIELD_CODING
+    out->merge[0][stat->poc] = psnr[0];
+    out->merge[1][stat->poc] = psnr[1];
+    out->merge[2][stat->poc] = psnr[2];
+#endif
+#if CALC_SSIM
+    out->ms_ssim_avg[0] += ms_ssim[0];
+#if CALC_SSIM_UV
+    if (op_msssim_uv)
+    {
+        out->ms_ssim_avg[1] += ms_ssim[1];
+        out->ms_ssim_avg[2] += ms_ssim[2];
+    }
+#endif
+#endif
+    return 0;
+}
+#endif
+
 int main(int argc, const char **argv)
 {
     STATES              state = STATE_ENCODING;
     unsigned char      *bs_buf = NULL;
     unsigned char      *bs_buf2 = NULL;
-    FILE               *fp_inp = NULL;
+    YUV_READER         *fp_inp = NULL;
     ENC                id;
+#if STREAM_API
+    ENC_STREAM        *stream = NULL;
+    ENC_STREAM_CB      stream_cb;
+    APP_ENC_OUT        out;
+#endif
     ENC_PARAM          param_input;
     COM_BITB           bitb;
     COM_IMGB          *imgb_enc = NULL; // used in the real encoding process (always 16-bit)
@@ -5635,6 +6177,10 @@ int main(int argc, const char **argv)
 #endif
 #if TEMPORAL_FILTER
     TF_CTX tf_ctx;
+#if TF_INPUT_RING
+    TF_INPUT tf_inp = { 0 };
+    int tf_skip;
+#endif
 #endif
 
     srand((unsigned int)(time(NULL)));
@@ -5652,6 +6198,13 @@ int main(int argc, const char **argv)
     if(op_flag[OP_FLAG_FNAME_OUT])
     {
         /* bitstream file - remove contents and close */
+#if OUTPUT_SINK
+        if (app_sink_open(op_fname_out, "wb") == NULL)
+        {
+            v0print("cannot open bitstream file (%s)\n", op_fname_out);
+            return -1;
+        }
+#else
         FILE * fp;
         fp = fopen(op_fname_out, "wb");
         if(fp == NULL)
@@ -5660,10 +6213,18 @@ int main(int argc, const char **argv)
             return -1;
         }
         fclose(fp);
+#endif
     }
     if(op_flag[OP_FLAG_FNAME_REC])
     {
         /* reconstruction file - remove contents and close */
+#if OUTPUT_SINK
+        if (app_sink_open(op_fname_rec, "wb") == NULL)
+        {
+            v0print("cannot open reconstruction file (%s)\n", op_fname_rec);
+            return -1;
+        }
+#else
         FILE * fp;
         fp = fopen(op_fname_rec, "wb");
         if(fp == NULL)
@@ -5672,15 +6233,17 @@ int main(int argc, const char **argv)
             return -1;
         }
         fclose(fp);
+#endif
     }
     /* open original file */
-    fp_inp = fopen(op_fname_inp, "rb");
+    fp_inp = yuv_reader_open(op_fname_inp);
     if(fp_inp == NULL)
     {
         v0print("cannot open original file (%s)\n", op_fname_inp);
         print_usage();
         return -1;
     }
+#if !STREAM_API
     /* allocate bitstream buffer */
     bs_buf = (unsigned char*)malloc(MAX_BS_BUF);
     if(bs_buf == NULL)
@@ -5694,6 +6257,7 @@ int main(int argc, const char **argv)
         v0print("cannot allocate bitstream buffer, size=%d", MAX_BS_BUF);
         return -1;
     }
+#endif
     /* read configurations and set values for create descriptor */
     if(get_conf(&param_input))
     {
@@ -5861,19 +6425,44 @@ int main(int argc, const char **argv)
     };
         
     if (op_temporal_filter) {
-        tf_init(&tf_ctx, param_input.qp, param_input.pic_width, param_input.pic_height,
-                param_input.bit_depth_input, param_input.bit_depth_internal, 
-                filter_strength, op_temporal_filter_period, 
-                op_temporal_filter_lookahead);
+        if (tf_init(&tf_ctx, param_input.qp, param_input.pic_width, param_input.pic_height,
+                    param_input.bit_depth_input, param_input.bit_depth_internal, 
+                    filter_strength, op_temporal_filter_period, 
+                    op_temporal_filter_lookahead))
+        {
+            v0print("cannot initialize temporal filter\n");
+            tf_uninit(&tf_ctx);
+            return -1;
+        }
     }
 #endif
     /* create encoder */
+#if STREAM_API
+    memset(&stream_cb, 0, sizeof(ENC_STREAM_CB));
+    stream_cb.opaque = &out;
+    stream_cb.packet = app_enc_packet;
+#if TEMPORAL_FILTER
+    if (op_temporal_filter)
+    {
+        stream_cb.input = app_enc_input;
+    }
+#endif
+    stream = enc_stream_create(&param_input, &stream_cb, NULL);
+    id = stream ? enc_stream_encoder(stream) : NULL;
+#else
     id = enc_create(&param_input, NULL);
+#endif
     if (id == NULL)
     {
         v0print("cannot create encoder\n");
         return -1;
     }
+#if TEMPORAL_FILTER && TF_PARALLEL && LF_ROW_PARALLEL
+    if (op_temporal_filter)
+    {
+        tf_ctx.pool = ((ENC_CTX *)id)->pool;
+    }
+#endif
 #if LIBVC_ON
     set_livcdata_enc(id, &libvc_data);
 #endif
@@ -5917,7 +6506,38 @@ int main(int argc, const char **argv)
 #endif
     /* encode Sequence Header if needed **************************************/
     bitb.err = 0; // update BSB
-#if REPEAT_SEQ_HEADER
+#if STREAM_API
+    memset(&out, 0, sizeof(APP_ENC_OUT));
+    out.id = id;
+    out.param = &param_input;
+    out.ilist_org = ilist_org;
+    out.ilist_rec = ilist_rec;
+    out.pic_ocnt = &pic_ocnt;
+    out.clk_beg = &clk_beg;
+    out.clk_tot = &clk_tot;
+    out.udata_size = udata_size;
+    out.is_first_enc = &is_first_enc;
+    out.bitrate = &bitrate;
+#if !CALC_SSIM
+    out.seq_header_bit = &seq_header_bit;
+#endif
+    out.psnr_avg = psnr_avg;
+#if CALC_SSIM
+    out.ms_ssim_avg = ms_ssim_avg;
+#endif
+#if TEMPORAL_FILTER
+    out.tf_ctx = &tf_ctx;
+#if TF_INPUT_RING
+    out.tf_inp = &tf_inp;
+#endif
+#endif
+    ret = enc_stream_header(stream);
+    if (COM_FAILED(ret))
+    {
+        v0print("cannot encode header \n");
+        return -1;
+    }
+#elif REPEAT_SEQ_HEADER
     ret = init_seq_header( (ENC_CTX *)id, &bitb);
 #else
     ret = enc_seq_header((ENC_CTX *)id, &bitb, &stat);
@@ -5982,7 +6602,39 @@ int main(int argc, const char **argv)
             }
         }
     }
-
+#endif
+#if TF_INPUT_RING
+    tf_inp.fp = fp_inp;
+    tf_inp.tf = op_temporal_filter ? &tf_ctx : NULL;
+    tf_inp.bit_depth_input = param_input.bit_depth_input;
+    tf_inp.bit_depth_internal = param_input.bit_depth_internal;
+#if FIELD_CODING
+    tf_inp.field_coding = param_input.field_coding;
+    tf_inp.is_top_field = 1;
+    tf_inp.field_buf = temp_buffer_input_field;
+#endif
+    if (tf_inp.tf)
+    {
+        tf_inp.imgb = imgb_alloc(param_input.pic_width, param_input.pic_height, COM_COLORSPACE_YUV420, 10);
+        if (tf_inp.imgb == NULL)
+        {
+            v0print("cannot allocate temporal filter input buffer\n");
+            goto ERR;
+        }
+        tf_inp.imgb->horizontal_size = param_input.horizontal_size;
+        tf_inp.imgb->vertical_size = param_input.vertical_size;
+        for (i = 0; i < MAX_FILTER_LEN && param_input.bit_depth_input > param_input.bit_depth_internal; i++)
+        {
+            tf_inp.enc_imgb[i] = imgb_alloc(param_input.pic_width, param_input.pic_height, COM_COLORSPACE_YUV420, 10);
+            if (tf_inp.enc_imgb[i] == NULL)
+            {
+                v0print("cannot allocate temporal filter input buffer\n");
+                goto ERR;
+            }
+        }
+    }
+#endif
+#if FIELD_CODING
 	double psnr_merge_avg[3] = { 0, 0 ,0 };
 	double *merge_y;
 	double *merge_u;
@@ -5990,6 +6642,13 @@ int main(int argc, const char **argv)
 	merge_y = (double *)malloc(sizeof(double) * param_input.frames_to_be_encoded);
 	merge_u = (double *)malloc(sizeof(double) * param_input.frames_to_be_encoded);
 	merge_v = (double *)malloc(sizeof(double) * param_input.frames_to_be_encoded);
+#if STREAM_API
+    out.merge[0] = merge_y;
+    out.merge[1] = merge_u;
+    out.merge[2] = merge_v;
+    out.temp_buffer_output_field = temp_buffer_output_field;
+    out.state_output_field = state_output_field;
+#endif
 #endif
 
     /* encode pictures *******************************************************/
@@ -6013,7 +6672,9 @@ int main(int argc, const char **argv)
                     goto ERR;
                 }
 
-#if FIELD_CODING
+#if TF_INPUT_RING
+                if (pic_icnt == param_input.frames_to_be_encoded || tf_input_read(&tf_inp, ilist_t->imgb, !(pic_icnt%2)))
+#elif FIELD_CODING
                 if (pic_icnt == param_input.frames_to_be_encoded || imgb_read_conv(fp_inp, ilist_t->imgb, param_input.bit_depth_input, param_input.bit_depth_internal, param_input.field_coding, !(pic_icnt%2), temp_buffer_input_field))
 #else
                 if (pic_icnt == param_input.frames_to_be_encoded || imgb_read_conv(fp_inp, ilist_t->imgb, param_input.bit_depth_input, param_input.bit_depth_internal))
@@ -6054,7 +6715,9 @@ int main(int argc, const char **argv)
                 return -1;
             }
             /* read original image */
-#if FIELD_CODING
+#if TF_INPUT_RING
+            if (pic_icnt == param_input.frames_to_be_encoded || tf_input_read(&tf_inp, ilist_t->imgb, !(pic_icnt%2)))
+#elif FIELD_CODING
             if (pic_icnt == param_input.frames_to_be_encoded || imgb_read_conv(fp_inp, ilist_t->imgb, param_input.bit_depth_input, param_input.bit_depth_internal, param_input.field_coding, !(pic_icnt%2), temp_buffer_input_field))
 #else
             if (pic_icnt == param_input.frames_to_be_encoded || imgb_read_conv(fp_inp, ilist_t->imgb, param_input.bit_depth_input, param_input.bit_depth_internal))
@@ -6062,10 +6725,19 @@ int main(int argc, const char **argv)
             {
                 v2print("reached end of original file (or reading error)\n");
                 state = STATE_BUMPING;
+#if STREAM_API
+                v1print("Entering bumping process... \n");
+                enc_stream_push(stream, NULL);
+#else
                 setup_bumping(id);
+#endif
                 continue;
             }
+#if TF_INPUT_RING
+            tf_input_skip(&tf_inp, ilist_t->imgb, param_input.sub_sample_ratio - 1);
+#else
             skip_frames(fp_inp, ilist_t->imgb, param_input.sub_sample_ratio - 1, param_input.bit_depth_input);
+#endif
 #if LIB_PIC_UPDATE
             if (op_lib_pic_update)
             {
@@ -6080,6 +6752,15 @@ int main(int argc, const char **argv)
 #endif
             imgb_list_make_used(ilist_t, pic_icnt);
 
+#if STREAM_API
+            /* push image to encoder, the temporal filter runs in app_enc_input() */
+            ret = enc_stream_push(stream, ilist_t->imgb);
+            if (COM_FAILED(ret))
+            {
+                v0print("enc_push() failed\n");
+                return -1;
+            }
+#else
             /* get encoding buffer */
             if(COM_OK != enc_picbuf_get_inbuf((ENC_CTX *)id, &imgb_enc))
             {
@@ -6093,7 +6774,22 @@ int main(int argc, const char **argv)
             {
                 clk_beg = com_clk_get();
                 IMGB_TO_PICYUV(imgb_enc, tf_ctx.org_pic);
+#if TF_INPUT_RING
+                /* the window is centred on the input picture being encoded */
+                tf_input_fill(&tf_inp, tf_inp.cur + FILTER_RANGE);
+                tf_skip = tf_inp.cur - (int)pic_icnt;
 #if DQP_OPT
+                if (tf_prepare_frames(&tf_ctx, (int)pic_icnt, tf_skip, (ENC_CTX *)id))
+                {
+                    if (tf_filter(&tf_ctx, (int)pic_icnt + tf_skip, tf_skip, (ENC_CTX *)id))
+                    {
+#else
+                if (tf_prepare_frames(&tf_ctx, (int)pic_icnt, tf_skip))
+                {
+                    if (tf_filter(&tf_ctx, (int)pic_icnt + tf_skip, tf_skip))
+                    {
+#endif
+#elif DQP_OPT
                 if (tf_prepare_frames(&tf_ctx, (int)pic_icnt, op_skip_frames, op_fname_inp, (ENC_CTX *)id))
                 {
                     if (tf_filter(&tf_ctx, (int)pic_icnt + op_skip_frames, op_skip_frames, (ENC_CTX *)id))
@@ -6120,6 +6816,7 @@ int main(int argc, const char **argv)
             }
             /* release encoding buffer */
             imgb_enc->release(imgb_enc);
+#endif
             pic_icnt++;
         }
         /* encoding */
@@ -6138,7 +6835,9 @@ int main(int argc, const char **argv)
                     goto ERR;
                 }
 
-#if FIELD_CODING
+#if TF_INPUT_RING
+                if (pic_icnt == param_input.frames_to_be_encoded || tf_input_read(&tf_inp, ilist_t->imgb, !(pic_icnt%2)))
+#elif FIELD_CODING
                 if (pic_icnt == param_input.frames_to_be_encoded || imgb_read_conv(fp_inp, ilist_t->imgb, param_input.bit_depth_input, param_input.bit_depth_internal, param_input.field_coding, !(pic_icnt%2), NULL))
 #else
                 if (pic_icnt == param_input.frames_to_be_encoded || imgb_read_conv(fp_inp, ilist_t->imgb, param_input.bit_depth_input, param_input.bit_depth_internal))
@@ -6147,7 +6846,11 @@ int main(int argc, const char **argv)
                     v2print("reached end of original file (or reading error)\n");
                     goto ERR;
                 }            
+#if TF_INPUT_RING
+                    tf_input_skip(&tf_inp, ilist_t->imgb, param_input.sub_sample_ratio - 1);
+#else
                     skip_frames(fp_inp, ilist_t->imgb, param_input.sub_sample_ratio - 1, param_input.bit_depth_input);
+#endif
                     if (pic_lib_skip+1 >= libvc_data.list_poc_of_RLpic[rl_k] && libvc_data.list_poc_of_RLpic[rl_k] >= 0)
                     {
                         if (pic_lib_skip > 0 || (pic_lib_skip + 1 >= libvc_data.list_poc_of_RLpic[rl_k + 1] 
@@ -6170,7 +6873,22 @@ int main(int argc, const char **argv)
                 {
                     clk_beg = com_clk_get();
                     IMGB_TO_PICYUV(imgb_enc, tf_ctx.org_pic);
+#if TF_INPUT_RING
+                    /* the window is centred on the input picture being encoded */
+                    tf_input_fill(&tf_inp, tf_inp.cur + FILTER_RANGE);
+                    tf_skip = tf_inp.cur - (int)pic_icnt;
 #if DQP_OPT
+                    if (tf_prepare_frames(&tf_ctx, (int)pic_icnt, tf_skip, (ENC_CTX *)id))
+                    {
+                        if (tf_filter(&tf_ctx, (int)pic_icnt + tf_skip, tf_skip, (ENC_CTX *)id))
+                        {
+#else
+                    if (tf_prepare_frames(&tf_ctx, (int)pic_icnt, tf_skip))
+                    {
+                        if (tf_filter(&tf_ctx, (int)pic_icnt + tf_skip, tf_skip))
+                        {
+#endif
+#elif DQP_OPT
                     if (tf_prepare_frames(&tf_ctx, (int)pic_icnt, op_skip_frames, op_fname_inp, (ENC_CTX *)id))
                     {
                         if (tf_filter(&tf_ctx, (int)pic_icnt + op_skip_frames, op_skip_frames, (ENC_CTX *)id))
@@ -6208,7 +6926,11 @@ int main(int argc, const char **argv)
             }
 
         }
+#if STREAM_API
+        ret = enc_stream_encode(stream);
+#else
         ret = enc_encode(id, &bitb, &stat);
+#endif
         if (ret == RL_UPDATE_TO_LIBPIC)
         {
             {
@@ -6249,12 +6971,20 @@ int main(int argc, const char **argv)
                 print_libenc_data(libvc_data);
             }
             libvc_data.update = 0;
+#if STREAM_API
+            ret = enc_stream_encode(stream);
+#else
             ret = enc_encode(id, &bitb, &stat);
+#endif
         }
         if (ret == COM_OK_SKIP)
             continue;
+#else
+#if STREAM_API
+        ret = enc_stream_encode(stream);
 #else
         ret = enc_encode(id, &bitb, &stat);
+#endif
 #endif
         num_encoded_frames += ret == COM_OK;
         if(COM_FAILED(ret))
@@ -6272,6 +7002,9 @@ int main(int argc, const char **argv)
         }
         else if (ret == COM_OK)
         {
+#if STREAM_API
+            /* bitstream, reconstruction and PSNR were handled by app_enc_packet() */
+#else
             if (op_flag[OP_FLAG_FNAME_OUT] && stat.write > 0)
             {
                 int end_of_seq = (param_input.frames_to_be_encoded == num_encoded_frames) ? END_OF_VIDEO_SEQUENCE : NOT_END_OF_VIDEO_SEQUENCE;
@@ -6357,6 +7090,7 @@ int main(int argc, const char **argv)
 #endif
             /* release recon buffer */
             if(imgb_rec) imgb_rec->release(imgb_rec);
+#endif
         }
         else if (ret == COM_OK_NO_MORE_FRM)
         {
@@ -6371,7 +7105,12 @@ int main(int argc, const char **argv)
                 && state == STATE_ENCODING)
         {
             state = STATE_BUMPING;
+#if STREAM_API
+            v1print("Entering bumping process... \n");
+            enc_stream_push(stream, NULL);
+#else
             setup_bumping(id);
+#endif
         }
     }
     /* store remained reconstructed pictures in output list */
@@ -6500,18 +7239,25 @@ int main(int argc, const char **argv)
     v1print("===============================================================================\n");
     print_flush(stdout);
 ERR:
-#if LIB_PIC_UPDATE
+#if OUTPUT_SINK
+    app_sink_close_all();
+#endif
+#if STREAM_API
+    enc_stream_delete(stream);
+#elif LIB_PIC_UPDATE
     enc_delete(id,1);
+#else
+    enc_delete(id);
+#endif
+#if LIB_PIC_UPDATE
     if (op_lib_pic_update)
     {
         free_enc_libpic(&enc_libpic);
     }
-#else
-    enc_delete(id);
 #endif
     imgb_list_free(ilist_org);
     imgb_list_free(ilist_rec);
-    if(fp_inp) fclose(fp_inp);
+    if(fp_inp) yuv_reader_close(fp_inp);
     if(bs_buf) free(bs_buf); /* release bitstream buffer */
     if (bs_buf2)
     {
@@ -6533,6 +7279,13 @@ ERR:
     {
         tf_uninit(&tf_ctx);
     }    
+#if TF_INPUT_RING
+    if (tf_inp.imgb) imgb_free(tf_inp.imgb);
+    for (i = 0; i < MAX_FILTER_LEN; i++)
+    {
+        if (tf_inp.enc_imgb[i]) imgb_free(tf_inp.enc_imgb[i]);
+    }
+#endif
 #endif
 
 #if FIELD_CODING
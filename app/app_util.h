@@ -56,6 +56,28 @@ extern "C"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
+#if OUTPUT_SINK
+#include "com_thread.h"
+#if defined(WIN32) || defined(WIN64)
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+#endif
+#if YUV_READER_MMAP
+#if defined(WIN32) || defined(WIN64)
+#include <io.h>
+#include <fcntl.h>
+#elif defined(LINUX)
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#endif
+#if X86_SSE
+#include <emmintrin.h>
+#endif
 
 /* print function ************************************************************/
 #if defined(LINUX)
@@ -139,7 +161,150 @@ static COM_CLK com_clk_from(COM_CLK from) \
 
 #define IFVCA_CLIP(n,min,max) (((n)>(max))? (max) : (((n)<(min))? (min) : (n)))
 
-static int skip_frames(FILE * fp, COM_IMGB * img, int num_skipped_frames, int bit_depth)
+#if YUV_READER_MMAP
+#define YUV_READ_RELEASE           (64 << 20) /* mapped bytes consumed before their pages are dropped */
+
+/* raw YUV source: the whole file mapped, or frames read from a pipe into a reusable buffer */
+typedef struct _YUV_READER
+{
+    FILE          * fp;
+    unsigned char * data;
+    /* mapped size, or buffer capacity when the input is not mapped */
+    size_t          size;
+    /* read position and start of the mapped pages still resident */
+    size_t          pos;
+    size_t          released;
+    int             mapped;
+} YUV_READER;
+
+/* "-" reads the standard input */
+static YUV_READER * yuv_reader_open(const char * fname)
+{
+    YUV_READER * r = (YUV_READER *)calloc(1, sizeof(YUV_READER));
+    if (r == NULL)
+    {
+        return NULL;
+    }
+    if (!strcmp(fname, "-"))
+    {
+        r->fp = stdin;
+#if defined(WIN32) || defined(WIN64)
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+    }
+    else
+    {
+        r->fp = fopen(fname, "rb");
+    }
+    if (r->fp == NULL)
+    {
+        free(r);
+        return NULL;
+    }
+#if defined(LINUX)
+    {
+        struct stat st;
+        void * m;
+        if (!fstat(fileno(r->fp), &st) && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fileno(r->fp), 0);
+            if (m != MAP_FAILED)
+            {
+                madvise(m, st.st_size, MADV_SEQUENTIAL);
+                r->data = (unsigned char *)m;
+                r->size = st.st_size;
+                r->mapped = 1;
+            }
+        }
+    }
+#endif
+    return r;
+}
+
+static void yuv_reader_close(YUV_READER * r)
+{
+#if defined(LINUX)
+    if (r->mapped)
+    {
+        munmap(r->data, r->size);
+    }
+    else
+#endif
+    {
+        free(r->data);
+    }
+    if (r->fp != stdin) fclose(r->fp);
+    free(r);
+}
+
+/* next size bytes of the input, valid until the next read; NULL at the end of the input */
+static unsigned char * yuv_reader_read(YUV_READER * r, size_t size)
+{
+    unsigned char * p;
+#if defined(LINUX)
+    if (r->mapped)
+    {
+        if (size > r->size - r->pos)
+        {
+            return NULL;
+        }
+        /* sequential input is never revisited, keep the resident set at a few frames */
+        if (r->pos - r->released >= YUV_READ_RELEASE)
+        {
+            size_t len = (r->pos - r->released) & ~((size_t)sysconf(_SC_PAGESIZE) - 1);
+            madvise(r->data + r->released, len, MADV_DONTNEED);
+            r->released += len;
+        }
+        p = r->data + r->pos;
+        r->pos += size;
+        return p;
+    }
+#endif
+    if (size > r->size)
+    {
+        p = (unsigned char *)realloc(r->data, size);
+        if (p == NULL)
+        {
+            return NULL;
+        }
+        r->data = p;
+        r->size = size;
+    }
+    if (fread(r->data, 1, size, r->fp) != size)
+    {
+        return NULL;
+    }
+    r->pos += size;
+    return r->data;
+}
+
+static int yuv_reader_skip(YUV_READER * r, size_t size)
+{
+#if defined(LINUX)
+    if (r->mapped)
+    {
+        r->pos = (size < r->size - r->pos) ? r->pos + size : r->size;
+        return 0;
+    }
+#endif
+    while (size > 0)
+    {
+        size_t n = (r->size > 0 && size > r->size) ? r->size : size;
+        if (yuv_reader_read(r, n) == NULL)
+        {
+            return -1;
+        }
+        size -= n;
+    }
+    return 0;
+}
+#else
+typedef FILE YUV_READER;
+#define yuv_reader_open(fname)     fopen(fname, "rb")
+#define yuv_reader_close(r)        fclose(r)
+#endif
+
+static int skip_frames(YUV_READER * fp, COM_IMGB * img, int num_skipped_frames, int bit_depth)
 {
     int y_size, u_size, v_size, skipped_size;
     int f_w = img->width[0];
@@ -154,7 +319,11 @@ static int skip_frames(FILE * fp, COM_IMGB * img, int num_skipped_frames, int bi
         y_size = f_w * f_h * scale;
         u_size = v_size = (f_w >> 1) * (f_h >> 1) * scale;
         skipped_size = (y_size + u_size + v_size) * num_skipped_frames;
+#if YUV_READER_MMAP
+        yuv_reader_skip(fp, skipped_size);
+#else
         fseek(fp, skipped_size, SEEK_CUR);
+#endif
     }
     else
     {
@@ -164,12 +333,202 @@ static int skip_frames(FILE * fp, COM_IMGB * img, int num_skipped_frames, int bi
     return 0;
 }
 
+#if OUTPUT_SINK
+#define APP_SINK_BUF               (8 << 20) /* bytes staged before a block is handed to the writer thread */
+#define APP_SINK_MAX               4
+
+/* output file kept open for the whole run; data is staged in one buffer while the writer thread
+   writes the other one out */
+typedef struct _APP_SINK
+{
+    char               fname[256];
+    FILE             * fp;
+    unsigned char    * buf[2];
+    int                len[2];
+    int                cur;        /* buffer being filled */
+    int                err;        /* set by the writer thread */
+    COM_THREAD_QUEUE * queue;
+} APP_SINK;
+
+static APP_SINK app_sinks[APP_SINK_MAX];
+
+static void app_sink_work(void * arg)
+{
+    APP_SINK * sink = (APP_SINK *)arg;
+    int idx = !sink->cur;
+    if (fwrite(sink->buf[idx], 1, sink->len[idx], sink->fp) != (size_t)sink->len[idx])
+    {
+        sink->err = 1;
+    }
+    sink->len[idx] = 0;
+}
+
+/* hands the staged bytes to the writer thread once it finished the previous block */
+static int app_sink_flush(APP_SINK * sink)
+{
+    if (sink->len[sink->cur] > 0)
+    {
+        com_thread_queue_wait(sink->queue);
+        sink->cur = !sink->cur;
+        com_thread_queue_post(sink->queue, app_sink_work, sink);
+    }
+    return sink->err ? -1 : 0;
+}
+
+static APP_SINK * app_sink_find(const char * fname)
+{
+    int i;
+    for (i = 0; i < APP_SINK_MAX; i++)
+    {
+        if (app_sinks[i].fp && !strcmp(app_sinks[i].fname, fname))
+        {
+            return &app_sinks[i];
+        }
+    }
+    return NULL;
+}
+
+static int app_sink_close(APP_SINK * sink)
+{
+    int ret;
+    if (sink == NULL || sink->fp == NULL)
+    {
+        return 0;
+    }
+    app_sink_flush(sink);
+    com_thread_queue_delete(sink->queue);
+    ret = sink->err ? -1 : 0;
+    if (fclose(sink->fp))
+    {
+        ret = -1;
+    }
+    if (ret)
+    {
+        print("cannot write file = %s\n", sink->fname);
+    }
+    free(sink->buf[0]);
+    free(sink->buf[1]);
+    memset(sink, 0, sizeof(APP_SINK));
+    return ret;
+}
+
+static void app_sink_close_all(void)
+{
+    int i;
+    for (i = 0; i < APP_SINK_MAX; i++)
+    {
+        app_sink_close(&app_sinks[i]);
+    }
+}
+
+/* opens fname ("-" is the standard output) with mode and routes imgb_write() and write_data() of that name
+   through the sink until app_sink_close() */
+static APP_SINK * app_sink_open(const char * fname, const char * mode)
+{
+    APP_SINK * sink = app_sink_find(fname);
+    int i;
+    if (sink)
+    {
+        app_sink_close(sink);
+    }
+    for (i = 0; i < APP_SINK_MAX && app_sinks[i].fp; i++);
+    if (i == APP_SINK_MAX)
+    {
+        print("too many output files, cannot open file = %s\n", fname);
+        return NULL;
+    }
+    sink = &app_sinks[i];
+    if (!strcmp(fname, "-"))
+    {
+        /* the data keeps the standard output and the log moves to the standard error */
+        int fd;
+        fflush(stdout);
+#if defined(WIN32) || defined(WIN64)
+        fd = _dup(_fileno(stdout));
+        _setmode(fd, _O_BINARY);
+        sink->fp = fd < 0 ? NULL : _fdopen(fd, "wb");
+        _dup2(_fileno(stderr), _fileno(stdout));
+#else
+        fd = dup(fileno(stdout));
+        sink->fp = fd < 0 ? NULL : fdopen(fd, "wb");
+        dup2(fileno(stderr), fileno(stdout));
+#endif
+    }
+    else
+    {
+        sink->fp = fopen(fname, mode);
+    }
+    sink->buf[0] = (unsigned char *)malloc(APP_SINK_BUF);
+    sink->buf[1] = (unsigned char *)malloc(APP_SINK_BUF);
+    if (sink->fp == NULL || sink->buf[0] == NULL || sink->buf[1] == NULL)
+    {
+        print("cannot open file = %s\n", fname);
+        if (sink->fp) fclose(sink->fp);
+        free(sink->buf[0]);
+        free(sink->buf[1]);
+        memset(sink, 0, sizeof(APP_SINK));
+        return NULL;
+    }
+    strncpy(sink->fname, fname, sizeof(sink->fname) - 1);
+    /* a failed thread leaves the writes on the caller */
+    sink->queue = com_thread_queue_create(1);
+    return sink;
+}
+
+/* room for size bytes in the staging buffer, filled by the caller and committed with app_sink_commit() */
+static unsigned char * app_sink_reserve(APP_SINK * sink, int size)
+{
+    assert(size <= APP_SINK_BUF);
+    if (sink->len[sink->cur] + size > APP_SINK_BUF)
+    {
+        app_sink_flush(sink);
+    }
+    return sink->buf[sink->cur] + sink->len[sink->cur];
+}
+
+#define app_sink_commit(sink, size)        ((sink)->len[(sink)->cur] += (size))
+
+static int app_sink_write(APP_SINK * sink, const void * data, int size)
+{
+    const unsigned char * p = (const unsigned char *)data;
+    while (size > 0)
+    {
+        int n = size < APP_SINK_BUF ? size : APP_SINK_BUF;
+        memcpy(app_sink_reserve(sink, n), p, n);
+        app_sink_commit(sink, n);
+        p += n;
+        size -= n;
+    }
+    return sink->err ? -1 : 0;
+}
+#endif
+
 static int imgb_write(char * fname, COM_IMGB * img, int bit_depth, int output_width, int output_height)
 {
     unsigned char * p8;
     int             i, j;
     FILE          * fp;
     int scale = (bit_depth == 10 ? 2 : 1);
+#if OUTPUT_SINK
+    APP_SINK      * sink = app_sink_find(fname);
+    if (sink)
+    {
+        assert(img->cs == COM_COLORSPACE_YUV420);
+        for (i = 0; i < 3; i++)
+        {
+            int width = (i == 0 ? output_width : output_width >> 1) * scale;
+            int height = i == 0 ? output_height : output_height >> 1;
+            p8 = (unsigned char *)img->addr_plane[i];
+            for (j = 0; j < height; j++)
+            {
+                memcpy(app_sink_reserve(sink, width), p8, width);
+                app_sink_commit(sink, width);
+                p8 += img->stride[i];
+            }
+        }
+        return sink->err ? -1 : 0;
+    }
+#endif
     fp = fopen(fname, "ab");
     if(fp == NULL)
     {
@@ -218,6 +577,22 @@ static void __imgb_cpy_plane(void *src, void *dst, int bw, int h, int s_src, int
 static int write_data(char * fname, unsigned char * data, int size, int end_of_video_sequence)
 {
     FILE * fp;
+#if OUTPUT_SINK
+    APP_SINK * sink = app_sink_find(fname);
+    if (sink)
+    {
+        static const unsigned char video_sequence_end_code[4] = { 0x00, 0x00, 0x01, 0xB1 };
+        if (data != NULL)
+        {
+            app_sink_write(sink, data, size);
+        }
+        if (end_of_video_sequence == END_OF_VIDEO_SEQUENCE)
+        {
+            app_sink_write(sink, video_sequence_end_code, 4);
+        }
+        return sink->err ? -1 : 0;
+    }
+#endif
     fp = fopen(fname, "ab");
     if(fp == NULL)
     {
@@ -268,23 +643,40 @@ static void imgb_conv_8b_to_16b(COM_IMGB * imgb_dst, COM_IMGB * imgb_src,
     }
 }
 
+/* rounds width samples down by shift bits and clips them to 8 bits */
+static void conv_row_16b_to_8b(const short * s, unsigned char * d, int width, int shift)
+{
+    int k = 0, t0;
+    int add = (shift > 0) ? (1 << (shift - 1)) : 0;
+#if X86_SSE
+    const __m128i madd = _mm_set1_epi16((short)add);
+    const __m128i mshift = _mm_cvtsi32_si128(shift);
+    for (; k + 16 <= width; k += 16)
+    {
+        __m128i s0 = _mm_sra_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(s + k)), madd), mshift);
+        __m128i s1 = _mm_sra_epi16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(s + k + 8)), madd), mshift);
+        _mm_storeu_si128((__m128i *)(d + k), _mm_packus_epi16(s0, s1));
+    }
+#endif
+    for (; k < width; k++)
+    {
+        t0 = ((s[k] + add) >> shift);
+        d[k] = (unsigned char)(IFVCA_CLIP(t0, 0, 255));
+    }
+}
+
 static void imgb_conv_16b_to_8b(COM_IMGB * imgb_dst, COM_IMGB * imgb_src, int shift)
 {
-    int i, j, k, t0, add;
+    int i, j;
     short         * s;
     unsigned char * d;
-    add = (shift > 0) ? (1 << (shift - 1)) : 0;
     for(i = 0; i < 3; i++)
     {
         s = imgb_src->addr_plane[i];
         d = imgb_dst->addr_plane[i];
         for(j = 0; j < imgb_src->height[i]; j++)
         {
-            for(k = 0; k < imgb_src->width[i]; k++)
-            {
-                t0 = ((s[k] + add) >> shift);
-                d[k] = (unsigned char)(IFVCA_CLIP(t0, 0, 255));
-            }
+            conv_row_16b_to_8b(s, d, imgb_src->width[i], shift);
             s = (short*)(((unsigned char *)s) + imgb_src->stride[i]);
             d = d + imgb_dst->stride[i];
         }
@@ -352,6 +744,42 @@ static void imgb_cpy_conv_rec(COM_IMGB * dst, COM_IMGB * src, int dst_bit_depth,
     }
 }
 
+#if OUTPUT_SINK
+/* imgb_cpy_conv_rec() and imgb_write() in one pass: the rows go straight into the staging buffer of sink */
+static int imgb_write_conv(APP_SINK * sink, COM_IMGB * img, int dst_bit_depth, int src_bit_depth, int output_width, int output_height)
+{
+    int i, j;
+    int scale = (dst_bit_depth == 10 ? 2 : 1);
+    if (!(dst_bit_depth == 10 && src_bit_depth == 10) && !(dst_bit_depth == 8 && (src_bit_depth == 8 || src_bit_depth == 10)))
+    {
+        v0print("The internal/output bitdepth is not supported\n");
+        return -1;
+    }
+    assert(img->cs == COM_COLORSPACE_YUV420);
+    for (i = 0; i < 3; i++)
+    {
+        unsigned char * s = (unsigned char *)img->addr_plane[i];
+        int width = i == 0 ? output_width : output_width >> 1;
+        int height = i == 0 ? output_height : output_height >> 1;
+        for (j = 0; j < height; j++)
+        {
+            unsigned char * d = app_sink_reserve(sink, width * scale);
+            if (scale == 2)
+            {
+                memcpy(d, s, width * 2);
+            }
+            else
+            {
+                conv_row_16b_to_8b((short *)s, d, width, src_bit_depth - 8);
+            }
+            app_sink_commit(sink, width * scale);
+            s += img->stride[i];
+        }
+    }
+    return sink->err ? -1 : 0;
+}
+#endif
+
 static void imgb_free(COM_IMGB * imgb)
 {
     int i;
@@ -405,10 +833,84 @@ COM_IMGB * imgb_alloc(int width, int height, int cs, int bitDepth)
     return imgb;
 }
 
+#if YUV_READER_MMAP
+/* converts width input samples (8 bits, or 10 bits little endian) to 16 bits, scaled up by shift bits or
+   rounded down by -shift bits and clipped to maxval; fails on a 10-bit sample beyond [0, 1023] */
+static int conv_row_yuv_to_16b(const unsigned char * s, short * d, int width, int bit_depth_input, int shift, short maxval)
+{
+    int k = 0, t0;
+    int add = (shift < 0) ? (1 << (-shift - 1)) : 0;
+#if X86_SSE
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i madd = _mm_set1_epi16((short)add);
+    const __m128i mmax = _mm_set1_epi16(shift < 0 ? maxval : 0x7fff);
+    const __m128i mlsh = _mm_cvtsi32_si128(shift > 0 ? shift : 0);
+    const __m128i mrsh = _mm_cvtsi32_si128(shift < 0 ? -shift : 0);
+    if (bit_depth_input == 10)
+    {
+        const __m128i mrange = _mm_set1_epi16((short)0xfc00);
+        for (; k + 8 <= width; k += 8)
+        {
+            __m128i s0 = _mm_loadu_si128((const __m128i *)(s + 2 * k));
+            /* the scalar loop reports the offending sample */
+            if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(s0, mrange), zero)) != 0xffff)
+            {
+                break;
+            }
+            s0 = _mm_srl_epi16(_mm_add_epi16(_mm_sll_epi16(s0, mlsh), madd), mrsh);
+            _mm_storeu_si128((__m128i *)(d + k), _mm_min_epi16(s0, mmax));
+        }
+    }
+    else
+    {
+        for (; k + 16 <= width; k += 16)
+        {
+            __m128i s0 = _mm_loadu_si128((const __m128i *)(s + k));
+            __m128i s1 = _mm_unpackhi_epi8(s0, zero);
+            s0 = _mm_unpacklo_epi8(s0, zero);
+            s0 = _mm_srl_epi16(_mm_add_epi16(_mm_sll_epi16(s0, mlsh), madd), mrsh);
+            s1 = _mm_srl_epi16(_mm_add_epi16(_mm_sll_epi16(s1, mlsh), madd), mrsh);
+            _mm_storeu_si128((__m128i *)(d + k), _mm_min_epi16(s0, mmax));
+            _mm_storeu_si128((__m128i *)(d + k + 8), _mm_min_epi16(s1, mmax));
+        }
+    }
+#endif
+    for (; k < width; k++)
+    {
+        if (bit_depth_input == 10)
+        {
+            t0 = (short)(s[k * 2] | (s[k * 2 + 1] << 8));
+            if (t0 > 1023 || t0 < 0)
+            {
+                printf("\nError: input pixel value %d beyond [0, 1023], please check bit-depth %d of the input yuv file.\n", t0, bit_depth_input);
+                return -1;
+            }
+        }
+        else
+        {
+            t0 = s[k];
+        }
+        if (shift > 0)
+        {
+            d[k] = (short)(t0 << shift);
+        }
+        else if (shift < 0)
+        {
+            d[k] = (short)IFVCA_CLIP((t0 + add) >> (-shift), 0, maxval);
+        }
+        else
+        {
+            d[k] = (short)t0;
+        }
+    }
+    return 0;
+}
+
+#endif
 #if FIELD_CODING
-static int imgb_read_conv(FILE * fp, COM_IMGB * img, int bit_depth_input, int bit_depth_internal, int field_coding, int is_top_field, short *temp_buffer_input_field[3])
+static int imgb_read_conv(YUV_READER * fp, COM_IMGB * img, int bit_depth_input, int bit_depth_internal, int field_coding, int is_top_field, short *temp_buffer_input_field[3])
 #else
-static int imgb_read_conv(FILE * fp, COM_IMGB * img, int bit_depth_input, int bit_depth_internal)
+static int imgb_read_conv(YUV_READER * fp, COM_IMGB * img, int bit_depth_input, int bit_depth_internal)
 #endif
 {
     int width_pic = img->width[0];
@@ -434,6 +936,20 @@ static int imgb_read_conv(FILE * fp, COM_IMGB * img, int bit_depth_input, int bi
                     int padding_w = (img->width[0] - img->horizontal_size) >> (comp > 0 ? 1 : 0);
                     int padding_h = (img->height[0] - img->vertical_size) >> (comp > 0 ? 1 : 0);
                     int size_byte = ((img->horizontal_size * (img->vertical_size << 1)) >> (comp > 0 ? 2 : 0)) * scale;
+#if YUV_READER_MMAP
+                    unsigned char * buf = yuv_reader_read(fp, size_byte);
+                    if (buf == NULL)
+                    {
+                        return -1;
+                    }
+
+                    /* the frame planes are contiguous, convert each as a single row */
+                    dst = temp_buffer_input_field[comp];
+                    if (conv_row_yuv_to_16b(buf, dst, size_yuv[comp], bit_depth_input, bit_shift, maxval))
+                    {
+                        return -1;
+                    }
+#else
                     unsigned char * buf = malloc(size_byte);
                     if (fread(buf, 1, size_byte, fp) != (unsigned)size_byte)
                     {
@@ -496,6 +1012,7 @@ static int imgb_read_conv(FILE * fp, COM_IMGB * img, int bit_depth_input, int bi
                     }
 
                     free(buf);
+#endif
                 }
             }
 
@@ -556,6 +1073,34 @@ static int imgb_read_conv(FILE * fp, COM_IMGB * img, int bit_depth_input, int bi
                 int padding_w = (img->width[0] - img->horizontal_size) >> (comp > 0 ? 1 : 0);
                 int padding_h = (img->height[0] - img->vertical_size) >> (comp > 0 ? 1 : 0);
                 int size_byte = ((img->horizontal_size * img->vertical_size) >> (comp > 0 ? 2 : 0)) * scale;
+#if YUV_READER_MMAP
+                int width_inp = img->width[comp] - padding_w;
+                unsigned char * buf = yuv_reader_read(fp, size_byte);
+                if (buf == NULL)
+                {
+                    return -1;
+                }
+
+                dst = (short*)img->addr_plane[comp];
+                for (int y = 0; y < img->height[comp] - padding_h; y++)
+                {
+                    short * d = dst + y * img->width[comp];
+                    if (conv_row_yuv_to_16b(buf + y * width_inp * scale, d, width_inp, bit_depth_input, bit_shift, maxval))
+                    {
+                        return -1;
+                    }
+                    //padding right
+                    for (int x = width_inp; x < img->width[comp]; x++)
+                    {
+                        d[x] = d[x - 1];
+                    }
+                }
+                //padding bottom
+                for (int y = img->height[comp] - padding_h; y < img->height[comp]; y++)
+                {
+                    memcpy(dst + y * img->width[comp], dst + (y - 1) * img->width[comp], img->width[comp] * sizeof(short));
+                }
+#else
                 unsigned char * buf = malloc(size_byte);
                 if (fread(buf, 1, size_byte, fp) != (unsigned)size_byte)
                 {
@@ -648,6 +1193,7 @@ static int imgb_read_conv(FILE * fp, COM_IMGB * img, int bit_depth_input, int bi
                 }
 
                 free(buf);
+#endif
             }
 #if FIELD_CODING
         }
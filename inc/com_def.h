@@ -534,6 +534,9 @@ extern int fp_trace_counter;
 #endif
 #define MAX_CU_DIM                        (MAX_CU_SIZE * MAX_CU_SIZE)
 #define MIN_CU_DIM                        (MIN_CU_SIZE * MIN_CU_SIZE)
+#if COL_MV_COMPRESS
+#define COL_MV_LOG2                        4  /* granularity of the motion field stored with a picture */
+#endif
 #if CTU_256
 #define MAX_CU_DEPTH                       7  /* 256x256 ~ 4x4 */
 #define MAX_CU_DEPTH2                      9
@@ -1836,6 +1839,7 @@ typedef struct _COM_PIC
     u8               cu_delta_qp_flag;
 #endif
 #endif
+    /* motion field read by the colocated predictors, one entry per SCU (per COL_MV_LOG2 block with COL_MV_COMPRESS) */
     s16            (*map_mv)[REFP_NUM][MV_D];
     s8             (*map_refi)[REFP_NUM];
 #if ETMVP || SUB_TMVP || AWP
@@ -1909,6 +1913,15 @@ typedef struct _LibVCData
 /*****************************************************************************
  * picture buffer allocator
  *****************************************************************************/
+#if PIC_BUF_POOL
+/* pictures given back to com_pic_free(), handed out again by com_pic_alloc() */
+typedef struct _COM_PIC_POOL
+{
+    COM_PIC         *pic[MAX_PB_SIZE];
+    int              num;
+} COM_PIC_POOL;
+#endif
+
 typedef struct _PICBUF_ALLOCATOR
 {
     /* width */
@@ -1923,8 +1936,48 @@ typedef struct _PICBUF_ALLOCATOR
     int              ndata[4];
     /* arbitrary address, if needs */
     void            *pdata[4];
+#if PIC_BUF_POOL
+    /* recycled pictures, NULL to free pictures right away */
+    COM_PIC_POOL    *pool;
+#endif
 } PICBUF_ALLOCATOR;
 
+#if SCRATCH_ARENA
+/*****************************************************************************
+ * scratch arena for block-level temporary buffers
+ *****************************************************************************/
+#define COM_SCRATCH_SIZE                   (4 << 20)
+#define COM_SCRATCH_ALIGN                  64
+
+/* heap block handed out once the arena is full */
+typedef struct _COM_ARENA_SPILL
+{
+    struct _COM_ARENA_SPILL *next;
+    /* arena position it was allocated at */
+    int              mark;
+} COM_ARENA_SPILL;
+
+typedef struct _COM_ARENA
+{
+    u8              *base;
+    /* capacity and bytes handed out, in bytes; used keeps counting past size while blocks spill to the heap */
+    int              size;
+    int              used;
+    /* spilled blocks, most recent first */
+    COM_ARENA_SPILL *spill;
+} COM_ARENA;
+#endif
+
+#if TM_COST_CACHE
+/* template costs and filter passes of the CU under template matching, see com_tm_cache_reset() */
+typedef struct _COM_TM_CACHE COM_TM_CACHE;
+#endif
+
+#if PADLESS_REF
+/* border-clamped reference window of MC, see com_ref_window() */
+typedef struct _COM_REF_WIN COM_REF_WIN;
+#endif
+
 /*****************************************************************************
  * picture manager for DPB in decoder and RPB in encoder
  *****************************************************************************/
@@ -3028,6 +3081,23 @@ typedef struct _COM_MAP
 #endif
 } COM_MAP;
 
+#if DBK_EDGE_BITMAP
+/*****************************************************************************
+* deblocking edge map: EDGE_TYPE_* of the left edge (bits 0-1) and the top
+* edge (bits 2-3) of every 4x4 block, two blocks per byte
+*****************************************************************************/
+typedef struct _COM_EDGE_MAP
+{
+    u8                     *map;
+    int                     w4;      /* 4x4 blocks in a line */
+    int                     h4;      /* lines of 4x4 blocks */
+    int                     stride;  /* bytes per line of 4x4 blocks */
+} COM_EDGE_MAP;
+typedef COM_EDGE_MAP       *COM_EDGE_FILTER;
+#else
+typedef int              ***COM_EDGE_FILTER;
+#endif
+
 /*****************************************************************************
 * common info
 *****************************************************************************/
@@ -3196,5 +3266,6 @@ typedef struct _COM_CNTMPM
 #include "com_picman.h"
 #include "com_mc.h"
 #include "com_img.h"
+#include "com_thread.h"
 
 #endif /* _COM_DEF_H_ */
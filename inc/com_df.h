@@ -41,19 +41,35 @@ extern "C"
 {
 #endif
 
-void create_edge_filter_avs2(int w, int h, int ***edge_filter);
-void clear_edge_filter_avs2(int x, int y, int w, int h, int ***edge_filter);
-void delete_edge_filter_avs2(int ***edge_filter, int h);
-void set_edge_filter_param_hor_avs2(COM_PIC * pic, int ***edge_filter, int x_pel, int y_pel, int cuw, int cuh, int edge_condition);
-void set_edge_filter_param_ver_avs2(COM_PIC * pic, int ***edge_filter, int x_pel, int y_pel, int cuw, int cuh, int edge_condition);
-void set_edge_filter_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, int*** edge_filter);
-void set_edge_filter_one_scu_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, int ***edge_filter, int x, int y, int cuw, int cuh, int cud, int cup, BOOL b_recurse);
-void deblock_block_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], int*** edge_filter, int pel_x, int pel_y, int cuw, int cuh);
-
-void deblock_frame_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], int*** edge_filter);
+#if DBK_EDGE_BITMAP
+COM_EDGE_MAP * create_edge_filter_avs2(int w, int h);
+void delete_edge_filter_avs2(COM_EDGE_MAP *edge_filter);
+#else
+void create_edge_filter_avs2(int w, int h, COM_EDGE_FILTER edge_filter);
+void delete_edge_filter_avs2(COM_EDGE_FILTER edge_filter, int h);
+#endif
+void clear_edge_filter_avs2(int x, int y, int w, int h, COM_EDGE_FILTER edge_filter);
+void set_edge_filter_param_hor_avs2(COM_PIC * pic, COM_EDGE_FILTER edge_filter, int x_pel, int y_pel, int cuw, int cuh, int edge_condition);
+void set_edge_filter_param_ver_avs2(COM_PIC * pic, COM_EDGE_FILTER edge_filter, int x_pel, int y_pel, int cuw, int cuh, int edge_condition);
+void set_edge_filter_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_EDGE_FILTER edge_filter);
+void set_edge_filter_one_scu_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_EDGE_FILTER edge_filter, int x, int y, int cuw, int cuh, int cud, int cup, BOOL b_recurse);
+void deblock_block_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter, int pel_x, int pel_y, int cuw, int cuh);
+
+void deblock_frame_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#if LF_CTU_PIPELINE
+void deblock_lcu_row_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#endif
 
 #if DBR
-void deblock_mb_avs2(COM_INFO *info, COM_MAP *map, COM_PIC *pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], int*** edge_filter, int mb_y, int mb_x, int edge_dir, COM_PIC *pic_org, int enc, DBR_PARAM *dbr_picture_param
+void deblock_mb_avs2(COM_INFO *info, COM_MAP *map, COM_PIC *pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter, int mb_y, int mb_x, int edge_dir, COM_PIC *pic_org, int enc, DBR_PARAM *dbr_picture_param
 #if RDO_DBK_LUMA_ONLY
     , int only_luma
 #endif
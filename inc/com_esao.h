@@ -73,7 +73,18 @@ void esao_on_smb(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_
 void esao_on_block(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_esao, ESAO_BLK_PARAM *esao_blk_param, ESAO_FUNC_POINTER *func_esao_filter, int comp_idx, int pix_y, int pix_x, int lcu_pix_height, int lcu_pix_width, int sample_bit_depth, int lcu_pos, int lcu_open_flag,
     int lcu_available_left, int lcu_available_right, int lcu_available_up, int lcu_available_down, int lcu_available_upleft, int lcu_available_upright, int lcu_available_leftdown, int lcu_available_rightdwon);
 
-void esao_on_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_esao, ESAO_BLK_PARAM *rec_esao_params, ESAO_FUNC_POINTER *func_esao_filter);
+void esao_on_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_esao, ESAO_BLK_PARAM *rec_esao_params, ESAO_FUNC_POINTER *func_esao_filter
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#if LF_CTU_PIPELINE
+void esao_on_lcu_row(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_esao, ESAO_BLK_PARAM *rec_esao_params, ESAO_FUNC_POINTER *func_esao_filter, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#endif
 #endif
 
 #if ESAO || CCSAO
@@ -130,6 +141,23 @@ void ccsao_on_frame(COM_INFO *info, COM_MAP *map, COM_PIC *pic_rec,
 #else
     COM_PIC *pic_ccsao,
 #endif
-    CCSAO_BLK_PARAM *ccsao_param, CCSAO_FUNC_POINTER *ccsao_func_ptr);
+    CCSAO_BLK_PARAM *ccsao_param, CCSAO_FUNC_POINTER *ccsao_func_ptr
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#if LF_CTU_PIPELINE
+void ccsao_on_lcu_row(COM_INFO *info, COM_MAP *map, COM_PIC *pic_rec,
+#if CCSAO_ENHANCEMENT
+    COM_PIC *pic_ccsao[2],
+#else
+    COM_PIC *pic_ccsao,
+#endif
+    CCSAO_BLK_PARAM *ccsao_param, CCSAO_FUNC_POINTER *ccsao_func_ptr, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#endif
 #endif
 #endif
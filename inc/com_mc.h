@@ -294,6 +294,18 @@ void mv_clip(int x, int y, int pic_w, int pic_h, int w, int h,
 void single_mv_clip(int x, int y, int pic_w, int pic_h, int w, int h, s16 mv[MV_D]);
 #endif
 
+#if PADLESS_REF
+/* returns pic when the luma area [x0, x1) x [y0, y1) (plus filter margins) lies in the picture and its padding,
+   otherwise a picture whose planes address a border-clamped copy of that area, valid until the next call;
+   returns NULL when the window cannot grow to the area, the caller then skips the block and the picture
+   fails through com_ref_win_status() */
+COM_REF_WIN * com_ref_win_create();
+void com_ref_win_delete(COM_REF_WIN *win);
+void com_ref_win_bind(COM_REF_WIN *win);
+int com_ref_win_status(COM_REF_WIN *win);
+COM_PIC* com_ref_window(COM_PIC *pic, int x0, int y0, int x1, int y1);
+#endif
+
 #if AWP_ENH
 void com_dawp_mc(COM_INFO* info, COM_MODE* mod_info_curr, COM_REFP(*refp)[REFP_NUM], u8 tree_status, int bit_depth, COM_PIC* pic, u32* map_scu, pel**** awp_weight_tpl);
 #endif
@@ -306,6 +318,12 @@ void remove_duplicate_cands(s16(*pmv_cands)[REFP_NUM][MV_D], s8(*refi_cands)[REF
 void cands_adjustment(s16(*pmv_cands)[REFP_NUM][MV_D], s8(*refi_cands)[REFP_NUM], int* num_cands_all);
 void pre_evaluation_cands(int x, int y, int pic_w, int pic_h, int w, int h, pel* reco_luma, const int stride_luma, COM_REFP(*refp)[REFP_NUM], s16(*pmv_cands)[REFP_NUM][MV_D], s8(*refi_cands)[REFP_NUM], int* num_cands_all, const int bit_depth, BOOL is_simplified);
 void tm_padding(pel* img_pad, pel* img_rec, int s_rec, int width, int height, int offset);
+#if TM_COST_CACHE
+COM_TM_CACHE * com_tm_cache_create();
+void com_tm_cache_delete(COM_TM_CACHE *cache);
+void com_tm_cache_bind(COM_TM_CACHE *cache);
+void com_tm_cache_reset();
+#endif
 #endif
 void com_affine_mc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[REFP_NUM], COM_MAP *pic_map, int bit_depth
 #if AFFINE_DMVR
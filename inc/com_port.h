@@ -125,6 +125,22 @@ typedef s32                        double_pel; /* pixel type */
 #define com_mfree(m)              if(m){free(m); m = NULL;}
 #define com_mfree_fast(m)         if(m){com_mfree(m);}
 
+#if defined(WIN32) || defined(WIN64)
+#include <malloc.h>
+#define com_malloc_align(size, align) _aligned_malloc((size), (align))
+#define com_mfree_align(m)        if(m){_aligned_free(m); m = NULL;}
+#else
+/* posix_memalign() wrapper, see com_img.c */
+void * com_malloc_align(size_t size, size_t align);
+#define com_mfree_align(m)        if(m){free(m); m = NULL;}
+#endif
+
+#if defined(WIN32) || defined(WIN64)
+#define COM_THREAD_LOCAL          __declspec(thread)
+#else
+#define COM_THREAD_LOCAL          __thread
+#endif
+
 #define com_mcpy(dst,src,size)    memcpy((dst), (src), (size))
 #define com_mset(dst,v,size)      memset((dst), (v), (size))
 #define com_mset_x64a(dst,v,size) memset((dst), (v), (size))
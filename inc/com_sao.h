@@ -69,7 +69,18 @@ void SAO_on_block(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic
 void SAO_on_smb(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_sao, int pix_y, int pix_x, int smb_pix_width, int smb_pix_height,
                 SAO_BLK_PARAM *sao_blk_param, int sample_bit_depth);
 
-void sao_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_sao, SAO_BLK_PARAM **rec_sao_blk_param);
+void sao_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_sao, SAO_BLK_PARAM **rec_sao_blk_param
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#if LF_CTU_PIPELINE
+void sao_lcu_row(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_sao, SAO_BLK_PARAM **rec_sao_blk_param, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#endif
 
 int com_malloc_3d_sao_stat_data(SAO_STAT_DATA ****array3D, int num_SMB, int num_comp, int num_class);
 int com_malloc_2d_sao_param(SAO_BLK_PARAM *** array2D, int num_SMB, int num_comp);
@@ -0,0 +1,87 @@
+/* ====================================================================================================================
+
+  The copyright in this software is being made available under the License included below.
+  This software may be subject to other third party and contributor rights, including patent rights, and no such
+  rights are granted under this license.
+
+  Copyright (c) 2018, HUAWEI TECHNOLOGIES CO., LTD. All rights reserved.
+  Copyright (c) 2018, SAMSUNG ELECTRONICS CO., LTD. All rights reserved.
+  Copyright (c) 2018, PEKING UNIVERSITY SHENZHEN GRADUATE SCHOOL. All rights reserved.
+  Copyright (c) 2018, PENGCHENG LABORATORY. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted only for
+  the purpose of developing standards within Audio and Video Coding Standard Workgroup of China (AVS) and for testing and
+  promoting such standards. The following conditions are required to be met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+      the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+      the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * The name of HUAWEI TECHNOLOGIES CO., LTD. or SAMSUNG ELECTRONICS CO., LTD. may not be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+* ====================================================================================================================
+*/
+
+#ifndef _COM_THREAD_H_
+#define _COM_THREAD_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* pool of worker threads running parallel-for jobs; the calling thread works on the job as well */
+typedef struct _COM_THREAD_POOL COM_THREAD_POOL;
+/* per-index completion flags for wavefront dependencies inside a job */
+typedef struct _COM_THREAD_PROGRESS COM_THREAD_PROGRESS;
+
+/* one item of a parallel-for job */
+typedef void (*COM_THREAD_JOB)(void *arg, int idx);
+
+/* create a pool running jobs on num_threads threads in total (caller included),
+   NULL is returned for num_threads <= 1 and all jobs then run on the caller */
+COM_THREAD_POOL * com_thread_pool_create(int num_threads);
+void com_thread_pool_delete(COM_THREAD_POOL *pool);
+/* number of threads running a job, 1 for a NULL pool */
+int com_thread_pool_size(COM_THREAD_POOL *pool);
+/* run job(arg, idx) for idx = 0 ... num - 1 and return when all of them finished.
+   Indices are handed out in increasing order. Not re-entrant: a job must not call it again */
+void com_thread_pool_run(COM_THREAD_POOL *pool, COM_THREAD_JOB job, void *arg, int num);
+
+COM_THREAD_PROGRESS * com_thread_progress_create(int num);
+void com_thread_progress_delete(COM_THREAD_PROGRESS *prog);
+void com_thread_progress_reset(COM_THREAD_PROGRESS *prog);
+/* mark index idx as done */
+void com_thread_progress_set(COM_THREAD_PROGRESS *prog, int idx);
+/* mark index idx as not done, so that it can be reused for the next item of a ring */
+void com_thread_progress_clear(COM_THREAD_PROGRESS *prog, int idx);
+/* block until index idx is marked as done */
+void com_thread_progress_wait(COM_THREAD_PROGRESS *prog, int idx);
+
+/* background thread running posted work items one at a time in posting order */
+typedef struct _COM_THREAD_QUEUE COM_THREAD_QUEUE;
+typedef void (*COM_THREAD_WORK)(void *arg);
+
+/* at most depth items are pending or running, posting one more blocks until the oldest finished */
+COM_THREAD_QUEUE * com_thread_queue_create(int depth);
+/* finishes the posted items before returning */
+void com_thread_queue_delete(COM_THREAD_QUEUE *queue);
+/* work(arg) runs on the caller when queue is NULL */
+void com_thread_queue_post(COM_THREAD_QUEUE *queue, COM_THREAD_WORK work, void *arg);
+/* block until all posted items finished */
+void com_thread_queue_wait(COM_THREAD_QUEUE *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _COM_THREAD_H_ */
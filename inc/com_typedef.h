@@ -298,6 +298,45 @@ extern "C"
 
 #define REUSE_CU_SPLIT_OPT                 1 // M5900: Adjust threshold for reusing cu results
 
+//encoder & decoder speed-up (non-normative)
+#define SBAC_CTX_JOURNAL                   1 // SBAC_STORE/SBAC_LOAD copy only the context chunks touched since the last snapshot
+#define SBAC_RATE_EST                      1 // RDO rate estimation accumulates table-driven fractional bits instead of running the arithmetic coder
+#define ENC_PRESET                         1 // --preset selects a speed tier (tool enables, RDO candidate counts, split depth, ME range, early termination)
+#if ENC_PRESET
+#define FAST_SPLIT_PRED                    1 // linear split/no-split predictor prunes CU split modes before RDO, confidence threshold set by the preset
+#endif
+#if INTER_TM
+#define TM_COST_CACHE                      1 // template matching reuses template costs and horizontal filter passes of MVs already tested in the CU
+#endif
+#define LF_CTU_PIPELINE                    1 // decoder runs deblock/SAO/ESAO/CCSAO/ALF per LCU row with line buffers instead of full-frame copies
+#if LF_CTU_PIPELINE
+#define LF_ROW_PARALLEL                    1 // in-loop filters run LCU rows (LCUs of a row in the decoder pipeline) on the --threads pool
+#endif
+#define DBK_EDGE_BITMAP                    1 // deblocking edge types packed 2 bits per edge in a flat map, filled per LCU while decoding
+#define ALF_ENC_INCR                       1 // ALF encoder: per-LCU statistics on the --threads pool, enabled-LCU sums updated incrementally, merged-class solves cached
+#if ESAO_ENH && ECCSAO && LF_ROW_PARALLEL
+#define ESAO_ENC_FUSED_STAT                1 // ESAO/CCSAO encoder statistics of all labels and modes gathered row by row in one sweep per LCU, LCUs on the --threads pool
+#endif
+#define PADLESS_REF                        1 // decoder DPB pictures carry no padding, MC reads outside the picture through a border-clamped block window
+#define PIC_BUF_POOL                       1 // picture planes and rows 64-byte aligned, decoder pictures released at a sequence restart are reused instead of reallocated
+#if PIC_BUF_POOL
+#define PIC_BUF_HUGE_PAGE                  1 // picture planes of 2 MB and more are advised for transparent huge pages (Linux)
+#endif
+#define COL_MV_COMPRESS                    1 // pictures keep one motion vector per 16x16 block for the colocated predictors, the 4x4 motion maps belong to the codec context
+#define CU_DATA_LAZY                       1 // encoder core CU data allocated only for the CU shapes the split configuration can reach
+#define BS_READER_MMAP                     1 // app_decoder maps the bitstream file (or reads it in large blocks) and locates start codes with memchr
+#define RBSP_SPAN_EXTRACT                  1 // emulation prevention removal copies whole spans between 00 00 01/02 hits instead of running every byte through the state machine
+#define OUTPUT_SINK                        1 // app output files stay open behind a staging buffer that a background thread writes out ("-" writes to stdout)
+#define YUV_READER_MMAP                    1 // app_encoder maps the input YUV file (or reads whole frames from a pipe, "-" reads stdin) and converts rows with SIMD
+#define TF_INPUT_RING                      1 // app_encoder reads each input picture once into the temporal filter ring instead of the filter re-reading the input file per picture
+#define TF_PARALLEL                        1 // temporal filter ME, MC and bilateral filtering run over block rows on the encoder thread pool, bilateral weights come from a table
+#define LOOKAHEAD_STAGE                    1 // pushed pictures get a coarse motion field and histogram statistics on a lookahead thread, ALO takes its CTU factors from them
+#define LOOKAHEAD_FAST_ME                  1 // lookahead motion search starts from 4x and 2x downsampled matches
+#define LOOKAHEAD_ROW_PARALLEL             1 // lookahead motion search runs block rows on its own thread pool, whose threads are taken out of the --threads budget of the encoder pool
+#define STREAM_API                         1 // in-memory encoder/decoder streams: pictures and packets pushed by the caller, output through callbacks, the apps are clients of them
+#define MERGE_PARSE_ONLY                   1 // app_bitstream_merge maps its inputs and parses only sequence/picture headers, packets are written from the mapping and no decoder is created
+#define SCRATCH_ARENA                      1 // MC/AWP/OBMC/TM temporary blocks come from a bump arena of the core bound to the calling thread instead of function-static arrays
+
 //high-level
 #define PHASE_2_PROFILE                    1 // 
 #define RPL_GOP32                          1 // M6161: Hierarchical GOP structure of 32 for random access
@@ -507,6 +546,10 @@ typedef short                              CPMV;
 #if ENC_ME_IMP
 #define SIMD_GRAD_ME                       1
 #endif
+#define SIMD_RBSP                          1
+#define SIMD_TF                            1
+#define SIMD_LA_SAD                        1
+#define SIMD_ESAO_STAT                     1
 #else
 #define SIMD_MC                            0
 #define SIMD_SAD                           0
@@ -520,6 +563,10 @@ typedef short                              CPMV;
 #if ENC_ME_IMP
 #define SIMD_GRAD_ME                       0
 #endif
+#define SIMD_RBSP                          0
+#define SIMD_TF                            0
+#define SIMD_LA_SAD                        0
+#define SIMD_ESAO_STAT                     0
 #endif
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -761,7 +808,11 @@ typedef struct _COM_BITB
  *****************************************************************************/
 typedef struct _DEC_CDSC
 {
+#if LF_ROW_PARALLEL
+    int            threads; /* number of threads running the in-loop filters, 0 or 1 for none */
+#else
     int            __na; /* nothing */
+#endif
 } DEC_CDSC;
 
 /*****************************************************************************
@@ -149,6 +149,20 @@ u16 com_get_avail_intra(int x_scu, int y_scu, int pic_width_in_scu, int scup, u3
 
 COM_PIC * com_pic_alloc(PICBUF_ALLOCATOR * pa, int * ret);
 void com_pic_free(PICBUF_ALLOCATOR *pa, COM_PIC *pic);
+#if PIC_BUF_POOL
+void com_pic_pool_clear(COM_PIC_POOL *pool);
+#endif
+#if SCRATCH_ARENA
+int com_arena_create(COM_ARENA *arena, int size);
+void com_arena_delete(COM_ARENA *arena);
+void * com_arena_alloc(COM_ARENA *arena, int size);
+void com_arena_unspill(COM_ARENA *arena, int mark);
+#define com_arena_mark(arena)              ((arena)->used)
+#define com_arena_release(arena, mark)     ((arena)->spill ? com_arena_unspill((arena), (mark)) : (void)((arena)->used = (mark)))
+void com_scratch_bind(COM_ARENA *arena);
+COM_ARENA * com_scratch(void);
+#endif
+int com_rbsp_extract(const u8 *src, int size, u8 *dst);
 COM_PIC* com_picbuf_alloc(int w, int h, int pad_l, int pad_c, int *err);
 void com_picbuf_free(COM_PIC *pic);
 void com_picbuf_expand(COM_PIC *pic, int exp_l, int exp_c);
@@ -340,10 +354,16 @@ int com_split_is_vertical(SPLIT_MODE mode);
 //! Check that mode is horizontal
 int com_split_is_horizontal(SPLIT_MODE mode);
 
+#if COL_MV_COMPRESS
+/* the colocated position functions return an index into the COL_MV_LOG2 motion field of the colocated picture */
+#endif
 int get_colocal_scup(int scup, int pic_width_in_scu, int pic_height_in_scu);
 #if AWP
 int get_rb_scup(int scup, int pic_width_in_scu, int pic_height_in_scu, int cu_width, int cu_height, int max_cuwh);
 #endif
+#if COL_MV_COMPRESS
+void com_col_mv_compress(COM_PIC *pic, s16(*map_mv)[REFP_NUM][MV_D], s8(*map_refi)[REFP_NUM], int pic_width_in_scu, int pic_height_in_scu);
+#endif
 void get_col_mv(COM_REFP refp[REFP_NUM], u32 ptr, int scup, s16 mvp[REFP_NUM][MV_D]);
 void get_col_mv_from_list0(COM_REFP refp[REFP_NUM], u32 ptr, int scup, s16 mvp[REFP_NUM][MV_D]);
 #if SUB_TMVP || AWP
@@ -42,7 +42,18 @@
 void create_alf_global_buffer(DEC_CTX *ctx);
 void release_alf_global_buffer(DEC_CTX *ctx);
 
-void alf_process_dec(DEC_CTX* ctx, ALF_PARAM **alf_param, COM_PIC* pic_rec, COM_PIC* pic_dec);
+void alf_process_dec(DEC_CTX* ctx, ALF_PARAM **alf_param, COM_PIC* pic_rec, COM_PIC* pic_dec
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#if LF_CTU_PIPELINE
+void alf_process_dec_lcu_row(DEC_CTX* ctx, ALF_PARAM **alf_param, COM_PIC* pic_rec, COM_PIC* pic_dec, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+);
+#endif
 void filter_one_ctb(DEC_ALF_VAR * dec_alf, pel *rec, pel *dec, int stride, int comp_idx, int bit_depth, ALF_PARAM *alf_param
     , int lcu_y_pos, int lcu_height, int lcu_x_pos, int lcu_width
     , BOOL is_above_avail, BOOL is_below_avail, BOOL is_left_avail, BOOL is_right_avail, BOOL is_above_left_avail
@@ -161,8 +161,33 @@ typedef struct _DEC_CORE
 #if ETMVP
     COM_MOTION    best_etmvp_mvfield[(MAX_CU_SIZE >> 2) * (MAX_CU_SIZE >> 2)];
 #endif
+#if SCRATCH_ARENA
+    /* temporary blocks of MC, bound to the thread running dec_pic() */
+    COM_ARENA     scratch;
+#endif
+#if TM_COST_CACHE
+    COM_TM_CACHE *tm_cache;
+#endif
+#if PADLESS_REF
+    COM_REF_WIN  *ref_win;
+#endif
 } DEC_CORE;
 
+#if LF_CTU_PIPELINE
+/******************************************************************************
+ * lines [y0, y1) of one in-loop filter stage input, kept while the LCU row
+ * reading them is filtered in place in the decoded picture
+ *****************************************************************************/
+typedef struct _DEC_LF_BAND
+{
+    pel                  *buf[N_C];
+    int                   stride[N_C];
+    int                   lines[N_C];
+    int                   y0[N_C];
+    int                   y1[N_C];
+} DEC_LF_BAND;
+
+#endif
 /******************************************************************************
  * CONTEXT used for decoding process.
  *
@@ -207,7 +232,11 @@ struct _DEC_CTX
     decoded properly, this value should reach to zero */
     int                   lcu_cnt;
 
+#if DBK_EDGE_BITMAP
+    COM_EDGE_MAP        *edge_filter;
+#else
     int                 **edge_filter[LOOPFILTER_DIR_TYPE];
+#endif
 
 #if AWP_ENH
     pel                 ****awp_weight_tpl;
@@ -239,6 +268,14 @@ struct _DEC_CTX
 
     COM_PIC              *pic_alf_Dec;
     COM_PIC              *pic_alf_Rec;
+#if LF_CTU_PIPELINE
+    DEC_LF_BAND           lf_band_dbk[2]; //deblocked lines of the two LCU rows in flight, SAO and CCSAO input
+    DEC_LF_BAND           lf_band_esao;   //SAO output lines, ESAO input
+    DEC_LF_BAND           lf_band_alf;    //ESAO/CCSAO output lines, ALF input
+#endif
+#if LF_ROW_PARALLEL
+    COM_THREAD_POOL      *pool;           //LCUs of an LCU row are filtered on this pool, NULL for single-threaded
+#endif
     int                   pic_alf_on[N_C];
     int                ***coeff_all_to_write_alf;
     DEC_ALF_VAR            *dec_alf;
@@ -264,6 +301,10 @@ struct _DEC_CTX
     int                   pic_cnt;
     /* picture buffer allocator */
     PICBUF_ALLOCATOR      pa;
+#if PIC_BUF_POOL
+    /* DPB pictures kept across sequence restarts */
+    COM_PIC_POOL          pic_pool;
+#endif
     /* bitstream has an error? */
     u8                    bs_err;
     /* reference picture (0: foward, 1: backward) */
@@ -316,6 +357,10 @@ int  dec_esao(DEC_CTX * ctx);
 int  dec_ccsao(DEC_CTX *ctx);
 #endif
 
+#if LF_CTU_PIPELINE
+int  dec_loop_filter_lcu_rows(DEC_CTX *ctx);
+#endif
+
 int  dec_pic(DEC_CTX * ctx, DEC_CORE * core, COM_SQH *sqh, COM_PIC_HEADER * ph, COM_SH_EXT * shext);
 #if PATCH
 void de_copy_lcu_scu(u32 * scu_temp, u32 * scu_best, s8(*refi_temp)[REFP_NUM], s8(*refi_best)[REFP_NUM], s16(*mv_temp)[REFP_NUM][MV_D],
@@ -0,0 +1,78 @@
+/* ====================================================================================================================
+
+  The copyright in this software is being made available under the License included below.
+  This software may be subject to other third party and contributor rights, including patent rights, and no such
+  rights are granted under this license.
+
+  Copyright (c) 2018, HUAWEI TECHNOLOGIES CO., LTD. All rights reserved.
+  Copyright (c) 2018, SAMSUNG ELECTRONICS CO., LTD. All rights reserved.
+  Copyright (c) 2018, PEKING UNIVERSITY SHENZHEN GRADUATE SCHOOL. All rights reserved.
+  Copyright (c) 2018, PENGCHENG LABORATORY. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted only for
+  the purpose of developing standards within Audio and Video Coding Standard Workgroup of China (AVS) and for testing and
+  promoting such standards. The following conditions are required to be met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+      the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+      the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * The name of HUAWEI TECHNOLOGIES CO., LTD. or SAMSUNG ELECTRONICS CO., LTD. may not be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+* ====================================================================================================================
+*/
+
+#ifndef _DEC_STREAM_H_
+#define _DEC_STREAM_H_
+
+#include "dec_def.h"
+
+#if STREAM_API
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* caller hooks of a decoder stream, every member but frame may be NULL */
+typedef struct _DEC_STREAM_CB
+{
+    void                 * opaque;
+    /* memory of the stream and its packet buffers, malloc and free when NULL */
+    void                *(*alloc)(void * opaque, size_t size);
+    void                 (*free)(void * opaque, void * ptr);
+    /* one packet was decoded (size in bytes before emulation prevention removal), ret is the
+       result of dec_cnk(); a video sequence end arrives with stat->ctype COM_CT_SEQ_END */
+    int                  (*packet)(void * opaque, int size, DEC_STAT * stat, int ret);
+    /* decoded picture in output order, valid until the callback returns (addref keeps it),
+       a negative return fails the stream call */
+    int                  (*frame)(void * opaque, COM_IMGB * img);
+} DEC_STREAM_CB;
+
+typedef struct _DEC_STREAM DEC_STREAM;
+
+DEC_STREAM * dec_stream_create(DEC_CDSC * cdsc, const DEC_STREAM_CB * cb, int * err);
+void dec_stream_delete(DEC_STREAM * s);
+/* decoder handle of the stream for settings the descriptor does not carry */
+DEC dec_stream_decoder(DEC_STREAM * s);
+/* decodes the packets completed by the bytes of an elementary stream, the bytes may be cut anywhere;
+   an incomplete last packet is kept until the next push or the flush */
+int dec_stream_push(DEC_STREAM * s, const u8 * data, int size);
+/* decodes the kept bytes and outputs the remaining pictures */
+int dec_stream_flush(DEC_STREAM * s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+#endif /* _DEC_STREAM_H_ */
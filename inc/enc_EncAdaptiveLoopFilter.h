@@ -146,6 +146,13 @@ void add_alf_corr_data(ALF_CORR_DATA *A, ALF_CORR_DATA *B, ALF_CORR_DATA *C
     , int num_coef
 #endif
 );
+#if ALF_ENC_INCR
+void sub_alf_corr_data(ALF_CORR_DATA *A, ALF_CORR_DATA *B, ALF_CORR_DATA *C
+#if ALF_SHAPE
+    , int num_coef
+#endif
+);
+#endif
 void accumulate_lcu_correlation(ENC_CTX *ctx, ALF_CORR_DATA **alf_corr_acc, ALF_CORR_DATA ***alf_corr_src_lcu, BOOL use_all_lcus);
 void decide_alf_picture_param(ENC_ALF_VAR *enc_alf, ALF_PARAM **alf_pic_param, ALF_CORR_DATA **alf_corr, double lambda_luma);
 void derive_filter_info(ENC_ALF_VAR *enc_alf, int comp_idx, ALF_CORR_DATA *alf_corr, ALF_PARAM *alf_param, int max_num_filter, double lambda);
@@ -37,6 +37,7 @@
 #include "com_def.h"
 #include "enc_bsw.h"
 #include "enc_sad.h"
+#include "enc_lookahead.h"
 
 /* support RDOQ */
 #define SCALE_BITS               15    /* Inherited from TMuC, pressumably for fractional bit estimates in RDOQ */
@@ -371,6 +372,51 @@ typedef struct _ENC_PARENT_INFO
     int             p_height_log2;
 } ENC_PARENT_INFO;
 #endif
+
+#if ENC_PRESET
+/* encoder speed presets, ordered from slowest to fastest */
+typedef enum _ENC_PRESET_ID
+{
+    ENC_PRESET_PLACEBO   = -2,
+    ENC_PRESET_SLOW      = -1,
+    ENC_PRESET_MEDIUM    =  0, /* default (zero-initialized ENC_PARAM), the anchor configuration */
+    ENC_PRESET_FAST      =  1,
+    ENC_PRESET_VERYFAST  =  2,
+    ENC_PRESET_ULTRAFAST =  3,
+    ENC_PRESET_NUM       = ENC_PRESET_ULTRAFAST - ENC_PRESET_PLACEBO + 1
+} ENC_PRESET_ID;
+
+/* non-normative search knobs selected by the speed preset */
+typedef struct _ENC_PRESET_CFG
+{
+    /* intra modes passed from SATD pre-selection to RDO */
+    int            ipd_rdo_num;
+    /* skip/direct candidates passed to RDO */
+    int            skip_rdo_num;
+    /* AWP / SAWP candidates passed to RDO */
+    int            awp_rdo_num;
+    int            sawp_rdo_num;
+    /* deepest binary/EQT split depth tried by the encoder */
+    int            max_bet_depth;
+    /* integer-pel ME search range is scaled by 2^(-search_range_shift) */
+    int            search_range_shift;
+    /* scale of the candidate-pruning thresholds (< 1: prune harder) */
+    double         et_ratio;
+    /* confidence needed by the split predictor (FAST_SPLIT_PRED) to prune split modes, 0: off */
+    double         split_pred_thr;
+} ENC_PRESET_CFG;
+
+/* max_bet_depth of the presets that try every split depth the sequence header allows */
+#define ENC_PRESET_NO_LIMIT     COM_INT_MAX
+
+#define ENC_AWP_RDO_NUM(ctx)    ((ctx)->preset.awp_rdo_num)
+#define ENC_SAWP_RDO_NUM(ctx)   ((ctx)->preset.sawp_rdo_num)
+#define ENC_ET_RATIO(ctx)       ((ctx)->preset.et_ratio)
+#else
+#define ENC_AWP_RDO_NUM(ctx)    AWP_RDO_NUM
+#define ENC_SAWP_RDO_NUM(ctx)   SAWP_RDO_NUM
+#define ENC_ET_RATIO(ctx)       1.0
+#endif
 /* encoder parameter */
 typedef struct _ENC_PARAM
 {
@@ -674,6 +720,14 @@ typedef struct _ENC_PARAM
     int            alo_enable_type;
 #endif
     int            air_enable_flag;
+#if ENC_PRESET
+    /* speed preset (ENC_PRESET_ID) */
+    int            preset;
+#endif
+#if LF_ROW_PARALLEL
+    /* number of threads running the in-loop filters, 0 or 1 for none */
+    int            threads;
+#endif
 #if HDR_DISPLAY
     int            colour_description;
     int            colour_primaries;
@@ -693,8 +747,37 @@ typedef struct _ENC_SBAC
     COM_SBAC_CTX  ctx;
     u32            bitcounter;
     u8             is_bitcount;
+#if SBAC_RATE_EST
+    /* estimated rate in units of 1/(1 << SBAC_EST_FRAC_BITS) bit, used when is_bitcount is set */
+    u64            frac_bits;
+#endif
+#if SBAC_CTX_JOURNAL
+    /* context chunks touched since the last SBAC_STORE/SBAC_LOAD into this object */
+    u64            ctx_dirty;
+    /* generation stamped when this object was last overwritten (0: never) */
+    u64            ctx_gen;
+    /* object this one was last copied from, and its generation at that time */
+    const struct _ENC_SBAC *ctx_src;
+    u64            ctx_src_gen;
+#endif
 } ENC_SBAC;
 
+#if SBAC_RATE_EST
+#define SBAC_EST_FRAC_BITS      15
+/* a terminating 1 leaves range at QUAR_HALF_PROB and shifts the code by 8 bits, a 0 is nearly free */
+#define SBAC_EST_TRM_BITS       (PROB_BITS - 3)
+#endif
+
+#if SBAC_CTX_JOURNAL
+#define SBAC_CTX_CHUNK_LOG2     4 /* 16 context models (one cache line) per journal chunk */
+#define SBAC_CTX_CHUNK_NUM      ((sizeof(COM_SBAC_CTX) / sizeof(SBAC_CTX_MODEL) + (1 << SBAC_CTX_CHUNK_LOG2) - 1) >> SBAC_CTX_CHUNK_LOG2)
+/* ctx_dirty holds one bit per chunk: fails to compile when the contexts outgrow it */
+typedef char sbac_ctx_chunk_num_check[(SBAC_CTX_CHUNK_NUM <= 64) ? 1 : -1];
+/* record that a context model of sbac is about to be updated */
+#define SBAC_CTX_TOUCH(sbac, model) \
+    ((sbac)->ctx_dirty |= (u64)1 << ((u32)((model) - (SBAC_CTX_MODEL *)&(sbac)->ctx) >> SBAC_CTX_CHUNK_LOG2))
+#endif
+
 typedef struct _ENC_CU_DATA
 {
 #if CTU_256
@@ -1010,6 +1093,21 @@ typedef struct _ENC_ALF_VAR
     pel         **var_img;
     BOOL        **alf_lcu_enabled;
     unsigned int  bit_increment;
+#if ALF_ENC_INCR
+    /* running sum of the per-LCU statistics alf_corr_sum_src[] of the LCUs flagged in alf_lcu_in_sum */
+    ALF_CORR_DATA  *alf_corr_sum[N_C];
+    ALF_CORR_DATA **alf_corr_sum_src[N_C];
+    BOOL          **alf_lcu_in_sum;
+    /* quantized filters of merged class intervals [start][stop], valid while filter_cache_tag equals filter_cache_cur */
+    int             filter_cache_cur;
+    int             filter_cache_tag[NO_VAR_BINS][NO_VAR_BINS];
+    double          filter_cache_err[NO_VAR_BINS][NO_VAR_BINS][2];
+#if ALF_SHAPE
+    int             filter_cache_coef[NO_VAR_BINS][NO_VAR_BINS][ALF_MAX_NUM_COEF_SHAPE2 + 1];
+#else
+    int             filter_cache_coef[NO_VAR_BINS][NO_VAR_BINS][ALF_MAX_NUM_COEF];
+#endif
+#endif
 } ENC_ALF_VAR;
 
 /*****************************************************************************
@@ -1242,6 +1340,24 @@ typedef struct _ENC_CORE
     int cur_qt_depth;
     int cur_bet_depth;
 #endif
+#if FAST_SPLIT_PRED
+    /* best NO_SPLIT mode of the parent CU (SPLIT_PRED_PARENT_*) */
+    u8  split_pred_parent;
+#endif
+#if SCRATCH_ARENA
+    /* temporary blocks of MC, bound to the thread running enc_pic() */
+    COM_ARENA     scratch;
+#endif
+#if SBAC_CTX_JOURNAL
+    /* last generation handed out to an SBAC snapshot of this core */
+    u64           sbac_gen;
+#endif
+#if TM_COST_CACHE
+    COM_TM_CACHE *tm_cache;
+#endif
+#if PADLESS_REF
+    COM_REF_WIN  *ref_win;
+#endif
 #if INTER_ME_MVLIB
 };
 
@@ -1348,6 +1464,14 @@ struct _ENC_CTX
     ENC_PINTRA             pintra;
     /* inter prediction analysis */
     ENC_PINTER             pinter;
+#if ENC_PRESET
+    /* search knobs of the selected speed preset */
+    ENC_PRESET_CFG         preset;
+#endif
+#if LF_ROW_PARALLEL
+    /* in-loop filters run LCU rows on this pool, NULL for single-threaded */
+    COM_THREAD_POOL       *pool;
+#endif
 #if USE_IBC
     /* IBC prediction analysis */
     ENC_PIBC               pibc;
@@ -1385,7 +1509,11 @@ struct _ENC_CTX
     s64                    dist_filter;  //distortion of filtered samples
 #endif
 
+#if DBK_EDGE_BITMAP
+    COM_EDGE_MAP         *edge_filter;
+#else
     int                  **edge_filter[LOOPFILTER_DIR_TYPE];
+#endif
 
     COM_PIC               *pic_sao;
     SAO_STAT_DATA         ***sao_stat_data; //[SMB][comp][types]
@@ -1523,6 +1651,10 @@ struct _ENC_CTX
 #if ALO
     void* pEncALO;
 #endif
+#if LOOKAHEAD_STAGE
+    /* statistics of the pushed pictures, NULL when no tool uses them */
+    LOOKAHEAD           * lookahead;
+#endif
 };
 
 /*****************************************************************************
@@ -1548,9 +1680,11 @@ int enc_deblock_avs2(ENC_CTX * ctx, COM_PIC * pic
 #endif
 );
 #if DBR
-void enc_deblock_frame(ENC_CTX * ctx, COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_PIC * pic_org, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], int*** edge_filter, double lambda);
+void enc_deblock_frame(ENC_CTX * ctx, COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_PIC * pic_org, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter, double lambda);
 #endif
 int enc_push_frm(ENC_CTX * ctx, COM_IMGB * img);
+/* end of input: the pictures left in the buffer are coded without waiting for a full GOP */
+void enc_setup_bumping(ENC_CTX * ctx);
 int enc_ready(ENC_CTX * ctx);
 void enc_flush(ENC_CTX * ctx);
 #if AWP || SAWP
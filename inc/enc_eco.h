@@ -76,6 +76,12 @@ void enc_sbac_init(COM_BSW * bs);
 void enc_sbac_finish(COM_BSW *bs, int is_ipcm);
 void enc_sbac_encode_bin(u32 bin, ENC_SBAC *sbac, SBAC_CTX_MODEL *ctx_model, COM_BSW *bs);
 void enc_sbac_encode_bin_trm(u32 bin, ENC_SBAC *sbac, COM_BSW *bs);
+void enc_sbac_encode_bin_for_rdoq(u32 bin, SBAC_CTX_MODEL *model);
+#if SBAC_RATE_EST
+void enc_sbac_init_est(void);
+u16 enc_sbac_est_prob_lps(SBAC_CTX_MODEL model);
+u16 enc_sbac_est_prob_lpsW(SBAC_CTX_MODEL model1, SBAC_CTX_MODEL model2, u16 *cmps);
+#endif
 int encode_coef(COM_BSW * bs, s16 coef[N_C][MAX_CU_DIM], int cu_width_log2, int cu_height_log2, u8 pred_mode, COM_MODE *mi, u8 tree_status, ENC_CTX * ctx
 #if CUDQP
     , int qp_y
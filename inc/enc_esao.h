@@ -40,7 +40,10 @@ void get_multi_classes_statistics_for_esao(COM_PIC *pic_org,COM_PIC  *pic_lic, E
     int label_index,int lcu_pos,int pix_y, int pix_x, int lcu_available_left, int lcu_available_right, int lcu_available_up, int lcu_available_down,
     int lcu_available_upleft, int lcu_available_upright, int lcu_available_leftdown, int lcu_available_rightdwon);
 
-#if ESAO_ENH
+#if ESAO_ENC_FUSED_STAT
+void get_frame_statistics_for_esao(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_org, COM_PIC  *pic_esao, ESAO_STAT_DATA ***esao_luma_state_data, ESAO_STAT_DATA ***esao_chroma_state_data
+    , COM_THREAD_POOL *pool);
+#elif ESAO_ENH
 void get_frame_statistics_for_esao(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_org, COM_PIC  *pic_esao, ESAO_STAT_DATA ***esao_luma_state_data, ESAO_STAT_DATA ***esao_chroma_state_data);
 #else
 void get_frame_statistics_for_esao(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_org, COM_PIC  *pic_esao, ESAO_STAT_DATA **esao_luma_state_data, ESAO_STAT_DATA **esao_chroma_state_data);
@@ -140,6 +143,9 @@ void get_ccsao_frame_stat(COM_INFO *info, COM_MAP *map, COM_PIC *pic_org,
 #if ECCSAO
     , CCSAO_STAT_DATA *****ccsao_edge_stat_data
 #endif
+#if ESAO_ENC_FUSED_STAT
+    , COM_THREAD_POOL *pool
+#endif
 );
 
 #if CCSAO_ENHANCEMENT
@@ -0,0 +1,132 @@
+/* ====================================================================================================================
+
+  The copyright in this software is being made available under the License included below.
+  This software may be subject to other third party and contributor rights, including patent rights, and no such
+  rights are granted under this license.
+
+  Copyright (c) 2018, HUAWEI TECHNOLOGIES CO., LTD. All rights reserved.
+  Copyright (c) 2018, SAMSUNG ELECTRONICS CO., LTD. All rights reserved.
+  Copyright (c) 2018, PEKING UNIVERSITY SHENZHEN GRADUATE SCHOOL. All rights reserved.
+  Copyright (c) 2018, PENGCHENG LABORATORY. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted only for
+  the purpose of developing standards within Audio and Video Coding Standard Workgroup of China (AVS) and for testing and
+  promoting such standards. The following conditions are required to be met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+      the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+      the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * The name of HUAWEI TECHNOLOGIES CO., LTD. or SAMSUNG ELECTRONICS CO., LTD. may not be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+* ====================================================================================================================
+*/
+
+#ifndef _ENC_LOOKAHEAD_H_
+#define _ENC_LOOKAHEAD_H_
+
+#include "com_def.h"
+
+#if LOOKAHEAD_STAGE
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* the temporal filter (enc_temporalFilter.c) does not take its motion from here on purpose: it needs sub-pel
+   motion of 8x8 blocks against pictures on both sides of the filtered one, while this stage keeps full-pel
+   16x16 motion against the previous picture only, and runs only when ALO is on */
+#define LOOKAHEAD_BLK_SIZE         16 /* luma block size of the coarse motion field */
+#define LOOKAHEAD_HIST_BINS        256 /* luma histogram bins, 10-bit samples >> 2 */
+#if LOOKAHEAD_FAST_ME
+#define LOOKAHEAD_PYRAMID          2 /* downsampled levels the motion search starts on */
+#endif
+#if LOOKAHEAD_ROW_PARALLEL
+/* share of --threads taken by the lookahead thread and its row pool, which run beside the encoder pool */
+#define LOOKAHEAD_THREADS(threads) ((threads) >> 2)
+#endif
+
+/* full-pel luma motion of one block against the previous input picture */
+typedef struct _LOOKAHEAD_MV
+{
+    /* block position minus the position of its match */
+    s16                  mvx;
+    s16                  mvy;
+    /* block size, cut at the right and bottom picture edges */
+    u16                  w;
+    u16                  h;
+    s32                  sad;
+    s64                  sse;
+} LOOKAHEAD_MV;
+
+typedef struct _LOOKAHEAD LOOKAHEAD;
+
+/* statistics of one input picture, filled on the lookahead thread */
+typedef struct _LOOKAHEAD_FRAME
+{
+    LOOKAHEAD          * la;
+    /* input picture index as counted by enc_push_frm() */
+    int                  pic_icnt;
+    /* luma copy the statistics are computed on */
+    pel                * y;
+#if LOOKAHEAD_FAST_ME
+    /* y downsampled by 2 and by 4 */
+    pel                * ds[LOOKAHEAD_PYRAMID];
+#endif
+    /* 0 for the first picture, which has no motion field */
+    int                  has_ref;
+    LOOKAHEAD_MV       * mv;
+    int                  hist[LOOKAHEAD_HIST_BINS];
+    /* cosine similarity of hist with the histogram of the previous picture */
+    double               cos_sim;
+    /* sum of the block SADs */
+    s64                  sad;
+} LOOKAHEAD_FRAME;
+
+struct _LOOKAHEAD
+{
+    int                  width;
+    int                  height;
+    int                  search_range;
+    int                  blk_w;
+    int                  blk_h;
+    /* ring of frames, indexed by pic_icnt % num */
+    int                  num;
+    LOOKAHEAD_FRAME    * frame;
+    COM_THREAD_QUEUE   * queue;
+#if LOOKAHEAD_ROW_PARALLEL
+    /* block rows of the motion search, NULL when they run on the lookahead thread alone */
+    COM_THREAD_POOL    * pool;
+#endif
+    /* a ring entry is done once its statistics are complete */
+    COM_THREAD_PROGRESS* done;
+};
+
+/* num is the number of input pictures that are pushed but not yet encoded plus one */
+LOOKAHEAD * enc_lookahead_create(int width, int height, int search_range, int num
+#if LOOKAHEAD_ROW_PARALLEL
+    , int threads
+#endif
+);
+void enc_lookahead_delete(LOOKAHEAD * la);
+/* copies the luma of the pushed picture and queues its statistics on the lookahead thread */
+void enc_lookahead_push(LOOKAHEAD * la, COM_PIC * pic, int pic_icnt);
+/* waits for the statistics of a pushed picture that has not been encoded yet */
+const LOOKAHEAD_FRAME * enc_lookahead_get(LOOKAHEAD * la, int pic_icnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+#endif /* _ENC_LOOKAHEAD_H_ */
@@ -87,6 +87,10 @@ void enc_bit_est_affine_mvp(ENC_CTX * ctx, ENC_CORE * core, s32 slice_type, s8 r
 u32 enc_get_bit_number(ENC_SBAC *sbac);
 void enc_init_bits_est();
 void enc_init_bef_data(ENC_CORE* core, ENC_CTX* ctx);
+#if CUDQP_QP_MAP || FAST_SPLIT_PRED
+int enc_get_block_avg(pel *buff, int block_w, int block_h, int stride);
+int enc_get_block_std_simp(pel *buff, int block_w, int block_h, int stride, int average);
+#endif
 
 #if RDO_DBK
 void calc_delta_dist_filter_boundary(ENC_CTX* ctx, ENC_CORE *core, COM_PIC *pic_rec, COM_PIC *pic_org, int cu_width, int cu_height, pel(*src)[MAX_CU_DIM],
@@ -171,6 +171,10 @@ public:
 
     FrameDistortion MotionCompensation(Pixel* srcYUV, Pixel* tarYUV, int srcPoc, int tarPoc, int width, int height, int blockSize, int searchRange);
 
+#if LOOKAHEAD_STAGE
+    FrameDistortion LookaheadDistortion(const LOOKAHEAD_FRAME* frame, int srcPoc, int tarPoc);
+#endif
+
     void CalulateCtuFactor(FrameDistortion& rFD, double* workCtuFactor);
 
     double CalulateCtuLambda(int ctuIdx, double oldLambda);
@@ -28,6 +28,10 @@ double adjustCtuLambda(ENC_CTX* ctx);
 
 void updateCosineSimilarity(ENC_CTX* ctx);
 
+#if LOOKAHEAD_STAGE
+void updateLookaheadCtuFactor(ENC_CTX* ctx);
+#endif
+
 #ifdef __cplusplus
 } //<-- extern "C"
 #endif
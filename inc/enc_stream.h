@@ -0,0 +1,89 @@
+/* ====================================================================================================================
+
+  The copyright in this software is being made available under the License included below.
+  This software may be subject to other third party and contributor rights, including patent rights, and no such
+  rights are granted under this license.
+
+  Copyright (c) 2018, HUAWEI TECHNOLOGIES CO., LTD. All rights reserved.
+  Copyright (c) 2018, SAMSUNG ELECTRONICS CO., LTD. All rights reserved.
+  Copyright (c) 2018, PEKING UNIVERSITY SHENZHEN GRADUATE SCHOOL. All rights reserved.
+  Copyright (c) 2018, PENGCHENG LABORATORY. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted only for
+  the purpose of developing standards within Audio and Video Coding Standard Workgroup of China (AVS) and for testing and
+  promoting such standards. The following conditions are required to be met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+      the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+      the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * The name of HUAWEI TECHNOLOGIES CO., LTD. or SAMSUNG ELECTRONICS CO., LTD. may not be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+* ====================================================================================================================
+*/
+
+#ifndef _ENC_STREAM_H_
+#define _ENC_STREAM_H_
+
+#include "enc_def.h"
+
+#if STREAM_API
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define ENC_STREAM_BS_SIZE         (32*1024*1024) /* byte, bitstream buffer of one coded picture */
+
+/* caller hooks of an encoder stream, every member but packet may be NULL */
+typedef struct _ENC_STREAM_CB
+{
+    void                 * opaque;
+    /* memory of the stream and its bitstream buffers, malloc and free when NULL */
+    void                *(*alloc)(void * opaque, size_t size);
+    void                 (*free)(void * opaque, void * ptr);
+    /* pushed picture after it was copied into the encoder buffer and before it is queued,
+       a pre-filter may change the samples in place */
+    int                  (*input)(void * opaque, COM_IMGB * img, int pic_icnt);
+    /* one coded unit in coding order: a picture with its reconstruction, the sequence header
+       (without REPEAT_SEQ_HEADER) or the video sequence end code after the last picture, both
+       with rec NULL; data and rec are valid until the callback returns, a negative return
+       fails the stream call */
+    int                  (*packet)(void * opaque, const u8 * data, int size, COM_IMGB * rec, ENC_STAT * stat);
+} ENC_STREAM_CB;
+
+typedef struct _ENC_STREAM ENC_STREAM;
+
+/* creates the encoder, it may be configured through enc_stream_encoder() until the header is coded */
+ENC_STREAM * enc_stream_create(ENC_PARAM * param, const ENC_STREAM_CB * cb, int * err);
+void enc_stream_delete(ENC_STREAM * s);
+/* encoder handle of the stream for settings the parameters do not carry */
+ENC enc_stream_encoder(ENC_STREAM * s);
+/* codes the sequence header, done by the first push or coding step when not called */
+int enc_stream_header(ENC_STREAM * s);
+/* queues a picture of 16-bit samples at the internal bit depth, NULL ends the input;
+   every push is to be followed by one enc_stream_encode(); COM_ERR_INVALID_ARGUMENT when the
+   planes, colour space or plane sizes differ from the coded picture */
+int enc_stream_push(ENC_STREAM * s, COM_IMGB * img);
+/* one coding step: COM_OK when a picture was delivered, COM_OK_OUT_NOT_AVAILABLE while the
+   reordering delay fills, COM_OK_NO_MORE_FRM after the input ended and all pictures are out */
+int enc_stream_encode(ENC_STREAM * s);
+/* ends the input and codes the remaining pictures */
+int enc_stream_flush(ENC_STREAM * s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+#endif /* _ENC_STREAM_H_ */
@@ -107,10 +107,23 @@ typedef struct TF_CTX
     TF_MV_PRMD mv_pyramid;
 
     TF_PIC_BUF pic_bufs[MAX_FILTER_LEN];
+#if TF_PARALLEL
+    /* pool running the block rows of ME, MC and the bilateral filter, set by the caller after tf_init() */
+    COM_THREAD_POOL * pool;
+    /* bilateral exp() weights per channel, indexed by sigma class and absolute sample difference */
+    double * weight_lut[CHAN_NUM];
+#endif
 } TF_CTX;
 
-void tf_init(TF_CTX * h, int qp, int width, int height, int input_depth, int internal_depth, double strength[FILTER_TYPE], int period[FILTER_TYPE], int gop_based);
+/* returns -1 if the filter tables cannot be allocated; tf_uninit() releases what was set up */
+int tf_init(TF_CTX * h, int qp, int width, int height, int input_depth, int internal_depth, double strength[FILTER_TYPE], int period[FILTER_TYPE], int gop_based);
+#if TF_INPUT_RING
+/* marks the ring slot of input frame frame_idx, whose org_pic the caller has filled, as holding it */
+void tf_push_frame(TF_CTX * h, int frame_idx);
+int  tf_prepare_frames(TF_CTX * h, int poc, int skip_frame
+#else
 int  tf_prepare_frames(TF_CTX * h, int poc, int skip_frame, char * input_name
+#endif
 #if DQP_OPT
     , ENC_CTX *ctx
 #endif
@@ -48,8 +48,17 @@ void enc_bsw_write_slice_size(COM_BSW *bs);
 void enc_diff_pred(int x, int y, int cu_width_log2, int cu_height_log2, COM_PIC *org, pel pred[N_C][MAX_CU_DIM], s16 diff[N_C][MAX_CU_DIM]);
 
 
+#if SBAC_CTX_JOURNAL
+void enc_sbac_copy(ENC_SBAC *dst, const ENC_SBAC *src);
+void enc_sbac_ctx_reset(ENC_SBAC *sbac);
+void enc_sbac_gen_bind(u64 *gen);
+
+#define SBAC_STORE(dst, src) enc_sbac_copy(&(dst), &(src))
+#define SBAC_LOAD(dst, src)  enc_sbac_copy(&(dst), &(src))
+#else
 #define SBAC_STORE(dst, src) com_mcpy(&dst, &src, sizeof(ENC_SBAC))
 #define SBAC_LOAD(dst, src)  com_mcpy(&dst, &src, sizeof(ENC_SBAC))
+#endif
 
 int enc_create_cu_data(ENC_CU_DATA *cu_data, int cu_width_log2, int cu_height_log2
 #if USE_SP
@@ -107,7 +107,71 @@ byte CLIP_TAB_AVS[64] =
     7, 7, 8, 8, 8, 9, 9, 9
 };
 
-void create_edge_filter_avs2(int w, int h, int ***edge_filter)
+#if DBK_EDGE_BITMAP
+#define EDGE_MAP_SHIFT(b4_x, dir)                  ((((b4_x) & 1) << 2) + ((dir) << 1))
+#define EDGE_MAP_PTR(em, b4_y, b4_x)               ((em)->map + (b4_y) * (em)->stride + ((b4_x) >> 1))
+#define EDGE_MAP_GET(em, dir, b4_y, b4_x)          ((*EDGE_MAP_PTR(em, b4_y, b4_x) >> EDGE_MAP_SHIFT(b4_x, dir)) & 3)
+#define EDGE_MAP_SET(em, dir, b4_y, b4_x, v) \
+    (*EDGE_MAP_PTR(em, b4_y, b4_x) = (u8)((*EDGE_MAP_PTR(em, b4_y, b4_x) & ~(3 << EDGE_MAP_SHIFT(b4_x, dir))) | ((v) << EDGE_MAP_SHIFT(b4_x, dir))))
+
+COM_EDGE_MAP * create_edge_filter_avs2(int w, int h)
+{
+    COM_EDGE_MAP *edge_filter = (COM_EDGE_MAP *)com_malloc(sizeof(COM_EDGE_MAP));
+    com_assert_rv(edge_filter != NULL, NULL);
+    edge_filter->w4 = w >> LOOPFILTER_SIZE_IN_BIT;
+    edge_filter->h4 = h >> LOOPFILTER_SIZE_IN_BIT;
+    edge_filter->stride = (edge_filter->w4 + 1) >> 1;
+    edge_filter->map = (u8 *)com_malloc(edge_filter->stride * edge_filter->h4 + 1);
+    if (edge_filter->map == NULL)
+    {
+        com_mfree(edge_filter);
+        return NULL;
+    }
+    com_mset(edge_filter->map, 0, edge_filter->stride * edge_filter->h4 + 1);
+    return edge_filter;
+}
+
+void clear_edge_filter_avs2(int x, int y, int w, int h, COM_EDGE_FILTER edge_filter)
+{
+    int b4_x_start = x >> LOOPFILTER_SIZE_IN_BIT;
+    int b4_x_end = COM_MIN((x + w) >> LOOPFILTER_SIZE_IN_BIT, edge_filter->w4);
+    int b4_y_end = COM_MIN((y + h) >> LOOPFILTER_SIZE_IN_BIT, edge_filter->h4);
+    int b4_x, b4_y;
+    if (b4_x_start >= b4_x_end)
+    {
+        return;
+    }
+    for (b4_y = y >> LOOPFILTER_SIZE_IN_BIT; b4_y < b4_y_end; b4_y++)
+    {
+        u8 *line = EDGE_MAP_PTR(edge_filter, b4_y, 0);
+        b4_x = b4_x_start;
+        if (b4_x & 1)
+        {
+            line[b4_x >> 1] &= 0x0f;
+            b4_x++;
+        }
+        if (b4_x_end - b4_x >= 2)
+        {
+            com_mset(line + (b4_x >> 1), 0, (b4_x_end - b4_x) >> 1);
+            b4_x += (b4_x_end - b4_x) & ~1;
+        }
+        if (b4_x < b4_x_end)
+        {
+            line[b4_x >> 1] &= 0xf0;
+        }
+    }
+}
+
+void delete_edge_filter_avs2(COM_EDGE_MAP *edge_filter)
+{
+    if (edge_filter)
+    {
+        com_mfree(edge_filter->map);
+        com_mfree(edge_filter);
+    }
+}
+#else
+void create_edge_filter_avs2(int w, int h, COM_EDGE_FILTER edge_filter)
 {
     //allocate memory
     for (int i = 0; i < LOOPFILTER_DIR_TYPE; i++)
@@ -131,7 +195,7 @@ void create_edge_filter_avs2(int w, int h, int ***edge_filter)
     }
 }
 
-void clear_edge_filter_avs2(int x, int y, int w, int h, int ***edge_filter)
+void clear_edge_filter_avs2(int x, int y, int w, int h, COM_EDGE_FILTER edge_filter)
 {
     for (int i = 0; i < LOOPFILTER_DIR_TYPE; i++)
     {
@@ -145,7 +209,7 @@ void clear_edge_filter_avs2(int x, int y, int w, int h, int ***edge_filter)
     }
 }
 
-void delete_edge_filter_avs2(int ***edge_filter, int h)
+void delete_edge_filter_avs2(COM_EDGE_FILTER edge_filter, int h)
 {
     for (int i = 0; i < LOOPFILTER_DIR_TYPE; i++)
     {
@@ -166,7 +230,9 @@ void delete_edge_filter_avs2(int ***edge_filter, int h)
     }
 }
 
-void set_edge_filter_param_hor_avs2(COM_PIC * pic, int ***edge_filter, int x_pel, int y_pel, int cuw, int cuh, int edge_condition)
+#endif
+
+void set_edge_filter_param_hor_avs2(COM_PIC * pic, COM_EDGE_FILTER edge_filter, int x_pel, int y_pel, int cuw, int cuh, int edge_condition)
 {
     int w = cuw >> LOOPFILTER_SIZE_IN_BIT;
     int b4_x_start = x_pel >> LOOPFILTER_SIZE_IN_BIT;
@@ -182,11 +248,19 @@ void set_edge_filter_param_hor_avs2(COM_PIC * pic, int ***edge_filter, int x_pel
         {
             if ((int)(b4_x_start + i) < ((pic->width_luma) >> LOOPFILTER_SIZE_IN_BIT)&& (int)(b4_y_start) < ((pic->height_luma) >> LOOPFILTER_SIZE_IN_BIT))
             {
+#if DBK_EDGE_BITMAP
+                if (EDGE_MAP_GET(edge_filter, dir, b4_y_start, b4_x_start + i))
+                {
+                    break;
+                }
+                EDGE_MAP_SET(edge_filter, dir, b4_y_start, b4_x_start + i, edge_condition);
+#else
                 if (edge_filter[dir][b4_y_start][b4_x_start + i])
                 {
                     break;
                 }
                 edge_filter[dir][b4_y_start][b4_x_start + i] = edge_condition;
+#endif
             }
             else
             {
@@ -196,7 +270,7 @@ void set_edge_filter_param_hor_avs2(COM_PIC * pic, int ***edge_filter, int x_pel
     }
 }
 
-void set_edge_filter_param_ver_avs2(COM_PIC * pic, int ***edge_filter, int x_pel, int y_pel, int cuw, int cuh, int edge_condition)
+void set_edge_filter_param_ver_avs2(COM_PIC * pic, COM_EDGE_FILTER edge_filter, int x_pel, int y_pel, int cuw, int cuh, int edge_condition)
 {
     int h = cuh >> LOOPFILTER_SIZE_IN_BIT;
     int b4_x_start = x_pel >> LOOPFILTER_SIZE_IN_BIT;
@@ -213,11 +287,19 @@ void set_edge_filter_param_ver_avs2(COM_PIC * pic, int ***edge_filter, int x_pel
         {
             if ((int)(b4_y_start + i) < (pic->height_luma >> LOOPFILTER_SIZE_IN_BIT))
             {
+#if DBK_EDGE_BITMAP
+                if (EDGE_MAP_GET(edge_filter, dir, b4_y_start + i, b4_x_start))
+                {
+                    break;
+                }
+                EDGE_MAP_SET(edge_filter, dir, b4_y_start + i, b4_x_start, edge_condition);
+#else
                 if (edge_filter[dir][b4_y_start + i][b4_x_start])
                 {
                     break;
                 }
                 edge_filter[dir][b4_y_start + i][b4_x_start] = edge_condition;
+#endif
             }
             else
             {
@@ -227,7 +309,7 @@ void set_edge_filter_param_ver_avs2(COM_PIC * pic, int ***edge_filter, int x_pel
     }
 }
 
-void set_edge_filter_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, int*** edge_filter)
+void set_edge_filter_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_EDGE_FILTER edge_filter)
 {
     int i, j;
     BOOL b_recurse = 1;
@@ -243,7 +325,7 @@ void set_edge_filter_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, int*** ed
     }
 }
 
-void set_edge_filter_one_scu_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, int ***edge_filter, int x, int y, int cuw, int cuh, int cud, int cup, BOOL b_recurse)
+void set_edge_filter_one_scu_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_EDGE_FILTER edge_filter, int x, int y, int cuw, int cuh, int cud, int cup, BOOL b_recurse)
 {
     s8 split_mode = NO_SPLIT;
     int lcu_idx;
@@ -348,6 +430,13 @@ int check_skip_filtering(COM_INFO *info, COM_MAP *map, COM_REFP refp[MAX_NUM_REF
     {
         return 0;
     }
+#if DBK_EDGE_BITMAP
+    /* both sides of most edges inside a prediction unit carry the same motion */
+    if (!memcmp(refiP, refiQ, sizeof(s8) * REFP_NUM) && !memcmp(mvP, mvQ, sizeof(s16) * REFP_NUM * MV_D))
+    {
+        return 1;
+    }
+#endif
 
     if (p_pic0 == q_pic0 && p_pic1 == q_pic1)
     {
@@ -836,7 +925,7 @@ void edge_loop_x(COM_INFO *info, COM_MAP *map, COM_REFP refp[MAX_NUM_REF_PICS][R
     }
 }
 
-void deblock_mb_avs2(COM_INFO *info, COM_MAP *map, COM_PIC *pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], int*** edge_filter, int mb_y, int mb_x, int edge_dir
+void deblock_mb_avs2(COM_INFO *info, COM_MAP *map, COM_PIC *pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter, int mb_y, int mb_x, int edge_dir
 #if DBR
     , COM_PIC *pic_org, int enc, DBR_PARAM *dbr_param
 #endif
@@ -924,8 +1013,12 @@ void deblock_mb_avs2(COM_INFO *info, COM_MAP *map, COM_PIC *pic, COM_REFP refp[M
 #endif
         b4_x_start = mb_x;
         b4_y_start = mb_y;
+#if DBK_EDGE_BITMAP
+        edge_condition = edge_condition ? EDGE_MAP_GET(edge_filter, dir, b4_y_start, b4_x_start) : 0;
+#else
         edge_condition = (edge_filter[dir][b4_y_start][b4_x_start] &&
                          edge_condition) ? edge_filter[dir][b4_y_start][b4_x_start] : 0;
+#endif
         // then  4 horizontal
         if (edge_condition)
         {
@@ -1006,7 +1099,7 @@ void deblock_mb_avs2(COM_INFO *info, COM_MAP *map, COM_PIC *pic, COM_REFP refp[M
 }
 
 //deblock one CU
-void deblock_block_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], int*** edge_filter, int pel_x, int pel_y, int cuw, int cuh )
+void deblock_block_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter, int pel_x, int pel_y, int cuw, int cuh )
 {
 #if DBR
     DBR_PARAM dbr_param = info->pic_header.ph_dbr_param;
@@ -1046,8 +1139,80 @@ void deblock_block_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP re
 
 int printf_flag = 0;
 
+#if LF_ROW_PARALLEL
+typedef struct _DBK_JOB
+{
+    COM_INFO            *info;
+    COM_MAP             *map;
+    COM_PIC             *pic;
+    COM_REFP           (*refp)[REFP_NUM];
+    COM_EDGE_FILTER      edge_filter;
+    COM_THREAD_PROGRESS *ver_done;       /* LCU rows whose vertical edges are filtered */
+    int                  mb_y_start;     /* mb rows of the LCU row for the per-LCU jobs */
+    int                  mb_y_end;
+    int                  dir;            /* edge direction of the per-LCU jobs */
+} DBK_JOB;
+
+//filter the edges of one direction in the mb area [mb_x_start, mb_x_end) x [mb_y_start, mb_y_end)
+static void deblock_mb_area(DBK_JOB *job, int mb_y_start, int mb_y_end, int mb_x_start, int mb_x_end, int dir)
+{
+    int mb_x, mb_y;
+#if DBR
+    DBR_PARAM dbr_param = job->info->pic_header.ph_dbr_param;
+#endif
+
+    for (mb_y = mb_y_start; mb_y < mb_y_end; mb_y++)
+    {
+        for (mb_x = mb_x_start; mb_x < mb_x_end; mb_x++)
+        {
+            deblock_mb_avs2(job->info, job->map, job->pic, job->refp, job->edge_filter, mb_y, mb_x, dir
+#if DBR
+                , NULL, 0, &dbr_param
+#endif
+#if RDO_DBK_LUMA_ONLY
+                , 0
+#endif
+            );
+        }
+    }
+}
+
+//one LCU row of the frame wavefront: vertical edges of the row, then horizontal edges once the vertical
+//edges of the row above are done. A horizontal edge modifies at most 3 lines and reads 4 lines on each side,
+//so the rows above and below can be filtered concurrently in either direction
+static void deblock_row_job(void *arg, int lcu_y)
+{
+    DBK_JOB *job = (DBK_JOB *)arg;
+    int mb_w = job->pic->width_luma >> LOOPFILTER_SIZE_IN_BIT;
+    int mb_y_start = (lcu_y << job->info->log2_max_cuwh) >> LOOPFILTER_SIZE_IN_BIT;
+    int mb_y_end = min(((lcu_y + 1) << job->info->log2_max_cuwh) >> LOOPFILTER_SIZE_IN_BIT, job->pic->height_luma >> LOOPFILTER_SIZE_IN_BIT);
+
+    deblock_mb_area(job, mb_y_start, mb_y_end, 0, mb_w, 0);
+    com_thread_progress_set(job->ver_done, lcu_y);
+    if (lcu_y > 0)
+    {
+        com_thread_progress_wait(job->ver_done, lcu_y - 1);
+    }
+    deblock_mb_area(job, mb_y_start, mb_y_end, 0, mb_w, 1);
+}
+
+//one LCU of an LCU row; a vertical edge modifies at most 3 columns and reads 4 columns on each side
+static void deblock_lcu_job(void *arg, int lcu_x)
+{
+    DBK_JOB *job = (DBK_JOB *)arg;
+    int mb_x_start = (lcu_x << job->info->log2_max_cuwh) >> LOOPFILTER_SIZE_IN_BIT;
+    int mb_x_end = min(((lcu_x + 1) << job->info->log2_max_cuwh) >> LOOPFILTER_SIZE_IN_BIT, job->pic->width_luma >> LOOPFILTER_SIZE_IN_BIT);
+
+    deblock_mb_area(job, job->mb_y_start, job->mb_y_end, mb_x_start, mb_x_end, job->dir);
+}
+#endif
+
 //deblock one frame
-void deblock_frame_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], int*** edge_filter)
+void deblock_frame_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
 {
     int mb_x, mb_y;
     int blk_nr = -1;
@@ -1057,6 +1222,25 @@ void deblock_frame_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP re
 
     printf_flag = 1;
 
+#if LF_ROW_PARALLEL
+    if (com_thread_pool_size(pool) > 1 && info->pic_height_in_lcu > 1)
+    {
+        DBK_JOB job;
+        job.info = info;
+        job.map = map;
+        job.pic = pic;
+        job.refp = refp;
+        job.edge_filter = edge_filter;
+        job.ver_done = com_thread_progress_create(info->pic_height_in_lcu);
+        if (job.ver_done != NULL)
+        {
+            com_thread_pool_run(pool, deblock_row_job, &job, info->pic_height_in_lcu);
+            com_thread_progress_delete(job.ver_done);
+            printf_flag = 0;
+            return;
+        }
+    }
+#endif
     for (mb_y = 0; mb_y < (pic->height_luma >> LOOPFILTER_SIZE_IN_BIT); mb_y++)
     {
         for (mb_x = 0; mb_x < (pic->width_luma >> LOOPFILTER_SIZE_IN_BIT); mb_x++)
@@ -1091,4 +1275,73 @@ void deblock_frame_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP re
         }
     }
     printf_flag = 0;
-}
\ No newline at end of file
+}
+
+#if LF_CTU_PIPELINE
+//deblock one LCU row: vertical then horizontal edges of the row. Horizontal edges on the top
+//LCU boundary modify the last lines of the row above, so rows have to be filtered in raster order
+void deblock_lcu_row_avs2(COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
+{
+    int mb_x, mb_y;
+    int mb_y_start = (lcu_y << info->log2_max_cuwh) >> LOOPFILTER_SIZE_IN_BIT;
+    int mb_y_end = min(((lcu_y + 1) << info->log2_max_cuwh) >> LOOPFILTER_SIZE_IN_BIT, pic->height_luma >> LOOPFILTER_SIZE_IN_BIT);
+#if DBR
+    DBR_PARAM dbr_param = info->pic_header.ph_dbr_param;
+#endif
+
+#if LF_ROW_PARALLEL
+    if (com_thread_pool_size(pool) > 1)
+    {
+        //the horizontal edges of an LCU read columns changed by the vertical edges of its right neighbour
+        DBK_JOB job;
+        job.info = info;
+        job.map = map;
+        job.pic = pic;
+        job.refp = refp;
+        job.edge_filter = edge_filter;
+        job.ver_done = NULL;
+        job.mb_y_start = mb_y_start;
+        job.mb_y_end = mb_y_end;
+        job.dir = 0;
+        com_thread_pool_run(pool, deblock_lcu_job, &job, info->pic_width_in_lcu);
+        job.dir = 1;
+        com_thread_pool_run(pool, deblock_lcu_job, &job, info->pic_width_in_lcu);
+        return;
+    }
+#endif
+    for (mb_y = mb_y_start; mb_y < mb_y_end; mb_y++)
+    {
+        for (mb_x = 0; mb_x < (pic->width_luma >> LOOPFILTER_SIZE_IN_BIT); mb_x++)
+        {
+            //vertical
+            deblock_mb_avs2(info, map, pic, refp, edge_filter, mb_y, mb_x, 0
+#if DBR
+                , NULL, 0, &dbr_param
+#endif
+#if RDO_DBK_LUMA_ONLY
+                , 0
+#endif
+            );
+        }
+    }
+    for (mb_y = mb_y_start; mb_y < mb_y_end; mb_y++)
+    {
+        for (mb_x = 0; mb_x < (pic->width_luma >> LOOPFILTER_SIZE_IN_BIT); mb_x++)
+        {
+            //horizontal
+            deblock_mb_avs2(info, map, pic, refp, edge_filter, mb_y, mb_x, 1
+#if DBR
+                , NULL, 0, &dbr_param
+#endif
+#if RDO_DBK_LUMA_ONLY
+                , 0
+#endif
+            );
+        }
+    }
+}
+#endif
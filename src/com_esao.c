@@ -136,13 +136,13 @@ void esao_on_block_for_luma_avx(pel* p_dst, int i_dst, pel * p_src, int  i_src,
                 t10 = _mm256_mullo_epi16(t10, c3);
                 etype = _mm256_add_epi16(t10, etype);
 
-                s16 *p_type = (s16*)&etype;
-                s16 *t = (s16*)&t0;
+                s16 p_type[16], t[16];
+                _mm256_storeu_si256((__m256i *)p_type, etype);
                 for (z = 0; z < 16; z++)
                 {
                     t[z] = esao_offset[p_type[z]];
                 }
-                t0 = _mm256_loadu_si256((__m256i *)&(t[0]));
+                t0 = _mm256_loadu_si256((__m256i *)t);
                 t0 = _mm256_add_epi16(t0, s1);
                 t0 = _mm256_min_epi16(t0, max_val);
                 t0 = _mm256_max_epi16(t0, min_val);
@@ -217,13 +217,13 @@ void esao_on_block_for_luma_avx(pel* p_dst, int i_dst, pel * p_src, int  i_src,
                 t10 = _mm256_mullo_epi16(t10, c3);
                 etype = _mm256_add_epi16(t10, etype);
 
-                s16 *p_type = (s16*)&etype;
-                s16 *t = (s16*)&t0;
+                s16 p_type[16], t[16];
+                _mm256_storeu_si256((__m256i *)p_type, etype);
                 for (z = 0; z < 16; z++)
                 {
                     t[z] = esao_offset[p_type[z]];
                 }
-                t0 = _mm256_loadu_si256((__m256i *)&(t[0]));
+                t0 = _mm256_loadu_si256((__m256i *)t);
                 t0 = _mm256_add_epi16(t0, s1);
                 t0 = _mm256_min_epi16(t0, max_val);
                 t0 = _mm256_max_epi16(t0, min_val);
@@ -349,13 +349,13 @@ void esao_on_block_for_luma_sse(pel* p_dst, int i_dst, pel * p_src, int i_src, i
                 t10 = _mm_mullo_epi16(t10, c3);
                 etype = _mm_add_epi16(t10, etype);
 
-                s16 *p_type = (s16*)&etype;
-                s16 *t = (s16*)&t0;
+                s16 p_type[8], t[8];
+                _mm_storeu_si128((__m128i *)p_type, etype);
                 for (z = 0; z < 8; z++)
                 {
                     t[z] = esao_offset[p_type[z]];
                 }
-                t0 = _mm_loadu_si128((__m128i *)&t[0]);
+                t0 = _mm_loadu_si128((__m128i *)t);
                 t0 = _mm_add_epi16(t0, s1);
                 t0 = _mm_min_epi16(t0, max_val);
                 t0 = _mm_max_epi16(t0, min_val);
@@ -415,13 +415,13 @@ void esao_on_block_for_luma_sse(pel* p_dst, int i_dst, pel * p_src, int i_src, i
                 t10 = _mm_srli_epi16(t10, shift_bo);
                 t10 = _mm_mullo_epi16(t10, c3);
                 etype = _mm_add_epi16(t10, etype);
-                s16 *p_type = (s16*)&etype;
-                s16 *t = (s16*)&t0;
+                s16 p_type[8], t[8];
+                _mm_storeu_si128((__m128i *)p_type, etype);
                 for (z = 0; z < 8; z++)
                 {
                     t[z] = esao_offset[p_type[z]];
                 }
-                t0 = _mm_loadu_si128((__m128i *)&(t[0]));
+                t0 = _mm_loadu_si128((__m128i *)t);
                 t0 = _mm_add_epi16(t0, s1);
                 t0 = _mm_min_epi16(t0, max_val);
                 t0 = _mm_max_epi16(t0, min_val);
@@ -613,13 +613,13 @@ void esao_on_block_for_chroma_avx(pel * p_dst, int i_dst, pel * p_src, int i_src
             s1 = _mm256_loadu_si256((__m256i *)&p_src[x]);
             src0 = _mm256_mullo_epi16(s1, c1);
             src1 = _mm256_srli_epi16(src0, shift_bo);
-            s16 *p_type = (s16*)&src1;
-            s16 *t = (s16*)&t0;
+            s16 p_type[16], t[16];
+            _mm256_storeu_si256((__m256i *)p_type, src1);
             for (z = 0; z < 16; z++)
             {
                 t[z] = esao_offset[p_type[z]];
             }
-            t0 = _mm256_loadu_si256((__m256i *)&(t[0]));
+            t0 = _mm256_loadu_si256((__m256i *)t);
             t0 = _mm256_add_epi16(t0, s1);
             t0 = _mm256_min_epi16(t0, max_val);
             t0 = _mm256_max_epi16(t0, min_val);
@@ -671,12 +671,13 @@ void esao_on_block_for_chroma_sse(pel * p_dst, int i_dst, pel * p_src, int i_src
             s1 = _mm_loadu_si128((__m128i *)&p_src[x]);
             src0 = _mm_mullo_epi16(s1, c1);
             src1 = _mm_srli_epi16(src0, shift_bo);
-            s16 *p_type = (s16*)&src1;
-            s16 *t = (s16*)&t0;
+            s16 p_type[8], t[8];
+            _mm_storeu_si128((__m128i *)p_type, src1);
             for (z = 0; z < 8; z++)
             {
                 t[z] = esao_offset[p_type[z]];
             }
+            t0 = _mm_loadu_si128((__m128i *)t);
 
             t0 = _mm_add_epi16(t0, s1);
             t0 = _mm_min_epi16(t0, max_val);
@@ -1115,6 +1116,96 @@ void esao_on_block(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pi
 #endif
 }
 
+#if LF_CTU_PIPELINE
+#if LF_ROW_PARALLEL
+typedef struct _ESAO_JOB
+{
+    COM_INFO          *info;
+    COM_MAP           *map;
+    COM_PIC           *pic_rec;
+    COM_PIC           *pic_esao;
+    ESAO_BLK_PARAM    *rec_esao_params;
+    ESAO_FUNC_POINTER *func_esao_filter;
+    int                lcu_y;
+} ESAO_JOB;
+#endif
+
+static void esao_on_lcu(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_esao, ESAO_BLK_PARAM *rec_esao_params, ESAO_FUNC_POINTER *func_esao_filter, int lcu_y, int lcu_x)
+{
+    int input_MaxSizeInBit = info->log2_max_cuwh;
+    int pix_y = lcu_y << input_MaxSizeInBit;
+    int pix_x = lcu_x << input_MaxSizeInBit;
+    int lcu_pix_height = min(1 << (input_MaxSizeInBit), (info->pic_height - pix_y));
+    int lcu_pix_width = min(1 << (input_MaxSizeInBit), (info->pic_width - pix_x));
+    int lcu_pos = lcu_x + lcu_y * info->pic_width_in_lcu;
+    esao_on_smb(info, map, pic_rec, pic_esao, func_esao_filter, pix_y, pix_x, lcu_pix_width, lcu_pix_height, rec_esao_params, info->bit_depth_internal, lcu_pos);
+}
+
+#if LF_ROW_PARALLEL
+static void esao_lcu_job(void *arg, int lcu_x)
+{
+    ESAO_JOB *job = (ESAO_JOB *)arg;
+    esao_on_lcu(job->info, job->map, job->pic_rec, job->pic_esao, job->rec_esao_params, job->func_esao_filter, job->lcu_y, lcu_x);
+}
+#endif
+
+void esao_on_lcu_row(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_esao, ESAO_BLK_PARAM *rec_esao_params, ESAO_FUNC_POINTER *func_esao_filter, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
+{
+#if LF_ROW_PARALLEL
+    if (com_thread_pool_size(pool) > 1)
+    {
+        ESAO_JOB job = { info, map, pic_rec, pic_esao, rec_esao_params, func_esao_filter, lcu_y };
+        com_thread_pool_run(pool, esao_lcu_job, &job, info->pic_width_in_lcu);
+        return;
+    }
+#endif
+    for (int lcu_x = 0; lcu_x < info->pic_width_in_lcu; lcu_x++)
+    {
+        esao_on_lcu(info, map, pic_rec, pic_esao, rec_esao_params, func_esao_filter, lcu_y, lcu_x);
+    }
+}
+
+#if LF_ROW_PARALLEL
+static void esao_row_job(void *arg, int lcu_y)
+{
+    ESAO_JOB *job = (ESAO_JOB *)arg;
+    esao_on_lcu_row(job->info, job->map, job->pic_rec, job->pic_esao, job->rec_esao_params, job->func_esao_filter, lcu_y, NULL);
+}
+#endif
+
+void esao_on_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_esao, ESAO_BLK_PARAM *rec_esao_params, ESAO_FUNC_POINTER *func_esao_filter
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
+{
+    if ((info->pic_header.pic_esao_on[Y_C] == 0) && (info->pic_header.pic_esao_on[U_C] == 0) && (info->pic_header.pic_esao_on[V_C] == 0))
+    {
+        return;
+    }
+    decide_esao_filter_func_pointer(func_esao_filter);
+#if LF_ROW_PARALLEL
+    if (com_thread_pool_size(pool) > 1)
+    {
+        ESAO_JOB job = { info, map, pic_rec, pic_esao, rec_esao_params, func_esao_filter, 0 };
+        com_thread_pool_run(pool, esao_row_job, &job, info->pic_height_in_lcu);
+        return;
+    }
+#endif
+    for (int lcu_y = 0; lcu_y < info->pic_height_in_lcu; lcu_y++)
+    {
+        esao_on_lcu_row(info, map, pic_rec, pic_esao, rec_esao_params, func_esao_filter, lcu_y
+#if LF_ROW_PARALLEL
+            , NULL
+#endif
+        );
+    }
+}
+#else
 void esao_on_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_esao, ESAO_BLK_PARAM *rec_esao_params, ESAO_FUNC_POINTER *func_esao_filter)
 {
     if ((info->pic_header.pic_esao_on[Y_C] == 0) && (info->pic_header.pic_esao_on[U_C] == 0) && (info->pic_header.pic_esao_on[V_C] == 0))
@@ -1142,6 +1233,7 @@ void esao_on_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pi
     }
 }
 #endif
+#endif
 
 #if ESAO || CCSAO
 static BOOL is_same_patch(s8* map_patch_idx, int mb_nr1, int mb_nr2)
@@ -1555,10 +1647,13 @@ void ccsao_on_block(COM_INFO *info, COM_PIC *pic_rec,
 
 #if ECCSAO
     int class_type = info->pic_header.ccsao_class_type[comp][set];
+    // select the filter locally, blocks of different sets may be filtered concurrently
+    CCSAO_FUNC_POINTER blk_func = *ccsao_func_ptr;
     if (class_type == 0)
-        ccsao_func_ptr->ccsao_on_block_for_chroma = ccsao_on_block_for_chroma;
+        blk_func.ccsao_on_block_for_chroma = ccsao_on_block_for_chroma;
     else
-        ccsao_func_ptr->ccsao_on_block_for_chroma = ccsao_on_block_for_chroma_edge;
+        blk_func.ccsao_on_block_for_chroma = ccsao_on_block_for_chroma_edge;
+    ccsao_func_ptr = &blk_func;
 #endif
 
     assert(set      >= 0 && set      <  CCSAO_SET_NUM);
@@ -1605,6 +1700,130 @@ void ccsao_on_block(COM_INFO *info, COM_PIC *pic_rec,
         lcu_available_left, lcu_available_right, lcu_available_up, lcu_available_down, lcu_available_upleft, lcu_available_upright, lcu_available_leftdown, lcu_available_rightdwon);
 }
 
+#if LF_CTU_PIPELINE
+#if LF_ROW_PARALLEL
+typedef struct _CCSAO_JOB
+{
+    COM_INFO           *info;
+    COM_MAP            *map;
+    COM_PIC            *pic_rec;
+#if CCSAO_ENHANCEMENT
+    COM_PIC           **pic_ccsao;
+#else
+    COM_PIC            *pic_ccsao;
+#endif
+    CCSAO_BLK_PARAM    *ccsao_param;
+    CCSAO_FUNC_POINTER *ccsao_func_ptr;
+    int                 lcu_y;
+} CCSAO_JOB;
+#endif
+
+static void ccsao_on_lcu(COM_INFO *info, COM_MAP *map, COM_PIC *pic_rec,
+#if CCSAO_ENHANCEMENT
+    COM_PIC *pic_ccsao[2],
+#else
+    COM_PIC *pic_ccsao,
+#endif
+    CCSAO_BLK_PARAM *ccsao_param, CCSAO_FUNC_POINTER *ccsao_func_ptr, int lcu_y, int lcu_x)
+{
+    int log2_max_cuwh_c = info->log2_max_cuwh - 1;
+    int y_c             = lcu_y << log2_max_cuwh_c;
+    int x_c             = lcu_x << log2_max_cuwh_c;
+    int lcu_height_c    = min(1 << log2_max_cuwh_c, (info->pic_height >> 1) - y_c);
+    int lcu_width_c     = min(1 << log2_max_cuwh_c, (info->pic_width  >> 1) - x_c);
+    int lcu_pos         = lcu_x + lcu_y * info->pic_width_in_lcu;
+
+    for (int comp = U_C-1; comp < N_C-1; comp++)
+    {
+        int is_left_avail, is_right_avail, is_above_avail, is_below_avail, is_above_left_avail, is_above_right_avail, is_below_left_avail, is_below_right_avail;
+
+        if (!info->pic_header.pic_ccsao_on[comp] || !ccsao_param[comp].lcu_flag[lcu_pos])
+        {
+            continue;
+        }
+
+        // reuse ESAO U V boundary check
+        check_boundary_available_for_esao(info, map, y_c, x_c, lcu_height_c, lcu_width_c, comp+1,
+            &is_left_avail, &is_right_avail, &is_above_avail, &is_below_avail, &is_above_left_avail, &is_above_right_avail, &is_below_left_avail, &is_below_right_avail, 1);
+        ccsao_on_block(info, pic_rec, pic_ccsao, ccsao_param, ccsao_func_ptr, comp, x_c, y_c, lcu_width_c, lcu_height_c, info->bit_depth_internal, lcu_pos,
+            is_left_avail, is_right_avail, is_above_avail, is_below_avail, is_above_left_avail, is_above_right_avail, is_below_left_avail, is_below_right_avail);
+    }
+}
+
+#if LF_ROW_PARALLEL
+static void ccsao_lcu_job(void *arg, int lcu_x)
+{
+    CCSAO_JOB *job = (CCSAO_JOB *)arg;
+    ccsao_on_lcu(job->info, job->map, job->pic_rec, job->pic_ccsao, job->ccsao_param, job->ccsao_func_ptr, job->lcu_y, lcu_x);
+}
+#endif
+
+void ccsao_on_lcu_row(COM_INFO *info, COM_MAP *map, COM_PIC *pic_rec,
+#if CCSAO_ENHANCEMENT
+    COM_PIC *pic_ccsao[2],
+#else
+    COM_PIC *pic_ccsao,
+#endif
+    CCSAO_BLK_PARAM *ccsao_param, CCSAO_FUNC_POINTER *ccsao_func_ptr, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
+{
+#if LF_ROW_PARALLEL
+    if (com_thread_pool_size(pool) > 1)
+    {
+        CCSAO_JOB job = { info, map, pic_rec, pic_ccsao, ccsao_param, ccsao_func_ptr, lcu_y };
+        com_thread_pool_run(pool, ccsao_lcu_job, &job, info->pic_width_in_lcu);
+        return;
+    }
+#endif
+    for (int lcu_x = 0; lcu_x < info->pic_width_in_lcu; lcu_x++)
+    {
+        ccsao_on_lcu(info, map, pic_rec, pic_ccsao, ccsao_param, ccsao_func_ptr, lcu_y, lcu_x);
+    }
+}
+
+#if LF_ROW_PARALLEL
+static void ccsao_row_job(void *arg, int lcu_y)
+{
+    CCSAO_JOB *job = (CCSAO_JOB *)arg;
+    ccsao_on_lcu_row(job->info, job->map, job->pic_rec, job->pic_ccsao, job->ccsao_param, job->ccsao_func_ptr, lcu_y, NULL);
+}
+#endif
+
+void ccsao_on_frame(COM_INFO *info, COM_MAP *map, COM_PIC *pic_rec,
+#if CCSAO_ENHANCEMENT
+    COM_PIC *pic_ccsao[2],
+#else
+    COM_PIC *pic_ccsao,
+#endif
+    CCSAO_BLK_PARAM *ccsao_param, CCSAO_FUNC_POINTER *ccsao_func_ptr
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
+{
+    decide_ccsao_func_pointer(ccsao_func_ptr);
+
+#if LF_ROW_PARALLEL
+    if (com_thread_pool_size(pool) > 1)
+    {
+        CCSAO_JOB job = { info, map, pic_rec, pic_ccsao, ccsao_param, ccsao_func_ptr, 0 };
+        com_thread_pool_run(pool, ccsao_row_job, &job, info->pic_height_in_lcu);
+        return;
+    }
+#endif
+    for (int lcu_y = 0; lcu_y < info->pic_height_in_lcu; lcu_y++)
+    {
+        ccsao_on_lcu_row(info, map, pic_rec, pic_ccsao, ccsao_param, ccsao_func_ptr, lcu_y
+#if LF_ROW_PARALLEL
+            , NULL
+#endif
+        );
+    }
+}
+#else
 void ccsao_on_frame(COM_INFO *info, COM_MAP *map, COM_PIC *pic_rec,
 #if CCSAO_ENHANCEMENT
     COM_PIC *pic_ccsao[2],
@@ -1654,3 +1873,4 @@ void ccsao_on_frame(COM_INFO *info, COM_MAP *map, COM_PIC *pic_rec,
     }
 }
 #endif
+#endif
@@ -31,8 +31,42 @@
 * ====================================================================================================================
 */
 
+#define _DEFAULT_SOURCE /* madvise(), MADV_HUGEPAGE and posix_memalign() under -std=c99 */
 #include "com_typedef.h"
 #include "com_img.h"
+#if PIC_BUF_HUGE_PAGE && defined(LINUX)
+#include <sys/mman.h>
+#endif
+
+#if !defined(WIN32) && !defined(WIN64)
+void * com_malloc_align(size_t size, size_t align)
+{
+    void * m;
+    return posix_memalign(&m, align, size) ? NULL : m;
+}
+#endif
+
+#if PIC_BUF_POOL
+#define IMGB_ALIGN                 64        /* alignment of plane buffers, plane origins and strides in bytes */
+#define IMGB_HUGE_PAGE             (2 << 20)
+
+static void * imgb_buf_alloc(int size)
+{
+#if PIC_BUF_HUGE_PAGE && defined(LINUX) && defined(MADV_HUGEPAGE)
+    if(size >= IMGB_HUGE_PAGE)
+    {
+        void * buf = com_malloc_align(COM_ALIGN(size, IMGB_HUGE_PAGE), IMGB_HUGE_PAGE);
+        if(buf)
+        {
+            /* only a hint, the kernel may ignore it */
+            madvise(buf, COM_ALIGN(size, IMGB_HUGE_PAGE), MADV_HUGEPAGE);
+        }
+        return buf;
+    }
+#endif
+    return com_malloc_align(size, IMGB_ALIGN);
+}
+#endif
 
 static void imgb_delete(COM_IMGB * imgb)
 {
@@ -40,7 +74,11 @@ static void imgb_delete(COM_IMGB * imgb)
     com_assert_r(imgb);
     for(i=0; i<COM_IMGB_MAX_PLANE; i++)
     {
+#if PIC_BUF_POOL
+        com_mfree_align(imgb->buf_addr[i]);
+#else
         if (imgb->buf_addr[i]) com_mfree(imgb->buf_addr[i]);
+#endif
     }
     com_mfree(imgb);
 }
@@ -89,9 +127,17 @@ COM_IMGB * com_imgb_create(int width, int height, int cs, int pad[COM_IMGB_MAX_P
             imgb->width_aligned[i] = COM_ALIGN(width, a_size);
             imgb->height_aligned[i] = COM_ALIGN(height, a_size);
             imgb->pad_left[i] = imgb->pad_right[i]=imgb->pad_up[i]=imgb->pad_down[i]=p_size;
+#if PIC_BUF_POOL
+            /* widen the left padding and the stride so that every row starts on an IMGB_ALIGN boundary */
+            imgb->pad_left[i] = COM_ALIGN(p_size, IMGB_ALIGN / scale);
+            imgb->stride[i] = COM_ALIGN((imgb->width_aligned[i] + imgb->pad_left[i] + imgb->pad_right[i]) * scale, IMGB_ALIGN);
+            imgb->buf_size[i] = imgb->stride[i]*(imgb->height_aligned[i] + imgb->pad_up[i] + imgb->pad_down[i]);
+            imgb->buf_addr[i] = imgb_buf_alloc(imgb->buf_size[i]);
+#else
             imgb->stride[i] = (imgb->width_aligned[i] + imgb->pad_left[i] + imgb->pad_right[i]) * scale;
             imgb->buf_size[i] = imgb->stride[i]*(imgb->height_aligned[i] + imgb->pad_up[i] + imgb->pad_down[i]);
             imgb->buf_addr[i] = com_malloc(imgb->buf_size[i]);
+#endif
             imgb->addr_plane[i] = ((u8*)imgb->buf_addr[i]) + imgb->pad_up[i]*imgb->stride[i] + imgb->pad_left[i]* scale;
             if(i == 0)
             {
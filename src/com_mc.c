@@ -4003,7 +4003,13 @@ void com_mc_l_nn(s16 *ref, int gmv_x, int gmv_y, int s_ref, int s_pred, s16 *pre
 #if IF_LUMA12_CHROMA6
     const int offset = 5;
 #endif
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16 *buf = com_arena_alloc(scratch, sizeof(s16) * (MAX_CU_SIZE + MC_IBUF_PAD_L) * MAX_CU_SIZE);
+#else
     static s16 buf[(MAX_CU_SIZE + MC_IBUF_PAD_L)*MAX_CU_SIZE];
+#endif
     int        dx, dy;
 
     if (is_half_pel_filter)
@@ -4144,6 +4150,9 @@ void com_mc_l_nn(s16 *ref, int gmv_x, int gmv_y, int s_ref, int s_pred, s16 *pre
     }
 #endif
 #endif
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 
 #if INTER_TM
@@ -4316,7 +4325,13 @@ void com_mc_tm_l_nn(pel *ref, pel *pred, int s_ref, int s_pred, int init_gmv_x,
     const int tm_size = (SIMPLIFIED_MAX_TM_ITERATIONS >> 1) + 1;
     u16 offset = is_search ? 2 : 5;
     int w_buf = w + tm_size * 2 + (2*offset + 1), h_buf = h + tm_size * 2 + (2*offset + 1);
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    pel* img_pad = (pel*)com_arena_alloc(scratch, w_buf * h_buf * sizeof(pel));
+#else
     pel* img_pad = (pel*)malloc(w_buf * h_buf * sizeof(pel));
+#endif
     ref += ((init_gmv_y >> 2) - tm_size) * s_ref + ((init_gmv_x >> 2) - tm_size);
     tm_padding(img_pad, ref, s_ref, w_buf, h_buf, offset);
     int gmv_y_offset = (gmv_y - init_gmv_y) >> 2;
@@ -4324,7 +4339,11 @@ void com_mc_tm_l_nn(pel *ref, pel *pred, int s_ref, int s_pred, int init_gmv_x,
     pel* ref_buf = img_pad;
     ref_buf += (gmv_y_offset + tm_size) * w_buf + gmv_x_offset + tm_size;
 
+#if SCRATCH_ARENA
+    s16 *buf = com_arena_alloc(scratch, sizeof(s16) * (MAX_CU_SIZE + MC_IBUF_PAD_L) * MAX_CU_SIZE);
+#else
     static s16 buf[(MAX_CU_SIZE + MC_IBUF_PAD_L)*MAX_CU_SIZE];
+#endif
     int dx = gmv_x & 0x3;
     int dy = gmv_y & 0x3;
     const s16 *coeff_hor_12tap = tbl_mc_l_coeff_12tap[dx];
@@ -4406,7 +4425,11 @@ void com_mc_tm_l_nn(pel *ref, pel *pred, int s_ref, int s_pred, int init_gmv_x,
 
     }
 #endif
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#else
     free(img_pad);
+#endif
 }
 #endif
 
@@ -4756,9 +4779,21 @@ void com_mc_c_nn(s16 *ref, int gmv_x, int gmv_y, int s_ref, int s_pred, s16 *pre
         offset = 1;
     }
 #endif
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16         *buf = com_arena_alloc(scratch, sizeof(s16) * (MAX_CU_SIZE + MC_IBUF_PAD_C + 16) * (MAX_CU_SIZE + MC_IBUF_PAD_C + 16));
+#else
     static s16         buf[(MAX_CU_SIZE + MC_IBUF_PAD_C + 16)*(MAX_CU_SIZE + MC_IBUF_PAD_C + 16)];
+#endif
+#else
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16         *buf = com_arena_alloc(scratch, sizeof(s16) * (MAX_CU_SIZE + MC_IBUF_PAD_C) * MAX_CU_SIZE);
 #else
     static s16         buf[(MAX_CU_SIZE + MC_IBUF_PAD_C)*MAX_CU_SIZE];
+#endif
 #endif
     int         dx, dy;
 
@@ -4941,6 +4976,9 @@ void com_mc_c_nn(s16 *ref, int gmv_x, int gmv_y, int s_ref, int s_pred, s16 *pre
     }
 #endif
 #endif
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 
 COM_MC_L com_tbl_mc_l[2][2] =
@@ -4996,7 +5034,13 @@ static const s8 tbl_bio_grad_l_coeff[4][8] =
 
 static void com_grad_x_l_nn(s16* ref, int gmv_x, int gmv_y, int s_ref, int s_pred, s16* pred, int w, int h, int bit_depth, int is_dmvr)
 {
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16         *buf = com_arena_alloc(scratch, sizeof(s16) * (MAX_CU_SIZE + MC_IBUF_PAD_L) * MAX_CU_SIZE);
+#else
     static s16         buf[(MAX_CU_SIZE + MC_IBUF_PAD_L) * MAX_CU_SIZE];
+#endif
 #if IF_LUMA12_CHROMA6_SIMD
     int dx, dy;
 #else
@@ -5104,11 +5148,20 @@ static void com_grad_x_l_nn(s16* ref, int gmv_x, int gmv_y, int s_ref, int s_pre
         }
     }
 #endif
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 
 static void com_grad_y_l_nn(s16* ref, int gmv_x, int gmv_y, int s_ref, int s_pred, s16* pred, int w, int h, int bit_depth, int is_dmvr)
 {
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16         *buf = com_arena_alloc(scratch, sizeof(s16) * (MAX_CU_SIZE + MC_IBUF_PAD_L) * MAX_CU_SIZE);
+#else
     static s16         buf[(MAX_CU_SIZE + MC_IBUF_PAD_L) * MAX_CU_SIZE];
+#endif
 #if IF_LUMA12_CHROMA6_SIMD
     int dx, dy;
 #else
@@ -5214,6 +5267,9 @@ static void com_grad_y_l_nn(s16* ref, int gmv_x, int gmv_y, int s_ref, int s_pre
         }
     }
 #endif
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 
 void bio_vxvy(s16* vx, s16* vy, int wb, s32* s1, s32* s2, s32* s3, s32* s5, s32* s6, int avg_size)
@@ -5962,6 +6018,163 @@ static void asp_mv_rounding(s32* hor, s32* ver, s32* rounded_hor, s32* rounded_v
 }
 #endif // SIMD_ASP
 
+#if PADLESS_REF
+#define REF_WIN_MARGIN                     16 // luma samples added around a requested area: interpolation taps, BIO gradients, TM padding
+#define REF_WIN_SIZE                       (MAX_CU_SIZE + 128) // initial window size, grown when MC asks for a larger area
+
+/* border-clamped copy of the area of a reference picture that MC is about to read; one window is
+   live at a time per core, MC on pictures with padding never fills it */
+struct _COM_REF_WIN
+{
+    COM_PIC pic;
+    /* width and height of the luma buffer, the chroma buffers are half of it */
+    int     size;
+    pel    *y;
+    pel    *uv[2];
+    /* COM_ERR_OUT_OF_MEMORY once a request could not grow the buffers, see com_ref_win_status() */
+    int     err;
+};
+
+/* window of the core running on this thread, see com_ref_win_bind() */
+static COM_THREAD_LOCAL COM_REF_WIN *ref_win;
+
+static int ref_win_alloc(COM_REF_WIN *win, int size)
+{
+    /* the SIMD filters load whole vectors past the last sample of a row */
+    int size_l = (size * size + REF_WIN_MARGIN) * sizeof(pel);
+    int size_c = (((size + 1) >> 1) * ((size + 1) >> 1) + REF_WIN_MARGIN) * sizeof(pel);
+    /* the old buffers stay in place when the new ones cannot be allocated */
+    pel *y = (pel *)com_malloc_fast(size_l);
+    pel *u = (pel *)com_malloc_fast(size_c);
+    pel *v = (pel *)com_malloc_fast(size_c);
+    if (y == NULL || u == NULL || v == NULL)
+    {
+        com_mfree_fast(y);
+        com_mfree_fast(u);
+        com_mfree_fast(v);
+        return COM_ERR_OUT_OF_MEMORY;
+    }
+    com_mfree_fast(win->y);
+    com_mfree_fast(win->uv[0]);
+    com_mfree_fast(win->uv[1]);
+    win->y = y;
+    win->uv[0] = u;
+    win->uv[1] = v;
+    win->size = size;
+    return COM_OK;
+}
+
+COM_REF_WIN * com_ref_win_create()
+{
+    COM_REF_WIN *win = (COM_REF_WIN *)com_malloc_fast(sizeof(COM_REF_WIN));
+    com_assert_rv(win, NULL);
+    com_mset(win, 0, sizeof(COM_REF_WIN));
+    if (ref_win_alloc(win, REF_WIN_SIZE))
+    {
+        com_ref_win_delete(win);
+        return NULL;
+    }
+    return win;
+}
+
+void com_ref_win_delete(COM_REF_WIN *win)
+{
+    if (win == NULL)
+    {
+        return;
+    }
+    if (ref_win == win)
+    {
+        ref_win = NULL;
+    }
+    com_mfree_fast(win->y);
+    com_mfree_fast(win->uv[0]);
+    com_mfree_fast(win->uv[1]);
+    com_mfree_fast(win);
+}
+
+void com_ref_win_bind(COM_REF_WIN *win)
+{
+    ref_win = win;
+    if (win)
+    {
+        win->err = COM_OK;
+    }
+}
+
+int com_ref_win_status(COM_REF_WIN *win)
+{
+    return win ? win->err : COM_OK;
+}
+
+static void ref_win_fill(pel *dst, int s_dst, pel *src, int s_src, int width, int height, int x0, int y0, int w, int h)
+{
+    for (int j = 0; j < h; j++)
+    {
+        pel *s = src + COM_CLIP3(0, height - 1, y0 + j) * s_src;
+        pel *d = dst + j * s_dst;
+        int i = 0;
+        for (; i < w && x0 + i < 0; i++)
+        {
+            d[i] = s[0];
+        }
+        int n = COM_MIN(w, width - x0) - i;
+        if (n > 0)
+        {
+            com_mcpy(d + i, s + x0 + i, n * sizeof(pel));
+            i += n;
+        }
+        for (; i < w; i++)
+        {
+            d[i] = s[width - 1];
+        }
+    }
+}
+
+COM_PIC* com_ref_window(COM_PIC *pic, int x0, int y0, int x1, int y1)
+{
+    int pad = pic->padsize_luma;
+    x0 -= REF_WIN_MARGIN;
+    y0 -= REF_WIN_MARGIN;
+    x1 += REF_WIN_MARGIN;
+    y1 += REF_WIN_MARGIN;
+    if (x0 >= -pad && y0 >= -pad && x1 <= pic->width_luma + pad && y1 <= pic->height_luma + pad)
+    {
+        return pic;
+    }
+    COM_REF_WIN *win = ref_win;
+    com_assert(win != NULL);
+    /* +2: an odd x0 or y0 adds one chroma sample */
+    int span = COM_MAX(x1 - x0, y1 - y0) + 2;
+    if (span > win->size && ref_win_alloc(win, span) != COM_OK)
+    {
+        win->err = COM_ERR_OUT_OF_MEMORY;
+        return NULL;
+    }
+    int s_l = win->size, s_c = (win->size + 1) >> 1;
+    ref_win_fill(win->y, s_l, pic->y, pic->stride_luma, pic->width_luma, pic->height_luma, x0, y0, x1 - x0, y1 - y0);
+    int cx0 = x0 >> 1, cy0 = y0 >> 1;
+    int cw = ((x1 + 1) >> 1) - cx0, ch = ((y1 + 1) >> 1) - cy0;
+    ref_win_fill(win->uv[0], s_c, pic->u, pic->stride_chroma, pic->width_chroma, pic->height_chroma, cx0, cy0, cw, ch);
+    ref_win_fill(win->uv[1], s_c, pic->v, pic->stride_chroma, pic->width_chroma, pic->height_chroma, cx0, cy0, cw, ch);
+
+    win->pic = *pic;
+    win->pic.y = win->y - y0 * s_l - x0;
+    win->pic.u = win->uv[0] - cy0 * s_c - cx0;
+    win->pic.v = win->uv[1] - cy0 * s_c - cx0;
+    win->pic.stride_luma = s_l;
+    win->pic.stride_chroma = s_c;
+    return &win->pic;
+}
+
+/* window of a w x h block read at the fractional positions (gmv_x0, gmv_y0) and (gmv_x1, gmv_y1), in 1/(1 << shift) luma samples */
+static COM_PIC* ref_window_blk(COM_PIC *pic, int gmv_x0, int gmv_y0, int gmv_x1, int gmv_y1, int shift, int w, int h)
+{
+    return com_ref_window(pic, COM_MIN(gmv_x0, gmv_x1) >> shift, COM_MIN(gmv_y0, gmv_y1) >> shift,
+                          (COM_MAX(gmv_x0, gmv_x1) >> shift) + w + 1, (COM_MAX(gmv_y0, gmv_y1) >> shift) + h + 1);
+}
+#endif
+
 void mv_clip(int x, int y, int pic_w, int pic_h, int w, int h, s8 refi[REFP_NUM], s16 mv[REFP_NUM][MV_D], s16(*mv_t)[MV_D])
 {
     // Сֵ
@@ -6455,6 +6668,14 @@ static void prefetch_for_sub_pu_mc(
         qpel_gmv_y = (((y + y_sub) << 2) + mv_temp[i][MV_Y]);
 
         ref_pic = refp[refi[i]][i].pic; // ȡοͼ
+#if PADLESS_REF
+        ref_pic = com_ref_window(ref_pic, (qpel_gmv_x >> 2) - num_extra_pixel_left_for_filter, (qpel_gmv_y >> 2) - num_extra_pixel_left_for_filter,
+                                 (qpel_gmv_x >> 2) - num_extra_pixel_left_for_filter + w_sub + filter_size, (qpel_gmv_y >> 2) - num_extra_pixel_left_for_filter + h_sub + filter_size);
+        if (ref_pic == NULL)
+        {
+            return;
+        }
+#endif
         pel* ref = ref_pic->y + ((qpel_gmv_y >> 2) - num_extra_pixel_left_for_filter) * ref_pic->stride_luma +
             (qpel_gmv_x >> 2) - num_extra_pixel_left_for_filter; // ȷõַ
         pel* dst = dmvr_padding_buf[i][0] + offset; // Ŀ껺ĵַ
@@ -6606,8 +6827,15 @@ void process_DMVR( int x, int y, int pic_w, int pic_h, int w, int h, s8 refi[REF
 )
 {
     // 飬ڴ洢οͼƽ棨L0L1ӿ飨sub-PU˶ʸ
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16 (*sub_pu_L0)[MV_D] = com_arena_alloc(scratch, sizeof(s16) * ((MAX_CU_SIZE * MAX_CU_SIZE) >> (MIN_CU_LOG2 << 1)) * MV_D);
+    s16 (*sub_pu_L1)[MV_D] = com_arena_alloc(scratch, sizeof(s16) * ((MAX_CU_SIZE * MAX_CU_SIZE) >> (MIN_CU_LOG2 << 1)) * MV_D);
+#else
     s16 sub_pu_L0[(MAX_CU_SIZE * MAX_CU_SIZE) >> (MIN_CU_LOG2 << 1)][MV_D];
     s16 sub_pu_L1[(MAX_CU_SIZE * MAX_CU_SIZE) >> (MIN_CU_LOG2 << 1)][MV_D];
+#endif
 
     // һŲںʸż
     s16 ref_pred_mv_scaled_step = 2;
@@ -6802,6 +7030,9 @@ void process_DMVR( int x, int y, int pic_w, int pic_h, int w, int h, s8 refi[REF
             num++;
         }
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 #endif
 
@@ -6889,6 +7120,14 @@ static void prefetch_for_affine_mc(
         qpel_gmv_y = (y << 2) + mv_temp[i][0][MV_Y];
 
         ref_pic = refp[refi[i]][i].pic; // ȡοͼ
+#if PADLESS_REF
+        ref_pic = com_ref_window(ref_pic, (qpel_gmv_x >> 2) - num_extra_pixel_left_for_filter, (qpel_gmv_y >> 2) - num_extra_pixel_left_for_filter,
+                                 (qpel_gmv_x >> 2) - num_extra_pixel_left_for_filter + filter_size, (qpel_gmv_y >> 2) - num_extra_pixel_left_for_filter + filter_size);
+        if (ref_pic == NULL)
+        {
+            return;
+        }
+#endif
         pel* ref = ref_pic->y + ((qpel_gmv_y >> 2) - num_extra_pixel_left_for_filter) * ref_pic->stride_luma +
             (qpel_gmv_x >> 2) - num_extra_pixel_left_for_filter; // ȷõַ
         pel* dst = dmvr_padding_buf[i][0] + offset; // Ŀ껺ĵַ
@@ -7061,9 +7300,6 @@ void com_affine_dmvr_refine(
 
 void process_AFFINEDMVR(int x, int y, int pic_w, int pic_h, int w, int h, s8 refi[REFP_NUM], CPMV(*mv)[VER_NUM][MV_D], COM_REFP(*refp)[REFP_NUM], pel(*dmvr_padding_buf)[N_C][PAD_BUFFER_STRIDE * PAD_BUFFER_STRIDE])
 {
-    s16 sub_pu_L0[(MAX_CU_SIZE * MAX_CU_SIZE) >> (MIN_CU_LOG2 << 1)][MV_D];
-    s16 sub_pu_L1[(MAX_CU_SIZE * MAX_CU_SIZE) >> (MIN_CU_LOG2 << 1)][MV_D];
-
     // һ飬ڴ洢˶ʸ
     /*s16 refined_mv[REFP_NUM][1][MV_D] = {{mv[REFP_0][0][MV_X], mv[REFP_0][0][MV_Y]},
                                        { mv[REFP_1][0][MV_X], mv[REFP_1][0][MV_Y] }
@@ -7236,9 +7472,19 @@ void com_mc(int x, int y, int w, int h, int pred_stride, pel pred_buf[N_C][MAX_C
     s8 *refi = mod_info_curr->refi;
     s16 (*mv)[MV_D] = mod_info_curr->mv;
     COM_PIC *ref_pic;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    pel (*pred_snd)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+#else
     static pel pred_snd[N_C][MAX_CU_DIM];
+#endif
 #if BGC
+#if SCRATCH_ARENA
+    pel (*pred_uv)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * V_C * MAX_CU_DIM);
+#else
     static pel pred_uv[V_C][MAX_CU_DIM];
+#endif
     pel *dst_u, *dst_v;
     pel *pred_fir = info->pred_tmp;
     pel *p0, *p1, *dest0;
@@ -7311,6 +7557,20 @@ void com_mc(int x, int y, int w, int h, int pred_stride, pel pred_buf[N_C][MAX_C
         init_qpel_gmv_x = (x << 2) + mod_info_curr->init_mv[REFP_0][MV_X];
         init_qpel_gmv_y = (y << 2) + mod_info_curr->init_mv[REFP_0][MV_Y];
 #endif
+#if PADLESS_REF
+#if INTER_TM
+        if (mod_info_curr->tm_flag && info->sqh.tm_enable_flag == 2)
+        {
+            ref_pic = ref_window_blk(ref_pic, qpel_gmv_x, qpel_gmv_y, init_qpel_gmv_x, init_qpel_gmv_y, 2, w, h);
+        }
+        else
+#endif
+        ref_pic = ref_window_blk(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 2, w, h);
+        if (ref_pic == NULL)
+        {
+            return;
+        }
+#endif
 
         if (channel != CHANNEL_C)
         {
@@ -7425,6 +7685,9 @@ void com_mc(int x, int y, int w, int h, int pred_stride, pel pred_buf[N_C][MAX_C
         if( refp[refi[REFP_0]][REFP_0].pic->ptr == refp[refi[REFP_1]][REFP_1].pic->ptr && mv[REFP_0][MV_X] == mv[REFP_1][MV_X] && mv[REFP_0][MV_Y] == mv[REFP_1][MV_Y] )
 #endif
         {
+#if SCRATCH_ARENA
+            com_arena_release(scratch, scratch_mark);
+#endif
             return;
         }
     }
@@ -7443,6 +7706,20 @@ void com_mc(int x, int y, int w, int h, int pred_stride, pel pred_buf[N_C][MAX_C
         init_qpel_gmv_x = (x << 2) + mod_info_curr->init_mv[REFP_1][MV_X];
         init_qpel_gmv_y = (y << 2) + mod_info_curr->init_mv[REFP_1][MV_Y];
 #endif
+#if PADLESS_REF
+#if INTER_TM
+        if (mod_info_curr->tm_flag && info->sqh.tm_enable_flag == 2)
+        {
+            ref_pic = ref_window_blk(ref_pic, qpel_gmv_x, qpel_gmv_y, init_qpel_gmv_x, init_qpel_gmv_y, 2, w, h);
+        }
+        else
+#endif
+        ref_pic = ref_window_blk(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 2, w, h);
+        if (ref_pic == NULL)
+        {
+            return;
+        }
+#endif
 
         if (channel != CHANNEL_C)
         {
@@ -7710,6 +7987,9 @@ void com_mc(int x, int y, int w, int h, int pred_stride, pel pred_buf[N_C][MAX_C
 #endif
         }
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 #if OBMC_TEMP
 static s64 obmc_ssd_16b_up(int w, void *src1, void *src2, int bit_depth)
@@ -8081,6 +8361,13 @@ void com_subblk_obmc(int x, int y, int w, int h, int pred_stride, pel* pred_buf[
         ref_pic = refp[refi[REFP_0]][REFP_0].pic;
         qpel_gmv_x = (x << 2) + mv_t[REFP_0][MV_X];
         qpel_gmv_y = (y << 2) + mv_t[REFP_0][MV_Y];
+#if PADLESS_REF
+        ref_pic = ref_window_blk(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 2, w, h);
+        if (ref_pic == NULL)
+        {
+            return;
+        }
+#endif
 
         if (luma)
         {
@@ -8153,6 +8440,13 @@ void com_subblk_obmc(int x, int y, int w, int h, int pred_stride, pel* pred_buf[
         ref_pic = refp[refi[REFP_1]][REFP_1].pic;
         qpel_gmv_x = (x << 2) + mv_t[REFP_1][MV_X];
         qpel_gmv_y = (y << 2) + mv_t[REFP_1][MV_Y];
+#if PADLESS_REF
+        ref_pic = ref_window_blk(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 2, w, h);
+        if (ref_pic == NULL)
+        {
+            return;
+        }
+#endif
 
         if (luma)
         {
@@ -8307,6 +8601,13 @@ void com_get_obmc_temp_pred(int x, int y, int w, int h,  pel pred_buf[MAX_CU_SIZ
                 qpel_gmv_y = 0;
             int sw = w;
             int sh = 1;
+#if PADLESS_REF
+            ref_pic = com_ref_window(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x + sw, qpel_gmv_y + sh);
+            if (ref_pic == NULL)
+            {
+                return;
+            }
+#endif
             if (luma)
             {
                 com_mc_obmc_up(ref_pic->y, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_luma, pred, sw, bit_depth);
@@ -8321,6 +8622,13 @@ void com_get_obmc_temp_pred(int x, int y, int w, int h,  pel pred_buf[MAX_CU_SIZ
             qpel_gmv_y = y + (mv_t[REFP_0][MV_Y]>>2);
             int sw = 1;
             int sh = h;
+#if PADLESS_REF
+            ref_pic = com_ref_window(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x + sw, qpel_gmv_y + sh);
+            if (ref_pic == NULL)
+            {
+                return;
+            }
+#endif
             if (luma)
                 com_mc_obmc_left(ref_pic->y, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_luma, pred, sh, bit_depth);
         }
@@ -8361,6 +8669,13 @@ void com_get_obmc_temp_pred(int x, int y, int w, int h,  pel pred_buf[MAX_CU_SIZ
                 qpel_gmv_y = 0;
             int sw = w;
             int sh = 1;
+#if PADLESS_REF
+            ref_pic = com_ref_window(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x + sw, qpel_gmv_y + sh);
+            if (ref_pic == NULL)
+            {
+                return;
+            }
+#endif
             if (luma)
                 com_mc_obmc_up(ref_pic->y, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_luma, pred, sw, bit_depth);
         }
@@ -8372,6 +8687,13 @@ void com_get_obmc_temp_pred(int x, int y, int w, int h,  pel pred_buf[MAX_CU_SIZ
             qpel_gmv_y = y + (mv_t[REFP_1][MV_Y]>>2);
             int sw = 1;
             int sh = h;
+#if PADLESS_REF
+            ref_pic = com_ref_window(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x + sw, qpel_gmv_y + sh);
+            if (ref_pic == NULL)
+            {
+                return;
+            }
+#endif
             if (luma)
                 com_mc_obmc_left(ref_pic->y, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_luma, pred, sh, bit_depth);
         }
@@ -9208,7 +9530,11 @@ void com_derive_awp_weight(COM_MODE *mod_info_curr, int compIdx, pel weight0[N_C
 static inline u32 sort_awp_cost_list(u32* in, int inputValueArraySize, int* tbl, int outputIndexArraySize)
 {
     int numValidInList = 1;
+#if SCRATCH_ARENA
+    u32 sortedlist[56];
+#else
     static u32 sortedlist[56];
+#endif
     sortedlist[0] = in[0];
     tbl[0] = (int)0;
 
@@ -10068,7 +10394,13 @@ void com_mvap_mc(COM_INFO *info, COM_MODE *mod_info_curr, void *tmp_cu_mvfield,
     s32 w         = 0;
     s32 tmp_x     = x;
     s32 tmp_y     = y;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    pel (*pred_tmp)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+#else
     static pel pred_tmp[N_C][MAX_CU_DIM];
+#endif
     COM_MOTION *cu_mvfield = (COM_MOTION *)tmp_cu_mvfield;
     BOOL cur_apply_DMVR = dmvr->apply_DMVR;
 
@@ -10128,6 +10460,9 @@ void com_mvap_mc(COM_INFO *info, COM_MODE *mod_info_curr, void *tmp_cu_mvfield,
             }
         }
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 #endif
 #if SUB_TMVP
@@ -10150,7 +10485,13 @@ void com_sbTmvp_mc(COM_INFO *info, COM_MODE *mod_info_curr, s32 sub_blk_width, s
     s32 w = 0;
     s32 tmp_x = x;
     s32 tmp_y = y;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    pel (*pred_tmp)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+#else
     static pel pred_tmp[N_C][MAX_CU_DIM];
+#endif
     BOOL cur_apply_DMVR = dmvr->apply_DMVR;
     for (int k = 0; k<SBTMVP_NUM; k++)
     {
@@ -10204,6 +10545,9 @@ void com_sbTmvp_mc(COM_INFO *info, COM_MODE *mod_info_curr, s32 sub_blk_width, s
             }
         }
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 #endif
 #if ETMVP
@@ -10226,7 +10570,13 @@ void com_etmvp_mc(COM_INFO *info, COM_MODE *mod_info_curr, void *tmp_cu_mvfield,
     s32 w = 0;
     s32 tmp_x = x;
     s32 tmp_y = y;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    pel (*pred_tmp)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+#else
     static pel pred_tmp[N_C][MAX_CU_DIM];
+#endif
     COM_MOTION *cu_mvfield = (COM_MOTION *)tmp_cu_mvfield;
 
     for (h = 0; h < cu_height; h += sub_h)
@@ -10285,6 +10635,9 @@ void com_etmvp_mc(COM_INFO *info, COM_MODE *mod_info_curr, void *tmp_cu_mvfield,
             }
         }
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 #endif
 
@@ -10787,6 +11140,9 @@ void com_affine_mc_l(int x, int y, int pic_w, int pic_h, int cu_width, int cu_he
     s32 mv_scale_tmp_hor, mv_scale_tmp_ver;
     s32 hor_max, hor_min, ver_max, ver_min;
     s32 mv_scale_tmp_hor_ori, mv_scale_tmp_ver_ori;
+#if PADLESS_REF
+    COM_PIC *ref_pic_org = ref_pic;
+#endif
 
 #if CPMV_BIT_DEPTH == 18
     for (int i = 0; i < cp_num; i++)
@@ -10820,6 +11176,13 @@ void com_affine_mc_l(int x, int y, int pic_w, int pic_h, int cu_width, int cu_he
 
         qpel_gmv_x = (x << 4) + mv_scale_tmp_hor;
         qpel_gmv_y = (y << 4) + mv_scale_tmp_ver;
+#if PADLESS_REF
+        ref_pic = ref_window_blk(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 4, cu_width, cu_height);
+        if (ref_pic == NULL)
+        {
+            return;
+        }
+#endif
         com_mc_l_hp(mv_scale_tmp_hor_ori, mv_scale_tmp_ver_ori, ref_pic->y, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_luma, cu_width, pred_y, cu_width, cu_height, bit_depth);
 
         return;
@@ -10927,6 +11290,13 @@ void com_affine_mc_l(int x, int y, int pic_w, int pic_h, int cu_width, int cu_he
             mv_scale_tmp_ver = min(ver_max, max(ver_min, mv_scale_tmp_ver));
             qpel_gmv_x = ((x + w) << 4) + mv_scale_tmp_hor;
             qpel_gmv_y = ((y + h) << 4) + mv_scale_tmp_ver;
+#if PADLESS_REF
+            ref_pic = ref_window_blk(ref_pic_org, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 4, sub_w, sub_h);
+            if (ref_pic == NULL)
+            {
+                return;
+            }
+#endif
 #if ASP
             if (enable_asp) 
             {
@@ -10984,6 +11354,9 @@ void com_affine_mc_lc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[R
     s32 hor_max, hor_min, ver_max, ver_min;
     s32 mv_scale_tmp_hor_ori, mv_scale_tmp_ver_ori;
     s32 mv_save[MAX_CU_SIZE >> MIN_CU_LOG2][MAX_CU_SIZE >> MIN_CU_LOG2][MV_D];
+#if PADLESS_REF
+    COM_PIC *ref_pic_org = ref_pic;
+#endif
 
 #if CPMV_BIT_DEPTH == 18
     for (int i = 0; i < cp_num; i++)//жϸmvǷڷΧ
@@ -11017,6 +11390,13 @@ void com_affine_mc_lc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[R
 
         qpel_gmv_x = (x << 4) + mv_scale_tmp_hor;
         qpel_gmv_y = (y << 4) + mv_scale_tmp_ver;
+#if PADLESS_REF
+        ref_pic = ref_window_blk(ref_pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 4, cu_width, cu_height);
+        if (ref_pic == NULL)
+        {
+            return;
+        }
+#endif
         com_mc_l_hp(mv_scale_tmp_hor_ori, mv_scale_tmp_ver_ori, ref_pic->y, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_luma, cu_width, pred_y, cu_width, cu_height, bit_depth);
         com_mc_c_hp(mv_scale_tmp_hor_ori, mv_scale_tmp_ver_ori, ref_pic->u, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_chroma, cu_width >> 1, pred_u, cu_width >> 1, cu_height >> 1, bit_depth);
         com_mc_c_hp(mv_scale_tmp_hor_ori, mv_scale_tmp_ver_ori, ref_pic->v, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_chroma, cu_width >> 1, pred_v, cu_width >> 1, cu_height >> 1, bit_depth);
@@ -11153,6 +11533,13 @@ void com_affine_mc_lc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[R
             mv_scale_tmp_ver = min(ver_max, max(ver_min, mv_scale_tmp_ver));
             qpel_gmv_x = ((x + w) << 4) + mv_scale_tmp_hor;
             qpel_gmv_y = ((y + h) << 4) + mv_scale_tmp_ver;
+#if PADLESS_REF
+            ref_pic = ref_window_blk(ref_pic_org, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 4, sub_w, sub_h);
+            if (ref_pic == NULL)
+            {
+                return;
+            }
+#endif
 #if ASP
             if(enable_asp)
             {
@@ -11199,6 +11586,13 @@ void com_affine_mc_lc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[R
             mv_scale_tmp_ver = min(ver_max, max(ver_min, mv_scale_tmp_ver));
             qpel_gmv_x = ((x + w) << 4) + mv_scale_tmp_hor;
             qpel_gmv_y = ((y + h) << 4) + mv_scale_tmp_ver;
+#if PADLESS_REF
+            ref_pic = ref_window_blk(ref_pic_org, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 4, sub_w, sub_h);
+            if (ref_pic == NULL)
+            {
+                return;
+            }
+#endif
             com_mc_c_hp( mv_scale_tmp_hor_ori, mv_scale_tmp_ver_ori, ref_pic->u, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_chroma, cu_width >> 1, pred_u + (w >> 1), sub_w >> 1, sub_h >> 1, bit_depth );
             com_mc_c_hp( mv_scale_tmp_hor_ori, mv_scale_tmp_ver_ori, ref_pic->v, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_chroma, cu_width >> 1, pred_v + (w >> 1), sub_w >> 1, sub_h >> 1, bit_depth );
         }
@@ -11231,9 +11625,17 @@ void com_affine_mc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[REFP
     s8 *refi = mod_info_curr->refi; 
     CPMV (*mv)[VER_NUM][MV_D] = mod_info_curr->affine_mv;
     pel (*pred_buf)[MAX_CU_DIM] = mod_info_curr->pred;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+#endif
 
 #if BGC
+#if SCRATCH_ARENA
+    pel (*pred_uv)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * V_C * MAX_CU_DIM);
+#else
     static pel pred_uv[V_C][MAX_CU_DIM];
+#endif
     pel *dst_u, *dst_v;
     u8  bgc_flag = mod_info_curr->bgc_flag;
     u8  bgc_idx = mod_info_curr->bgc_idx;
@@ -11242,7 +11644,11 @@ void com_affine_mc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[REFP
 
     s16(*map_mv)[REFP_NUM][MV_D] = pic_map->map_mv;
 
+#if SCRATCH_ARENA
+    pel (*pred_snd)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+#else
     static pel pred_snd[N_C][MAX_CU_DIM];
+#endif
     pel(*pred)[MAX_CU_DIM] = pred_buf;
 
     int bidx = 0;
@@ -11438,6 +11844,9 @@ void com_affine_mc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[REFP
         }
 #endif
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 
 #if AWP_ENH
@@ -11451,12 +11860,23 @@ void com_dawp_mc(COM_INFO* info, COM_MODE* mod_info_curr, COM_REFP(*refp)[REFP_N
     s32 w = 0;
     s32 tmp_x = x;
     s32 tmp_y = y;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    pel (*pred_awp_tmp0)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+    pel (*pred_awp_tmp1)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+    pel (*pred_tpl0)[AWP_TPL_SIZE * 2] = com_arena_alloc(scratch, sizeof(pel) * AWP_TPL_SIZE * 2);
+    pel (*pred_tpl1)[AWP_TPL_SIZE * 2] = com_arena_alloc(scratch, sizeof(pel) * AWP_TPL_SIZE * 2);
+    pel (*awp_weight0)[MAX_AWP_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_AWP_DIM);
+    pel (*awp_weight1)[MAX_AWP_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_AWP_DIM);
+#else
     static pel pred_awp_tmp0[N_C][MAX_CU_DIM];
     static pel pred_awp_tmp1[N_C][MAX_CU_DIM];
     static pel pred_tpl0[1][AWP_TPL_SIZE * 2];
     static pel pred_tpl1[1][AWP_TPL_SIZE * 2];
     static pel awp_weight0[N_C][MAX_AWP_DIM];
     static pel awp_weight1[N_C][MAX_AWP_DIM];
+#endif
 
 #if DMVR
     /* disable DMVR*/
@@ -11631,8 +12051,13 @@ void com_dawp_mc(COM_INFO* info, COM_MODE* mod_info_curr, COM_REFP(*refp)[REFP_N
     mod_info_curr->refi[REFP_0] = REFI_INVALID;
     mod_info_curr->refi[REFP_1] = REFI_INVALID;
 
+#if SCRATCH_ARENA
+    int mode_list[AWP_MODE_NUM];
+    int inv_mode_list[AWP_MODE_NUM];
+#else
     static int mode_list[AWP_MODE_NUM];
     static int inv_mode_list[AWP_MODE_NUM];
+#endif
     com_get_tpl_ref(mod_info_curr, pred_tpl0[0], pred_tpl1[0]);
     com_tpl_reorder_awp_mode(mod_info_curr, mode_list, inv_mode_list);
     int dawp_idx = mod_info_curr->dawp_idx;
@@ -11671,6 +12096,9 @@ void com_dawp_mc(COM_INFO* info, COM_MODE* mod_info_curr, COM_REFP(*refp)[REFP_N
         /* combine two pred buf */
         com_derive_awp_pred(mod_info_curr, Y_C, pred_awp_tmp0, pred_awp_tmp1, awp_weight0[Y_C], awp_weight1[Y_C]);
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 #endif
 
@@ -11686,10 +12114,19 @@ void com_awp_mc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[REFP_NU
     s32 w = 0;
     s32 tmp_x = x;
     s32 tmp_y = y;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    pel (*pred_awp_tmp0)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+    pel (*pred_awp_tmp1)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+    pel (*awp_weight0)[MAX_AWP_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_AWP_DIM);
+    pel (*awp_weight1)[MAX_AWP_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_AWP_DIM);
+#else
     static pel pred_awp_tmp0[N_C][MAX_CU_DIM];
     static pel pred_awp_tmp1[N_C][MAX_CU_DIM];
     static pel awp_weight0[N_C][MAX_AWP_DIM];
     static pel awp_weight1[N_C][MAX_AWP_DIM];
+#endif
 
 #if DMVR
     /* disable DMVR*/
@@ -11790,6 +12227,9 @@ void com_awp_mc(COM_INFO *info, COM_MODE *mod_info_curr, COM_REFP(*refp)[REFP_NU
         /* combine two pred buf */
         com_derive_awp_pred(mod_info_curr, Y_C, pred_awp_tmp0, pred_awp_tmp1, awp_weight0[Y_C], awp_weight1[Y_C]);
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 #endif
 
@@ -12309,10 +12749,197 @@ const COM_FN_SAD com_tbl_sad_16b[9][9] =
 #endif
 };
 
+#if TM_COST_CACHE
+#define TM_COST_CACHE_SIZE                 256 // template cost hash entries, power of two
+#define TM_COST_CACHE_PROBE                4
+#define TM_HPASS_CACHE_NUM                 8   // horizontally filtered template windows kept per CU
+#define TM_HPASS_MARGIN                    8   // rows filtered above and below the template for later vertical MV steps
+#define TM_HPASS_TAP                       12
+
+typedef struct _TM_COST_ENTRY
+{
+    COM_PIC *pic;
+    s16      mv[MV_D];
+    s16      init_mv[MV_D];
+    u64      cost;
+    u32      stamp;
+} TM_COST_ENTRY;
+
+typedef struct _TM_HPASS_ENTRY
+{
+    COM_PIC *pic;
+    int      gmv_x;   /* quarter-pel horizontal position of the template in the reference */
+    int      row0;    /* first reference row of the filtered window */
+    int      rows;
+    int      tm_w;
+    u32      stamp;
+    s16      buf[MAX_CU_SIZE * (TM_WIDTH + TM_HPASS_TAP - 1 + 2 * TM_HPASS_MARGIN)];
+} TM_HPASS_ENTRY;
+
+/* the template of the current CU is fixed between two com_tm_cache_reset() calls, so template costs and
+   filter passes only depend on the reference picture and the MV tested */
+struct _COM_TM_CACHE
+{
+    u32            stamp;
+    TM_COST_ENTRY  cost[TM_COST_CACHE_SIZE];
+    int            hpass_next;
+    TM_HPASS_ENTRY hpass[TM_HPASS_CACHE_NUM];
+};
+
+/* cache of the core running on this thread, see com_tm_cache_bind() */
+static COM_THREAD_LOCAL COM_TM_CACHE *tm_cache;
+
+COM_TM_CACHE * com_tm_cache_create()
+{
+    COM_TM_CACHE *cache = (COM_TM_CACHE *)com_malloc_fast(sizeof(COM_TM_CACHE));
+    com_assert_rv(cache, NULL);
+    com_mset(cache, 0, sizeof(COM_TM_CACHE));
+    cache->stamp = 1;
+    return cache;
+}
+
+void com_tm_cache_delete(COM_TM_CACHE *cache)
+{
+    if (tm_cache == cache)
+    {
+        tm_cache = NULL;
+    }
+    com_mfree_fast(cache);
+}
+
+void com_tm_cache_bind(COM_TM_CACHE *cache)
+{
+    tm_cache = cache;
+}
+
+void com_tm_cache_reset()
+{
+    if (++tm_cache->stamp == 0)
+    {
+        com_mset(tm_cache->cost, 0, sizeof(tm_cache->cost));
+        for (int i = 0; i < TM_HPASS_CACHE_NUM; i++)
+        {
+            tm_cache->hpass[i].stamp = 0;
+        }
+        tm_cache->stamp = 1;
+    }
+}
+
+static TM_COST_ENTRY* tm_cost_cache_get(COM_PIC *pic, s16 init_mv[MV_D], s16 mv[MV_D], BOOL is_simplified, u64 *cost)
+{
+    /* only the simplified sub-pel filters depend on init_mv (through the padded search window) */
+    s16 key_init[MV_D] = { 0, 0 };
+    if (is_simplified && ((mv[MV_X] | mv[MV_Y]) & 0x3))
+    {
+        copy_mv(key_init, init_mv);
+    }
+    u32 hash = ((u32)(mv[MV_X] * 31 + mv[MV_Y] * 131 + key_init[MV_X] * 7 + key_init[MV_Y] * 17) ^ (u32)(((size_t)pic) >> 6)) & (TM_COST_CACHE_SIZE - 1);
+    TM_COST_ENTRY *free_entry = NULL;
+    for (int i = 0; i < TM_COST_CACHE_PROBE; i++)
+    {
+        TM_COST_ENTRY *e = &tm_cache->cost[(hash + i) & (TM_COST_CACHE_SIZE - 1)];
+        if (e->stamp != tm_cache->stamp)
+        {
+            if (free_entry == NULL)
+            {
+                free_entry = e;
+            }
+            continue;
+        }
+        if (e->pic == pic && SAME_MV(e->mv, mv) && SAME_MV(e->init_mv, key_init))
+        {
+            *cost = e->cost;
+            return NULL;
+        }
+    }
+    if (free_entry == NULL)
+    {
+        free_entry = &tm_cache->cost[hash];
+    }
+    free_entry->pic = pic;
+    copy_mv(free_entry->mv, mv);
+    copy_mv(free_entry->init_mv, key_init);
+    free_entry->stamp = 0;
+    return free_entry;
+}
+
+static void tm_cost_cache_put(TM_COST_ENTRY *e, u64 cost)
+{
+    if (e != NULL)
+    {
+        e->cost = cost;
+        e->stamp = tm_cache->stamp;
+    }
+}
+
+#if SIMD_MC && IF_LUMA12_CHROMA6_SIMD
+/* returns the 12-tap horizontal pass of the template rows starting at gmv_y, reusing the pass of an earlier MV
+   with the same horizontal position; the sample stride of the returned buffer is tm_w */
+static s16* tm_hpass_get(COM_PIC *pic, int gmv_x, int gmv_y, int tm_w, int tm_h, int bit_depth)
+{
+    const int pad = TM_HPASS_TAP / 2 - 1;
+    const int row = (gmv_y >> 2) - pad;
+    const int rows = tm_h + TM_HPASS_TAP - 1;
+    TM_HPASS_ENTRY *e;
+    for (int i = 0; i < TM_HPASS_CACHE_NUM; i++)
+    {
+        e = &tm_cache->hpass[i];
+        if (e->stamp == tm_cache->stamp && e->pic == pic && e->gmv_x == gmv_x && e->tm_w == tm_w && row >= e->row0 && row + rows <= e->row0 + e->rows)
+        {
+            return e->buf + (row - e->row0) * tm_w;
+        }
+    }
+
+    /* filter a taller window, clipped to the rows single_mv_clip() lets a template reach */
+    int row0 = COM_MAX(row - TM_HPASS_MARGIN, -MAX_CU_SIZE2 - 4 - pad);
+    int row1 = COM_MIN(row + rows + TM_HPASS_MARGIN, pic->height_luma + MAX_CU_SIZE2 + 4 + pad + 1);
+    row0 = COM_MIN(row0, row);
+    row1 = COM_MAX(row1, row + rows);
+    if ((row1 - row0) * tm_w > (int)(sizeof(e->buf) / sizeof(s16)))
+    {
+        row0 = row;
+        row1 = row + rows;
+    }
+
+    const int shift1 = bit_depth - 6;
+    const s32 add1 = (1 << shift1) >> 1;
+    e = &tm_cache->hpass[tm_cache->hpass_next];
+    tm_cache->hpass_next = (tm_cache->hpass_next + 1) % TM_HPASS_CACHE_NUM;
+#if PADLESS_REF
+    COM_PIC *src = com_ref_window(pic, (gmv_x >> 2) - pad, row0, (gmv_x >> 2) - pad + tm_w + TM_HPASS_TAP - 1, row1);
+    if (src == NULL)
+    {
+        return NULL;
+    }
+#else
+    COM_PIC *src = pic;
+#endif
+    mc_filter_l_12pel_horz_clip_sse(src->y + row0 * src->stride_luma + (gmv_x >> 2) - pad, src->stride_luma, e->buf, tm_w, tbl_mc_l_coeff_12tap[gmv_x & 0x3], tm_w, row1 - row0, 0, (1 << bit_depth) - 1, add1, shift1, 0);
+    e->pic = pic;
+    e->gmv_x = gmv_x;
+    e->row0 = row0;
+    e->rows = row1 - row0;
+    e->tm_w = tm_w;
+    e->stamp = tm_cache->stamp;
+    return e->buf + (row - row0) * tm_w;
+}
+#endif
+#endif
+
 u64 com_calc_tm_cost(int x, int y, u16 tm_size[3][2], COM_PIC* ref_pic, s16 init_mv[MV_D], s16 mv[MV_D], pel template_rec[3][MAX_CU_SIZE * TM_WIDTH], pel template_pred[3][MAX_CU_SIZE * TM_WIDTH], const int bit_depth, BOOL is_simplified)
 {
     u64 tm_cost = 0;
     BOOL is_search = TRUE;
+#if PADLESS_REF
+    COM_PIC *ref_pic_org = ref_pic;
+#endif
+#if TM_COST_CACHE
+    TM_COST_ENTRY *cache_entry = tm_cost_cache_get(ref_pic, init_mv, mv, is_simplified, &tm_cost);
+    if (cache_entry == NULL)
+    {
+        return tm_cost;
+    }
+#endif
 
     for (u8 i = 0; i < 3; i++)
     {
@@ -12327,6 +12954,13 @@ u64 com_calc_tm_cost(int x, int y, u16 tm_size[3][2], COM_PIC* ref_pic, s16 init
         
         int dx = mv[MV_X] & 0x3 ? 1 : 0;
         int dy = mv[MV_Y] & 0x3 ? 1 : 0;
+#if PADLESS_REF
+        ref_pic = ref_window_blk(ref_pic_org, qpel_gmv_x, qpel_gmv_y, init_qpel_gmv_x, init_qpel_gmv_y, 2, tm_w, tm_h);
+        if (ref_pic == NULL)
+        {
+            return tm_cost;
+        }
+#endif
 
         if (is_simplified)
         {
@@ -12347,6 +12981,23 @@ u64 com_calc_tm_cost(int x, int y, u16 tm_size[3][2], COM_PIC* ref_pic, s16 init
                 com_mc_tm_l_nn(ref_pic->y, template_pred[i], ref_pic->stride_luma, tm_w, init_qpel_gmv_x, init_qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, tm_w, tm_h, is_search, bit_depth);
             }
         }
+#if TM_COST_CACHE && SIMD_MC && IF_LUMA12_CHROMA6_SIMD
+        else if (dx == 1 && dy == 1)
+        {
+            /* same filtering as com_mc_l_nn(), with the horizontal pass shared by every MV of the same horizontal position */
+            const int shift2 = 22 - bit_depth;
+#if PADLESS_REF
+            s16 *hpass = tm_hpass_get(ref_pic_org, qpel_gmv_x, qpel_gmv_y, tm_w, tm_h, bit_depth);
+            if (hpass == NULL)
+            {
+                return tm_cost;
+            }
+#else
+            s16 *hpass = tm_hpass_get(ref_pic, qpel_gmv_x, qpel_gmv_y, tm_w, tm_h, bit_depth);
+#endif
+            mc_filter_l_12pel_vert_clip_sse(hpass, tm_w, template_pred[i], tm_w, tbl_mc_l_coeff_12tap[qpel_gmv_y & 0x3], tm_w, tm_h, 0, (1 << bit_depth) - 1, 1 << (shift2 - 1), shift2, 1);
+        }
+#endif
         else
         {
             com_mc_l(mv[MV_X], mv[MV_Y], ref_pic->y, qpel_gmv_x, qpel_gmv_y, ref_pic->stride_luma, tm_w, template_pred[i], tm_w, tm_h, bit_depth);
@@ -12354,6 +13005,9 @@ u64 com_calc_tm_cost(int x, int y, u16 tm_size[3][2], COM_PIC* ref_pic, s16 init
 
         tm_cost += com_sad_16b(com_tbl_log2[tm_w], com_tbl_log2[tm_h], template_rec[i], template_pred[i], tm_w, tm_w, bit_depth);
     }
+#if TM_COST_CACHE
+    tm_cost_cache_put(cache_entry, tm_cost);
+#endif
     return tm_cost;
 }
 
@@ -12478,8 +13132,15 @@ void com_tm_process(int x, int y, int pic_w, int pic_h, int w, int h, COM_REFP(*
     assert(x>=TM_WIDTH && y>=TM_WIDTH);
 
     COM_PIC* ref_pic;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    pel (*template_rec)[MAX_CU_SIZE*TM_WIDTH] = com_arena_alloc(scratch, sizeof(pel) * 3 * MAX_CU_SIZE*TM_WIDTH);
+    pel (*template_pred)[MAX_CU_SIZE*TM_WIDTH] = com_arena_alloc(scratch, sizeof(pel) * 3 * MAX_CU_SIZE*TM_WIDTH);
+#else
     static pel template_rec[3][MAX_CU_SIZE*TM_WIDTH];
     static pel template_pred[3][MAX_CU_SIZE*TM_WIDTH];
+#endif
     u16 tm_size[3][2] = { {w, TM_WIDTH}, {TM_WIDTH, h}, {TM_WIDTH, TM_WIDTH}};
 
     for (u16 i = 0; i < TM_WIDTH; i++)
@@ -12508,6 +13169,9 @@ void com_tm_process(int x, int y, int pic_w, int pic_h, int w, int h, COM_REFP(*
         best_cost[refp_idx] = com_tm_search(x, y, pic_w, pic_h, w, h, tm_size, ref_pic, 
             init_mv[refp_idx], mv[refp_idx], template_rec, template_pred, bit_depth, is_simplified);
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 
 void remove_duplicate_cands(s16(*pmv_cands)[REFP_NUM][MV_D], s8(*refi_cands)[REFP_NUM], int* num_cands_all)
@@ -12554,8 +13218,15 @@ void pre_evaluation_cands(int x, int y, int pic_w, int pic_h, int w, int h, pel*
     assert(x>=TM_WIDTH && y>=TM_WIDTH);
 
     COM_PIC* ref_pic;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    pel (*template_rec)[MAX_CU_SIZE*TM_WIDTH] = com_arena_alloc(scratch, sizeof(pel) * 3 * MAX_CU_SIZE*TM_WIDTH);
+    pel (*template_pred)[3][MAX_CU_SIZE*TM_WIDTH] = com_arena_alloc(scratch, sizeof(pel) * REFP_NUM * 3 * MAX_CU_SIZE*TM_WIDTH);
+#else
     static pel template_rec[3][MAX_CU_SIZE*TM_WIDTH];
     static pel template_pred[REFP_NUM][3][MAX_CU_SIZE*TM_WIDTH];
+#endif
     u16 tm_size[3][2] = { {w, TM_WIDTH}, {TM_WIDTH, h}, {TM_WIDTH, TM_WIDTH}};
     
     //ģԭʼ
@@ -12625,6 +13296,13 @@ void pre_evaluation_cands(int x, int y, int pic_w, int pic_h, int w, int h, pel*
                 int dx = cur_mv[refp_idx][MV_X] & 0x3 ? 1 : 0;
                 int dy = cur_mv[refp_idx][MV_Y] & 0x3 ? 1 : 0;
                 BOOL is_search = TRUE;
+#if PADLESS_REF
+                ref_pic = ref_window_blk(refp[cur_refi[refp_idx]][refp_idx].pic, qpel_gmv_x, qpel_gmv_y, qpel_gmv_x, qpel_gmv_y, 2, tm_w, tm_h);
+                if (ref_pic == NULL)
+                {
+                    continue;
+                }
+#endif
 
                 if (is_simplified)
                 {
@@ -12679,6 +13357,14 @@ void pre_evaluation_cands(int x, int y, int pic_w, int pic_h, int w, int h, pel*
                 u16 tm_h = tm_size[i][1];
                 tm_cost += com_sad_16b(com_tbl_log2[tm_w], com_tbl_log2[tm_h], template_rec[i], template_pred[refp_idx][i], tm_w, tm_w, bit_depth);
             }
+#if TM_COST_CACHE
+            /* a uni-pred candidate cost is the starting point of its template search in com_tm_process() */
+            if (!((cur_mv[refp_idx][MV_X] | cur_mv[refp_idx][MV_Y]) & 0x3))
+            {
+                u64 cached_cost;
+                tm_cost_cache_put(tm_cost_cache_get(refp[cur_refi[refp_idx]][refp_idx].pic, cur_mv[refp_idx], cur_mv[refp_idx], is_simplified, &cached_cost), tm_cost);
+            }
+#endif
         }
 
         int shift = 0;
@@ -12705,6 +13391,9 @@ void pre_evaluation_cands(int x, int y, int pic_w, int pic_h, int w, int h, pel*
             }
         }
     }
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 
 void tm_padding(pel* img_pad, pel* img_rec, int s_rec, int width, int height, int offset)
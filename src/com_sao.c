@@ -770,6 +770,95 @@ void SAO_on_smb(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_s
     }
 }
 
+#if LF_CTU_PIPELINE
+#if LF_ROW_PARALLEL
+typedef struct _SAO_JOB
+{
+    COM_INFO       *info;
+    COM_MAP        *map;
+    COM_PIC        *pic_rec;
+    COM_PIC        *pic_sao;
+    SAO_BLK_PARAM **rec_sao_blk_param;
+    int             lcu_y;
+} SAO_JOB;
+#endif
+
+static void sao_lcu(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_sao, SAO_BLK_PARAM **rec_sao_blk_param, int lcu_y, int lcu_x)
+{
+    int input_max_size_in_bit = info->log2_max_cuwh;
+    int pix_y = lcu_y << input_max_size_in_bit;
+    int pix_x = lcu_x << input_max_size_in_bit;
+    int lcu_pix_height = min(1 << (input_max_size_in_bit), (info->pic_height - pix_y));
+    int lcu_pix_width = min(1 << (input_max_size_in_bit), (info->pic_width - pix_x));
+    int lcu_pos = lcu_x + lcu_y * info->pic_width_in_lcu;
+
+    SAO_on_smb(info, map, pic_rec, pic_sao, pix_y, pix_x, lcu_pix_width, lcu_pix_height, rec_sao_blk_param[lcu_pos], info->bit_depth_internal);
+}
+
+#if LF_ROW_PARALLEL
+static void sao_lcu_job(void *arg, int lcu_x)
+{
+    SAO_JOB *job = (SAO_JOB *)arg;
+    sao_lcu(job->info, job->map, job->pic_rec, job->pic_sao, job->rec_sao_blk_param, job->lcu_y, lcu_x);
+}
+#endif
+
+void sao_lcu_row(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_sao, SAO_BLK_PARAM **rec_sao_blk_param, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
+{
+    int lcu_x;
+#if LF_ROW_PARALLEL
+    if (com_thread_pool_size(pool) > 1)
+    {
+        SAO_JOB job = { info, map, pic_rec, pic_sao, rec_sao_blk_param, lcu_y };
+        com_thread_pool_run(pool, sao_lcu_job, &job, info->pic_width_in_lcu);
+        return;
+    }
+#endif
+    for (lcu_x = 0; lcu_x < info->pic_width_in_lcu; lcu_x++)
+    {
+        sao_lcu(info, map, pic_rec, pic_sao, rec_sao_blk_param, lcu_y, lcu_x);
+    }
+}
+
+#if LF_ROW_PARALLEL
+static void sao_row_job(void *arg, int lcu_y)
+{
+    SAO_JOB *job = (SAO_JOB *)arg;
+    sao_lcu_row(job->info, job->map, job->pic_rec, job->pic_sao, job->rec_sao_blk_param, lcu_y, NULL);
+}
+#endif
+
+//SAO reads pic_sao and writes pic_rec, so all LCUs can be filtered in any order
+void sao_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_sao, SAO_BLK_PARAM **rec_sao_blk_param
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
+{
+    int lcu_y;
+#if LF_ROW_PARALLEL
+    SAO_JOB job = { info, map, pic_rec, pic_sao, rec_sao_blk_param, 0 };
+    if (com_thread_pool_size(pool) > 1)
+    {
+        com_thread_pool_run(pool, sao_row_job, &job, info->pic_height_in_lcu);
+        return;
+    }
+#endif
+
+    for (lcu_y = 0; lcu_y < info->pic_height_in_lcu; lcu_y++)
+    {
+        sao_lcu_row(info, map, pic_rec, pic_sao, rec_sao_blk_param, lcu_y
+#if LF_ROW_PARALLEL
+            , NULL
+#endif
+        );
+    }
+}
+#else
 void sao_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_sao, SAO_BLK_PARAM **rec_sao_blk_param)
 {
     int pic_pix_height = info->pic_height;
@@ -794,6 +883,8 @@ void sao_frame(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_rec, COM_PIC  *pic_sa
     }
 }
 
+#endif
+
 int com_malloc_3d_sao_stat_data(SAO_STAT_DATA ** **array3D, int num_SMB, int num_comp, int num_class)
 {
     int i, j;
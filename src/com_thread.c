@@ -0,0 +1,430 @@
+/* ====================================================================================================================
+
+  The copyright in this software is being made available under the License included below.
+  This software may be subject to other third party and contributor rights, including patent rights, and no such
+  rights are granted under this license.
+
+  Copyright (c) 2018, HUAWEI TECHNOLOGIES CO., LTD. All rights reserved.
+  Copyright (c) 2018, SAMSUNG ELECTRONICS CO., LTD. All rights reserved.
+  Copyright (c) 2018, PEKING UNIVERSITY SHENZHEN GRADUATE SCHOOL. All rights reserved.
+  Copyright (c) 2018, PENGCHENG LABORATORY. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted only for
+  the purpose of developing standards within Audio and Video Coding Standard Workgroup of China (AVS) and for testing and
+  promoting such standards. The following conditions are required to be met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+      the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+      the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * The name of HUAWEI TECHNOLOGIES CO., LTD. or SAMSUNG ELECTRONICS CO., LTD. may not be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+* ====================================================================================================================
+*/
+
+#include "com_port.h"
+#include "com_thread.h"
+
+#if defined(WIN32) || defined(WIN64)
+#include <windows.h>
+typedef HANDLE                      THREAD_T;
+typedef CRITICAL_SECTION            MUTEX_T;
+typedef CONDITION_VARIABLE          COND_T;
+#define mutex_init(m)               InitializeCriticalSection(m)
+#define mutex_destroy(m)            DeleteCriticalSection(m)
+#define mutex_lock(m)               EnterCriticalSection(m)
+#define mutex_unlock(m)             LeaveCriticalSection(m)
+#define cond_init(c)                InitializeConditionVariable(c)
+#define cond_destroy(c)
+#define cond_wait(c, m)             SleepConditionVariableCS(c, m, INFINITE)
+#define cond_broadcast(c)           WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+typedef pthread_t                   THREAD_T;
+typedef pthread_mutex_t             MUTEX_T;
+typedef pthread_cond_t              COND_T;
+#define mutex_init(m)               pthread_mutex_init(m, NULL)
+#define mutex_destroy(m)            pthread_mutex_destroy(m)
+#define mutex_lock(m)               pthread_mutex_lock(m)
+#define mutex_unlock(m)             pthread_mutex_unlock(m)
+#define cond_init(c)                pthread_cond_init(c, NULL)
+#define cond_destroy(c)             pthread_cond_destroy(c)
+#define cond_wait(c, m)             pthread_cond_wait(c, m)
+#define cond_broadcast(c)           pthread_cond_broadcast(c)
+#endif
+
+struct _COM_THREAD_POOL
+{
+    int              num_workers;  /* threads besides the caller */
+    THREAD_T        *workers;
+    MUTEX_T          mutex;
+    COND_T           cond_job;     /* a job was posted or the pool is shutting down */
+    COND_T           cond_done;    /* the last item of a job finished */
+    COM_THREAD_JOB   job;
+    void            *arg;
+    int              num;          /* items of the current job */
+    int              next;         /* next item to hand out */
+    int              done;         /* finished items */
+    unsigned int     job_id;       /* increases with every posted job */
+    int              quit;
+};
+
+struct _COM_THREAD_PROGRESS
+{
+    int              num;
+    u8              *flag;
+    MUTEX_T          mutex;
+    COND_T           cond;
+};
+
+/* claim and run items of the current job until none is left; called and returns with the mutex held */
+static void pool_work(COM_THREAD_POOL *pool)
+{
+    while (pool->next < pool->num)
+    {
+        COM_THREAD_JOB job = pool->job;
+        void *arg = pool->arg;
+        int idx = pool->next++;
+        mutex_unlock(&pool->mutex);
+        job(arg, idx);
+        mutex_lock(&pool->mutex);
+        if (++pool->done == pool->num)
+        {
+            cond_broadcast(&pool->cond_done);
+        }
+    }
+}
+
+#if defined(WIN32) || defined(WIN64)
+static DWORD WINAPI pool_worker(LPVOID param)
+#else
+static void * pool_worker(void *param)
+#endif
+{
+    COM_THREAD_POOL *pool = (COM_THREAD_POOL *)param;
+    unsigned int job_id;
+    mutex_lock(&pool->mutex);
+    job_id = pool->job_id;
+    while (1)
+    {
+        while (!pool->quit && pool->job_id == job_id)
+        {
+            cond_wait(&pool->cond_job, &pool->mutex);
+        }
+        if (pool->quit)
+        {
+            break;
+        }
+        job_id = pool->job_id;
+        pool_work(pool);
+    }
+    mutex_unlock(&pool->mutex);
+    return 0;
+}
+
+COM_THREAD_POOL * com_thread_pool_create(int num_threads)
+{
+    COM_THREAD_POOL *pool;
+    int i;
+    if (num_threads <= 1)
+    {
+        return NULL;
+    }
+    pool = (COM_THREAD_POOL *)com_malloc(sizeof(COM_THREAD_POOL));
+    com_assert_rv(pool, NULL);
+    memset(pool, 0, sizeof(COM_THREAD_POOL));
+    pool->workers = (THREAD_T *)com_malloc(sizeof(THREAD_T) * (num_threads - 1));
+    if (pool->workers == NULL)
+    {
+        com_mfree(pool);
+        return NULL;
+    }
+    mutex_init(&pool->mutex);
+    cond_init(&pool->cond_job);
+    cond_init(&pool->cond_done);
+    for (i = 0; i < num_threads - 1; i++)
+    {
+#if defined(WIN32) || defined(WIN64)
+        pool->workers[i] = CreateThread(NULL, 0, pool_worker, pool, 0, NULL);
+        if (pool->workers[i] == NULL)
+        {
+            break;
+        }
+#else
+        if (pthread_create(&pool->workers[i], NULL, pool_worker, pool))
+        {
+            break;
+        }
+#endif
+        pool->num_workers++;
+    }
+    return pool;
+}
+
+void com_thread_pool_delete(COM_THREAD_POOL *pool)
+{
+    int i;
+    if (pool == NULL)
+    {
+        return;
+    }
+    mutex_lock(&pool->mutex);
+    pool->quit = 1;
+    cond_broadcast(&pool->cond_job);
+    mutex_unlock(&pool->mutex);
+    for (i = 0; i < pool->num_workers; i++)
+    {
+#if defined(WIN32) || defined(WIN64)
+        WaitForSingleObject(pool->workers[i], INFINITE);
+        CloseHandle(pool->workers[i]);
+#else
+        pthread_join(pool->workers[i], NULL);
+#endif
+    }
+    cond_destroy(&pool->cond_done);
+    cond_destroy(&pool->cond_job);
+    mutex_destroy(&pool->mutex);
+    com_mfree(pool->workers);
+    com_mfree(pool);
+}
+
+int com_thread_pool_size(COM_THREAD_POOL *pool)
+{
+    return pool ? pool->num_workers + 1 : 1;
+}
+
+void com_thread_pool_run(COM_THREAD_POOL *pool, COM_THREAD_JOB job, void *arg, int num)
+{
+    int i;
+    if (pool == NULL || pool->num_workers == 0 || num <= 1)
+    {
+        for (i = 0; i < num; i++)
+        {
+            job(arg, i);
+        }
+        return;
+    }
+    mutex_lock(&pool->mutex);
+    pool->job = job;
+    pool->arg = arg;
+    pool->num = num;
+    pool->next = 0;
+    pool->done = 0;
+    pool->job_id++;
+    cond_broadcast(&pool->cond_job);
+    pool_work(pool);
+    while (pool->done < pool->num)
+    {
+        cond_wait(&pool->cond_done, &pool->mutex);
+    }
+    mutex_unlock(&pool->mutex);
+}
+
+COM_THREAD_PROGRESS * com_thread_progress_create(int num)
+{
+    COM_THREAD_PROGRESS *prog = (COM_THREAD_PROGRESS *)com_malloc(sizeof(COM_THREAD_PROGRESS));
+    com_assert_rv(prog, NULL);
+    prog->num = num;
+    prog->flag = (u8 *)com_malloc(num > 0 ? num : 1);
+    if (prog->flag == NULL)
+    {
+        com_mfree(prog);
+        return NULL;
+    }
+    memset(prog->flag, 0, num > 0 ? num : 1);
+    mutex_init(&prog->mutex);
+    cond_init(&prog->cond);
+    return prog;
+}
+
+void com_thread_progress_delete(COM_THREAD_PROGRESS *prog)
+{
+    if (prog == NULL)
+    {
+        return;
+    }
+    cond_destroy(&prog->cond);
+    mutex_destroy(&prog->mutex);
+    com_mfree(prog->flag);
+    com_mfree(prog);
+}
+
+void com_thread_progress_reset(COM_THREAD_PROGRESS *prog)
+{
+    memset(prog->flag, 0, prog->num);
+}
+
+void com_thread_progress_set(COM_THREAD_PROGRESS *prog, int idx)
+{
+    mutex_lock(&prog->mutex);
+    prog->flag[idx] = 1;
+    cond_broadcast(&prog->cond);
+    mutex_unlock(&prog->mutex);
+}
+
+void com_thread_progress_clear(COM_THREAD_PROGRESS *prog, int idx)
+{
+    mutex_lock(&prog->mutex);
+    prog->flag[idx] = 0;
+    mutex_unlock(&prog->mutex);
+}
+
+void com_thread_progress_wait(COM_THREAD_PROGRESS *prog, int idx)
+{
+    mutex_lock(&prog->mutex);
+    while (!prog->flag[idx])
+    {
+        cond_wait(&prog->cond, &prog->mutex);
+    }
+    mutex_unlock(&prog->mutex);
+}
+
+struct _COM_THREAD_QUEUE
+{
+    THREAD_T         thread;
+    MUTEX_T          mutex;
+    COND_T           cond;         /* an item was posted or finished, or the queue is shutting down */
+    COM_THREAD_WORK *work;
+    void           **arg;
+    int              depth;
+    int              head;         /* oldest item, running or pending */
+    int              num;          /* items pending or running */
+    int              quit;
+};
+
+#if defined(WIN32) || defined(WIN64)
+static DWORD WINAPI queue_worker(LPVOID param)
+#else
+static void * queue_worker(void *param)
+#endif
+{
+    COM_THREAD_QUEUE *queue = (COM_THREAD_QUEUE *)param;
+    mutex_lock(&queue->mutex);
+    while (1)
+    {
+        while (!queue->quit && queue->num == 0)
+        {
+            cond_wait(&queue->cond, &queue->mutex);
+        }
+        if (queue->num == 0)
+        {
+            break;
+        }
+        {
+            COM_THREAD_WORK work = queue->work[queue->head];
+            void *arg = queue->arg[queue->head];
+            mutex_unlock(&queue->mutex);
+            work(arg);
+            mutex_lock(&queue->mutex);
+        }
+        queue->head = (queue->head + 1) % queue->depth;
+        queue->num--;
+        cond_broadcast(&queue->cond);
+    }
+    mutex_unlock(&queue->mutex);
+    return 0;
+}
+
+COM_THREAD_QUEUE * com_thread_queue_create(int depth)
+{
+    COM_THREAD_QUEUE *queue;
+    int ok;
+    queue = (COM_THREAD_QUEUE *)com_malloc(sizeof(COM_THREAD_QUEUE));
+    com_assert_rv(queue, NULL);
+    memset(queue, 0, sizeof(COM_THREAD_QUEUE));
+    queue->depth = depth > 0 ? depth : 1;
+    queue->work = (COM_THREAD_WORK *)com_malloc(sizeof(COM_THREAD_WORK) * queue->depth);
+    queue->arg = (void **)com_malloc(sizeof(void *) * queue->depth);
+    if (queue->work == NULL || queue->arg == NULL)
+    {
+        com_mfree(queue->work);
+        com_mfree(queue->arg);
+        com_mfree(queue);
+        return NULL;
+    }
+    mutex_init(&queue->mutex);
+    cond_init(&queue->cond);
+#if defined(WIN32) || defined(WIN64)
+    queue->thread = CreateThread(NULL, 0, queue_worker, queue, 0, NULL);
+    ok = queue->thread != NULL;
+#else
+    ok = !pthread_create(&queue->thread, NULL, queue_worker, queue);
+#endif
+    if (!ok)
+    {
+        cond_destroy(&queue->cond);
+        mutex_destroy(&queue->mutex);
+        com_mfree(queue->work);
+        com_mfree(queue->arg);
+        com_mfree(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+void com_thread_queue_delete(COM_THREAD_QUEUE *queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+    mutex_lock(&queue->mutex);
+    queue->quit = 1;
+    cond_broadcast(&queue->cond);
+    mutex_unlock(&queue->mutex);
+#if defined(WIN32) || defined(WIN64)
+    WaitForSingleObject(queue->thread, INFINITE);
+    CloseHandle(queue->thread);
+#else
+    pthread_join(queue->thread, NULL);
+#endif
+    cond_destroy(&queue->cond);
+    mutex_destroy(&queue->mutex);
+    com_mfree(queue->work);
+    com_mfree(queue->arg);
+    com_mfree(queue);
+}
+
+void com_thread_queue_post(COM_THREAD_QUEUE *queue, COM_THREAD_WORK work, void *arg)
+{
+    int idx;
+    if (queue == NULL)
+    {
+        work(arg);
+        return;
+    }
+    mutex_lock(&queue->mutex);
+    while (queue->num == queue->depth)
+    {
+        cond_wait(&queue->cond, &queue->mutex);
+    }
+    idx = (queue->head + queue->num) % queue->depth;
+    queue->work[idx] = work;
+    queue->arg[idx] = arg;
+    queue->num++;
+    cond_broadcast(&queue->cond);
+    mutex_unlock(&queue->mutex);
+}
+
+void com_thread_queue_wait(COM_THREAD_QUEUE *queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+    mutex_lock(&queue->mutex);
+    while (queue->num > 0)
+    {
+        cond_wait(&queue->cond, &queue->mutex);
+    }
+    mutex_unlock(&queue->mutex);
+}
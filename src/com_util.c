@@ -51,14 +51,293 @@ int fp_trace_counter = 0;
 
 COM_PIC * com_pic_alloc(PICBUF_ALLOCATOR * pa, int * ret)
 {
+#if PIC_BUF_POOL
+    COM_PIC_POOL *pool = pa->pool;
+    while (pool && pool->num > 0)
+    {
+        COM_PIC *pic = pool->pic[--pool->num];
+        if (pic->imgb && pic->imgb->getref(pic->imgb) > 1)
+        {
+            /* the application still holds the planes (addref on an output picture): leave them to it */
+            com_picbuf_free(pic);
+            continue;
+        }
+        if (pic->width_luma == pa->width && pic->height_luma == pa->height && pic->padsize_luma == pa->pad_l && pic->padsize_chroma == pa->pad_c)
+        {
+            /* planes and maps are rewritten by the next picture, only its DPB state starts over */
+            pic->dtr = pic->ptr = 0;
+            pic->picture_output_delay = 0;
+            pic->is_ref = pic->need_for_out = 0;
+            pic->temporal_id = 0;
+            com_mset(pic->list_ptr, 0, sizeof(pic->list_ptr));
+            if (ret)
+            {
+                *ret = COM_OK;
+            }
+            return pic;
+        }
+        /* left from a sequence of another size */
+        com_picbuf_free(pic);
+    }
+#endif
     return com_picbuf_alloc(pa->width, pa->height, pa->pad_l, pa->pad_c, ret);
 }
 
 void com_pic_free(PICBUF_ALLOCATOR *pa, COM_PIC *pic)
 {
+#if PIC_BUF_POOL
+    if (pa->pool && pa->pool->num < MAX_PB_SIZE)
+    {
+        pa->pool->pic[pa->pool->num++] = pic;
+        return;
+    }
+#endif
     com_picbuf_free(pic);
 }
 
+#if PIC_BUF_POOL
+void com_pic_pool_clear(COM_PIC_POOL *pool)
+{
+    while (pool->num > 0)
+    {
+        com_picbuf_free(pool->pic[--pool->num]);
+    }
+}
+#endif
+
+#if SCRATCH_ARENA
+/* arena of the core running on this thread, see com_scratch_bind() */
+static COM_THREAD_LOCAL COM_ARENA *scratch_cur;
+
+int com_arena_create(COM_ARENA *arena, int size)
+{
+    arena->base = (u8 *)com_malloc_align(size, COM_SCRATCH_ALIGN);
+    com_assert_rv(arena->base, COM_ERR_OUT_OF_MEMORY);
+    arena->size = size;
+    arena->used = 0;
+    arena->spill = NULL;
+    return COM_OK;
+}
+
+void com_arena_delete(COM_ARENA *arena)
+{
+    if (scratch_cur == arena)
+    {
+        scratch_cur = NULL;
+    }
+    com_arena_unspill(arena, 0);
+    com_mfree_align(arena->base);
+    arena->size = arena->used = 0;
+}
+
+void * com_arena_alloc(COM_ARENA *arena, int size)
+{
+    int mark = arena->used;
+    size = (size + COM_SCRATCH_ALIGN - 1) & ~(COM_SCRATCH_ALIGN - 1);
+    arena->used += size;
+    if (arena->used <= arena->size)
+    {
+        return arena->base + mark;
+    }
+    /* full: hand out a heap block that com_arena_release() frees again */
+    COM_ARENA_SPILL *spill = (COM_ARENA_SPILL *)com_malloc_align(COM_SCRATCH_ALIGN + size, COM_SCRATCH_ALIGN);
+    com_assert_rv(spill, NULL);
+    spill->mark = mark;
+    spill->next = arena->spill;
+    arena->spill = spill;
+    return (u8 *)spill + COM_SCRATCH_ALIGN;
+}
+
+void com_arena_unspill(COM_ARENA *arena, int mark)
+{
+    while (arena->spill && arena->spill->mark >= mark)
+    {
+        COM_ARENA_SPILL *next = arena->spill->next;
+        com_mfree_align(arena->spill);
+        arena->spill = next;
+    }
+    arena->used = mark;
+}
+
+/* callers take a mark on entry and release it before returning, so nested blocks stack up */
+void com_scratch_bind(COM_ARENA *arena)
+{
+    scratch_cur = arena;
+}
+
+COM_ARENA * com_scratch(void)
+{
+    com_assert(scratch_cur != NULL);
+    return scratch_cur;
+}
+#endif
+
+#if RBSP_SPAN_EXTRACT
+static int rbsp_ctz(unsigned int v)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, v);
+    return (int)index;
+#else
+    return __builtin_ctz(v);
+#endif
+}
+
+/* position of the next byte 0x01 or 0x02 preceded by two zero bytes, size when there is none */
+static int rbsp_next_code(const u8 *src, int pos, int size)
+{
+    if (pos < 2)
+    {
+        pos = 2;
+    }
+#if SIMD_RBSP
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i one = _mm_set1_epi8(1);
+        const __m128i two = _mm_set1_epi8(2);
+        for (; pos + 16 <= size; pos += 16)
+        {
+            __m128i z0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(src + pos - 2)), zero);
+            __m128i z1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(src + pos - 1)), zero);
+            int mask = _mm_movemask_epi8(_mm_and_si128(z0, z1));
+            if (mask)
+            {
+                __m128i c = _mm_loadu_si128((const __m128i *)(src + pos));
+                c = _mm_or_si128(_mm_cmpeq_epi8(c, one), _mm_cmpeq_epi8(c, two));
+                mask &= _mm_movemask_epi8(c);
+                if (mask)
+                {
+                    return pos + rbsp_ctz(mask);
+                }
+            }
+        }
+    }
+#endif
+    for (; pos < size; pos++)
+    {
+        if ((src[pos] == 0x01 || src[pos] == 0x02) && src[pos - 1] == 0x00 && src[pos - 2] == 0x00)
+        {
+            return pos;
+        }
+    }
+    return size;
+}
+
+/* dst[i] = src[i] << bits | src[i + 1] >> (8 - bits) for the n bytes of a span misaligned by an earlier escape,
+   avail bytes of src are readable */
+static void rbsp_shift_copy(const u8 *src, int n, int avail, u8 *dst, int bits)
+{
+    int i = 0;
+#if SIMD_RBSP
+    const __m128i cnt = _mm_cvtsi32_si128(8 - bits);
+    const __m128i mask = _mm_set1_epi16(0xff);
+    for (; i + 16 <= n && i + 17 <= avail; i += 16)
+    {
+        __m128i cur = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i nxt = _mm_loadu_si128((const __m128i *)(src + i + 1));
+        /* 16-bit words cur << 8 | nxt shifted right keep the output byte in their low half */
+        __m128i lo = _mm_and_si128(_mm_srl_epi16(_mm_unpacklo_epi8(nxt, cur), cnt), mask);
+        __m128i hi = _mm_and_si128(_mm_srl_epi16(_mm_unpackhi_epi8(nxt, cur), cnt), mask);
+        _mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < n; i++)
+    {
+        dst[i] = (u8)(src[i] << bits);
+        if (i + 1 < avail)
+        {
+            dst[i] |= src[i + 1] >> (8 - bits);
+        }
+    }
+}
+#endif
+
+/* removes the emulation prevention bits (the 0x02 of every 00 00 02 drops its two low bits and the rest of
+   the payload moves up by two bits until the next start code) of size bytes of src into dst and returns the
+   number of bytes written; src and dst must not overlap */
+int com_rbsp_extract(const u8 *src, int size, u8 *dst)
+{
+    int bits = 0;
+    int rd = 0;
+    int wr = 0;
+#if RBSP_SPAN_EXTRACT
+    while (rd < size)
+    {
+        int code = rbsp_next_code(src, rd, size);
+        if (bits == 0)
+        {
+            memcpy(dst + wr, src + rd, code - rd);
+        }
+        else
+        {
+            rbsp_shift_copy(src + rd, code - rd, size - rd, dst + wr, bits);
+        }
+        wr += code - rd;
+        rd = code;
+        if (rd >= size)
+        {
+            break;
+        }
+        if (src[rd] == 0x02)
+        {
+            bits += 2;
+            if (bits >= 8)
+            {
+                bits = 0;
+                rd++;
+                continue;
+            }
+            dst[wr] = 0;
+        }
+        else
+        {
+            bits = 0;
+            dst[wr] = 0x01;
+        }
+        if (rd + 1 < size)
+        {
+            dst[wr] |= src[rd + 1] >> (8 - bits);
+        }
+        wr++;
+        rd++;
+    }
+#else
+    int zeros = 0;
+    for (; rd < size; rd++)
+    {
+        u8 cur = src[rd];
+        if (zeros >= 2 && cur == 0x02)
+        {
+            dst[wr] = 0;
+            bits += 2;
+            zeros = 0;
+            if (bits >= 8)
+            {
+                bits = 0;
+                continue;
+            }
+        }
+        else if (zeros >= 2 && cur == 0x01)
+        {
+            bits = 0;
+            dst[wr] = cur;
+        }
+        else
+        {
+            dst[wr] = (u8)(cur << bits);
+        }
+        if (rd + 1 < size)
+        {
+            dst[wr] |= src[rd + 1] >> (8 - bits);
+        }
+        wr++;
+        zeros = cur == 0x00 ? zeros + 1 : 0;
+    }
+#endif
+    return wr;
+}
+
 int com_atomic_inc(volatile int *pcnt)
 {
     int ret;
@@ -112,8 +391,13 @@ COM_PIC * com_picbuf_alloc(int width, int height, int pad_l, int pad_c, int *err
     pic->padsize_chroma = pad_c;
     pic->imgb  = imgb;
     /* allocate maps */
+#if COL_MV_COMPRESS
+    pic_width_in_scu = (pic->width_luma + ((1 << COL_MV_LOG2) - 1)) >> COL_MV_LOG2;
+    h_scu = (pic->height_luma + ((1 << COL_MV_LOG2) - 1)) >> COL_MV_LOG2;
+#else
     pic_width_in_scu = (pic->width_luma + ((1 << MIN_CU_LOG2) - 1)) >> MIN_CU_LOG2;
     h_scu = (pic->height_luma + ((1 << MIN_CU_LOG2) - 1)) >> MIN_CU_LOG2;
+#endif
     f_scu = pic_width_in_scu * h_scu;
     size = sizeof(s8) * f_scu * REFP_NUM;
     pic->map_refi = com_malloc_fast(size);
@@ -195,12 +479,13 @@ static void picbuf_expand(pel *a, int s, int width, int height, int exp)
         dst += s;
         src += s;
     }
+    /* upper and below rows span the expanded width only: the left padding of the plane may be wider than exp */
     /* upper */
     src = a - exp;
     dst = a - exp - (exp * s);
     for(i = 0; i < exp; i++)
     {
-        com_mcpy(dst, src, s*sizeof(pel));
+        com_mcpy(dst, src, (width + 2 * exp)*sizeof(pel));
         dst += s;
     }
     /* below */
@@ -208,7 +493,7 @@ static void picbuf_expand(pel *a, int s, int width, int height, int exp)
     dst = a + ((height - 1)*s) - exp + s;
     for(i = 0; i < exp; i++)
     {
-        com_mcpy(dst, src, s*sizeof(pel));
+        com_mcpy(dst, src, (width + 2 * exp)*sizeof(pel));
         dst += s;
     }
 }
@@ -220,8 +505,37 @@ void com_picbuf_expand(COM_PIC *pic, int exp_l, int exp_c)
     picbuf_expand(pic->v, pic->stride_chroma, pic->width_chroma, pic->height_chroma, exp_c);
 }
 
+#if COL_MV_COMPRESS
+/* SCU row or column that represents the 16x16 block containing b in the stored motion field */
+static int col_scu_pos(int b, int num_scu)
+{
+    const int mask = (-1) ^ 3;
+    int pos = (b & mask) + 2;
+    return pos < num_scu ? pos : ((b & mask) + num_scu) >> 1;
+}
+
+void com_col_mv_compress(COM_PIC *pic, s16(*map_mv)[REFP_NUM][MV_D], s8(*map_refi)[REFP_NUM], int pic_width_in_scu, int pic_height_in_scu)
+{
+    int w = (pic_width_in_scu + 3) >> 2;
+    int h = (pic_height_in_scu + 3) >> 2;
+    for (int j = 0; j < h; j++)
+    {
+        int row = col_scu_pos(j << 2, pic_height_in_scu) * pic_width_in_scu;
+        for (int i = 0; i < w; i++)
+        {
+            int scup = row + col_scu_pos(i << 2, pic_width_in_scu);
+            com_mcpy(pic->map_mv[j * w + i], map_mv[scup], sizeof(map_mv[0]));
+            com_mcpy(pic->map_refi[j * w + i], map_refi[scup], sizeof(map_refi[0]));
+        }
+    }
+}
+#endif
+
 int get_colocal_scup(int scup, int pic_width_in_scu, int pic_height_in_scu)
 {
+#if COL_MV_COMPRESS
+    return (scup / pic_width_in_scu >> 2) * ((pic_width_in_scu + 3) >> 2) + (scup % pic_width_in_scu >> 2);
+#else
     const int mask = (-1) ^ 3;
     int bx = scup % pic_width_in_scu;
     int by = scup / pic_width_in_scu;
@@ -238,13 +552,13 @@ int get_colocal_scup(int scup, int pic_width_in_scu, int pic_height_in_scu)
     }
 
     return ypos * pic_width_in_scu + xpos;
+#endif
 }
 
 
 #if AWP
 int get_rb_scup(int scup, int pic_width_in_scu, int pic_height_in_scu, int cu_width, int cu_height, int max_cuwh)
 {
-    const int mask = (-1) ^ 3;
     int bx = scup % pic_width_in_scu + (cu_width >> 2);
     int by = scup / pic_width_in_scu + (cu_height >> 2);
     int tempX = scup % pic_width_in_scu;
@@ -258,7 +572,10 @@ int get_rb_scup(int scup, int pic_width_in_scu, int pic_height_in_scu, int cu_wi
     {
         by = by - 1;
     }
-
+#if COL_MV_COMPRESS
+    return (by >> 2) * ((pic_width_in_scu + 3) >> 2) + (bx >> 2);
+#else
+    const int mask = (-1) ^ 3;
     int xpos = (bx & mask) + 2;
     int ypos = (by & mask) + 2;
 
@@ -271,6 +588,7 @@ int get_rb_scup(int scup, int pic_width_in_scu, int pic_height_in_scu, int cu_wi
         xpos = ((bx & mask) + pic_width_in_scu) >> 1;
     }
     return ypos * pic_width_in_scu + xpos;
+#endif
 }
 
 #endif // AWP
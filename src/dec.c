@@ -75,14 +75,141 @@ static DEC_CORE * core_alloc(void)
     core = (DEC_CORE*)com_malloc_fast(sizeof(DEC_CORE));
     com_assert_rv(core, NULL);
     com_mset_x64a(core, 0, sizeof(DEC_CORE));
+#if SCRATCH_ARENA
+    if (com_arena_create(&core->scratch, COM_SCRATCH_SIZE))
+    {
+        com_mfree_fast(core);
+        return NULL;
+    }
+#endif
+#if TM_COST_CACHE
+    core->tm_cache = com_tm_cache_create();
+    if (core->tm_cache == NULL)
+    {
+#if SCRATCH_ARENA
+        com_arena_delete(&core->scratch);
+#endif
+        com_mfree_fast(core);
+        return NULL;
+    }
+#endif
+#if PADLESS_REF
+    core->ref_win = com_ref_win_create();
+    if (core->ref_win == NULL)
+    {
+#if SCRATCH_ARENA
+        com_arena_delete(&core->scratch);
+#endif
+#if TM_COST_CACHE
+        com_tm_cache_delete(core->tm_cache);
+#endif
+        com_mfree_fast(core);
+        return NULL;
+    }
+#endif
     return core;
 }
 
 static void core_free(DEC_CORE * core)
 {
+#if SCRATCH_ARENA
+    com_arena_delete(&core->scratch);
+#endif
+#if TM_COST_CACHE
+    com_tm_cache_delete(core->tm_cache);
+#endif
+#if PADLESS_REF
+    com_ref_win_delete(core->ref_win);
+#endif
     com_mfree_fast(core);
 }
 
+#if LF_CTU_PIPELINE
+/* lines kept above and below the LCU row in each in-loop filter band (in lines of the plane) */
+#define LF_BAND_DBK_TOP                    8 // SAO writes 4 lines above the row, ALF chroma reads 5
+#define LF_BAND_DBK_BOT                    4
+#define LF_BAND_ESAO_TOP                   2
+#define LF_BAND_ESAO_BOT                   2
+#define LF_BAND_ALF_TOP                    8
+
+static void lf_band_free(DEC_LF_BAND *band)
+{
+    int i;
+    for (i = 0; i < N_C; i++)
+    {
+        com_mfree(band->buf[i]);
+        band->stride[i] = band->lines[i] = 0;
+        band->y0[i] = band->y1[i] = 0;
+    }
+}
+
+static int lf_band_alloc(DEC_LF_BAND *band, COM_PIC *pic, int lcu_size, int top, int bot)
+{
+    int i, size;
+    for (i = 0; i < N_C; i++)
+    {
+        int stride = i ? pic->stride_chroma : pic->stride_luma;
+        int lines = (i ? (lcu_size >> 1) : lcu_size) + top + bot;
+        band->y0[i] = band->y1[i] = 0;
+        if (band->buf[i] != NULL && band->stride[i] == stride && band->lines[i] >= lines)
+        {
+            continue;
+        }
+        com_mfree(band->buf[i]);
+        /* one more line for the zeroed tail of the last line */
+        size = sizeof(pel) * stride * (lines + 1);
+        band->buf[i] = (pel *)com_malloc(size);
+        com_assert_rv(band->buf[i] != NULL, COM_ERR_OUT_OF_MEMORY);
+        com_mset(band->buf[i], 0, size);
+        band->stride[i] = stride;
+        band->lines[i] = lines;
+    }
+    return COM_OK;
+}
+
+/* load the lines of LCU row lcu_y plus margins; lines still held by prev are taken from
+   there because the picture has already been filtered in place on them */
+static void lf_band_fill_row(DEC_LF_BAND *band, DEC_LF_BAND *prev, COM_PIC *pic, int lcu_y, int lcu_size, int top, int bot)
+{
+    int i, y, y0, y1;
+    for (i = 0; i < N_C; i++)
+    {
+        int size = i ? (lcu_size >> 1) : lcu_size;
+        int height = i ? pic->height_chroma : pic->height_luma;
+        int width = i ? pic->width_chroma : pic->width_luma;
+        int pad = i ? pic->padsize_chroma : pic->padsize_luma;
+        int stride = i ? pic->stride_chroma : pic->stride_luma;
+        pel *src = i == Y_C ? pic->y : (i == U_C ? pic->u : pic->v);
+        pel *dst = band->buf[i] + pad;
+        y0 = COM_MAX(0, lcu_y * size - top);
+        y1 = COM_MIN(height, (lcu_y + 1) * size + bot);
+        assert(stride == band->stride[i] && y1 - y0 <= band->lines[i]);
+        y = y0;
+        if (prev->y0[i] <= y0 && prev->y1[i] > y0)
+        {
+            y = COM_MIN(y1, prev->y1[i]);
+            memmove(dst, prev->buf[i] + pad + (y0 - prev->y0[i]) * stride, sizeof(pel) * stride * (y - y0));
+        }
+        for (; y < y1; y++)
+        {
+            com_mcpy(dst + (y - y0) * stride, src + y * stride, sizeof(pel) * width);
+            com_mset(dst + (y - y0) * stride + width, 0, sizeof(pel) * (stride - width));
+        }
+        band->y0[i] = y0;
+        band->y1[i] = y1;
+    }
+}
+
+/* picture whose planes address the band lines at their picture coordinates */
+static void lf_band_view(COM_PIC *view, COM_PIC *pic, DEC_LF_BAND *band)
+{
+    *view = *pic;
+    view->y = band->buf[Y_C] + pic->padsize_luma - band->y0[Y_C] * band->stride[Y_C];
+    view->u = band->buf[U_C] + pic->padsize_chroma - band->y0[U_C] * band->stride[U_C];
+    view->v = band->buf[V_C] + pic->padsize_chroma - band->y0[V_C] * band->stride[V_C];
+}
+#endif
+
 #if AWP_ENH
 void dec_delete_awp_bufs(DEC_CTX* ctx)
 {
@@ -127,6 +254,18 @@ static void sequence_deinit(DEC_CTX * ctx)
         com_mfree( ctx->map.map_split );
         ctx->map.map_split = NULL;
     }
+#if COL_MV_COMPRESS
+    if( ctx->map.map_mv )
+    {
+        com_mfree( ctx->map.map_mv );
+        ctx->map.map_mv = NULL;
+    }
+    if( ctx->map.map_refi )
+    {
+        com_mfree( ctx->map.map_refi );
+        ctx->map.map_refi = NULL;
+    }
+#endif
     if( ctx->map.map_ipm )
     {
         com_mfree( ctx->map.map_ipm );
@@ -161,7 +300,12 @@ static void sequence_deinit(DEC_CTX * ctx)
         ctx->map.map_usp = NULL;
     }
 #endif
+#if DBK_EDGE_BITMAP
+    delete_edge_filter_avs2(ctx->edge_filter);
+    ctx->edge_filter = NULL;
+#else
     delete_edge_filter_avs2(ctx->edge_filter, ctx->info.pic_height);
+#endif
 
     if( ctx->pic_sao )
     {
@@ -241,6 +385,12 @@ static void sequence_deinit(DEC_CTX * ctx)
         com_picbuf_free(ctx->pic_alf_Dec);
         ctx->pic_alf_Dec = NULL;
     }
+#if LF_CTU_PIPELINE
+    lf_band_free(&ctx->lf_band_dbk[0]);
+    lf_band_free(&ctx->lf_band_dbk[1]);
+    lf_band_free(&ctx->lf_band_esao);
+    lf_band_free(&ctx->lf_band_alf);
+#endif
     release_alf_global_buffer(ctx);
     ctx->info.pic_header.pic_alf_on = NULL;
     ctx->info.pic_header.alf_picture_param = NULL;
@@ -333,6 +483,23 @@ static int sequence_init(DEC_CTX * ctx, COM_SQH * sqh)
         com_assert_gv(ctx->map.map_scu, ret, COM_ERR_OUT_OF_MEMORY, ERR);
         com_mset_x64a(ctx->map.map_scu, 0, size);
     }
+#if COL_MV_COMPRESS
+    /* alloc motion maps of the picture being decoded */
+    if (ctx->map.map_mv == NULL)
+    {
+        size = sizeof(s16) * ctx->info.f_scu * REFP_NUM * MV_D;
+        ctx->map.map_mv = com_malloc(size);
+        com_assert_gv(ctx->map.map_mv, ret, COM_ERR_OUT_OF_MEMORY, ERR);
+        com_mset_x64a(ctx->map.map_mv, 0, size);
+    }
+    if (ctx->map.map_refi == NULL)
+    {
+        size = sizeof(s8) * ctx->info.f_scu * REFP_NUM;
+        ctx->map.map_refi = com_malloc(size);
+        com_assert_gv(ctx->map.map_refi, ret, COM_ERR_OUT_OF_MEMORY, ERR);
+        com_mset_x64a(ctx->map.map_refi, -1, size);
+    }
+#endif
     /* alloc cu mode SCU map */
     if (ctx->map.map_cu_mode == NULL)
     {
@@ -398,18 +565,35 @@ static int sequence_init(DEC_CTX * ctx, COM_SQH * sqh)
 
     ctx->pa.width = ctx->info.pic_width;
     ctx->pa.height = ctx->info.pic_height;
+#if PIC_BUF_POOL
+    ctx->pa.pool = &ctx->pic_pool;
+#endif
+#if PADLESS_REF
+    /* MC fetches the samples outside the picture through com_ref_window() */
+    ctx->pa.pad_l = 0;
+    ctx->pa.pad_c = 0;
+#else
     ctx->pa.pad_l = PIC_PAD_SIZE_L;
     ctx->pa.pad_c = PIC_PAD_SIZE_C;
+#endif
     ret = com_picman_init(&ctx->dpm, sqh->max_dpb_size, MAX_NUM_REF_PICS, &ctx->pa);
     com_assert_g(COM_SUCCEEDED(ret), ERR);
 
+#if DBK_EDGE_BITMAP
+    delete_edge_filter_avs2(ctx->edge_filter);
+    ctx->edge_filter = create_edge_filter_avs2(ctx->info.pic_width, ctx->info.pic_height);
+    com_assert_gv(ctx->edge_filter, ret, COM_ERR_OUT_OF_MEMORY, ERR);
+#else
     create_edge_filter_avs2(ctx->info.pic_width, ctx->info.pic_height, ctx->edge_filter);
+#endif
 
+#if !LF_CTU_PIPELINE
     if (ctx->pic_sao == NULL)
     {
         ctx->pic_sao = com_pic_alloc(&ctx->pa, &ret);
         com_assert_rv(ctx->pic_sao != NULL, ret);
     }
+#endif
 
     com_malloc_3d_sao_stat_data(&(ctx->sao_stat_data),
                               ((ctx->info.pic_width >> ctx->info.log2_max_cuwh) + (ctx->info.pic_width % (1 << ctx->info.log2_max_cuwh) ? 1 : 0)) * ((
@@ -421,11 +605,13 @@ static int sequence_init(DEC_CTX * ctx, COM_SQH * sqh)
                                ((ctx->info.pic_width >> ctx->info.log2_max_cuwh) + (ctx->info.pic_width % (1 << ctx->info.log2_max_cuwh) ? 1 : 0)) * ((
                                            ctx->info.pic_height >> ctx->info.log2_max_cuwh) + (ctx->info.pic_height % (1 << ctx->info.log2_max_cuwh) ? 1 : 0)), N_C);
 #if ESAO
+#if !LF_CTU_PIPELINE
     if (ctx->pic_esao == NULL)
     {
         ctx->pic_esao = com_pic_alloc(&ctx->pa, &ret);
         com_assert_rv(ctx->pic_esao != NULL, ret);
     }
+#endif
 #if ESAO_PH_SYNTAX
     if (ctx->info.pic_header.pic_esao_params == NULL)
     {
@@ -441,6 +627,7 @@ static int sequence_init(DEC_CTX * ctx, COM_SQH * sqh)
 #endif
 #endif
 #if CCSAO
+#if !LF_CTU_PIPELINE
 #if CCSAO_ENHANCEMENT
     if (ctx->pic_ccsao[0] == NULL)
     {
@@ -459,6 +646,7 @@ static int sequence_init(DEC_CTX * ctx, COM_SQH * sqh)
         com_assert_rv(ctx->pic_ccsao != NULL, ret);
     }
 #endif
+#endif
 #if CCSAO_PH_SYNTAX
     if (ctx->info.pic_header.pic_ccsao_params==NULL)
     {
@@ -480,11 +668,13 @@ static int sequence_init(DEC_CTX * ctx, COM_SQH * sqh)
         ctx->pic_alf_Rec = com_pic_alloc(&ctx->pa, &ret);
         com_assert_rv(ctx->pic_alf_Rec != NULL, ret);
     }
+#if !LF_CTU_PIPELINE
     if (ctx->pic_alf_Dec == NULL)
     {
         ctx->pic_alf_Dec = com_pic_alloc(&ctx->pa, &ret);
         com_assert_rv(ctx->pic_alf_Dec != NULL, ret);
     }
+#endif
     create_alf_global_buffer(ctx);
     ctx->info.pic_header.pic_alf_on = ctx->pic_alf_on;
     ctx->info.pic_header.alf_picture_param = ctx->dec_alf->alf_picture_param;
@@ -1312,6 +1502,7 @@ static int dec_eco_unit(DEC_CTX * ctx, DEC_CORE * core, int x, int y, int cu_wid
         if (mod_info_curr->tm_flag)
         {
             BOOL is_simplified = ctx->info.sqh.tm_enable_flag == 1 ? 0 : 1;
+            /* the TM cache still holds the candidate costs of pre_evaluation_cands() in dec_decode_cu() */
             com_tm_process(x, y, ctx->info.pic_width, ctx->info.pic_height, cu_width, cu_height, ctx->refp, mod_info_curr->refi, mod_info_curr->init_mv, mod_info_curr->mv, ctx->pic->y, ctx->pic->stride_luma, bit_depth, is_simplified);
         }
 #endif
@@ -2336,16 +2527,26 @@ ERR:
 
 int dec_deblock_avs2(DEC_CTX * ctx)
 {
+#if !DBK_EDGE_BITMAP
     clear_edge_filter_avs2(0, 0, ctx->pic->width_luma, ctx->pic->height_luma, ctx->edge_filter);
     set_edge_filter_avs2(&ctx->info, &ctx->map, ctx->pic, ctx->edge_filter);
-    deblock_frame_avs2(&ctx->info, &ctx->map, ctx->pic, ctx->refp, ctx->edge_filter);
+#endif
+    deblock_frame_avs2(&ctx->info, &ctx->map, ctx->pic, ctx->refp, ctx->edge_filter
+#if LF_ROW_PARALLEL
+        , ctx->pool
+#endif
+    );
     return COM_OK;
 }
 
 int dec_sao_avs2(DEC_CTX * ctx)
 {
     copy_frame_for_sao(ctx->pic_sao, ctx->pic);
-    sao_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_sao, ctx->rec_sao_blk_params);
+    sao_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_sao, ctx->rec_sao_blk_params
+#if LF_ROW_PARALLEL
+        , ctx->pool
+#endif
+    );
     return COM_OK;
 }
 
@@ -2481,9 +2682,17 @@ int  dec_esao(DEC_CTX * ctx)
     {
         copy_frame_for_esao(ctx->pic_esao, ctx->pic);
 #if ESAO_PH_SYNTAX
-        esao_on_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_esao, ctx->info.pic_header.pic_esao_params,&ctx->func_esao_block_filter);
+        esao_on_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_esao, ctx->info.pic_header.pic_esao_params,&ctx->func_esao_block_filter
+#if LF_ROW_PARALLEL
+            , ctx->pool
+#endif
+        );
 #else
-        esao_on_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_esao, ctx->pic_esao_params,&ctx->func_esao_block_filter);
+        esao_on_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_esao, ctx->pic_esao_params,&ctx->func_esao_block_filter
+#if LF_ROW_PARALLEL
+            , ctx->pool
+#endif
+        );
 #endif
     }
     return COM_OK;
@@ -2503,9 +2712,17 @@ int dec_ccsao(DEC_CTX *ctx)
         copy_frame_for_ccsao(ctx->pic_ccsao, ctx->pic, V_C);
 #endif
 #if CCSAO_PH_SYNTAX
-        ccsao_on_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_ccsao, ctx->info.pic_header.pic_ccsao_params, &ctx->ccsao_func_ptr);
+        ccsao_on_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_ccsao, ctx->info.pic_header.pic_ccsao_params, &ctx->ccsao_func_ptr
+#if LF_ROW_PARALLEL
+            , ctx->pool
+#endif
+        );
 #else
-        ccsao_on_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_ccsao, ctx->pic_ccsao_params, &ctx->ccsao_func_ptr);
+        ccsao_on_frame(&ctx->info, &ctx->map, ctx->pic, ctx->pic_ccsao, ctx->pic_ccsao_params, &ctx->ccsao_func_ptr
+#if LF_ROW_PARALLEL
+            , ctx->pool
+#endif
+        );
 #endif
     }
     return COM_OK;
@@ -2521,11 +2738,165 @@ int dec_alf_avs2(DEC_CTX * ctx, COM_PIC *pic_rec)
         ctx->pic_alf_Dec->stride_luma = pic_rec->stride_luma;
         ctx->pic_alf_Dec->stride_chroma = pic_rec->stride_chroma;
         copy_frame_for_alf(ctx->pic_alf_Dec, pic_rec);
-        alf_process_dec(ctx, ctx->dec_alf->alf_picture_param, pic_rec, ctx->pic_alf_Dec);
+        alf_process_dec(ctx, ctx->dec_alf->alf_picture_param, pic_rec, ctx->pic_alf_Dec
+#if LF_ROW_PARALLEL
+            , ctx->pool
+#endif
+        );
     }
     return COM_OK;
 }
 
+#if LF_CTU_PIPELINE
+/* deblock, SAO, ESAO, CCSAO and ALF of the decoded picture, LCU row by LCU row. At step r row r is
+   deblocked, row r-1 is SAO filtered and row r-2 goes through ESAO, CCSAO and ALF, so every stage
+   finds the lines it reads around its row already final in the previous stage. Each stage filters
+   ctx->pic in place and reads its input from a band holding only the lines of its row plus margins */
+int dec_loop_filter_lcu_rows(DEC_CTX *ctx)
+{
+    COM_PIC *pic = ctx->pic;
+    COM_PIC  view;
+    int      lcu_size = 1 << ctx->info.log2_max_cuwh;
+    int      num_rows = ctx->info.pic_height_in_lcu;
+    int      dbk_on = ctx->info.pic_header.loop_filter_disable_flag == 0;
+    int      sao_on = ctx->info.sqh.sample_adaptive_offset_enable_flag;
+    int      esao_on = 0, ccsao_on = 0, alf_on;
+    int      r, k, ret;
+#if ESAO
+    esao_on = ctx->info.sqh.esao_enable_flag &&
+              (ctx->info.pic_header.pic_esao_on[Y_C] || ctx->info.pic_header.pic_esao_on[U_C] || ctx->info.pic_header.pic_esao_on[V_C]);
+#endif
+#if CCSAO
+    ccsao_on = ctx->info.sqh.ccsao_enable_flag &&
+               (ctx->info.pic_header.pic_ccsao_on[U_C-1] || ctx->info.pic_header.pic_ccsao_on[V_C-1]);
+#endif
+    alf_on = ctx->info.sqh.adaptive_leveling_filter_enable_flag &&
+             !(ctx->dec_alf->alf_picture_param[Y_C]->alf_flag == 0 &&
+               ctx->dec_alf->alf_picture_param[U_C]->alf_flag == 0 && ctx->dec_alf->alf_picture_param[V_C]->alf_flag == 0);
+
+#if !DBK_EDGE_BITMAP
+    if (dbk_on)
+    {
+        clear_edge_filter_avs2(0, 0, pic->width_luma, pic->height_luma, ctx->edge_filter);
+        set_edge_filter_avs2(&ctx->info, &ctx->map, pic, ctx->edge_filter);
+    }
+#endif
+    if (sao_on || ccsao_on)
+    {
+        ret = lf_band_alloc(&ctx->lf_band_dbk[0], pic, lcu_size, LF_BAND_DBK_TOP, LF_BAND_DBK_BOT);
+        com_assert_rv(ret == COM_OK, ret);
+        ret = lf_band_alloc(&ctx->lf_band_dbk[1], pic, lcu_size, LF_BAND_DBK_TOP, LF_BAND_DBK_BOT);
+        com_assert_rv(ret == COM_OK, ret);
+    }
+#if ESAO
+    if (esao_on)
+    {
+        ret = lf_band_alloc(&ctx->lf_band_esao, pic, lcu_size, LF_BAND_ESAO_TOP, LF_BAND_ESAO_BOT);
+        com_assert_rv(ret == COM_OK, ret);
+        decide_esao_filter_func_pointer(&ctx->func_esao_block_filter);
+    }
+#endif
+#if CCSAO
+    if (ccsao_on)
+    {
+        decide_ccsao_func_pointer(&ctx->ccsao_func_ptr);
+    }
+#endif
+    if (alf_on)
+    {
+        ret = lf_band_alloc(&ctx->lf_band_alf, pic, lcu_size, LF_BAND_ALF_TOP, 0);
+        com_assert_rv(ret == COM_OK, ret);
+    }
+
+    for (r = 0; r < num_rows + 2; r++)
+    {
+        if (dbk_on && r < num_rows)
+        {
+            deblock_lcu_row_avs2(&ctx->info, &ctx->map, pic, ctx->refp, ctx->edge_filter, r
+#if LF_ROW_PARALLEL
+                , ctx->pool
+#endif
+            );
+        }
+        k = r - 1;
+        if ((sao_on || ccsao_on) && k >= 0 && k < num_rows)
+        {
+            /* the band of row k-1 stays alive for CCSAO of row k-1 in this step */
+            lf_band_fill_row(&ctx->lf_band_dbk[k & 1], &ctx->lf_band_dbk[(k + 1) & 1], pic, k, lcu_size, LF_BAND_DBK_TOP, LF_BAND_DBK_BOT);
+            if (sao_on)
+            {
+                lf_band_view(&view, pic, &ctx->lf_band_dbk[k & 1]);
+                sao_lcu_row(&ctx->info, &ctx->map, pic, &view, ctx->rec_sao_blk_params, k
+#if LF_ROW_PARALLEL
+                    , ctx->pool
+#endif
+                );
+            }
+        }
+        k = r - 2;
+        if (k < 0 || k >= num_rows)
+        {
+            continue;
+        }
+#if ESAO
+        if (esao_on)
+        {
+            lf_band_fill_row(&ctx->lf_band_esao, &ctx->lf_band_esao, pic, k, lcu_size, LF_BAND_ESAO_TOP, LF_BAND_ESAO_BOT);
+            lf_band_view(&view, pic, &ctx->lf_band_esao);
+#if ESAO_PH_SYNTAX
+            esao_on_lcu_row(&ctx->info, &ctx->map, pic, &view, ctx->info.pic_header.pic_esao_params, &ctx->func_esao_block_filter, k
+#if LF_ROW_PARALLEL
+                , ctx->pool
+#endif
+            );
+#else
+            esao_on_lcu_row(&ctx->info, &ctx->map, pic, &view, ctx->pic_esao_params, &ctx->func_esao_block_filter, k
+#if LF_ROW_PARALLEL
+                , ctx->pool
+#endif
+            );
+#endif
+        }
+#endif
+#if CCSAO
+        if (ccsao_on)
+        {
+#if CCSAO_ENHANCEMENT
+            COM_PIC *pic_ccsao[2] = { &view, NULL };
+#else
+            COM_PIC *pic_ccsao = &view;
+#endif
+            lf_band_view(&view, pic, &ctx->lf_band_dbk[k & 1]);
+#if CCSAO_PH_SYNTAX
+            ccsao_on_lcu_row(&ctx->info, &ctx->map, pic, pic_ccsao, ctx->info.pic_header.pic_ccsao_params, &ctx->ccsao_func_ptr, k
+#if LF_ROW_PARALLEL
+                , ctx->pool
+#endif
+            );
+#else
+            ccsao_on_lcu_row(&ctx->info, &ctx->map, pic, pic_ccsao, ctx->pic_ccsao_params, &ctx->ccsao_func_ptr, k
+#if LF_ROW_PARALLEL
+                , ctx->pool
+#endif
+            );
+#endif
+        }
+#endif
+        if (alf_on)
+        {
+            lf_band_fill_row(&ctx->lf_band_alf, &ctx->lf_band_alf, pic, k, lcu_size, LF_BAND_ALF_TOP, 0);
+            lf_band_view(&view, pic, &ctx->lf_band_alf);
+            alf_process_dec_lcu_row(ctx, ctx->dec_alf->alf_picture_param, pic, &view, k
+#if LF_ROW_PARALLEL
+                , ctx->pool
+#endif
+            );
+        }
+    }
+    return COM_OK;
+}
+#endif
+
 int dec_pic(DEC_CTX * ctx, DEC_CORE * core, COM_SQH *sqh, COM_PIC_HEADER * ph, COM_SH_EXT * shext)
 {
     COM_BSR   * bs;
@@ -2562,6 +2933,15 @@ int dec_pic(DEC_CTX * ctx, DEC_CORE * core, COM_SQH *sqh, COM_PIC_HEADER * ph, C
     com_mset_x64a(ctx->map.map_refi, -1, size);
     size = sizeof(s16) * ctx->info.f_scu * REFP_NUM * MV_D;
     com_mset_x64a(ctx->map.map_mv, 0, size);
+#if SCRATCH_ARENA
+    com_scratch_bind(&core->scratch);
+#endif
+#if TM_COST_CACHE
+    com_tm_cache_bind(core->tm_cache);
+#endif
+#if PADLESS_REF
+    com_ref_win_bind(core->ref_win);
+#endif
     bs = &ctx->bs;
     sbac = GET_SBAC_DEC(bs);
     /* reset SBAC */
@@ -2597,6 +2977,9 @@ int dec_pic(DEC_CTX * ctx, DEC_CORE * core, COM_SQH *sqh, COM_PIC_HEADER * ph, C
     {
         int lcu_qp;
         int adj_qp_cb, adj_qp_cr;
+#if SCRATCH_ARENA
+        com_arena_release(&core->scratch, 0);
+#endif
 #if PATCH
         /*set patch idx*/
         if (patch_cur_index != patch->idx)
@@ -2795,11 +3178,23 @@ int dec_pic(DEC_CTX * ctx, DEC_CORE * core, COM_SQH *sqh, COM_PIC_HEADER * ph, C
         ret = dec_eco_tree(ctx, core, core->x_pel, core->y_pel, ctx->info.log2_max_cuwh, ctx->info.log2_max_cuwh, 0, 0, bs, sbac
                            , NO_SPLIT, 0, 0, NO_MODE_CONS, TREE_LC);
         com_assert_g(COM_SUCCEEDED(ret), ERR);
+#if PADLESS_REF
+        ret = com_ref_win_status(core->ref_win);
+        com_assert_g(COM_SUCCEEDED(ret), ERR);
+#endif
         /* set split flags to map */
 #if CTU_256
         com_mcpy(ctx->map.map_split[core->lcu_num], core->split_mode, sizeof(s8) * MAX_CU_DEPTH2 * NUM_BLOCK_SHAPE * MAX_CU_CNT_IN_LCU);
 #else
         com_mcpy(ctx->map.map_split[core->lcu_num], core->split_mode, sizeof(s8) * MAX_CU_DEPTH * NUM_BLOCK_SHAPE * MAX_CU_CNT_IN_LCU);
+#endif
+#if DBK_EDGE_BITMAP
+        if (!ctx->info.pic_header.loop_filter_disable_flag)
+        {
+            /* record the deblocking edges of the LCU while its split tree is still in cache */
+            clear_edge_filter_avs2(core->x_pel, core->y_pel, ctx->info.max_cuwh, ctx->info.max_cuwh, ctx->edge_filter);
+            set_edge_filter_one_scu_avs2(&ctx->info, &ctx->map, ctx->pic, ctx->edge_filter, core->x_pel, core->y_pel, ctx->info.max_cuwh, ctx->info.max_cuwh, 0, 0, 1);
+        }
 #endif
         /* read end_of_picture_flag */
 #if PATCH
@@ -3086,6 +3481,9 @@ int dec_ready(DEC_CTX *ctx)
     core = core_alloc();
     com_assert_gv(core != NULL, ret, COM_ERR_OUT_OF_MEMORY, ERR);
     ctx->core = core;
+#if LF_ROW_PARALLEL
+    ctx->pool = com_thread_pool_create(ctx->cdsc.threads);
+#endif
     return COM_OK;
 ERR:
     if (core)
@@ -3102,6 +3500,10 @@ void dec_flush(DEC_CTX * ctx)
         core_free(ctx->core);
         ctx->core = NULL;
     }
+#if LF_ROW_PARALLEL
+    com_thread_pool_delete(ctx->pool);
+    ctx->pool = NULL;
+#endif
 }
 
 int dec_cnk(DEC_CTX * ctx, COM_BITB * bitb, DEC_STAT * stat)
@@ -3250,12 +3652,19 @@ int dec_cnk(DEC_CTX * ctx, COM_BITB * bitb, DEC_STAT * stat)
         /* get available frame buffer for decoded image */
         ctx->pic = com_picman_get_empty_pic(&ctx->dpm, &ret);
         com_assert_rv(ctx->pic, ret);
+#if !COL_MV_COMPRESS
         /* get available frame buffer for decoded image */
         ctx->map.map_refi = ctx->pic->map_refi;
         ctx->map.map_mv = ctx->pic->map_mv;
+#endif
         /* decode slice layer */
         ret = dec_pic(ctx, ctx->core, sqh, pic_header, shext);
         com_assert_rv(COM_SUCCEEDED(ret), ret);
+#if LF_CTU_PIPELINE
+        /* in-loop filters */
+        ret = dec_loop_filter_lcu_rows(ctx);
+        com_assert_rv(COM_SUCCEEDED(ret), ret);
+#else
         /* deblocking filter */
         if (ctx->info.pic_header.loop_filter_disable_flag == 0)
         {
@@ -3302,6 +3711,7 @@ int dec_cnk(DEC_CTX * ctx, COM_BITB * bitb, DEC_STAT * stat)
             ret = dec_alf_avs2(ctx, ctx->pic);
             com_assert_rv(COM_SUCCEEDED(ret), ret);
         }
+#endif
         /* MD5 check for testing encoder-decoder match*/
         if (ctx->use_pic_sign && ctx->pic_sign_exist)
         {
@@ -3309,9 +3719,12 @@ int dec_cnk(DEC_CTX * ctx, COM_BITB * bitb, DEC_STAT * stat)
             com_assert_rv(COM_SUCCEEDED(ret), ret);
             ctx->pic_sign_exist = 0; /* reset flag */
         }
-#if PIC_PAD_SIZE_L > 0
+#if PIC_PAD_SIZE_L > 0 && !PADLESS_REF
         /* expand pixels to padding area */
         dec_picbuf_expand(ctx, ctx->pic);
+#endif
+#if COL_MV_COMPRESS
+        com_col_mv_compress(ctx->pic, ctx->map.map_mv, ctx->map.map_refi, ctx->info.pic_width_in_scu, ctx->info.pic_height_in_scu);
 #endif
         /* put decoded picture to DPB */
 #if LIBVC_ON
@@ -3523,6 +3936,9 @@ void dec_delete(DEC id)
     DEC_CTX *ctx;
     DEC_ID_TO_CTX_R(id, ctx);
     sequence_deinit(ctx);
+#if PIC_BUF_POOL
+    com_pic_pool_clear(&ctx->pic_pool);
+#endif
 #if LIBVC_ON
     ctx->dpm.libvc_data = NULL;
 #endif
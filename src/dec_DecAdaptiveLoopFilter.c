@@ -35,6 +35,156 @@
 
 #define Clip_post(high,val) ((val > high)? high: val)
 
+#if LF_CTU_PIPELINE
+#if LF_ROW_PARALLEL
+typedef struct _ALF_DEC_JOB
+{
+    DEC_CTX    *ctx;
+    ALF_PARAM **alf_param;
+    COM_PIC    *pic_rec;
+    COM_PIC    *pic_dec;
+    int         lcu_y;
+} ALF_DEC_JOB;
+#endif
+
+/*
+*************************************************************************
+* Function: ALF decoding process of one LCU
+* Input:
+*         ctx  : CONTEXT used for decoding process
+*     pic_rec  : picture of the the ALF input image
+*     pic_dec  : picture of the the ALF reconstructed image
+*       lcu_y  : LCU row index
+*       lcu_x  : LCU column index
+*************************************************************************
+*/
+static void alf_process_dec_lcu(DEC_CTX* ctx, ALF_PARAM **alf_param, COM_PIC* pic_rec, COM_PIC* pic_dec, int lcu_y, int lcu_x)
+{
+    int bit_depth = ctx->info.bit_depth_internal;
+    int  lcu_idx, num_lcu_in_pic_width, num_lcu_in_pic_height;
+    int  lcu_y_pos, lcu_x_pos, lcu_height, lcu_width;
+    int  comp_idx, img_height, img_width;
+    BOOL is_left_avail, is_right_avail, is_above_avail, is_below_avail;
+    BOOL is_above_left_avail, is_above_right_avail;
+    lcu_height = 1 << ctx->info.log2_max_cuwh;
+    lcu_width  = lcu_height;
+    img_height = ctx->info.pic_height;
+    img_width  = ctx->info.pic_width;
+    num_lcu_in_pic_width  = img_width / lcu_width;
+    num_lcu_in_pic_height = img_height / lcu_height;
+    num_lcu_in_pic_width  += (img_width % lcu_width) ? 1 : 0;
+    num_lcu_in_pic_height += (img_height % lcu_height) ? 1 : 0;
+#if ALF_SHAPE || ALF_IMP || ALF_SHIFT
+    BOOL alf_enhance_flag = ctx->info.sqh.adaptive_leveling_filter_enhance_flag;
+#endif
+    lcu_idx = lcu_y * num_lcu_in_pic_width + lcu_x;
+    lcu_y_pos = lcu_y * lcu_height;
+    lcu_x_pos = lcu_x * lcu_width;
+    int cur_lcu_height = (lcu_y_pos + lcu_height > img_height) ? (img_height - lcu_y_pos) : lcu_height;
+    int cur_lcu_width = (lcu_x_pos + lcu_width  > img_width) ? (img_width - lcu_x_pos) : lcu_width;
+    //derive CTU boundary availabilities
+    derive_boundary_avail(ctx, num_lcu_in_pic_width, num_lcu_in_pic_height, lcu_idx, &is_left_avail, &is_right_avail, &is_above_avail,
+                        &is_below_avail, &is_above_left_avail, &is_above_right_avail);
+    for (comp_idx = 0; comp_idx < N_C; comp_idx++)
+    {
+        if (!ctx->dec_alf->alf_lcu_enabled[lcu_idx][comp_idx])
+        {
+            continue;
+        }
+        filter_one_ctb(ctx->dec_alf, comp_idx == Y_C ? pic_rec->y : (comp_idx == U_C ? pic_rec->u : pic_rec->v)
+                     , comp_idx == Y_C ? pic_dec->y : (comp_idx == U_C ? pic_dec->u : pic_dec->v)
+                     , (comp_idx == Y_C) ? (pic_rec->stride_luma) : (pic_rec->stride_chroma)
+                     , comp_idx, bit_depth, alf_param[comp_idx], lcu_y_pos, cur_lcu_height, lcu_x_pos, cur_lcu_width
+                     , is_above_avail, is_below_avail, is_left_avail, is_right_avail, is_above_left_avail, is_above_right_avail, bit_depth
+#if ALF_SHAPE || ALF_IMP || ALF_SHIFT
+                     , alf_enhance_flag
+#endif
+        );
+    }
+}
+
+#if LF_ROW_PARALLEL
+static void alf_dec_lcu_job(void *arg, int lcu_x)
+{
+    ALF_DEC_JOB *job = (ALF_DEC_JOB *)arg;
+    alf_process_dec_lcu(job->ctx, job->alf_param, job->pic_rec, job->pic_dec, job->lcu_y, lcu_x);
+}
+#endif
+
+/*
+*************************************************************************
+* Function: ALF decoding process of one LCU row
+* Input:
+*         ctx  : CONTEXT used for decoding process
+*     pic_rec  : picture of the the ALF input image
+*     pic_dec  : picture of the the ALF reconstructed image
+*       lcu_y  : LCU row index; pic_dec only has to hold the lines read by this row
+*        pool  : LCUs of the row are filtered in parallel on this pool
+*************************************************************************
+*/
+void alf_process_dec_lcu_row(DEC_CTX* ctx, ALF_PARAM **alf_param, COM_PIC* pic_rec, COM_PIC* pic_dec, int lcu_y
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
+{
+#if LF_ROW_PARALLEL
+    if (com_thread_pool_size(pool) > 1)
+    {
+        ALF_DEC_JOB job = { ctx, alf_param, pic_rec, pic_dec, lcu_y };
+        com_thread_pool_run(pool, alf_dec_lcu_job, &job, ctx->info.pic_width_in_lcu);
+        return;
+    }
+#endif
+    for (int lcu_x = 0; lcu_x < ctx->info.pic_width_in_lcu; lcu_x++)
+    {
+        alf_process_dec_lcu(ctx, alf_param, pic_rec, pic_dec, lcu_y, lcu_x);
+    }
+}
+
+#if LF_ROW_PARALLEL
+static void alf_dec_row_job(void *arg, int lcu_y)
+{
+    ALF_DEC_JOB *job = (ALF_DEC_JOB *)arg;
+    alf_process_dec_lcu_row(job->ctx, job->alf_param, job->pic_rec, job->pic_dec, lcu_y, NULL);
+}
+#endif
+
+/*
+*************************************************************************
+* Function: ALF decoding process top function
+* Input:
+*         ctx  : CONTEXT used for decoding process
+*     pic_rec  : picture of the the ALF input image
+*     pic_dec  : picture of the the ALF reconstructed image
+*        pool  : LCU rows are filtered in parallel on this pool
+*************************************************************************
+*/
+void alf_process_dec(DEC_CTX* ctx, ALF_PARAM **alf_param, COM_PIC* pic_rec, COM_PIC* pic_dec
+#if LF_ROW_PARALLEL
+    , COM_THREAD_POOL *pool
+#endif
+)
+{
+#if LF_ROW_PARALLEL
+    if (com_thread_pool_size(pool) > 1)
+    {
+        ALF_DEC_JOB job = { ctx, alf_param, pic_rec, pic_dec, 0 };
+        com_thread_pool_run(pool, alf_dec_row_job, &job, ctx->info.pic_height_in_lcu);
+        return;
+    }
+#endif
+    for (int lcu_y = 0; lcu_y < ctx->info.pic_height_in_lcu; lcu_y++)
+    {
+        alf_process_dec_lcu_row(ctx, alf_param, pic_rec, pic_dec, lcu_y
+#if LF_ROW_PARALLEL
+            , NULL
+#endif
+        );
+    }
+}
+
+#else
 /*
 *************************************************************************
 * Function: ALF decoding process top function
@@ -113,6 +263,8 @@ void alf_process_dec(DEC_CTX* ctx, ALF_PARAM **alf_param, COM_PIC* pic_rec, COM_
     }
 }
 
+#endif
+
 /*
 *************************************************************************
 * Function: ALF filter on CTB
@@ -129,9 +281,25 @@ void filter_one_ctb(DEC_ALF_VAR * dec_alf, pel *rec, pel *dec, int stride, int c
 {
     const int  format_shift = (comp_idx == Y_C) ? 0 : 1;
     int y_pos, x_pos, height, width;
+#if LF_ROW_PARALLEL
+    //CTBs are filtered concurrently, so the coefficients are reconstructed into local tables
+#if ALF_SHAPE
+    int  coeff_buf[NO_VAR_BINS][ALF_MAX_NUM_COEF_SHAPE2 + 1]; // + 1 for the ALF_SHIFT coefficient
+#else
+    int  coeff_buf[NO_VAR_BINS][ALF_MAX_NUM_COEF];
+#endif
+    int *filter_coeff_sym[NO_VAR_BINS];
+    int  var_ind_tab[NO_VAR_BINS];
+    for (y_pos = 0; y_pos < (int)NO_VAR_BINS; y_pos++)
+    {
+        filter_coeff_sym[y_pos] = coeff_buf[y_pos];
+    }
+    reconstruct_coef_info(comp_idx, alf_param, filter_coeff_sym, var_ind_tab);
+#else
     //reconstruct coefficients to m_filterCoeffSym and m_varIndTab
     reconstruct_coef_info(comp_idx, alf_param, dec_alf->filter_coeff_sym,
                         dec_alf->var_ind_tab); //reconstruct ALF coefficients & related parameters
+#endif
     //derive CTB start positions, width, and height. If the boundary is not available, skip boundary samples.
     y_pos = (lcu_y_pos >> format_shift);
     height = (lcu_height >> format_shift);
@@ -161,7 +329,12 @@ void filter_one_ctb(DEC_ALF_VAR * dec_alf, pel *rec, pel *dec, int stride, int c
     );
 
     filter_one_comp_region(rec, img_buf, stride, wBuf, (comp_idx != Y_C)
-        , y_pos, height, x_pos, width, dec_alf->filter_coeff_sym, dec_alf->var_ind_tab
+        , y_pos, height, x_pos, width
+#if LF_ROW_PARALLEL
+        , filter_coeff_sym, var_ind_tab
+#else
+        , dec_alf->filter_coeff_sym, dec_alf->var_ind_tab
+#endif
 #if ALF_IMP
         , alf_enhance_flag ? (comp_idx == Y_C ? dec_alf->var_img_arr[alf_param->dir_index] : dec_alf->var_img_arr[0]) : dec_alf->var_img
 #else
@@ -7642,6 +7642,9 @@ int dec_decode_cu(DEC_CTX * ctx, DEC_CORE * core) // this function can be optimi
                 reduced_flag = num_cands_all < TM_CANDS ? 1 : 0;
                 cands_adjustment(pmv_cands, refi_cands, &num_cands_all);
             }
+#if TM_COST_CACHE
+            com_tm_cache_reset();
+#endif
             pre_evaluation_cands(cu_x, cu_y, ctx->info.pic_width, ctx->info.pic_height, cu_width, cu_height, ctx->pic->y, ctx->pic->stride_luma, ctx->refp, pmv_cands, refi_cands, &num_cands_all, ctx->info.bit_depth_internal, is_simplified);
             mod_info_curr->tm_idx = decode_tm_idx(bs, sbac, reduced_flag);
             for (u8 refp_idx = 0; refp_idx < REFP_NUM; refp_idx++)
@@ -0,0 +1,368 @@
+/* ====================================================================================================================
+
+  The copyright in this software is being made available under the License included below.
+  This software may be subject to other third party and contributor rights, including patent rights, and no such
+  rights are granted under this license.
+
+  Copyright (c) 2018, HUAWEI TECHNOLOGIES CO., LTD. All rights reserved.
+  Copyright (c) 2018, SAMSUNG ELECTRONICS CO., LTD. All rights reserved.
+  Copyright (c) 2018, PEKING UNIVERSITY SHENZHEN GRADUATE SCHOOL. All rights reserved.
+  Copyright (c) 2018, PENGCHENG LABORATORY. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted only for
+  the purpose of developing standards within Audio and Video Coding Standard Workgroup of China (AVS) and for testing and
+  promoting such standards. The following conditions are required to be met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+      the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+      the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * The name of HUAWEI TECHNOLOGIES CO., LTD. or SAMSUNG ELECTRONICS CO., LTD. may not be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+* ====================================================================================================================
+*/
+
+#include "dec_stream.h"
+
+#if STREAM_API
+
+#define DEC_STREAM_BUF_SIZE        (1 << 20) /* byte, initial size of the packet buffers */
+
+struct _DEC_STREAM
+{
+    DEC_STREAM_CB          cb;
+    DEC                    id;
+#if LIBVC_ON
+    /* library picture state of a decoder the caller does not give its own */
+    LibVCData              libvc_data;
+#endif
+    /* packet after emulation prevention removal, followed by a start code */
+    u8                   * rbsp;
+    int                    rbsp_size;
+    /* bytes of the incomplete packet of the previous pushes */
+    u8                   * buf;
+    int                    buf_size;
+    int                    buf_cap;
+    /* offset in the incomplete packet where the search for its end continues */
+    int                    scan;
+};
+
+static void * dec_stream_alloc(const DEC_STREAM_CB * cb, size_t size)
+{
+    return cb->alloc ? cb->alloc(cb->opaque, size) : malloc(size);
+}
+
+static void dec_stream_free(const DEC_STREAM_CB * cb, void * ptr)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+    if (cb->free)
+    {
+        cb->free(cb->opaque, ptr);
+    }
+    else
+    {
+        free(ptr);
+    }
+}
+
+/* grows a buffer to hold at least size bytes keeping its first keep bytes */
+static int dec_stream_reserve(DEC_STREAM * s, u8 ** buf, int * cap, int size, int keep)
+{
+    u8 * data;
+    int new_cap = *cap ? *cap : DEC_STREAM_BUF_SIZE;
+    if (size <= *cap)
+    {
+        return COM_OK;
+    }
+    while (new_cap < size)
+    {
+        new_cap *= 2;
+    }
+    data = (u8 *)dec_stream_alloc(&s->cb, new_cap);
+    if (data == NULL)
+    {
+        return COM_ERR_OUT_OF_MEMORY;
+    }
+    if (keep > 0)
+    {
+        com_mcpy(data, *buf, keep);
+    }
+    dec_stream_free(&s->cb, *buf);
+    *buf = data;
+    *cap = new_cap;
+    return COM_OK;
+}
+
+DEC_STREAM * dec_stream_create(DEC_CDSC * cdsc, const DEC_STREAM_CB * cb, int * err)
+{
+    DEC_STREAM * s;
+    int ret = COM_OK;
+
+    if (cb == NULL || cb->frame == NULL)
+    {
+        if (err) *err = COM_ERR_INVALID_ARGUMENT;
+        return NULL;
+    }
+    s = (DEC_STREAM *)dec_stream_alloc(cb, sizeof(DEC_STREAM));
+    if (s == NULL)
+    {
+        if (err) *err = COM_ERR_OUT_OF_MEMORY;
+        return NULL;
+    }
+    com_mset(s, 0, sizeof(DEC_STREAM));
+    s->cb = *cb;
+    s->scan = 5;
+    if (dec_stream_reserve(s, &s->rbsp, &s->rbsp_size, DEC_STREAM_BUF_SIZE, 0))
+    {
+        ret = COM_ERR_OUT_OF_MEMORY;
+        goto ERR;
+    }
+    s->id = dec_create(cdsc, &ret);
+    if (s->id == NULL)
+    {
+        goto ERR;
+    }
+#if LIBVC_ON
+    init_libvcdata(&s->libvc_data);
+    ((DEC_CTX *)s->id)->dpm.libvc_data = &s->libvc_data;
+#endif
+    if (err) *err = COM_OK;
+    return s;
+ERR:
+    dec_stream_free(cb, s->rbsp);
+    dec_stream_free(cb, s);
+    if (err) *err = ret == COM_OK ? COM_ERR : ret;
+    return NULL;
+}
+
+void dec_stream_delete(DEC_STREAM * s)
+{
+    DEC_STREAM_CB cb;
+    if (s == NULL)
+    {
+        return;
+    }
+    cb = s->cb;
+    dec_delete(s->id);
+#if LIBVC_ON
+    delete_libvcdata(&s->libvc_data);
+#endif
+    dec_stream_free(&cb, s->rbsp);
+    dec_stream_free(&cb, s->buf);
+    dec_stream_free(&cb, s);
+}
+
+DEC dec_stream_decoder(DEC_STREAM * s)
+{
+    return s->id;
+}
+
+static int dec_stream_output(DEC_STREAM * s, int state)
+{
+    COM_IMGB * img;
+    int ret = dec_pull_frm((DEC_CTX *)s->id, &img, state);
+    if (ret == COM_ERR_UNEXPECTED)
+    {
+        /* nothing left to output */
+        return ret;
+    }
+    if (COM_FAILED(ret))
+    {
+        return ret;
+    }
+    if (img)
+    {
+        ret = s->cb.frame(s->cb.opaque, img) < 0 ? COM_ERR : COM_OK;
+        img->release(img);
+    }
+    return ret;
+}
+
+/* outputs the pictures left in the DPB */
+static int dec_stream_bump(DEC_STREAM * s)
+{
+    int ret;
+    do
+    {
+        ret = dec_stream_output(s, 1);
+    } while (ret == COM_OK || ret == COM_OK_FRM_DELAYED);
+    return ret == COM_ERR_UNEXPECTED ? COM_OK : ret;
+}
+
+static int dec_stream_packet(DEC_STREAM * s, const u8 * pkt, int size)
+{
+    COM_BITB bitb;
+    DEC_STAT stat;
+    int ret, len;
+
+    ret = dec_stream_reserve(s, &s->rbsp, &s->rbsp_size, size + 3, 0);
+    if (COM_FAILED(ret))
+    {
+        return ret;
+    }
+    len = com_rbsp_extract(pkt, size, s->rbsp);
+    com_mset(s->rbsp + len, 0, size - len);
+    s->rbsp[len] = 0x00;
+    s->rbsp[len + 1] = 0x00;
+    s->rbsp[len + 2] = 0x01;
+
+    com_mset(&bitb, 0, sizeof(COM_BITB));
+    bitb.addr = s->rbsp;
+    bitb.ssize = size;
+    bitb.bsize = s->rbsp_size;
+    ret = dec_cnk((DEC_CTX *)s->id, &bitb, &stat);
+    if (s->cb.packet && s->cb.packet(s->cb.opaque, size, &stat, ret) < 0)
+    {
+        return COM_ERR;
+    }
+    if (stat.ctype == COM_CT_SEQ_END)
+    {
+        return dec_stream_bump(s);
+    }
+    if (COM_FAILED(ret))
+    {
+        return ret;
+    }
+    if (stat.fnum >= 0)
+    {
+        ret = dec_stream_output(s, 0);
+        if (COM_FAILED(ret) && ret != COM_ERR_UNEXPECTED)
+        {
+            return ret;
+        }
+    }
+    return COM_OK;
+}
+
+/* start code of the next sequence header, picture header, first slice or sequence end after the
+   packet start p; scan is the position of the 0x01 byte to test next, -1 when the bytes hold none */
+static int dec_stream_packet_end(const u8 * p, int size, int * scan)
+{
+    const u8 * q;
+    int j = *scan;
+    while (j < size - 1)
+    {
+        q = (const u8 *)memchr(p + j, 0x01, size - 1 - j);
+        if (q == NULL)
+        {
+            j = size - 1;
+            break;
+        }
+        j = (int)(q - p);
+        if (q[-1] == 0x00 && q[-2] == 0x00 && (q[1] == 0xb3 || q[1] == 0xb6 || q[1] == 0xb0 || q[1] == 0x00 || q[1] == 0xb1))
+        {
+            *scan = j;
+            return j - 2;
+        }
+        j++;
+    }
+    *scan = j;
+    return -1;
+}
+
+/* decodes the complete packets of p, all of them when last is set; returns the bytes consumed in used */
+static int dec_stream_split(DEC_STREAM * s, const u8 * p, int size, int last, int * used)
+{
+    const u8 * q;
+    int pos = 0, end, ret = COM_OK;
+
+    while (size - pos >= 3)
+    {
+        if (p[pos] != 0x00 || p[pos + 1] != 0x00 || p[pos + 2] != 0x01)
+        {
+            /* bytes in front of the first start code are dropped */
+            q = (const u8 *)memchr(p + pos + 2, 0x01, size - pos - 2);
+            while (q && (q[-1] != 0x00 || q[-2] != 0x00))
+            {
+                q = (const u8 *)memchr(q + 1, 0x01, p + size - q - 1);
+            }
+            pos = q ? (int)(q - p) - 2 : size - 2;
+            continue;
+        }
+        end = dec_stream_packet_end(p + pos, size - pos, &s->scan);
+        if (end < 0)
+        {
+            if (!last)
+            {
+                break;
+            }
+            end = size - pos;
+        }
+        ret = dec_stream_packet(s, p + pos, end);
+        pos += end;
+        s->scan = 5;
+        if (COM_FAILED(ret))
+        {
+            break;
+        }
+    }
+    if (last)
+    {
+        pos = size;
+    }
+    *used = pos;
+    return ret;
+}
+
+int dec_stream_push(DEC_STREAM * s, const u8 * data, int size)
+{
+    int ret, used;
+
+    if (s->buf_size > 0)
+    {
+        ret = dec_stream_reserve(s, &s->buf, &s->buf_cap, s->buf_size + size, s->buf_size);
+        if (COM_FAILED(ret))
+        {
+            return ret;
+        }
+        com_mcpy(s->buf + s->buf_size, data, size);
+        s->buf_size += size;
+        ret = dec_stream_split(s, s->buf, s->buf_size, 0, &used);
+        s->buf_size -= used;
+        memmove(s->buf, s->buf + used, s->buf_size);
+        return ret;
+    }
+    /* complete packets are decoded from the caller's bytes, only the rest is copied */
+    ret = dec_stream_split(s, data, size, 0, &used);
+    if (COM_SUCCEEDED(ret) && used < size)
+    {
+        ret = dec_stream_reserve(s, &s->buf, &s->buf_cap, size - used, 0);
+        if (COM_SUCCEEDED(ret))
+        {
+            com_mcpy(s->buf, data + used, size - used);
+            s->buf_size = size - used;
+        }
+    }
+    return ret;
+}
+
+int dec_stream_flush(DEC_STREAM * s)
+{
+    int ret = COM_OK, used;
+
+    if (s->buf_size > 0)
+    {
+        ret = dec_stream_split(s, s->buf, s->buf_size, 1, &used);
+        s->buf_size = 0;
+        s->scan = 5;
+        if (COM_FAILED(ret))
+        {
+            return ret;
+        }
+    }
+    return dec_stream_bump(s);
+}
+
+#endif
@@ -240,6 +240,39 @@ static ENC_CORE * core_alloc(void)
     core = (ENC_CORE *)com_malloc_fast(sizeof(ENC_CORE));
     com_assert_rv(core, NULL);
     com_mset_x64a(core, 0, sizeof(ENC_CORE));
+#if SCRATCH_ARENA
+    if (com_arena_create(&core->scratch, COM_SCRATCH_SIZE))
+    {
+        com_mfree_fast(core);
+        return NULL;
+    }
+#endif
+#if TM_COST_CACHE
+    core->tm_cache = com_tm_cache_create();
+    if (core->tm_cache == NULL)
+    {
+#if SCRATCH_ARENA
+        com_arena_delete(&core->scratch);
+#endif
+        com_mfree_fast(core);
+        return NULL;
+    }
+#endif
+#if PADLESS_REF
+    core->ref_win = com_ref_win_create();
+    if (core->ref_win == NULL)
+    {
+#if SCRATCH_ARENA
+        com_arena_delete(&core->scratch);
+#endif
+#if TM_COST_CACHE
+        com_tm_cache_delete(core->tm_cache);
+#endif
+        com_mfree_fast(core);
+        return NULL;
+    }
+#endif
+#if !CU_DATA_LAZY
     for(i = 0; i < MAX_CU_DEPTH; i++)
     {
         for(j = 0; j < MAX_CU_DEPTH; j++)
@@ -256,6 +289,7 @@ static ENC_CORE * core_alloc(void)
             );
         }
     }
+#endif
 #if INTER_ME_MVLIB
     for (i = 0; i < MAX_NUM_MVR; i++)
     {
@@ -301,10 +335,163 @@ static void core_free(ENC_CORE * core)
 #endif
 #if ENC_ME_IMP
     com_mfree_fast(core->affMVList);
+#endif
+#if SCRATCH_ARENA
+    com_arena_delete(&core->scratch);
+#endif
+#if TM_COST_CACHE
+    com_tm_cache_delete(core->tm_cache);
+#endif
+#if PADLESS_REF
+    com_ref_win_delete(core->ref_win);
 #endif
     com_mfree_fast(core);
 }
 
+#if CU_DATA_LAZY
+/* marks in reach[][] the CU shapes mode_coding_tree() can visit below a node, following its
+   normative and content-independent split constraints; nodes inside the picture are visited once per depth pair */
+static void cu_shape_reach(ENC_CTX *ctx, COM_SQH *sqh, int slice_type, u8 reach[MAX_CU_DEPTH][MAX_CU_DEPTH]
+                           , u8 (*done)[MAX_CU_DEPTH][MAX_CU_DEPTH][MAX_CU_DEPTH * 2], int x0, int y0, int cu_width_log2, int cu_height_log2, int qt_depth, int bet_depth)
+{
+    int cu_width = 1 << cu_width_log2;
+    int cu_height = 1 << cu_height_log2;
+    int pic_width = ctx->info.pic_width;
+    int pic_height = ctx->info.pic_height;
+    int boundary = !(x0 + cu_width <= pic_width && y0 + cu_height <= pic_height);
+    int boundary_r, boundary_b;
+    int split_allow[SPLIT_QUAD + 1];
+    int split_mode, i;
+
+    reach[cu_width_log2 - 2][cu_height_log2 - 2] = 1;
+    if (cu_width == MIN_CU_SIZE && cu_height == MIN_CU_SIZE)
+    {
+        return;
+    }
+    if (!boundary)
+    {
+        if (done[cu_width_log2 - 2][cu_height_log2 - 2][qt_depth][bet_depth])
+        {
+            return;
+        }
+        done[cu_width_log2 - 2][cu_height_log2 - 2][qt_depth][bet_depth] = 1;
+    }
+    boundary_b = boundary && (y0 + cu_height > pic_height) && !(x0 + cu_width > pic_width);
+    boundary_r = boundary && (x0 + cu_width > pic_width) && !(y0 + cu_height > pic_height);
+    com_check_split_mode(sqh, split_allow, cu_width_log2, cu_height_log2, boundary, boundary_b, boundary_r, ctx->info.log2_max_cuwh, 0
+                         , NO_SPLIT, qt_depth, bet_depth, slice_type);
+#if CTU_256
+    if (cu_width == 128 && cu_height == 256)
+    {
+        split_allow[SPLIT_BI_VER] = 0;
+    }
+    if (cu_width == 256 && cu_height == 128)
+    {
+        split_allow[SPLIT_BI_HOR] = 0;
+    }
+#endif
+#if ENC_PRESET
+    if (!boundary && split_allow[NO_SPLIT] && bet_depth >= ctx->preset.max_bet_depth)
+    {
+        for (i = SPLIT_BI_VER; i < SPLIT_QUAD; i++)
+        {
+            split_allow[i] = 0;
+        }
+    }
+#endif
+    for (split_mode = SPLIT_BI_VER; split_mode <= SPLIT_QUAD; split_mode++)
+    {
+        COM_SPLIT_STRUCT split_struct;
+        if (!split_allow[split_mode])
+        {
+            continue;
+        }
+        com_split_get_part_structure(split_mode, x0, y0, cu_width, cu_height, 0, 0, ctx->log2_culine, &split_struct);
+        for (i = 0; i < split_struct.part_count; i++)
+        {
+            if (split_struct.x_pos[i] < pic_width && split_struct.y_pos[i] < pic_height)
+            {
+                cu_shape_reach(ctx, sqh, slice_type, reach, done, split_struct.x_pos[i], split_struct.y_pos[i], split_struct.log_cuw[i], split_struct.log_cuh[i]
+                               , INC_QT_DEPTH(qt_depth, split_mode), INC_BET_DEPTH(bet_depth, split_mode));
+            }
+        }
+    }
+}
+
+/* split limits of the sequence header; shared by set_sqh() and the CU data walk done before the header is built */
+static void set_sqh_split(ENC_CTX *ctx, COM_SQH *sqh)
+{
+    sqh->min_cu_size     = ctx->param.min_cu_size;
+    sqh->max_part_ratio  = ctx->param.max_part_ratio;
+    sqh->max_split_times = ctx->param.max_split_times;
+    sqh->min_qt_size     = ctx->param.min_qt_size;
+    sqh->max_bt_size     = ctx->param.max_bt_size;
+    sqh->max_eqt_size    = ctx->param.max_eqt_size;
+    sqh->max_dt_size     = ctx->param.max_dt_size;
+}
+
+/* allocates the core CU data of the shapes reachable from an interior LCU and from the LCUs cut by the right/bottom picture edge */
+static int core_alloc_cu_data(ENC_CTX *ctx, ENC_CORE *core)
+{
+    static const int slice_type[2] = { SLICE_I, SLICE_P };
+    u8 done[MAX_CU_DEPTH][MAX_CU_DEPTH][MAX_CU_DEPTH][MAX_CU_DEPTH * 2];
+    u8 reach[MAX_CU_DEPTH][MAX_CU_DEPTH];
+    COM_SQH *sqh = &ctx->info.sqh;
+    int s, lx, ly, i, j;
+
+    set_sqh_split(ctx, sqh);
+    com_mset(reach, 0, sizeof(reach));
+    for (s = 0; s < 2; s++)
+    {
+        com_mset(done, 0, sizeof(done));
+        for (ly = 0; ly < 2; ly++)
+        {
+            for (lx = 0; lx < 2; lx++)
+            {
+                int x0 = (lx * (ctx->info.pic_width_in_lcu - 1)) << ctx->info.log2_max_cuwh;
+                int y0 = (ly * (ctx->info.pic_height_in_lcu - 1)) << ctx->info.log2_max_cuwh;
+                cu_shape_reach(ctx, sqh, slice_type[s], reach, done, x0, y0, ctx->info.log2_max_cuwh, ctx->info.log2_max_cuwh, 0, 0);
+            }
+        }
+    }
+    for (i = 0; i < MAX_CU_DEPTH; i++)
+    {
+        for (j = 0; j < MAX_CU_DEPTH; j++)
+        {
+            if (!reach[i][j])
+            {
+                continue;
+            }
+            com_assert_rv(enc_create_cu_data(&core->cu_data_best[i][j], i, j
+#if USE_SP
+                , 1, 1
+#endif
+            ) == COM_OK, COM_ERR_OUT_OF_MEMORY);
+            com_assert_rv(enc_create_cu_data(&core->cu_data_temp[i][j], i, j
+#if USE_SP
+                , 1, 1
+#endif
+            ) == COM_OK, COM_ERR_OUT_OF_MEMORY);
+        }
+    }
+    return COM_OK;
+}
+#endif
+
+#if ENC_PRESET
+/* search knobs per speed preset, indexed by (preset - ENC_PRESET_PLACEBO); medium is the anchor */
+static const ENC_PRESET_CFG enc_preset_tbl[ENC_PRESET_NUM] =
+{
+    /* ipd_rdo,     skip_rdo,           awp_rdo,     sawp_rdo,     bet_depth,           sr_shift, et_ratio, split_pred_thr */
+    {  IPD_RDO_CNT, MAX_INTER_SKIP_RDO, AWP_RDO_NUM, SAWP_RDO_NUM, ENC_PRESET_NO_LIMIT, -1, 1.25, 0.00 }, /* placebo   */
+    {  IPD_RDO_CNT, MAX_INTER_SKIP_RDO, AWP_RDO_NUM, SAWP_RDO_NUM, ENC_PRESET_NO_LIMIT,  0, 1.10, 0.00 }, /* slow      */
+    {  IPD_RDO_CNT, MAX_INTER_SKIP_RDO, AWP_RDO_NUM, SAWP_RDO_NUM, ENC_PRESET_NO_LIMIT,  0, 1.00, 0.00 }, /* medium    */
+    {  4,           6,                  5,           6,            4,                    1, 0.95, 0.95 }, /* fast      */
+    {  3,           4,                  3,           4,            3,                    1, 0.90, 0.90 }, /* veryfast  */
+    {  2,           2,                  1,           2,            2,                    2, 0.80, 0.80 }, /* ultrafast */
+};
+#endif
+
 static int set_init_param(ENC_PARAM * param, ENC_PARAM * param_input)
 {
     com_mcpy(param, param_input, sizeof(ENC_PARAM));
@@ -315,6 +502,9 @@ static int set_init_param(ENC_PARAM * param, ENC_PARAM * param_input)
     com_assert_rv(param->qp >= (MIN_QUANT - (8 * (param->bit_depth_internal - 8))), COM_ERR_INVALID_ARGUMENT);
     com_assert_rv(param->qp <= MAX_QUANT_BASE, COM_ERR_INVALID_ARGUMENT); // this assertion is align with the constraint for input QP
     com_assert_rv(param->i_period >= 0,COM_ERR_INVALID_ARGUMENT);
+#if ENC_PRESET
+    com_assert_rv(param->preset >= ENC_PRESET_PLACEBO && param->preset <= ENC_PRESET_ULTRAFAST, COM_ERR_INVALID_ARGUMENT);
+#endif
     if( !param->disable_hgop )
     {
 #if RPL_GOP32
@@ -485,13 +675,7 @@ static void set_sqh(ENC_CTX * ctx, COM_SQH * sqh)
     sqh->horizontal_size = ctx->param.horizontal_size;
     sqh->vertical_size   = ctx->param.vertical_size;
     sqh->log2_max_cu_width_height = (u8)ctx->info.log2_max_cuwh;
-    sqh->min_cu_size              = ctx->param.min_cu_size;
-    sqh->max_part_ratio           = ctx->param.max_part_ratio;
-    sqh->max_split_times          = ctx->param.max_split_times;
-    sqh->min_qt_size              = ctx->param.min_qt_size;
-    sqh->max_bt_size              = ctx->param.max_bt_size;
-    sqh->max_eqt_size             = ctx->param.max_eqt_size;
-    sqh->max_dt_size              = ctx->param.max_dt_size;
+    set_sqh_split(ctx, sqh);
 #if IPCM
     sqh->ipcm_enable_flag = ctx->param.ipcm_enable_flag;
 #endif
@@ -1898,6 +2082,10 @@ int enc_ready(ENC_CTX * ctx)
     ctx->info.f_scu             = ctx->info.pic_width_in_scu * ctx->info.pic_height_in_scu;
     ctx->log2_culine            = (u8)ctx->info.log2_max_cuwh - MIN_CU_LOG2;
     ctx->log2_cudim             = ctx->log2_culine << 1;
+#if CU_DATA_LAZY
+    ret = core_alloc_cu_data(ctx, core);
+    com_assert_g(ret == COM_OK, ERR);
+#endif
 
 #if ASP
     ctx->info.skip_me_asp = FALSE;
@@ -1961,6 +2149,17 @@ int enc_ready(ENC_CTX * ctx)
         com_assert_gv(ctx->map.map_scu, ret, COM_ERR_OUT_OF_MEMORY, ERR);
         com_mset_x64a(ctx->map.map_scu, 0, size);
     }
+#if COL_MV_COMPRESS
+    if (ctx->map.map_mv == NULL)
+    {
+        size = sizeof(s16) * ctx->info.f_scu * REFP_NUM * MV_D;
+        ctx->map.map_mv = com_malloc_fast(size);
+        com_assert_gv(ctx->map.map_mv, ret, COM_ERR_OUT_OF_MEMORY, ERR);
+        size = sizeof(s8) * ctx->info.f_scu * REFP_NUM;
+        ctx->map.map_refi = com_malloc_fast(size);
+        com_assert_gv(ctx->map.map_refi, ret, COM_ERR_OUT_OF_MEMORY, ERR);
+    }
+#endif
     if (ctx->map.map_split == NULL)
     {
 #if CTU_256
@@ -2100,7 +2299,12 @@ int enc_ready(ENC_CTX * ctx)
         ctx->pico_buf[i]->st_qpmap = qp_map;
     }
 #endif
+#if DBK_EDGE_BITMAP
+    ctx->edge_filter = create_edge_filter_avs2(ctx->info.pic_width, ctx->info.pic_height);
+    com_assert_gv(ctx->edge_filter, ret, COM_ERR_OUT_OF_MEMORY, ERR);
+#else
     create_edge_filter_avs2(ctx->info.pic_width, ctx->info.pic_height, ctx->edge_filter);
+#endif
 
     com_malloc_3d_sao_stat_data(&(ctx->sao_stat_data),
                               ((ctx->info.pic_width >> ctx->info.log2_max_cuwh) + (ctx->info.pic_width % (1 << ctx->info.log2_max_cuwh) ? 1 : 0)) * ((
@@ -2197,8 +2401,22 @@ int enc_ready(ENC_CTX * ctx)
         else
         {
             ctx->pEncALO = createEncALO(ctx);
+#if LOOKAHEAD_STAGE
+            ctx->lookahead = enc_lookahead_create(ctx->param.pic_width, ctx->param.pic_height, ctx->pinter.max_search_range, ctx->pico_max_cnt + 1
+#if LOOKAHEAD_ROW_PARALLEL
+                , LOOKAHEAD_THREADS(ctx->param.threads)
+#endif
+            );
+#endif
         }
     }
+#endif
+#if LF_ROW_PARALLEL
+#if LOOKAHEAD_STAGE && LOOKAHEAD_ROW_PARALLEL
+    ctx->pool = com_thread_pool_create(ctx->param.threads - (ctx->lookahead ? LOOKAHEAD_THREADS(ctx->param.threads) : 0));
+#else
+    ctx->pool = com_thread_pool_create(ctx->param.threads);
+#endif
 #endif
 
     return COM_OK;
@@ -2227,7 +2445,12 @@ ERR:
     {
         com_mfree_fast(ctx->pico_buf[i]);
     }
+#if DBK_EDGE_BITMAP
+    delete_edge_filter_avs2(ctx->edge_filter);
+    ctx->edge_filter = NULL;
+#else
     delete_edge_filter_avs2(ctx->edge_filter, pic_height);
+#endif
 
     if (ctx->pic_sao != NULL)
     {
@@ -2617,7 +2840,19 @@ void enc_flush(ENC_CTX * ctx)
 {
     int i;
     com_assert(ctx);
+#if LF_ROW_PARALLEL
+    com_thread_pool_delete(ctx->pool);
+    ctx->pool = NULL;
+#endif
+#if LOOKAHEAD_STAGE
+    enc_lookahead_delete(ctx->lookahead);
+    ctx->lookahead = NULL;
+#endif
     com_mfree_fast(ctx->map.map_scu);
+#if COL_MV_COMPRESS
+    com_mfree_fast(ctx->map.map_mv);
+    com_mfree_fast(ctx->map.map_refi);
+#endif
     com_mfree_fast(ctx->map.map_split);
     for (i = 0; i < (int)ctx->info.f_lcu; i++)
     {
@@ -2674,7 +2909,12 @@ void enc_flush(ENC_CTX * ctx)
         if(ctx->inbuf[i]) ctx->inbuf[i]->release(ctx->inbuf[i]);
     }
 
+#if DBK_EDGE_BITMAP
+    delete_edge_filter_avs2(ctx->edge_filter);
+    ctx->edge_filter = NULL;
+#else
     delete_edge_filter_avs2(ctx->edge_filter, ctx->info.pic_height);
+#endif
 
     if (ctx->pic_sao != NULL)
     {
@@ -2832,10 +3072,18 @@ int enc_deblock_avs2(ENC_CTX * ctx, COM_PIC * pic
     }
     else
     {
-        deblock_frame_avs2(&ctx->info, &ctx->map, pic, ctx->refp, ctx->edge_filter);
+        deblock_frame_avs2(&ctx->info, &ctx->map, pic, ctx->refp, ctx->edge_filter
+#if LF_ROW_PARALLEL
+            , ctx->pool
+#endif
+        );
     }
 #else
-    deblock_frame_avs2(&ctx->info, &ctx->map, pic, ctx->refp, ctx->edge_filter);
+    deblock_frame_avs2(&ctx->info, &ctx->map, pic, ctx->refp, ctx->edge_filter
+#if LF_ROW_PARALLEL
+        , ctx->pool
+#endif
+    );
 #endif
 
     return COM_OK;
@@ -2843,7 +3091,7 @@ int enc_deblock_avs2(ENC_CTX * ctx, COM_PIC * pic
 
 #if DBR
 //deblock one frame in the encoder
-void enc_deblock_frame(ENC_CTX * ctx, COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_PIC * pic_org, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], int*** edge_filter, double lambda)
+void enc_deblock_frame(ENC_CTX * ctx, COM_INFO *info, COM_MAP *map, COM_PIC * pic, COM_PIC * pic_org, COM_REFP refp[MAX_NUM_REF_PICS][REFP_NUM], COM_EDGE_FILTER edge_filter, double lambda)
 {
     int mb_x, mb_y;
     int md1 = 0, md2 = 0, min_index = 0, mnum = 0;
@@ -3459,8 +3707,10 @@ int enc_pic_prepare(ENC_CTX * ctx, COM_BITB * bitb)
     param = &ctx->param;
     PIC_REC(ctx) = com_picman_get_empty_pic(&ctx->rpm, &ret);
     com_assert_rv(PIC_REC(ctx) != NULL, ret);
+#if !COL_MV_COMPRESS
     ctx->map.map_refi = PIC_REC(ctx)->map_refi;
     ctx->map.map_mv   = PIC_REC(ctx)->map_mv;
+#endif
 #if RDO_DBK
     if(ctx->pic_dbk == NULL)
     {
@@ -3590,18 +3840,26 @@ int enc_pic_prepare(ENC_CTX * ctx, COM_BITB * bitb)
         {
             if (ctx->poc % GOP_P == 0)
             {
+#if LOOKAHEAD_STAGE
+                updateLookaheadCtuFactor(ctx);
+#else
                 updateOrgPic(ctx);
                 updateCosineSimilarity(ctx);
                 updateCtuFactor(ctx);
+#endif
             }
         }
         else if (ctx->param.i_period > 1 && ctx->poc % ctx->param.i_period != 0)
         {
             if (ctx->poc % ctx->param.gop_size == 0)
             {
+#if LOOKAHEAD_STAGE
+                updateLookaheadCtuFactor(ctx);
+#else
                 updateOrgPic(ctx);
                 updateCosineSimilarity(ctx);
                 updateCtuFactor(ctx);
+#endif
             }
         }
     }
@@ -3629,6 +3887,9 @@ int enc_pic_finish(ENC_CTX *ctx, COM_BITB *bitb, ENC_STAT *stat)
 
     /* expand current encoding picture, if needs */
     enc_picbuf_expand(ctx, PIC_REC(ctx));
+#if COL_MV_COMPRESS
+    com_col_mv_compress(PIC_REC(ctx), ctx->map.map_mv, ctx->map.map_refi, ctx->info.pic_width_in_scu, ctx->info.pic_height_in_scu);
+#endif
 
     /* picture buffer management */
 #if LIBVC_ON
@@ -3718,6 +3979,18 @@ int enc_pic(ENC_CTX * ctx, COM_BITB * bitb, ENC_STAT * stat)
     int last_lcu_delta_qp;
     bs = &ctx->bs;
     core = ctx->core;
+#if SCRATCH_ARENA
+    com_scratch_bind(&core->scratch);
+#endif
+#if TM_COST_CACHE
+    com_tm_cache_bind(core->tm_cache);
+#endif
+#if PADLESS_REF
+    com_ref_win_bind(core->ref_win);
+#endif
+#if SBAC_CTX_JOURNAL
+    enc_sbac_gen_bind(&core->sbac_gen);
+#endif
     pic_header = &ctx->info.pic_header;
     sqh = &ctx->info.sqh;
     shext = &ctx->info.shext;
@@ -4066,7 +4339,13 @@ int enc_pic(ENC_CTX * ctx, COM_BITB * bitb, ENC_STAT * stat)
     /* initialize entropy coder */
     enc_sbac_init(bs);
     com_sbac_ctx_init(&(GET_SBAC_ENC(bs)->ctx));
+#if SBAC_CTX_JOURNAL
+    enc_sbac_ctx_reset(GET_SBAC_ENC(bs));
+#endif
     com_sbac_ctx_init(&(core->s_curr_best[ctx->info.log2_max_cuwh - 2][ctx->info.log2_max_cuwh - 2].ctx));
+#if SBAC_CTX_JOURNAL
+    enc_sbac_ctx_reset(&core->s_curr_best[ctx->info.log2_max_cuwh - 2][ctx->info.log2_max_cuwh - 2]);
+#endif
     core->bs_temp.pdata[1] = &core->s_temp_run;
     /* LCU encoding */
 #if TRACE_RDO_EXCLUDE_I
@@ -4135,6 +4414,9 @@ int enc_pic(ENC_CTX * ctx, COM_BITB * bitb, ENC_STAT * stat)
 
         int lcu_qp;
         int adj_qp_cb, adj_qp_cr;
+#if SCRATCH_ARENA
+        com_arena_release(&core->scratch, 0);
+#endif
 
 #if PATCH
         /*set patch idx*/
@@ -4328,6 +4610,12 @@ int enc_pic(ENC_CTX * ctx, COM_BITB * bitb, ENC_STAT * stat)
         }
 #endif
         ret = enc_mode_analyze_lcu(ctx, core);
+#if PADLESS_REF
+        if (ret == COM_OK)
+        {
+            ret = com_ref_win_status(core->ref_win);
+        }
+#endif
 #if LIB_PIC_UPDATE
         if (ctx->rpm.libvc_data->encode_skip==0)
         {
@@ -4444,7 +4732,13 @@ int enc_pic(ENC_CTX * ctx, COM_BITB * bitb, ENC_STAT * stat)
                 /* initialize entropy coder */
                 enc_sbac_init(bs);
                 com_sbac_ctx_init(&(GET_SBAC_ENC(bs)->ctx));
+#if SBAC_CTX_JOURNAL
+                enc_sbac_ctx_reset(GET_SBAC_ENC(bs));
+#endif
                 com_sbac_ctx_init(&(core->s_curr_best[ctx->info.log2_max_cuwh - 2][ctx->info.log2_max_cuwh - 2].ctx));
+#if SBAC_CTX_JOURNAL
+                enc_sbac_ctx_reset(&core->s_curr_best[ctx->info.log2_max_cuwh - 2][ctx->info.log2_max_cuwh - 2]);
+#endif
 
                 last_lcu_qp = ctx->info.shext.slice_qp;
                 last_lcu_delta_qp = 0;
@@ -4680,6 +4974,9 @@ int enc_pic(ENC_CTX * ctx, COM_BITB * bitb, ENC_STAT * stat)
         }
         enc_sbac_init(bs);
         com_sbac_ctx_init(&(GET_SBAC_ENC(bs)->ctx));
+#if SBAC_CTX_JOURNAL
+        enc_sbac_ctx_reset(GET_SBAC_ENC(bs));
+#endif
         /* Encode slice data */
         last_lcu_qp = ctx->info.shext.slice_qp;
         last_lcu_delta_qp = 0;
@@ -4935,6 +5232,9 @@ int enc_pic(ENC_CTX * ctx, COM_BITB * bitb, ENC_STAT * stat)
                         /* initialize entropy coder */
                         enc_sbac_init(bs);
                         com_sbac_ctx_init(&(GET_SBAC_ENC(bs)->ctx));
+#if SBAC_CTX_JOURNAL
+                        enc_sbac_ctx_reset(GET_SBAC_ENC(bs));
+#endif
                     }
                     core->x_lcu = *(patch->width_in_lcu + patch->x_pat) + patch_cur_lcu_x;
                     core->y_lcu = patch_cur_lcu_y;
@@ -5111,6 +5411,12 @@ void en_copy_lcu_scu(u32 * scu_temp, u32 * scu_best, s8(*refi_temp)[REFP_NUM], s
     }
 }
 #endif
+void enc_setup_bumping(ENC_CTX * ctx)
+{
+    ctx->param.force_output = 1;
+    ctx->pic_ticnt = ctx->pic_icnt;
+}
+
 int enc_push_frm(ENC_CTX * ctx, COM_IMGB * imgb)
 {
     COM_PIC    * pic;
@@ -5134,7 +5440,12 @@ int enc_push_frm(ENC_CTX * ctx, COM_IMGB * imgb)
     pic->stride_chroma   = STRIDE_IMGB2PIC(imgb->stride[1]);
     pic->imgb  = imgb;
     imgb->addref(imgb);
-#if ALO
+#if LOOKAHEAD_STAGE
+    if (ctx->lookahead)
+    {
+        enc_lookahead_push(ctx->lookahead, pic, ctx->pic_icnt);
+    }
+#elif ALO
     if (ctx->param.alo_enable_type == 1)
     {
         // LD
@@ -5170,6 +5481,9 @@ ENC enc_create(ENC_PARAM * param_input, int * err)
     /* set default value for encoding parameter */
     ret = set_init_param(&ctx->param, param_input);
     com_assert_g(ret == COM_OK, ERR);
+#if ENC_PRESET
+    ctx->preset = enc_preset_tbl[ctx->param.preset - ENC_PRESET_PLACEBO];
+#endif
     /* create intra prediction analyzer */
     ret = pintra_set_complexity(ctx, 0);
     com_assert_g(ret == COM_OK, ERR);
@@ -5330,6 +5644,9 @@ ENC enc_create(ENC_PARAM * param_input, int * err)
 #endif
 #if ALO
     ctx->pEncALO = NULL;
+#endif
+#if LOOKAHEAD_STAGE
+    ctx->lookahead = NULL;
 #endif
     ret = enc_ready(ctx);
     com_assert_g(ret == COM_OK, ERR);
@@ -89,26 +89,14 @@ void alf_process(ENC_CTX* ctx, COM_BSW *alf_bs_temp, ALF_PARAM **alf_picture_par
     execute_pic_lcu_on_off_decision(ctx, alf_bs_temp, alf_picture_param, lambda_mode, FALSE, NULL, org_Y, org_UV, dec_Y, dec_UV, rec_Y, rec_UV, luma_stride);
 }
 
-/*
-*************************************************************************
-* Function: Calculate the correlation matrix for image
-* Input:
-*             ctx  : CONTEXT used for encoding process
-*     pic_alf_Org  : picture of the original image
-*     pic_alf_Rec  : picture of the the ALF input image
-*           stride : The stride of Y component of the ALF input picture
-*           lambda : The lambda value in the ALF-RD decision
-* Output:
-* Return:
-*************************************************************************
-*/
-void get_statistics_alf(ENC_CTX* ctx, pel *img_Y_org, pel **img_UV_org, pel *img_Y_dec, pel **img_UV_dec, int stride)
+/* correlation matrices of one LCU, only alf_corr[][lcu_idx] (alf_corr_arr[][][lcu_idx]) are written */
+static void get_statistics_lcu_alf(ENC_CTX* ctx, pel *img_Y_org, pel **img_UV_org, pel *img_Y_dec, pel **img_UV_dec, int stride, int lcu_idx)
 {
     ENC_ALF_VAR *enc_alf = ctx->enc_alf;
     BOOL  is_left_avail, is_right_avail, is_above_avail, is_below_avail;
     BOOL  is_above_left_avail, is_above_right_avail;
     int lcu_height, lcu_width, img_height, img_width;
-    int lcu_idx, num_lcu_in_frame, num_lcu_in_pic_width, num_lcu_in_pic_height;
+    int num_lcu_in_pic_width, num_lcu_in_pic_height;
     int lcu_y_pos, lcu_x_pos;
     int comp_idx, format_shift;
     lcu_height = 1 << ctx->info.log2_max_cuwh;
@@ -119,83 +107,145 @@ void get_statistics_alf(ENC_CTX* ctx, pel *img_Y_org, pel **img_UV_org, pel *img
     num_lcu_in_pic_height = img_height / lcu_height;
     num_lcu_in_pic_width += (img_width % lcu_width) ? 1 : 0;
     num_lcu_in_pic_height += (img_height % lcu_height) ? 1 : 0;
-    num_lcu_in_frame = num_lcu_in_pic_height * num_lcu_in_pic_width;
 #if ALF_SHAPE || ALF_IMP
     BOOL alf_enhance_flag = ctx->info.sqh.adaptive_leveling_filter_enhance_flag;
 #endif
 #if ALF_IMP
     ALF_CORR_DATA *alf_corr_each_lcu_arr[ITER_NUM] = {NULL};
 #endif
-    for (lcu_idx = 0; lcu_idx < num_lcu_in_frame; lcu_idx++)
+    lcu_y_pos = (lcu_idx / num_lcu_in_pic_width) * lcu_height;
+    lcu_x_pos = (lcu_idx % num_lcu_in_pic_width) * lcu_width;
+    int cur_lcu_height = (lcu_y_pos + lcu_height > img_height) ? (img_height - lcu_y_pos) : lcu_height;
+    int cur_lcu_width = (lcu_x_pos + lcu_width  > img_width) ? (img_width - lcu_x_pos) : lcu_width;
+    derive_boundary_avail(ctx, num_lcu_in_pic_width, num_lcu_in_pic_height, lcu_idx, &is_left_avail, &is_right_avail, &is_above_avail, &is_below_avail,
+                        &is_above_left_avail, &is_above_right_avail);
+    for (comp_idx = 0; comp_idx < N_C; comp_idx++)
     {
-        lcu_y_pos = (lcu_idx / num_lcu_in_pic_width) * lcu_height;
-        lcu_x_pos = (lcu_idx % num_lcu_in_pic_width) * lcu_width;
-        int cur_lcu_height = (lcu_y_pos + lcu_height > img_height) ? (img_height - lcu_y_pos) : lcu_height;
-        int cur_lcu_width = (lcu_x_pos + lcu_width  > img_width) ? (img_width - lcu_x_pos) : lcu_width;
-        derive_boundary_avail(ctx, num_lcu_in_pic_width, num_lcu_in_pic_height, lcu_idx, &is_left_avail, &is_right_avail, &is_above_avail, &is_below_avail,
-                            &is_above_left_avail, &is_above_right_avail);
-        for (comp_idx = 0; comp_idx < N_C; comp_idx++)
-        {
-            format_shift = (comp_idx == Y_C) ? 0 : 1;
+        format_shift = (comp_idx == Y_C) ? 0 : 1;
 #if ALF_IMP 
-            if (alf_enhance_flag)
+        if (alf_enhance_flag)
+        {
+            for (int it = 0; it < ITER_NUM; it++)
             {
-                for (int it = 0; it < ITER_NUM; it++)
-                {
-                    reset_alf_corr(enc_alf->alf_corr_arr[it][comp_idx][lcu_idx]
+                reset_alf_corr(enc_alf->alf_corr_arr[it][comp_idx][lcu_idx]
 #if ALF_SHAPE
-                        , alf_enhance_flag ? ALF_MAX_NUM_COEF_SHAPE2 : ALF_MAX_NUM_COEF
+                    , alf_enhance_flag ? ALF_MAX_NUM_COEF_SHAPE2 : ALF_MAX_NUM_COEF
 #endif
-                    );
-                }
-                for (int it = 0; it < ITER_NUM; it++)
-                {
-                    alf_corr_each_lcu_arr[it] = enc_alf->alf_corr_arr[it][comp_idx][lcu_idx];
-                }
+                );
             }
-            else
+            for (int it = 0; it < ITER_NUM; it++)
             {
+                alf_corr_each_lcu_arr[it] = enc_alf->alf_corr_arr[it][comp_idx][lcu_idx];
+            }
+        }
+        else
+        {
 #endif
-                reset_alf_corr(enc_alf->alf_corr[comp_idx][lcu_idx]
+            reset_alf_corr(enc_alf->alf_corr[comp_idx][lcu_idx]
 #if ALF_SHAPE
-                    , alf_enhance_flag ? ALF_MAX_NUM_COEF_SHAPE2 : ALF_MAX_NUM_COEF
+                , alf_enhance_flag ? ALF_MAX_NUM_COEF_SHAPE2 : ALF_MAX_NUM_COEF
 #endif
-                );
+            );
 #if ALF_IMP
-            }
+        }
 #endif
-            if (comp_idx == Y_C)
-            {
-                get_statistics_one_lcu_alf(ctx->enc_alf, comp_idx, lcu_y_pos, lcu_x_pos, cur_lcu_height, cur_lcu_width, is_above_avail
-                    , is_below_avail, is_left_avail, is_right_avail
-                    , is_above_left_avail, is_above_right_avail
+        if (comp_idx == Y_C)
+        {
+            get_statistics_one_lcu_alf(ctx->enc_alf, comp_idx, lcu_y_pos, lcu_x_pos, cur_lcu_height, cur_lcu_width, is_above_avail
+                , is_below_avail, is_left_avail, is_right_avail
+                , is_above_left_avail, is_above_right_avail
 #if ALF_IMP 
-                    , alf_corr_each_lcu_arr
+                , alf_corr_each_lcu_arr
 #endif
-                    , enc_alf->alf_corr[comp_idx][lcu_idx], img_Y_org, img_Y_dec, stride, format_shift
+                , enc_alf->alf_corr[comp_idx][lcu_idx], img_Y_org, img_Y_dec, stride, format_shift
 #if ALF_SHAPE || ALF_IMP
-                    , alf_enhance_flag
+                , alf_enhance_flag
 #endif
-                );
-            }
-            else
-            {
-                get_statistics_one_lcu_alf(ctx->enc_alf, comp_idx, lcu_y_pos, lcu_x_pos, cur_lcu_height, cur_lcu_width, is_above_avail
-                    , is_below_avail, is_left_avail, is_right_avail
-                    , is_above_left_avail, is_above_right_avail
+            );
+        }
+        else
+        {
+            get_statistics_one_lcu_alf(ctx->enc_alf, comp_idx, lcu_y_pos, lcu_x_pos, cur_lcu_height, cur_lcu_width, is_above_avail
+                , is_below_avail, is_left_avail, is_right_avail
+                , is_above_left_avail, is_above_right_avail
 #if ALF_IMP
-                    , alf_corr_each_lcu_arr
+                , alf_corr_each_lcu_arr
 #endif
-                    , enc_alf->alf_corr[comp_idx][lcu_idx], img_UV_org[comp_idx - U_C], img_UV_dec[comp_idx - U_C], (stride >> 1), format_shift
+                , enc_alf->alf_corr[comp_idx][lcu_idx], img_UV_org[comp_idx - U_C], img_UV_dec[comp_idx - U_C], (stride >> 1), format_shift
 #if ALF_SHAPE ||ALF_IMP
-                    , alf_enhance_flag
+                , alf_enhance_flag
 #endif
-                );
-            }
+            );
         }
     }
 }
 
+#if ALF_ENC_INCR && LF_ROW_PARALLEL
+typedef struct _ALF_STAT_JOB
+{
+    ENC_CTX  *ctx;
+    pel      *img_Y_org;
+    pel     **img_UV_org;
+    pel      *img_Y_dec;
+    pel     **img_UV_dec;
+    int       stride;
+} ALF_STAT_JOB;
+
+static void alf_stat_lcu_job(void *arg, int lcu_idx)
+{
+    ALF_STAT_JOB *job = (ALF_STAT_JOB *)arg;
+    get_statistics_lcu_alf(job->ctx, job->img_Y_org, job->img_UV_org, job->img_Y_dec, job->img_UV_dec, job->stride, lcu_idx);
+}
+#endif
+
+/*
+*************************************************************************
+* Function: Calculate the correlation matrix for image
+* Input:
+*             ctx  : CONTEXT used for encoding process
+*     pic_alf_Org  : picture of the original image
+*     pic_alf_Rec  : picture of the the ALF input image
+*           stride : The stride of Y component of the ALF input picture
+*           lambda : The lambda value in the ALF-RD decision
+* Output:
+* Return:
+*************************************************************************
+*/
+void get_statistics_alf(ENC_CTX* ctx, pel *img_Y_org, pel **img_UV_org, pel *img_Y_dec, pel **img_UV_dec, int stride)
+{
+    int lcu_height, lcu_width, img_height, img_width;
+    int lcu_idx, num_lcu_in_frame, num_lcu_in_pic_width, num_lcu_in_pic_height;
+    lcu_height = 1 << ctx->info.log2_max_cuwh;
+    lcu_width = lcu_height;
+    img_height = ctx->info.pic_height;
+    img_width = ctx->info.pic_width;
+    num_lcu_in_pic_width = img_width / lcu_width;
+    num_lcu_in_pic_height = img_height / lcu_height;
+    num_lcu_in_pic_width += (img_width % lcu_width) ? 1 : 0;
+    num_lcu_in_pic_height += (img_height % lcu_height) ? 1 : 0;
+    num_lcu_in_frame = num_lcu_in_pic_height * num_lcu_in_pic_width;
+#if ALF_ENC_INCR
+    // new statistics, the running sums have to be rebuilt
+    for (int comp_idx = 0; comp_idx < N_C; comp_idx++)
+    {
+        ctx->enc_alf->alf_corr_sum_src[comp_idx] = NULL;
+    }
+#if LF_ROW_PARALLEL
+    // every LCU writes its own statistics only
+    if (com_thread_pool_size(ctx->pool) > 1)
+    {
+        ALF_STAT_JOB job = { ctx, img_Y_org, img_UV_org, img_Y_dec, img_UV_dec, stride };
+        com_thread_pool_run(ctx->pool, alf_stat_lcu_job, &job, num_lcu_in_frame);
+        return;
+    }
+#endif
+#endif
+    for (lcu_idx = 0; lcu_idx < num_lcu_in_frame; lcu_idx++)
+    {
+        get_statistics_lcu_alf(ctx, img_Y_org, img_UV_org, img_Y_dec, img_UV_dec, stride, lcu_idx);
+    }
+}
+
 void derive_alf_boundary_availibility(ENC_CTX* ctx, int num_lcu_in_pic_width, int num_lcu_in_pic_height, int lcu_idx,
         BOOL *is_left_avail, BOOL *is_right_avail, BOOL *is_above_avail, BOOL *is_below_avail)
 {
@@ -503,6 +553,25 @@ void create_alf_global_buffers(ENC_CTX* ctx)
         ctx->enc_alf->alf_lcu_enabled[n] = (BOOL *)malloc(N_C * sizeof(BOOL));
         memset(ctx->enc_alf->alf_lcu_enabled[n], 0, N_C * sizeof(BOOL));
     }
+#if ALF_ENC_INCR
+    for (comp_idx = 0; comp_idx < N_C; comp_idx++)
+    {
+        allocate_alf_corr_data(&(ctx->enc_alf->alf_corr_sum[comp_idx]), comp_idx
+#if ALF_SHAPE
+                            , num_coef
+#endif
+        );
+        ctx->enc_alf->alf_corr_sum_src[comp_idx] = NULL;
+    }
+    ctx->enc_alf->alf_lcu_in_sum = (BOOL **)malloc(num_lcu_in_frame * sizeof(BOOL *));
+    for (n = 0; n < num_lcu_in_frame; n++)
+    {
+        ctx->enc_alf->alf_lcu_in_sum[n] = (BOOL *)malloc(N_C * sizeof(BOOL));
+        memset(ctx->enc_alf->alf_lcu_in_sum[n], 0, N_C * sizeof(BOOL));
+    }
+    ctx->enc_alf->filter_cache_cur = 0;
+    memset(ctx->enc_alf->filter_cache_tag, 0, sizeof(ctx->enc_alf->filter_cache_tag));
+#endif
     for (i = 0; i < img_height; i = i + 4)
     {
 #if ALF_IMP
@@ -666,6 +735,22 @@ void destroy_alf_global_buffers(ENC_CTX* ctx, unsigned int max_size_in_bit)
     }
     com_mfree(ctx->enc_alf->alf_lcu_enabled);
     ctx->enc_alf->alf_lcu_enabled = NULL;
+#if ALF_ENC_INCR
+    for (comp_idx = 0; comp_idx < N_C; comp_idx++)
+    {
+        free_alf_corr_data(&ctx->enc_alf->alf_corr_sum[comp_idx]
+#if ALF_SHAPE
+                        , num_coef
+#endif
+        );
+    }
+    for (n = 0; n < num_lcu_in_frame; n++)
+    {
+        com_mfree(ctx->enc_alf->alf_lcu_in_sum[n]);
+    }
+    com_mfree(ctx->enc_alf->alf_lcu_in_sum);
+    ctx->enc_alf->alf_lcu_in_sum = NULL;
+#endif
     for (g = 0; g < (int)NO_VAR_BINS; g++)
     {
         com_mfree(ctx->enc_alf->filter_coeff_sym[g]);
@@ -2289,6 +2374,38 @@ void add_alf_corr_data(ALF_CORR_DATA *A, ALF_CORR_DATA *B, ALF_CORR_DATA *C
     }
 }
 
+#if ALF_ENC_INCR
+void sub_alf_corr_data(ALF_CORR_DATA *A, ALF_CORR_DATA *B, ALF_CORR_DATA *C
+#if ALF_SHAPE
+                     , int num_coef
+#endif
+)
+{
+#if !ALF_SHAPE
+    int num_coef = ALF_MAX_NUM_COEF;
+#endif
+    int max_num_groups = NO_VAR_BINS;
+    int num_groups;
+    int g, j, i;
+    if (A->component_id >= 0)
+    {
+        num_groups = (A->component_id == Y_C) ? (max_num_groups) : (1);
+        for (g = 0; g < num_groups; g++)
+        {
+            C->pix_acc[g] = A->pix_acc[g] - B->pix_acc[g];
+            for (j = 0; j < num_coef; j++)
+            {
+                C->y_corr[g][j] = A->y_corr[g][j] - B->y_corr[g][j];
+                for (i = 0; i < num_coef; i++)
+                {
+                    C->E_corr[g][j][i] = A->E_corr[g][j][i] - B->E_corr[g][j][i];
+                }
+            }
+        }
+    }
+}
+#endif
+
 void accumulate_lcu_correlation(ENC_CTX *ctx, ALF_CORR_DATA **alf_corr_acc, ALF_CORR_DATA ***alf_corr_src_lcu, BOOL use_all_lcus)
 {
 #if ALF_SHAPE
@@ -2332,6 +2449,50 @@ void accumulate_lcu_correlation(ENC_CTX *ctx, ALF_CORR_DATA **alf_corr_acc, ALF_
                 use_all_lcus = TRUE;
             }
         }
+#if ALF_ENC_INCR
+        /* the statistics are sums of integer products, so adding and removing the LCUs whose
+           on/off flag changed since the last call gives exactly the from-scratch sum */
+        if (enc_alf->alf_corr_sum_src[comp_idx] != alf_corr_src_lcu[comp_idx])
+        {
+            reset_alf_corr(enc_alf->alf_corr_sum[comp_idx]
+#if ALF_SHAPE
+                          , num_coef
+#endif
+            );
+            for (addr = 0; addr < num_lcu_in_frame; addr++)
+            {
+                enc_alf->alf_lcu_in_sum[addr][comp_idx] = FALSE;
+            }
+            enc_alf->alf_corr_sum_src[comp_idx] = alf_corr_src_lcu[comp_idx];
+        }
+        for (addr = 0; addr < num_lcu_in_frame; addr++)
+        {
+            BOOL in_sum = use_all_lcus || enc_alf->alf_lcu_enabled[addr][comp_idx];
+            if (in_sum && !enc_alf->alf_lcu_in_sum[addr][comp_idx])
+            {
+                add_alf_corr_data(alf_corr_src_lcu[comp_idx][addr], enc_alf->alf_corr_sum[comp_idx], enc_alf->alf_corr_sum[comp_idx]
+#if ALF_SHAPE
+                                , num_coef
+#endif
+                );
+            }
+            else if (!in_sum && enc_alf->alf_lcu_in_sum[addr][comp_idx])
+            {
+                sub_alf_corr_data(enc_alf->alf_corr_sum[comp_idx], alf_corr_src_lcu[comp_idx][addr], enc_alf->alf_corr_sum[comp_idx]
+#if ALF_SHAPE
+                                , num_coef
+#endif
+                );
+            }
+            enc_alf->alf_lcu_in_sum[addr][comp_idx] = in_sum;
+        }
+        // handed out as a copy: a singular solve regularizes its matrix in place
+        add_alf_corr_data(enc_alf->alf_corr_sum[comp_idx], alf_corr_acc_comp, alf_corr_acc_comp
+#if ALF_SHAPE
+                        , num_coef
+#endif
+        );
+#else
         for (addr = 0; addr < (int)num_lcu_in_frame; addr++)
         {
             if (use_all_lcus || enc_alf->alf_lcu_enabled[addr][comp_idx])
@@ -2343,6 +2504,7 @@ void accumulate_lcu_correlation(ENC_CTX *ctx, ALF_CORR_DATA **alf_corr_acc, ALF_
                 );
             }
         }
+#endif
     }
 }
 
@@ -2836,6 +2998,10 @@ void find_best_filter_var_pred(ENC_ALF_VAR *enc_alf, double **y_sym, double ***E
     }
     first_filter = 1;
     lagrangian_min = 0;
+#if ALF_ENC_INCR
+    // merged intervals solved for an earlier filter count are reused within this search only
+    enc_alf->filter_cache_cur++;
+#endif
 #if ALF_IMP
     filters_per_fr = num_max_filters;
 #else
@@ -3253,6 +3419,24 @@ double find_filter_coeff(ENC_ALF_VAR *enc_alf, double ***E_global_seq, double **
     error = 0;
     for (filter_idx = 0; filter_idx < filters_per_fr; filter_idx++)
     {
+#if ALF_ENC_INCR
+        int start = interval_best[filter_idx][0];
+        int stop = interval_best[filter_idx][1];
+#if ALF_SHIFT
+        int num_coef = sqr_filter_length + alf_shift_enable;
+#else
+        int num_coef = sqr_filter_length;
+#endif
+        if (enc_alf->filter_cache_tag[start][stop] == enc_alf->filter_cache_cur)
+        {
+            error_tab_force0_coeff[filter_idx][0] = enc_alf->filter_cache_err[start][stop][0];
+            error_tab_force0_coeff[filter_idx][1] = enc_alf->filter_cache_err[start][stop][1];
+            error += error_tab_force0_coeff[filter_idx][1];
+            memcpy(filter_coeff_seq[filter_idx], enc_alf->filter_cache_coef[start][stop], num_coef * sizeof(int));
+            memcpy(filter_coeff_quant_seq[filter_idx], enc_alf->filter_cache_coef[start][stop], num_coef * sizeof(int));
+            continue;
+        }
+#endif
         add_A(enc_alf->E_temp, E_global_seq, interval_best[filter_idx][0], interval_best[filter_idx][1], sqr_filter_length);
         add_b(enc_alf->y_temp, y_global_seq, interval_best[filter_idx][0], interval_best[filter_idx][1], sqr_filter_length);
         pix_acc_temp = 0;
@@ -3278,6 +3462,12 @@ double find_filter_coeff(ENC_ALF_VAR *enc_alf, double ***E_global_seq, double **
             filter_coeff_seq[filter_idx][k] = filter_coeff_quant[k];
             filter_coeff_quant_seq[filter_idx][k] = filter_coeff_quant[k];
         }
+#if ALF_ENC_INCR
+        enc_alf->filter_cache_tag[start][stop] = enc_alf->filter_cache_cur;
+        enc_alf->filter_cache_err[start][stop][0] = error_tab_force0_coeff[filter_idx][0];
+        enc_alf->filter_cache_err[start][stop][1] = error_tab_force0_coeff[filter_idx][1];
+        memcpy(enc_alf->filter_cache_coef[start][stop], filter_coeff_quant, num_coef * sizeof(int));
+#endif
     }
     for (filter_idx = 0; filter_idx < filters_per_fr; filter_idx++)
     {
@@ -33,6 +33,7 @@
 
 #include "enc_def.h"
 #include <limits.h>
+#include <math.h>
 #if AWP
 #include "com_tbl.h"
 #endif
@@ -1240,7 +1241,11 @@ int enc_eco_udata(ENC_CTX * ctx, COM_BSW * bs)
 
 static void com_bsw_write_est(ENC_SBAC *sbac, int len)
 {
+#if SBAC_RATE_EST
+    sbac->frac_bits += (u64)len << SBAC_EST_FRAC_BITS;
+#else
     sbac->bitcounter += len;
+#endif
 }
 
 static void sbac_put_byte (u8 writing_byte, ENC_SBAC *sbac, COM_BSW *bs)
@@ -1288,6 +1293,13 @@ static void sbac_carry_propagate (ENC_SBAC *sbac, COM_BSW *bs)
 
 static void sbac_encode_bin_ep(u32 bin, ENC_SBAC *sbac, COM_BSW *bs)
 {
+#if SBAC_RATE_EST
+    if (sbac->is_bitcount)
+    {
+        sbac->frac_bits += 1 << SBAC_EST_FRAC_BITS;
+        return;
+    }
+#endif
 #if TRACE_BIN
     COM_TRACE_COUNTER;
     COM_TRACE_STR("range ");
@@ -1424,11 +1436,94 @@ static __inline int ace_get_log2(int v)
 #endif
 }
 
+#if SBAC_RATE_EST
+/* cost in 1/(1 << SBAC_EST_FRAC_BITS) bit of coding an MPS [0] or an LPS [1], indexed by the LPS probability (in 1/(MAX_PROB + 1)) */
+static u32 sbac_est_bits[2][1 << (PROB_BITS - 1)];
+
+void enc_sbac_init_est(void)
+{
+    int i;
+    const double scale = (double)(1 << SBAC_EST_FRAC_BITS);
+    const int num = 1 << (PROB_BITS - 1);
+    for (i = 0; i < num; i++)
+    {
+        double p_lps = (COM_MAX(i, 1) + 0.0) / (MAX_PROB + 1);
+        sbac_est_bits[0][i] = (u32)(-log(1.0 - p_lps) / log(2.0) * scale + 0.5);
+        sbac_est_bits[1][i] = (u32)(-log(p_lps) / log(2.0) * scale + 0.5);
+    }
+}
+
+/* LPS probability of a context model, as seen by the rate estimators */
+u16 enc_sbac_est_prob_lps(SBAC_CTX_MODEL model)
+{
+#if CABAC_MULTI_PROB
+    u16 p0 = (model >> PROB_BITS) & MCABAC_PROB_MASK;
+    u16 p1 = (model >> 1) & MCABAC_PROB_MASK;
+    u16 prob_lps = (u16)(p0 + p1 + 1) >> 1;
+    return prob_lps < 6 ? 6 : prob_lps;
+#else
+    return (model & PROB_MASK) >> 1;
+#endif
+}
+
+/* LPS probability and MPS of the pair of context models coded by enc_sbac_encode_binW */
+u16 enc_sbac_est_prob_lpsW(SBAC_CTX_MODEL model1, SBAC_CTX_MODEL model2, u16 *cmps)
+{
+    u16 prob_lps1 = enc_sbac_est_prob_lps(model1);
+    u16 prob_lps2 = enc_sbac_est_prob_lps(model2);
+    u16 cmps1 = model1 & 1;
+    u16 cmps2 = model2 & 1;
+    if (cmps1 == cmps2)
+    {
+        *cmps = cmps1;
+        return (prob_lps1 + prob_lps2) >> 1;
+    }
+    else if (prob_lps1 < prob_lps2)
+    {
+        *cmps = cmps1;
+        return (256 << LG_PMPS_SHIFTNO) - 1 - ((prob_lps2 - prob_lps1) >> 1);
+    }
+    else
+    {
+        *cmps = cmps2;
+        return (256 << LG_PMPS_SHIFTNO) - 1 - ((prob_lps1 - prob_lps2) >> 1);
+    }
+}
+
+/* rate-estimation counterpart of enc_sbac_encode_bin: adds the bin cost and adapts the model only */
+static void sbac_est_bin(u32 bin, ENC_SBAC *sbac, SBAC_CTX_MODEL *model)
+{
+    u16 cmps = (*model) & 1;
+    sbac->frac_bits += sbac_est_bits[bin != cmps][enc_sbac_est_prob_lps(*model)];
+    enc_sbac_encode_bin_for_rdoq(bin, model);
+}
+
+/* rate-estimation counterpart of enc_sbac_encode_binW */
+static void sbac_est_binW(u32 bin, ENC_SBAC *sbac, SBAC_CTX_MODEL *model1, SBAC_CTX_MODEL *model2)
+{
+    u16 cmps;
+    u16 prob_lps = enc_sbac_est_prob_lpsW(*model1, *model2, &cmps);
+    sbac->frac_bits += sbac_est_bits[bin != cmps][prob_lps];
+    enc_sbac_encode_bin_for_rdoq(bin, model1);
+    enc_sbac_encode_bin_for_rdoq(bin, model2);
+}
+#endif
+
 void enc_sbac_encode_bin(u32 bin, ENC_SBAC *sbac, SBAC_CTX_MODEL *model, COM_BSW *bs)
 {
 #if TRACE_BIN
     SBAC_CTX_MODEL prev_model = *model;
 #endif
+#if SBAC_CTX_JOURNAL
+    SBAC_CTX_TOUCH(sbac, model);
+#endif
+#if SBAC_RATE_EST
+    if (sbac->is_bitcount)
+    {
+        sbac_est_bin(bin, sbac, model);
+        return;
+    }
+#endif
 #if CABAC_MULTI_PROB
     if (g_compatible_back)
     {
@@ -1594,6 +1689,17 @@ void enc_sbac_encode_bin(u32 bin, ENC_SBAC *sbac, SBAC_CTX_MODEL *model, COM_BSW
 
 void enc_sbac_encode_binW(u32 bin, ENC_SBAC *sbac, SBAC_CTX_MODEL *model1, SBAC_CTX_MODEL *model2, COM_BSW *bs)
 {
+#if SBAC_CTX_JOURNAL
+    SBAC_CTX_TOUCH(sbac, model1);
+    SBAC_CTX_TOUCH(sbac, model2);
+#endif
+#if SBAC_RATE_EST
+    if (sbac->is_bitcount)
+    {
+        sbac_est_binW(bin, sbac, model1, model2);
+        return;
+    }
+#endif
 #if CABAC_MULTI_PROB
     if (g_compatible_back)
     {
@@ -1880,6 +1986,13 @@ void enc_sbac_encode_binW(u32 bin, ENC_SBAC *sbac, SBAC_CTX_MODEL *model1, SBAC_
 
 void enc_sbac_encode_bin_trm(u32 bin, ENC_SBAC *sbac, COM_BSW *bs)
 {
+#if SBAC_RATE_EST
+    if (sbac->is_bitcount)
+    {
+        sbac->frac_bits += bin ? (u64)SBAC_EST_TRM_BITS << SBAC_EST_FRAC_BITS : 0;
+        return;
+    }
+#endif
     int s_flag = (sbac->range == QUAR_HALF_PROB);
     u32 rMPS = (sbac->range - 1) | 0x100;
     (sbac->range) -= 2;
@@ -3437,6 +3550,10 @@ void enc_eco_run_length_cc(COM_BSW *bs, s16 *coef, int log2_w, int log2_h, int n
             t0 = ((COM_MIN(prev_level - 1, 5)) * 2) + (ch_type == Y_C ? 0 : 12);
             /* Run coding */
             enc_eco_run(run, sbac, &sbac_ctx->run[t0], bs);
+#if SBAC_CTX_JOURNAL
+            SBAC_CTX_TOUCH(sbac, &sbac_ctx->run_rdoq[t0]);
+            SBAC_CTX_TOUCH(sbac, &sbac_ctx->run_rdoq[t0 + 1]);
+#endif
             enc_eco_run_for_rdoq(run, 2, &sbac_ctx->run_rdoq[t0]);
 
             /* Level coding */
@@ -42,6 +42,9 @@
 #include "enc_esao.h"
 #include "com_esao.h"
 #endif
+#if ESAO_ENC_FUSED_STAT && SIMD_ESAO_STAT
+#include <smmintrin.h>
+#endif
 
 #if ESAO
 void get_multi_classes_statistics_for_esao(COM_PIC *pic_org, COM_PIC  *pic_esao, ESAO_STAT_DATA *esao_state_data, int bit_depth, int comp_idx, int lcu_height, int lcu_width,
@@ -213,6 +216,155 @@ void get_multi_classes_statistics_for_esao(COM_PIC *pic_org, COM_PIC  *pic_esao,
     }
 }
 
+#if ESAO_ENC_FUSED_STAT
+/* edge classes of the luma samples start_x ... end_x - 1 of one row for both luma types,
+   cls0: 8 + sum of the signs of the 8 neighbours against the sample, cls1: number of larger neighbours */
+static void esao_luma_edge_class_row(pel *rec, int stride, int start_x, int end_x, s8 *cls0, s8 *cls1)
+{
+    static const int nb_y[8] = { -1, -1, -1, 0, 0, 1, 1, 1 };
+    static const int nb_x[8] = { -1, 0, 1, -1, 1, -1, 0, 1 };
+    int x = start_x;
+#if SIMD_ESAO_STAT
+    for (; x + 8 <= end_x; x += 8)
+    {
+        __m128i cur = _mm_loadu_si128((__m128i *)(rec + x));
+        __m128i larger = _mm_setzero_si128();
+        __m128i smaller = _mm_setzero_si128();
+        for (int k = 0; k < 8; k++)
+        {
+            __m128i nb = _mm_loadu_si128((__m128i *)(rec + nb_y[k] * stride + nb_x[k] + x));
+            larger = _mm_sub_epi16(larger, _mm_cmpgt_epi16(nb, cur));
+            smaller = _mm_sub_epi16(smaller, _mm_cmpgt_epi16(cur, nb));
+        }
+        __m128i c0 = _mm_add_epi16(_mm_sub_epi16(larger, smaller), _mm_set1_epi16(8));
+        _mm_storel_epi64((__m128i *)(cls0 + x), _mm_packs_epi16(c0, c0));
+        _mm_storel_epi64((__m128i *)(cls1 + x), _mm_packs_epi16(larger, larger));
+    }
+#endif
+    for (; x < end_x; x++)
+    {
+        int larger = 0, smaller = 0;
+        for (int k = 0; k < 8; k++)
+        {
+            pel nb = rec[nb_y[k] * stride + nb_x[k] + x];
+            larger += nb > rec[x];
+            smaller += nb < rec[x];
+        }
+        cls0[x] = (s8)(8 + larger - smaller);
+        cls1[x] = (s8)larger;
+    }
+}
+
+/* statistics of all labels of one component of one LCU, same classes as get_multi_classes_statistics_for_esao();
+   the edge classes and differences of a row are derived once and every label then walks the row */
+static void get_all_classes_statistics_for_esao(COM_PIC *pic_org, COM_PIC *pic_esao, ESAO_STAT_DATA **esao_state_data, int bit_depth, int comp_idx,
+    int lcu_height, int lcu_width, int pix_y, int pix_x, int lcu_available_left, int lcu_available_right, int lcu_available_up, int lcu_available_down)
+{
+    int rec_stride = comp_idx == Y_C ? pic_esao->stride_luma : pic_esao->stride_chroma;
+    int org_stride = comp_idx == Y_C ? pic_org->stride_luma : pic_org->stride_chroma;
+    pel *rec_pic = comp_idx == Y_C ? pic_esao->y : (comp_idx == U_C ? pic_esao->u : pic_esao->v);
+    pel *org_pic = comp_idx == Y_C ? pic_org->y : (comp_idx == U_C ? pic_org->u : pic_org->v);
+    int start_x = 0, end_x = lcu_width, start_y = 0, end_y = lcu_height;
+    s8  cls0[MAX_CU_SIZE], cls1[MAX_CU_SIZE];
+    int diff[MAX_CU_SIZE];
+    rec_pic += pix_y * rec_stride + pix_x;
+    org_pic += pix_y * org_stride + pix_x;
+    if (comp_idx == Y_C)
+    {
+        start_x = lcu_available_left ? 0 : 1;
+        start_y = lcu_available_up ? 0 : 1;
+        end_y = lcu_available_down ? lcu_height : lcu_height - 1;
+        end_x = lcu_available_right ? lcu_width : lcu_width - 1;
+    }
+    for (int y = start_y; y < end_y; y++)
+    {
+        pel *rec = rec_pic + y * rec_stride;
+        pel *org = org_pic + y * org_stride;
+        for (int x = start_x; x < end_x; x++)
+        {
+            diff[x] = org[x] - rec[x];
+        }
+        if (comp_idx == Y_C)
+        {
+            esao_luma_edge_class_row(rec, rec_stride, start_x, end_x, cls0, cls1);
+            for (int label_index = 0; label_index < ESAO_LABEL_NUM_Y; label_index++)
+            {
+                ESAO_STAT_DATA *stat0 = &esao_state_data[label_index][0];
+                ESAO_STAT_DATA *stat1 = &esao_state_data[label_index][1];
+                int shift_count = label_index + 1;
+                for (int x = start_x; x < end_x; x++)
+                {
+                    int band_type = (rec[x] * shift_count) >> bit_depth;
+                    int true_index = band_type * NUM_ESAO_LUMA_TYPE0 + cls0[x];
+                    stat0->diff[true_index] += diff[x];
+                    stat0->count[true_index]++;
+                    if (ESAO_LUMA_TYPES > 1)
+                    {
+                        true_index = band_type * NUM_ESAO_LUMA_TYPE1 + cls1[x];
+                        stat1->diff[true_index] += diff[x];
+                        stat1->count[true_index]++;
+                    }
+                }
+            }
+        }
+        else
+        {
+            int label_count = (comp_idx == U_C) ? ESAO_LABEL_NUM_U : ESAO_LABEL_NUM_V;
+            for (int label_index = 0; label_index < label_count; label_index++)
+            {
+                ESAO_STAT_DATA *stat = &esao_state_data[label_index][comp_idx - 1];
+                int index_shift = tab_esao_chroma_class[label_index];
+                for (int x = start_x; x < end_x; x++)
+                {
+                    int band_type = (rec[x] * index_shift) >> bit_depth;
+                    stat->diff[band_type] += diff[x];
+                    stat->count[band_type]++;
+                }
+            }
+        }
+    }
+}
+
+typedef struct _ESAO_STAT_JOB
+{
+    COM_INFO         *info;
+    COM_MAP          *map;
+    COM_PIC          *pic_org;
+    COM_PIC          *pic_esao;
+    ESAO_STAT_DATA ***esao_luma_state_data;
+    ESAO_STAT_DATA ***esao_chroma_state_data;
+} ESAO_STAT_JOB;
+
+/* every LCU only writes its own statistics */
+static void esao_stat_lcu_job(void *arg, int lcu_pos)
+{
+    ESAO_STAT_JOB *job = (ESAO_STAT_JOB *)arg;
+    COM_INFO *info = job->info;
+    int is_left_avail, is_right_avail, is_above_avail, is_below_avail, is_above_left_avail, is_above_right_avail, is_below_left_avail, is_below_right_avail;
+    int pix_x = (lcu_pos % info->pic_width_in_lcu) << info->log2_max_cuwh;
+    int pix_y = (lcu_pos / info->pic_width_in_lcu) << info->log2_max_cuwh;
+    int lcu_pix_width = min(1 << info->log2_max_cuwh, info->pic_width - pix_x);
+    int lcu_pix_height = min(1 << info->log2_max_cuwh, info->pic_height - pix_y);
+    for (int comp_idx = Y_C; comp_idx < N_C; comp_idx++)
+    {
+        int lcu_pix_width_t = comp_idx ? (lcu_pix_width >> 1) : lcu_pix_width;
+        int lcu_pix_height_t = comp_idx ? (lcu_pix_height >> 1) : lcu_pix_height;
+        int pix_x_t = comp_idx ? (pix_x >> 1) : pix_x;
+        int pix_y_t = comp_idx ? (pix_y >> 1) : pix_y;
+        check_boundary_available_for_esao(info, job->map, pix_y_t, pix_x_t, lcu_pix_height_t, lcu_pix_width_t, comp_idx, &is_left_avail,
+              &is_right_avail, &is_above_avail, &is_below_avail, &is_above_left_avail, &is_above_right_avail, &is_below_left_avail, &is_below_right_avail, 1);
+        get_all_classes_statistics_for_esao(job->pic_org, job->pic_esao, comp_idx == Y_C ? job->esao_luma_state_data[lcu_pos] : job->esao_chroma_state_data[lcu_pos],
+            info->bit_depth_internal, comp_idx, lcu_pix_height_t, lcu_pix_width_t, pix_y_t, pix_x_t, is_left_avail, is_right_avail, is_above_avail, is_below_avail);
+    }
+}
+
+void get_frame_statistics_for_esao(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_org, COM_PIC  *pic_esao, ESAO_STAT_DATA ***esao_luma_state_data, ESAO_STAT_DATA ***esao_chroma_state_data
+    , COM_THREAD_POOL *pool)
+{
+    ESAO_STAT_JOB job = { info, map, pic_org, pic_esao, esao_luma_state_data, esao_chroma_state_data };
+    com_thread_pool_run(pool, esao_stat_lcu_job, &job, info->f_lcu);
+}
+#else
 #if ESAO_ENH
 void get_frame_statistics_for_esao(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_org, COM_PIC  *pic_esao, ESAO_STAT_DATA ***esao_luma_state_data, ESAO_STAT_DATA ***esao_chroma_state_data)
 #else
@@ -263,6 +415,8 @@ void get_frame_statistics_for_esao(COM_INFO *info, COM_MAP *map, COM_PIC  *pic_o
     }
 }
 
+#endif
+
 long long int  distortion_cal_esao(long long int count, int offset, long long int diff)
 {
     return (count * (long long int)offset * (long long int)offset - diff * offset * 2);
@@ -1530,7 +1684,11 @@ void get_frame_param_for_esao(ENC_CTX *ctx, ENC_CORE *core, COM_BSW *esao_bs_tem
 
 void enc_esao_rdo(ENC_CTX *ctx, ENC_CORE *core, COM_BSW *esao_bs)
 {
-    get_frame_statistics_for_esao(&ctx->info, &ctx->map, PIC_ORG(ctx), ctx->pic_esao, ctx->esao_luma_data, ctx->esao_chroma_data);
+    get_frame_statistics_for_esao(&ctx->info, &ctx->map, PIC_ORG(ctx), ctx->pic_esao, ctx->esao_luma_data, ctx->esao_chroma_data
+#if ESAO_ENC_FUSED_STAT
+        , ctx->pool
+#endif
+    );
     get_frame_param_for_esao(ctx, core, esao_bs);
 }
 
@@ -1638,9 +1796,17 @@ int enc_esao(ENC_CTX *ctx, ENC_CORE *core)
     enc_esao_rdo(ctx, core, &(core->bs_temp));
     copy_frame_for_esao(ctx->pic_esao, PIC_REC(ctx));
 #if ESAO_PH_SYNTAX
-    esao_on_frame(&ctx->info, &ctx->map, PIC_REC(ctx), ctx->pic_esao, ctx->info.pic_header.pic_esao_params, &ctx->func_esao_block_filter);
+    esao_on_frame(&ctx->info, &ctx->map, PIC_REC(ctx), ctx->pic_esao, ctx->info.pic_header.pic_esao_params, &ctx->func_esao_block_filter
+#if LF_ROW_PARALLEL
+        , ctx->pool
+#endif
+    );
 #else
-    esao_on_frame(&ctx->info, &ctx->map, PIC_REC(ctx), ctx->pic_esao, ctx->pic_esao_params, &ctx->func_esao_block_filter);
+    esao_on_frame(&ctx->info, &ctx->map, PIC_REC(ctx), ctx->pic_esao, ctx->pic_esao_params, &ctx->func_esao_block_filter
+#if LF_ROW_PARALLEL
+        , ctx->pool
+#endif
+    );
 #endif
     return COM_OK;
 }
@@ -1839,6 +2005,189 @@ void get_ccsao_class_stat(COM_PIC *pic_org,
     }
 }
 
+#if ESAO_ENC_FUSED_STAT
+/* edge class of calc_diff_range() for the samples 0 ... width - 1 of one row */
+static void ccsao_diff_range_row(pel *cur, pel *nb, int width, int th, s8 *range)
+{
+    int x = 0;
+#if SIMD_ESAO_STAT
+    int thred = ccsao_quan_value[th];
+    __m128i lo = _mm_set1_epi16((short)(-thred - 1));
+    __m128i mid = _mm_set1_epi16(-1);
+    __m128i hi = _mm_set1_epi16((short)(thred - 1));
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i diff = _mm_sub_epi16(_mm_loadu_si128((__m128i *)(cur + x)), _mm_loadu_si128((__m128i *)(nb + x)));
+        __m128i val = _mm_add_epi16(_mm_add_epi16(_mm_cmpgt_epi16(diff, lo), _mm_cmpgt_epi16(diff, mid)), _mm_cmpgt_epi16(diff, hi));
+        val = _mm_sub_epi16(_mm_setzero_si128(), val);
+        _mm_storel_epi64((__m128i *)(range + x), _mm_packs_epi16(val, val));
+    }
+#endif
+    for (; x < width; x++)
+    {
+        range[x] = (s8)calc_diff_range(cur[x], nb[x], th);
+    }
+}
+
+/* band and edge statistics of all modes of one chroma component of one LCU, same classes as get_ccsao_class_stat()
+   and get_ccsao_class_stat_edge(); the co-located samples of a row are gathered once and every mode then walks the row */
+static void get_ccsao_lcu_stat(COM_PIC *pic_org, COM_PIC *pic_ccsao[2], CCSAO_STAT_DATA ***ccsao_stat_data, CCSAO_STAT_DATA ***ccsao_edge_stat_data,
+    int bit_depth, int comp, int lcu_width_c, int lcu_height_c, int x_c, int y_c, int lcu_available_left, int lcu_available_up, int lcu_available_down)
+{
+    pel *p_src = pic_ccsao[0]->y;
+    pel *p_src2 = comp == U_C - 1 ? pic_ccsao[0]->u : pic_ccsao[0]->v;
+    pel *p_dst = comp == U_C - 1 ? pic_ccsao[1]->u : pic_ccsao[1]->v;
+    pel *p_org = comp == U_C - 1 ? pic_org->u : pic_org->v;
+    int  i_src = pic_ccsao[0]->stride_luma;
+    int  i_src2 = pic_ccsao[0]->stride_chroma;
+    int  i_dst = pic_ccsao[1]->stride_chroma;
+    int  i_org = pic_org->stride_chroma;
+    int  start_x_c = lcu_available_left ? 0 : 1;
+    int  start_y_c = lcu_available_up ? 0 : 1;
+    int  width = lcu_width_c - start_x_c;
+    pel  col_y[CCSAO_TYPE_NUM][MAX_CU_SIZE >> 1];
+    pel  edge_y[MAX_CU_SIZE >> 1], edge_a[MAX_CU_SIZE >> 1], edge_b[MAX_CU_SIZE >> 1];
+    s8   range_a[MAX_CU_SIZE >> 1], range_b[MAX_CU_SIZE >> 1];
+    int  band_y[MAX_CU_SIZE >> 1], band_c[MAX_CU_SIZE >> 1];
+    int  diff[MAX_CU_SIZE >> 1];
+
+    p_src += ((y_c + start_y_c) << 1) * i_src + ((x_c + start_x_c) << 1);
+    p_src2 += (y_c + start_y_c) * i_src2 + x_c + start_x_c;
+    p_dst += (y_c + start_y_c) * i_dst + x_c + start_x_c;
+    p_org += (y_c + start_y_c) * i_org + x_c + start_x_c;
+
+    for (int y = start_y_c; y < lcu_height_c; y++)
+    {
+#if CCSAO_LINE_BUFFER
+        int line_idx = (lcu_available_down && y >= lcu_height_c - CCSAO_PAD_ROWS - 1) ? lcu_height_c - y - 1 : 0;
+#endif
+        for (int x = 0; x < width; x++)
+        {
+            diff[x] = p_org[x] - p_dst[x];
+        }
+        /* band classes */
+        for (int type = 0; type < CCSAO_TYPE_NUM; type++)
+        {
+#if CCSAO_LINE_BUFFER
+            pel *src = p_src + i_src * ccsao_type_y[type][line_idx] + ccsao_type_x[type];
+#else
+            pel *src = p_src + i_src * ccsao_type_y[type] + ccsao_type_x[type];
+#endif
+            for (int x = 0; x < width; x++)
+            {
+                col_y[type][x] = src[x << 1];
+            }
+        }
+        for (int mode_c = 0; mode_c < CCSAO_BAND_NUM_C; mode_c++)
+        {
+            int band_num_c = mode_c + 1;
+            for (int x = 0; x < width; x++)
+            {
+                band_c[x] = (p_src2[x] * band_num_c) >> bit_depth;
+            }
+            for (int mode = 0; mode < CCSAO_BAND_NUM; mode++)
+            {
+                int band_num = mode + 1;
+                for (int type = 0; type < CCSAO_TYPE_NUM; type++)
+                {
+                    CCSAO_STAT_DATA *stat = &ccsao_stat_data[mode][mode_c][type];
+                    pel *col = col_y[type];
+                    for (int x = 0; x < width; x++)
+                    {
+                        int band = ((col[x] * band_num) >> bit_depth) * band_num_c + band_c[x];
+                        stat->diff[band] += diff[x];
+                        stat->count[band]++;
+                    }
+                }
+            }
+        }
+        /* edge classes */
+        for (int type = 0; type < CCSAO_EDGE_TYPE; type++)
+        {
+#if CCSAO_LINE_BUFFER
+            pel *src_y = p_src + i_src * ccsao_edge_type_y[0][0][line_idx];
+            pel *src_a = p_src + i_src * ccsao_edge_type_y[type][0][line_idx] + ccsao_edge_type_x[type][0];
+            pel *src_b = p_src + i_src * ccsao_edge_type_y[type][1][line_idx] + ccsao_edge_type_x[type][1];
+#else
+            pel *src_y = p_src;
+            pel *src_a = p_src + i_src * ccsao_edge_type_y[type][0] + ccsao_edge_type_x[type][0];
+            pel *src_b = p_src + i_src * ccsao_edge_type_y[type][1] + ccsao_edge_type_x[type][1];
+#endif
+            for (int x = 0; x < width; x++)
+            {
+                edge_y[x] = src_y[x << 1];
+                edge_a[x] = src_a[x << 1];
+                edge_b[x] = src_b[x << 1];
+            }
+            for (int th = 0; th < CCSAO_QUAN_NUM; th++)
+            {
+                ccsao_diff_range_row(edge_y, edge_a, width, th, range_a);
+                ccsao_diff_range_row(edge_y, edge_b, width, th, range_b);
+                for (int mode = 0; mode < CCSAO_EDGE_BAND_NUM_Y + CCSAO_EDGE_BAND_NUM_C; mode++)
+                {
+                    CCSAO_STAT_DATA *stat = &ccsao_edge_stat_data[mode][th][type];
+                    if (mode <= 1)
+                    {
+                        for (int x = 0; x < width; x++)
+                        {
+                            band_y[x] = (edge_y[x] * (mode + 1)) >> bit_depth;
+                        }
+                    }
+                    else
+                    {
+                        for (int x = 0; x < width; x++)
+                        {
+                            band_y[x] = (p_src2[x] * (mode - 1)) >> bit_depth;
+                        }
+                    }
+                    for (int x = 0; x < width; x++)
+                    {
+                        int band = band_y[x] * CCSAO_EDGE_NUM + range_a[x] * 4 + range_b[x];
+                        assert(band < CCSAO_CLASS_NUM);
+                        stat->diff[band] += diff[x];
+                        stat->count[band]++;
+                    }
+                }
+            }
+        }
+        p_src += i_src << 1;
+        p_src2 += i_src2;
+        p_dst += i_dst;
+        p_org += i_org;
+    }
+}
+
+typedef struct _CCSAO_STAT_JOB
+{
+    COM_INFO          *info;
+    COM_MAP           *map;
+    COM_PIC           *pic_org;
+    COM_PIC          **pic_ccsao;
+    CCSAO_STAT_DATA *****ccsao_stat_data;
+    CCSAO_STAT_DATA *****ccsao_edge_stat_data;
+} CCSAO_STAT_JOB;
+
+/* every LCU only writes its own statistics */
+static void ccsao_stat_lcu_job(void *arg, int lcu_pos)
+{
+    CCSAO_STAT_JOB *job = (CCSAO_STAT_JOB *)arg;
+    COM_INFO *info = job->info;
+    int is_left_avail, is_right_avail, is_above_avail, is_below_avail, is_above_left_avail, is_above_right_avail, is_below_left_avail, is_below_right_avail;
+    int x = (lcu_pos % info->pic_width_in_lcu) << info->log2_max_cuwh;
+    int y = (lcu_pos / info->pic_width_in_lcu) << info->log2_max_cuwh;
+    int lcu_width_c = min(1 << info->log2_max_cuwh, info->pic_width - x) >> 1;
+    int lcu_height_c = min(1 << info->log2_max_cuwh, info->pic_height - y) >> 1;
+    for (int comp = U_C - 1; comp < N_C - 1; comp++)
+    {
+        // reuse ESAO U V boundary check
+        check_boundary_available_for_esao(info, job->map, y >> 1, x >> 1, lcu_height_c, lcu_width_c, comp + 1,
+            &is_left_avail, &is_right_avail, &is_above_avail, &is_below_avail, &is_above_left_avail, &is_above_right_avail, &is_below_left_avail, &is_below_right_avail, 1);
+        get_ccsao_lcu_stat(job->pic_org, job->pic_ccsao, job->ccsao_stat_data[comp][lcu_pos], job->ccsao_edge_stat_data[comp][lcu_pos], info->bit_depth_internal, comp,
+            lcu_width_c, lcu_height_c, x >> 1, y >> 1, is_left_avail, is_above_avail, is_below_avail);
+    }
+}
+#endif
+
 void get_ccsao_frame_stat(COM_INFO *info, COM_MAP *map, COM_PIC *pic_org,
 #if CCSAO_ENHANCEMENT
     COM_PIC *pic_ccsao[2], CCSAO_STAT_DATA *****ccsao_stat_data
@@ -1848,8 +2197,15 @@ void get_ccsao_frame_stat(COM_INFO *info, COM_MAP *map, COM_PIC *pic_org,
 #if ECCSAO
     , CCSAO_STAT_DATA *****ccsao_edge_stat_data
 #endif
+#if ESAO_ENC_FUSED_STAT
+    , COM_THREAD_POOL *pool
+#endif
 )
 {
+#if ESAO_ENC_FUSED_STAT
+    CCSAO_STAT_JOB job = { info, map, pic_org, pic_ccsao, ccsao_stat_data, ccsao_edge_stat_data };
+    com_thread_pool_run(pool, ccsao_stat_lcu_job, &job, info->f_lcu);
+#else
     int bit_depth     = info->bit_depth_internal;
     int pic_width     = info->pic_width;
     int pic_height    = info->pic_height;
@@ -1900,6 +2256,7 @@ void get_ccsao_frame_stat(COM_INFO *info, COM_MAP *map, COM_PIC *pic_org,
             }
         }
     }
+#endif
 }
 
 long long int calc_ccsao_distorsion(long long int count, long long int offset, long long int diff)
@@ -2738,6 +3095,9 @@ void enc_ccsao_rdo(ENC_CTX *ctx, ENC_CORE *core, COM_BSW *ccsao_bs)
     get_ccsao_frame_stat(&ctx->info, &ctx->map, PIC_ORG(ctx), ctx->pic_ccsao, ctx->ccsao_chroma_data
 #if ECCSAO
         , ctx->ccsao_edge_chroma_data
+#endif
+#if ESAO_ENC_FUSED_STAT
+        , ctx->pool
 #endif
     );
 #if CCSAO_ENHANCEMENT
@@ -2856,9 +3216,17 @@ int enc_ccsao(ENC_CTX *ctx, ENC_CORE *core)
     if (ctx->info.pic_header.pic_ccsao_on[U_C-1] || ctx->info.pic_header.pic_ccsao_on[V_C-1])
     {
 #if CCSAO_PH_SYNTAX
-        ccsao_on_frame(&ctx->info, &ctx->map, PIC_REC(ctx), ctx->pic_ccsao, ctx->info.pic_header.pic_ccsao_params, &ctx->ccsao_func_ptr);
+        ccsao_on_frame(&ctx->info, &ctx->map, PIC_REC(ctx), ctx->pic_ccsao, ctx->info.pic_header.pic_ccsao_params, &ctx->ccsao_func_ptr
+#if LF_ROW_PARALLEL
+            , ctx->pool
+#endif
+        );
 #else
-        ccsao_on_frame(&ctx->info, &ctx->map, PIC_REC(ctx), ctx->pic_ccsao, ctx->pic_ccsao_params, &ctx->ccsao_func_ptr);
+        ccsao_on_frame(&ctx->info, &ctx->map, PIC_REC(ctx), ctx->pic_ccsao, ctx->pic_ccsao_params, &ctx->ccsao_func_ptr
+#if LF_ROW_PARALLEL
+            , ctx->pool
+#endif
+        );
 #endif
     }
     return COM_OK;
@@ -0,0 +1,404 @@
+/* ====================================================================================================================
+
+  The copyright in this software is being made available under the License included below.
+  This software may be subject to other third party and contributor rights, including patent rights, and no such
+  rights are granted under this license.
+
+  Copyright (c) 2018, HUAWEI TECHNOLOGIES CO., LTD. All rights reserved.
+  Copyright (c) 2018, SAMSUNG ELECTRONICS CO., LTD. All rights reserved.
+  Copyright (c) 2018, PEKING UNIVERSITY SHENZHEN GRADUATE SCHOOL. All rights reserved.
+  Copyright (c) 2018, PENGCHENG LABORATORY. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted only for
+  the purpose of developing standards within Audio and Video Coding Standard Workgroup of China (AVS) and for testing and
+  promoting such standards. The following conditions are required to be met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+      the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+      the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * The name of HUAWEI TECHNOLOGIES CO., LTD. or SAMSUNG ELECTRONICS CO., LTD. may not be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+* ====================================================================================================================
+*/
+
+#include "enc_lookahead.h"
+#include <math.h>
+
+#if LOOKAHEAD_STAGE
+
+#if SIMD_LA_SAD
+static void lookahead_block_cost_sse(const pel * org, const pel * ref, int stride, int w, int h, s32 * sad, s64 * sse)
+{
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i sum_sad = _mm_setzero_si128();
+    __m128i sum_sse = _mm_setzero_si128();
+    __m128i d;
+    int x, y;
+
+    /* 10-bit samples keep the 32-bit lanes of a 16x16 block from overflowing */
+    for (y = 0; y < h; y++)
+    {
+        for (x = 0; x < w; x += 8)
+        {
+            d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(org + x)), _mm_loadu_si128((const __m128i *)(ref + x)));
+            sum_sad = _mm_add_epi32(sum_sad, _mm_madd_epi16(_mm_abs_epi16(d), one));
+            sum_sse = _mm_add_epi32(sum_sse, _mm_madd_epi16(d, d));
+        }
+        org += stride;
+        ref += stride;
+    }
+    sum_sad = _mm_add_epi32(sum_sad, _mm_shuffle_epi32(sum_sad, 0x4e));
+    sum_sad = _mm_add_epi32(sum_sad, _mm_shuffle_epi32(sum_sad, 0xb1));
+    sum_sse = _mm_add_epi32(sum_sse, _mm_shuffle_epi32(sum_sse, 0x4e));
+    sum_sse = _mm_add_epi32(sum_sse, _mm_shuffle_epi32(sum_sse, 0xb1));
+    *sad = _mm_cvtsi128_si32(sum_sad);
+    *sse = (u32)_mm_cvtsi128_si32(sum_sse);
+}
+#endif
+
+static void lookahead_block_cost(const pel * org, const pel * ref, int stride, int w, int h, s32 * sad, s64 * sse)
+{
+    int x, y;
+#if SIMD_LA_SAD
+    if ((w & 7) == 0)
+    {
+        lookahead_block_cost_sse(org, ref, stride, w, h, sad, sse);
+        return;
+    }
+#endif
+    *sad = 0;
+    *sse = 0;
+    for (y = 0; y < h; y++)
+    {
+        for (x = 0; x < w; x++)
+        {
+            int diff = org[x] - ref[x];
+            *sad += COM_ABS(diff);
+            *sse += diff * diff;
+        }
+        org += stride;
+        ref += stride;
+    }
+}
+
+/* integer diamond search with the MSE criterion of the ALO block analysis, starting at (start_x, start_y)
+   of a plane of the given size; best is the MSE to beat and mv is updated with every better match */
+static void lookahead_diamond(const pel * cur, const pel * ref, int width, int height, int org_x, int org_y, int w, int h,
+                              int sr, int start_x, int start_y, double * best, LOOKAHEAD_MV * mv)
+{
+    static const int dx9[9] = { 0,-2,-1, 0, 1, 2, 1, 0,-1 };
+    static const int dy9[9] = { 0, 0,-1,-2,-1, 0, 1, 2, 1 };
+    static const int dx5[5] = { 0,-1, 0, 1, 0 };
+    static const int dy5[5] = { 0, 0,-1, 0, 1 };
+    const int left = COM_MAX(0, COM_MIN(org_x - sr, width - w));
+    const int right = COM_MAX(0, COM_MIN(org_x + sr, width - w));
+    const int top = COM_MAX(0, COM_MIN(org_y - sr, height - h));
+    const int bottom = COM_MAX(0, COM_MIN(org_y + sr, height - h));
+    const pel * org = cur + org_y * width + org_x;
+    const int * pat_x, * pat_y;
+    int start_idx = 0, flag5p = 0, flag9p = 1, pat_size, idx;
+    int next_x, next_y;
+    s32 sad;
+    s64 sse;
+
+    start_x = COM_CLIP3(left, right, start_x);
+    start_y = COM_CLIP3(top, bottom, start_y);
+    next_x = start_x;
+    next_y = start_y;
+    while (flag5p || flag9p)
+    {
+        pat_x = flag5p ? dx5 : dx9;
+        pat_y = flag5p ? dy5 : dy9;
+        pat_size = flag5p ? 5 : 9;
+        for (idx = start_idx; idx < pat_size; idx++)
+        {
+            const int cx = start_x + pat_x[idx];
+            const int cy = start_y + pat_y[idx];
+            if (cx >= left && cx <= right && cy >= top && cy <= bottom)
+            {
+                lookahead_block_cost(org, ref + cy * width + cx, width, w, h, &sad, &sse);
+                if ((double)sse / (w * h) < *best)
+                {
+                    *best = (double)sse / (w * h);
+                    mv->sad = sad;
+                    mv->sse = sse;
+                    mv->mvx = org_x - cx;
+                    mv->mvy = org_y - cy;
+                    next_x = cx;
+                    next_y = cy;
+                }
+            }
+        }
+        if (next_x == start_x && next_y == start_y)
+        {
+            flag9p = 0;
+            flag5p = 1 - flag5p;
+        }
+        else
+        {
+            start_x = next_x;
+            start_y = next_y;
+        }
+        start_idx = 1;
+    }
+}
+
+typedef struct _LOOKAHEAD_JOB
+{
+    LOOKAHEAD             * la;
+    LOOKAHEAD_FRAME       * cur;
+    const LOOKAHEAD_FRAME * ref;
+} LOOKAHEAD_JOB;
+
+/* one row of blocks, rows are independent */
+static void lookahead_search_row(void * arg, int by)
+{
+    LOOKAHEAD_JOB * job = (LOOKAHEAD_JOB *)arg;
+    LOOKAHEAD * la = job->la;
+    const int width = la->width;
+    const int height = la->height;
+    int bx;
+
+    for (bx = 0; bx < la->blk_w; bx++)
+    {
+        LOOKAHEAD_MV * mv = job->cur->mv + by * la->blk_w + bx;
+        const int org_x = bx * LOOKAHEAD_BLK_SIZE;
+        const int org_y = by * LOOKAHEAD_BLK_SIZE;
+        const int w = COM_MIN(LOOKAHEAD_BLK_SIZE, width - org_x);
+        const int h = COM_MIN(LOOKAHEAD_BLK_SIZE, height - org_y);
+        double best = 1048576;
+        int start_x = org_x, start_y = org_y;
+
+        mv->w = w;
+        mv->h = h;
+        mv->mvx = mv->mvy = 0;
+        mv->sad = 0;
+        mv->sse = 0;
+#if LOOKAHEAD_FAST_ME
+        {
+            /* coarse-to-fine: the match on the 4x and then the 2x downsampled pictures gives the start of the next level */
+            LOOKAHEAD_MV coarse;
+            int dx = 0, dy = 0, lvl;
+            for (lvl = LOOKAHEAD_PYRAMID; lvl >= 1; lvl--)
+            {
+                const int wl = width >> lvl;
+                const int hl = height >> lvl;
+                const int ox = org_x >> lvl;
+                const int oy = org_y >> lvl;
+                const int bw = COM_MAX(1, COM_MIN(w >> lvl, wl - ox));
+                const int bh = COM_MAX(1, COM_MIN(h >> lvl, hl - oy));
+                double best_lvl = 1048576;
+                if (ox >= wl || oy >= hl)
+                {
+                    continue;
+                }
+                coarse.mvx = coarse.mvy = 0;
+                lookahead_diamond(job->cur->ds[lvl - 1], job->ref->ds[lvl - 1], wl, hl, ox, oy, bw, bh,
+                                  la->search_range >> lvl, ox + (dx >> lvl), oy + (dy >> lvl), &best_lvl, &coarse);
+                dx = -coarse.mvx * (1 << lvl);
+                dy = -coarse.mvy * (1 << lvl);
+            }
+            /* the collocated block stays a candidate when the coarse levels went astray */
+            lookahead_block_cost(job->cur->y + org_y * width + org_x, job->ref->y + org_y * width + org_x, width, w, h, &mv->sad, &mv->sse);
+            best = (double)mv->sse / (w * h);
+            start_x += dx;
+            start_y += dy;
+        }
+#endif
+        lookahead_diamond(job->cur->y, job->ref->y, width, height, org_x, org_y, w, h, la->search_range, start_x, start_y, &best, mv);
+    }
+}
+
+#if LOOKAHEAD_FAST_ME
+/* 2x2 average of a plane */
+static void lookahead_downsample(const pel * src, int width, int height, pel * dst)
+{
+    const int w = width >> 1;
+    const int h = height >> 1;
+    int x, y;
+    for (y = 0; y < h; y++)
+    {
+        const pel * s0 = src + 2 * y * width;
+        const pel * s1 = s0 + width;
+        for (x = 0; x < w; x++)
+        {
+            dst[x] = (s0[2 * x] + s0[2 * x + 1] + s1[2 * x] + s1[2 * x + 1] + 2) >> 2;
+        }
+        dst += w;
+    }
+}
+#endif
+
+static void lookahead_motion_search(LOOKAHEAD * la, LOOKAHEAD_FRAME * cur, const LOOKAHEAD_FRAME * ref)
+{
+    LOOKAHEAD_JOB job;
+    int i;
+
+    job.la = la;
+    job.cur = cur;
+    job.ref = ref;
+#if LOOKAHEAD_ROW_PARALLEL
+    com_thread_pool_run(la->pool, lookahead_search_row, &job, la->blk_h);
+#else
+    for (i = 0; i < la->blk_h; i++)
+    {
+        lookahead_search_row(&job, i);
+    }
+#endif
+    cur->sad = 0;
+    for (i = 0; i < la->blk_w * la->blk_h; i++)
+    {
+        cur->sad += cur->mv[i].sad;
+    }
+}
+
+static void lookahead_frame(void * arg)
+{
+    LOOKAHEAD_FRAME * cur = (LOOKAHEAD_FRAME *)arg;
+    LOOKAHEAD * la = cur->la;
+    const LOOKAHEAD_FRAME * ref = cur->has_ref ? la->frame + (cur->pic_icnt - 1) % la->num : NULL;
+    const int num_pel = la->width * la->height;
+    int i;
+
+#if LOOKAHEAD_FAST_ME
+    lookahead_downsample(cur->y, la->width, la->height, cur->ds[0]);
+    lookahead_downsample(cur->ds[0], la->width >> 1, la->height >> 1, cur->ds[1]);
+#endif
+    memset(cur->hist, 0, sizeof(cur->hist));
+    for (i = 0; i < num_pel; i++)
+    {
+        cur->hist[cur->y[i] >> 2]++;
+    }
+    cur->cos_sim = 0;
+    cur->sad = 0;
+    if (ref)
+    {
+        double product = 0, cur_mold = 0, ref_mold = 0;
+        for (i = 0; i < LOOKAHEAD_HIST_BINS; i++)
+        {
+            product += (s64)cur->hist[i] * ref->hist[i];
+            cur_mold += (s64)cur->hist[i] * cur->hist[i];
+            ref_mold += (s64)ref->hist[i] * ref->hist[i];
+        }
+        cur->cos_sim = product / (sqrt(cur_mold) * sqrt(ref_mold));
+        lookahead_motion_search(la, cur, ref);
+    }
+    com_thread_progress_set(la->done, cur->pic_icnt % la->num);
+}
+
+LOOKAHEAD * enc_lookahead_create(int width, int height, int search_range, int num
+#if LOOKAHEAD_ROW_PARALLEL
+    , int threads
+#endif
+)
+{
+    LOOKAHEAD * la = (LOOKAHEAD *)com_malloc(sizeof(LOOKAHEAD));
+    int i;
+    com_assert_rv(la, NULL);
+    com_mset(la, 0, sizeof(LOOKAHEAD));
+    la->width = width;
+    la->height = height;
+    la->search_range = search_range;
+    la->blk_w = (width + LOOKAHEAD_BLK_SIZE - 1) / LOOKAHEAD_BLK_SIZE;
+    la->blk_h = (height + LOOKAHEAD_BLK_SIZE - 1) / LOOKAHEAD_BLK_SIZE;
+    la->num = num;
+    la->frame = (LOOKAHEAD_FRAME *)com_malloc(sizeof(LOOKAHEAD_FRAME) * num);
+    com_assert_g(la->frame, ERR);
+    com_mset(la->frame, 0, sizeof(LOOKAHEAD_FRAME) * num);
+    for (i = 0; i < num; i++)
+    {
+        la->frame[i].la = la;
+        la->frame[i].pic_icnt = -1;
+        la->frame[i].y = (pel *)com_malloc(sizeof(pel) * width * height);
+        la->frame[i].mv = (LOOKAHEAD_MV *)com_malloc(sizeof(LOOKAHEAD_MV) * la->blk_w * la->blk_h);
+        com_assert_g(la->frame[i].y && la->frame[i].mv, ERR);
+#if LOOKAHEAD_FAST_ME
+        la->frame[i].ds[0] = (pel *)com_malloc(sizeof(pel) * (width >> 1) * (height >> 1));
+        la->frame[i].ds[1] = (pel *)com_malloc(sizeof(pel) * (width >> 2) * (height >> 2));
+        com_assert_g(la->frame[i].ds[0] && la->frame[i].ds[1], ERR);
+#endif
+    }
+    la->done = com_thread_progress_create(num);
+    com_assert_g(la->done, ERR);
+    /* statistics run on the caller if the thread cannot be started */
+    la->queue = com_thread_queue_create(num);
+#if LOOKAHEAD_ROW_PARALLEL
+    la->pool = com_thread_pool_create(threads);
+#endif
+    return la;
+ERR:
+    enc_lookahead_delete(la);
+    return NULL;
+}
+
+void enc_lookahead_delete(LOOKAHEAD * la)
+{
+    int i;
+    if (la == NULL)
+    {
+        return;
+    }
+    com_thread_queue_delete(la->queue);
+#if LOOKAHEAD_ROW_PARALLEL
+    com_thread_pool_delete(la->pool);
+#endif
+    com_thread_progress_delete(la->done);
+    if (la->frame)
+    {
+        for (i = 0; i < la->num; i++)
+        {
+            com_mfree(la->frame[i].y);
+            com_mfree(la->frame[i].mv);
+#if LOOKAHEAD_FAST_ME
+            com_mfree(la->frame[i].ds[0]);
+            com_mfree(la->frame[i].ds[1]);
+#endif
+        }
+        com_mfree(la->frame);
+    }
+    com_mfree(la);
+}
+
+void enc_lookahead_push(LOOKAHEAD * la, COM_PIC * pic, int pic_icnt)
+{
+    LOOKAHEAD_FRAME * cur = la->frame + pic_icnt % la->num;
+    const pel * src = pic->y;
+    pel * dst;
+    int y;
+
+    /* the slot is free once the picture that used its old content as reference is done */
+    if (pic_icnt + 1 >= la->num)
+    {
+        com_thread_progress_wait(la->done, (pic_icnt + 1) % la->num);
+    }
+    com_thread_progress_clear(la->done, pic_icnt % la->num);
+    cur->pic_icnt = pic_icnt;
+    cur->has_ref = pic_icnt > 0 && la->frame[(pic_icnt - 1) % la->num].pic_icnt == pic_icnt - 1;
+    dst = cur->y;
+    for (y = 0; y < la->height; y++)
+    {
+        com_mcpy(dst, src, sizeof(pel) * la->width);
+        src += pic->stride_luma;
+        dst += la->width;
+    }
+    com_thread_queue_post(la->queue, lookahead_frame, cur);
+}
+
+const LOOKAHEAD_FRAME * enc_lookahead_get(LOOKAHEAD * la, int pic_icnt)
+{
+    LOOKAHEAD_FRAME * frame = la->frame + pic_icnt % la->num;
+    com_thread_progress_wait(la->done, pic_icnt % la->num);
+    com_assert(frame->pic_icnt == pic_icnt);
+    return frame;
+}
+#endif
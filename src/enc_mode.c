@@ -91,6 +91,12 @@ static s32 entropy_bits[ENTROPY_BITS_TABLE_SIZE];
 
 u32 enc_get_bit_number(ENC_SBAC *sbac)
 {
+#if SBAC_RATE_EST
+    if (sbac->is_bitcount)
+    {
+        return (u32)(sbac->frac_bits >> SBAC_EST_FRAC_BITS);
+    }
+#endif
     return sbac->bitcounter + 8 * (sbac->stacked_ff) + 8 * (sbac->is_pending_byte ? 1 : 0) + 23 - sbac->left_bits;
 }
 
@@ -1653,6 +1659,9 @@ void enc_init_bits_est()
         p = (MAX_PROB*(i + 0.5)) / ENTROPY_BITS_TABLE_SIZE;
         entropy_bits[i] = (s32)(-32000 * (log(p) / log(2.0) - PROB_BITS));
     }
+#if SBAC_RATE_EST
+    enc_sbac_init_est();
+#endif
 }
 
 static s32 biari_no_bits(int symbol, SBAC_CTX_MODEL* cm)
@@ -1660,7 +1669,11 @@ static s32 biari_no_bits(int symbol, SBAC_CTX_MODEL* cm)
     s32 est_bits;
     u8 cmps;
     u16 prob_lps;
-#if CABAC_MULTI_PROB
+#if SBAC_RATE_EST
+    cmps = (*cm) & 1;
+    symbol = (u8)(symbol != 0);
+    prob_lps = enc_sbac_est_prob_lps(*cm);
+#elif CABAC_MULTI_PROB
     u16 p0, p1;
     p0 = ((*cm) >> PROB_BITS)& MCABAC_PROB_MASK;
     p1 = ((*cm) >> 1) & MCABAC_PROB_MASK;
@@ -1683,6 +1696,10 @@ static s32 biari_no_bitsW(int symbol, SBAC_CTX_MODEL* cm1, SBAC_CTX_MODEL* cm2)
 {
     s32 est_bits;
     u16 prob_lps;
+#if SBAC_RATE_EST
+    u16 cmps;
+    prob_lps = enc_sbac_est_prob_lpsW(*cm1, *cm2, &cmps);
+#else
 #if CABAC_MULTI_PROB
     u16 p1_0 = ((*cm1) >> PROB_BITS)& MCABAC_PROB_MASK;
     u16 p1_1 = ((*cm1) >> 1) & MCABAC_PROB_MASK;
@@ -1720,6 +1737,7 @@ static s32 biari_no_bitsW(int symbol, SBAC_CTX_MODEL* cm1, SBAC_CTX_MODEL* cm2)
             prob_lps = (256 << LG_PMPS_SHIFTNO) - 1 - ((prob_lps1 - prob_lps2) >> 1);
         }
     }
+#endif
 
     symbol = (u8)(symbol != 0);
 
@@ -5789,6 +5807,161 @@ static void fixed_split_for_target_split_combination(ENC_CTX *ctx, ENC_CORE *cor
 }
 #endif
 
+#if FAST_SPLIT_PRED
+enum
+{
+    SPLIT_PRED_PARENT_NONE,
+    SPLIT_PRED_PARENT_INTRA,
+    SPLIT_PRED_PARENT_INTER,
+    SPLIT_PRED_PARENT_SKIP
+};
+
+#define SPLIT_PRED_FEAT_NUM                11
+
+/* logistic-regression weights (last entry: bias) of P(split) and of P(vertical split | BT/EQT split),
+   fit offline on the encoder's own RDO decisions */
+static const double split_pred_w[2][SPLIT_PRED_FEAT_NUM + 1] =
+{
+    /*  mad     grad_h   grad_v   quad     nb_size  p_intra  p_skip   area     aspect   qp       i_slice  bias */
+    {  0.4551,  0.4310,  0.4246,  0.0750, -0.3058,  0.3109, -1.5044,  0.2061, -0.0641, -0.3044,  0.4286, -4.6095 },
+    { -0.2172,  0.9552, -0.2620, -0.0220, -0.1171,  0.1433, -0.0418, -0.0865,  1.1515,  0.0790, -0.0795, -0.3379 },
+};
+
+static double split_pred_prob(const double *w, const double *f)
+{
+    double z = w[SPLIT_PRED_FEAT_NUM];
+    for (int i = 0; i < SPLIT_PRED_FEAT_NUM; i++)
+    {
+        z += w[i] * f[i];
+    }
+    return 1.0 / (1.0 + exp(-z));
+}
+
+/* texture, neighbour and context features of the CU at (x0, y0), see split_pred_w */
+static void split_pred_features(ENC_CTX *ctx, ENC_CORE *core, int x0, int y0, int cu_width_log2, int cu_height_log2, double f[SPLIT_PRED_FEAT_NUM])
+{
+    COM_PIC *pic = PIC_ORG(ctx);
+    int s = pic->stride_luma;
+    int w = 1 << cu_width_log2;
+    int h = 1 << cu_height_log2;
+    int hw = w >> 1;
+    int hh = h >> 1;
+    int shift = ctx->info.bit_depth_internal - 8;
+    pel *org = pic->y + y0 * s + x0;
+    int sum_q[4] = { 0, 0, 0, 0 };
+    int grad_h = 0, grad_v = 0;
+    int mad, mad_q = 0;
+    int i, j, q;
+
+    for (j = 0; j < h; j++)
+    {
+        pel *src = org + j * s;
+        for (i = 0; i < w; i++)
+        {
+            sum_q[((j >= hh) << 1) + (i >= hw)] += src[i];
+            if (i + 1 < w)
+            {
+                grad_h += abs(src[i + 1] - src[i]);
+            }
+            if (j + 1 < h)
+            {
+                grad_v += abs(src[i + s] - src[i]);
+            }
+        }
+    }
+    mad = enc_get_block_std_simp(org, w, h, s, (sum_q[0] + sum_q[1] + sum_q[2] + sum_q[3] + (w * h >> 1)) >> (cu_width_log2 + cu_height_log2));
+    for (q = 0; q < 4; q++)
+    {
+        mad_q += enc_get_block_std_simp(org + (q >> 1) * hh * s + (q & 1) * hw, hw, hh, s, (sum_q[q] + (hw * hh >> 1)) >> (cu_width_log2 + cu_height_log2 - 2));
+    }
+
+    /* size of the left and above CUs relative to the current one */
+    int nb_cnt = 0, nb_diff = 0;
+    int scup = PEL2SCU(y0) * ctx->info.pic_width_in_scu + PEL2SCU(x0);
+    if (x0 > 0 && MCU_GET_CODED_FLAG(ctx->map.map_scu[scup - 1]))
+    {
+        u32 m = ctx->map.map_cu_mode[scup - 1];
+        nb_diff += MCU_GET_LOGW(m) + MCU_GET_LOGH(m) - cu_width_log2 - cu_height_log2;
+        nb_cnt++;
+    }
+    if (y0 > 0 && MCU_GET_CODED_FLAG(ctx->map.map_scu[scup - ctx->info.pic_width_in_scu]))
+    {
+        u32 m = ctx->map.map_cu_mode[scup - ctx->info.pic_width_in_scu];
+        nb_diff += MCU_GET_LOGW(m) + MCU_GET_LOGH(m) - cu_width_log2 - cu_height_log2;
+        nb_cnt++;
+    }
+
+    f[0] = log(1.0 + (double)(mad >> shift));
+    f[1] = log(1.0 + (double)(grad_h >> shift) / (h * (w - 1)));
+    f[2] = log(1.0 + (double)(grad_v >> shift) / (w * (h - 1)));
+    f[3] = (mad_q + 2.0) / (4.0 * mad + 2.0);
+    f[4] = nb_cnt ? (double)nb_diff / nb_cnt : 0.0;
+    f[5] = core->split_pred_parent == SPLIT_PRED_PARENT_INTRA;
+    f[6] = core->split_pred_parent == SPLIT_PRED_PARENT_SKIP;
+    f[7] = cu_width_log2 + cu_height_log2;
+    f[8] = cu_width_log2 - cu_height_log2;
+    f[9] = ctx->info.shext.slice_qp / 8.0;
+    f[10] = ctx->info.pic_header.slice_type == SLICE_I;
+}
+
+/* drop NO_SPLIT or all split modes, and one split direction, when the predictors are confident enough */
+static void split_pred_prune(ENC_CTX *ctx, ENC_CORE *core, int x0, int y0, int cu_width_log2, int cu_height_log2, int *split_allow)
+{
+    double f[SPLIT_PRED_FEAT_NUM];
+    double thr = ctx->preset.split_pred_thr;
+    int num_split = 0;
+    int i;
+    for (i = 1; i < MAX_SPLIT_NUM; i++)
+    {
+        num_split += split_allow[i];
+    }
+    if (num_split == 0 || !split_allow[NO_SPLIT])
+    {
+        return;
+    }
+    split_pred_features(ctx, core, x0, y0, cu_width_log2, cu_height_log2, f);
+
+    double p_split = split_pred_prob(split_pred_w[0], f);
+    if (p_split < 1.0 - thr)
+    {
+        for (i = 1; i < MAX_SPLIT_NUM; i++)
+        {
+            split_allow[i] = 0;
+        }
+        return;
+    }
+    if (p_split > thr)
+    {
+        split_allow[NO_SPLIT] = 0;
+    }
+#if EQT
+    int allow_ver = split_allow[SPLIT_BI_VER] || split_allow[SPLIT_EQT_VER];
+    int allow_hor = split_allow[SPLIT_BI_HOR] || split_allow[SPLIT_EQT_HOR];
+#else
+    int allow_ver = split_allow[SPLIT_BI_VER];
+    int allow_hor = split_allow[SPLIT_BI_HOR];
+#endif
+    if (allow_ver && allow_hor)
+    {
+        double p_ver = split_pred_prob(split_pred_w[1], f);
+        if (p_ver > thr)
+        {
+            split_allow[SPLIT_BI_HOR] = 0;
+#if EQT
+            split_allow[SPLIT_EQT_HOR] = 0;
+#endif
+        }
+        else if (p_ver < 1.0 - thr)
+        {
+            split_allow[SPLIT_BI_VER] = 0;
+#if EQT
+            split_allow[SPLIT_EQT_VER] = 0;
+#endif
+        }
+    }
+}
+#endif
+
 static void check_run_split(ENC_CORE *core, int cu_width_log2, int cu_height_log2, int cup, int next_split, int do_curr, int do_split, int* split_allow, int boundary
 #if REUSE_CU_SPLIT_OPT
                             ,double lambda
@@ -7119,7 +7292,11 @@ void write_sao_lcu(ENC_CTX *ctx, int lcu_pos, int pix_y, int pix_x, SAO_BLK_PARA
 int enc_sao_avs2(ENC_CTX * ctx, COM_PIC * pic)
 {
     copy_frame_for_sao(ctx->pic_sao, pic);
-    sao_frame(&ctx->info, &ctx->map, pic, ctx->pic_sao, ctx->rec_sao_blk_params);
+    sao_frame(&ctx->info, &ctx->map, pic, ctx->pic_sao, ctx->rec_sao_blk_params
+#if LF_ROW_PARALLEL
+        , ctx->pool
+#endif
+    );
     return COM_OK;
 }
 
@@ -7218,6 +7395,9 @@ static double mode_coding_tree(ENC_CTX *ctx, ENC_CORE *core, int x0, int y0, int
     int num_split_tried = 0;
     int num_split_to_try = 0;
     int next_split = 1; //early termination on split by setting this to 0
+#if FAST_SPLIT_PRED
+    u8 split_pred_parent = core->split_pred_parent;
+#endif
 
 #if ASP
     BOOL is_skip_asp = FALSE;
@@ -7424,6 +7604,15 @@ static double mode_coding_tree(ENC_CTX *ctx, ENC_CORE *core, int x0, int y0, int
         {
             split_allow[NO_SPLIT] = 0;
         }
+#endif
+#if ENC_PRESET
+        if (!boundary && split_allow[NO_SPLIT] && bet_depth >= ctx->preset.max_bet_depth)
+        {
+            for (int i = SPLIT_BI_VER; i < SPLIT_QUAD; i++)
+            {
+                split_allow[i] = 0;
+            }
+        }
 #endif
         /***************************** Step 3: reduce split modes by fast algorithm ********************************/
 #if FS_SAME_SIZE_PER_X_CTU
@@ -7440,6 +7629,12 @@ static double mode_coding_tree(ENC_CTX *ctx, ENC_CORE *core, int x0, int y0, int
                         , ctx->lambda[0]
 #endif
         );
+#endif
+#if FAST_SPLIT_PRED
+        if (ctx->preset.split_pred_thr > 0 && !boundary)
+        {
+            split_pred_prune(ctx, core, x0, y0, cu_width_log2, cu_height_log2, split_allow);
+        }
 #endif
     }
     else
@@ -7548,6 +7743,10 @@ static double mode_coding_tree(ENC_CTX *ctx, ENC_CORE *core, int x0, int y0, int
             {
                 is_skip_asp = TRUE;
             }
+#endif
+#if FAST_SPLIT_PRED
+            split_pred_parent = core->mod_info_best.cu_mode == MODE_INTRA ? SPLIT_PRED_PARENT_INTRA
+                              : core->mod_info_best.cu_mode == MODE_SKIP ? SPLIT_PRED_PARENT_SKIP : SPLIT_PRED_PARENT_INTER;
 #endif
         }
         else
@@ -8008,6 +8207,9 @@ static double mode_coding_tree(ENC_CTX *ctx, ENC_CORE *core, int x0, int y0, int
                                 {
                                     ctx->info.skip_me_asp = FALSE;
                                 }
+#endif
+#if FAST_SPLIT_PRED
+                                core->split_pred_parent = split_pred_parent;
 #endif
                                 cost_temp += mode_coding_tree(ctx, core, x_pos, y_pos, split_struct.cup[cur_part_num], log2_sub_cuw, log2_sub_cuh, split_struct.cud
                                                               , split_mode, INC_QT_DEPTH(qt_depth, split_mode), INC_BET_DEPTH(bet_depth, split_mode), cons_pred_mode_child, tree_status_child);
@@ -8969,7 +9171,7 @@ void derive_split_combination_CTU(ENC_CTX *ctx, ENC_CORE *core)
 }
 #endif
 
-#if CUDQP_QP_MAP
+#if CUDQP_QP_MAP || FAST_SPLIT_PRED
 //get the average luminance of a block
 int enc_get_block_avg(pel *buff, int block_w, int block_h, int stride)
 {
@@ -9001,7 +9203,9 @@ int enc_get_block_std_simp(pel *buff, int block_w, int block_h, int stride, int
     }
     return (sum + (block_size >> 1)) / block_size;
 }
+#endif
 
+#if CUDQP_QP_MAP
 void enc_generate_cu_qp_map(ENC_CTX *ctx, int x, int y, int pic_w, int pic_h)
 {
     int qp_map_grid_size = 8;
@@ -9218,6 +9422,9 @@ int enc_mode_analyze_lcu(ENC_CTX *ctx, ENC_CORE *core)
 #endif
 
     /* decide mode */
+#if FAST_SPLIT_PRED
+    core->split_pred_parent = SPLIT_PRED_PARENT_NONE;
+#endif
     mode_coding_tree(ctx, core, core->x_pel, core->y_pel, 0, ctx->info.log2_max_cuwh, ctx->info.log2_max_cuwh, 0
                      , NO_SPLIT, 0, 0, NO_MODE_CONS, TREE_LC);
     update_to_ctx_map(ctx, core);
@@ -57,6 +57,22 @@ extern "C" {
         p->CalulateCosineSimilarity(p->getCurrOrgPicBuf(), p->getLastOrgPicBuf());
     }
 
+#if LOOKAHEAD_STAGE
+    void updateLookaheadCtuFactor(ENC_CTX* ctx)
+    {
+        EncALO* p = (EncALO*)(ctx->pEncALO);
+        const LOOKAHEAD_FRAME* frame = enc_lookahead_get(ctx->lookahead, ctx->pico->pic_icnt);
+        if (!frame->has_ref)
+        {
+            p->clearCtuFactor();
+            return;
+        }
+        p->setCosineSimilarity(frame->cos_sim);
+        FrameDistortion curFD = p->LookaheadDistortion(frame, ctx->poc, ctx->poc - 1);
+        p->CalulateCtuFactor(curFD, p->getWorkCtuFactor());
+    }
+#endif
+
 #ifdef __cplusplus
 }//<-- extern "C"
 #endif
@@ -437,6 +453,47 @@ FrameDistortion EncALO::MotionCompensation(Pixel* srcYUV, Pixel* tarYUV, int src
     return curFD;
 }
 
+#if LOOKAHEAD_STAGE
+FrameDistortion EncALO::LookaheadDistortion(const LOOKAHEAD_FRAME* frame, int srcPoc, int tarPoc)
+{
+    FrameDistortion curFD;
+    LOOKAHEAD* la = frame->la;
+    int nTB = la->blk_w * la->blk_h;
+
+    curFD.CurFramePoc = srcPoc;
+    curFD.RefFramePoc = tarPoc;
+    curFD.BlockSize = LOOKAHEAD_BLK_SIZE;
+    curFD.CUSize = LOOKAHEAD_BLK_SIZE;
+    curFD.TotalBlockNumInWidth = la->blk_w;
+    curFD.TotalBlockNumInHeight = la->blk_h;
+    curFD.TotalNumOfBlocks = nTB;
+    curFD.BlockDistortionArray = new BlockDistortion[nTB];
+
+    for (int i = 0; i < nTB; i++)
+    {
+        const LOOKAHEAD_MV* mv = frame->mv + i;
+        BlockDistortion* curBD = &curFD.BlockDistortionArray[i];
+        int totalBlockPixels = mv->w * mv->h;
+
+        curBD->GlobalBlockNumber = i;
+        curBD->BlockNumInWidth = i % la->blk_w;
+        curBD->BlockNumInHeight = i / la->blk_w;
+        curBD->BlockWidth = mv->w;
+        curBD->BlockHeight = mv->h;
+        curBD->OriginX = curBD->BlockNumInWidth * LOOKAHEAD_BLK_SIZE;
+        curBD->OriginY = curBD->BlockNumInHeight * LOOKAHEAD_BLK_SIZE;
+        curBD->SearchRange = la->search_range;
+        curBD->MVx = mv->mvx;
+        curBD->MVy = mv->mvy;
+        curBD->SAD = mv->sad;
+        curBD->MSE = (double)mv->sse / totalBlockPixels;
+        curBD->MAD = (double)mv->sad / totalBlockPixels;
+        curBD->MVL = sqrt(pow2(1.0 * curBD->MVx) + pow2(1.0 * curBD->MVy));
+    }
+    return curFD;
+}
+#endif
+
 void EncALO::CalulateCtuFactor(FrameDistortion& rFD, double* workCtuFactor)
 {
     int nBW = rFD.TotalBlockNumInWidth;
@@ -1788,7 +1788,7 @@ static int make_cand_inter_filter_list(ENC_CORE *core, ENC_CTX *ctx, int *mode_l
 
     for( i = num_rdo_with_inter_filter - 1; i >= num_rdo + 2; i-- ) //at least try 2
     {
-        if( cost_list[i] > cost_list[num_rdo] * 1.5 )
+        if( cost_list[i] > cost_list[num_rdo] * (1.5 * ENC_ET_RATIO(ctx)) )
         {
             num_rdo_with_inter_filter--;
 #if IPC
@@ -2090,7 +2090,7 @@ static int make_ipc_rdo_list(ENC_CORE *core, ENC_CTX *ctx, int *mode_list, int *
     }
     for( i = num_rdo_with_ic - 1; i >= num_rdo + 2; i-- ) //at least try 2
     {
-        if( cost_list[i] > cost_list[num_rdo] * 1.5 )
+        if( cost_list[i] > cost_list[num_rdo] * (1.5 * ENC_ET_RATIO(ctx)) )
         {
             num_rdo_with_ic--;
             ipc_list[i] = 0;
@@ -2454,7 +2454,9 @@ void check_best_mode(ENC_CORE *core, ENC_PINTER *pi, const double cost_curr, dou
 #endif
 }
 
+#if !SCRATCH_ARENA
 static s16    resi_t[N_C][MAX_CU_DIM];
+#endif
 
 #if TR_SAVE_LOAD
 #if SBT_SAVELOAD
@@ -2556,6 +2558,11 @@ static double pinter_residue_rdo(ENC_CTX *ctx, ENC_CORE *core, int bForceAllZero
 #endif
 )
 {
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16 (*resi_t)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+#endif
     COM_MODE *mod_info_curr = &core->mod_info_curr;
     s16 (*coef)[MAX_CU_DIM] = mod_info_curr->coef;
     s16 (*mv)[MV_D] = mod_info_curr->mv;
@@ -3294,8 +3301,13 @@ static double pinter_residue_rdo(ENC_CTX *ctx, ENC_CORE *core, int bForceAllZero
         int cu_mode = mod_info_curr->cu_mode;
         com_mcpy(nnz_store, num_nz_coef, sizeof(int)* MAX_NUM_TB* N_C);
 
+#if SCRATCH_ARENA
+        s16 (*bak_2Nx2N_coef)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+        s16 (*bak_pred)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+#else
         static s16 bak_2Nx2N_coef[N_C][MAX_CU_DIM];
         static s16 bak_pred[N_C][MAX_CU_DIM];
+#endif
         int cu_size = 1 << (cu_width_log2 + cu_height_log2);
         for (i = U_C; i < N_C; i++)
         {
@@ -3421,6 +3433,9 @@ static double pinter_residue_rdo(ENC_CTX *ctx, ENC_CORE *core, int bForceAllZero
 #if SBT_FAST
     core->cost_best = min( cost_best, core->cost_best );
 #endif
+#endif
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
 #endif
     return cost_best;
 }
@@ -3428,6 +3443,11 @@ static double pinter_residue_rdo(ENC_CTX *ctx, ENC_CORE *core, int bForceAllZero
 #if INTER_TM
 static double pinter_residue_rdo_no_mc(ENC_CTX *ctx, ENC_CORE *core, int bForceAllZero)
 {
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16 (*resi_t)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+#endif
     COM_MODE *mod_info_curr = &core->mod_info_curr;
     s16 (*coef)[MAX_CU_DIM] = mod_info_curr->coef;
     s16 (*mv)[MV_D] = mod_info_curr->mv;
@@ -3923,8 +3943,13 @@ static double pinter_residue_rdo_no_mc(ENC_CTX *ctx, ENC_CORE *core, int bForceA
         int cu_mode = mod_info_curr->cu_mode;
         com_mcpy(nnz_store, num_nz_coef, sizeof(int)* MAX_NUM_TB* N_C);
 
+#if SCRATCH_ARENA
+        s16 (*bak_2Nx2N_coef)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+        s16 (*bak_pred)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+#else
         static s16 bak_2Nx2N_coef[N_C][MAX_CU_DIM];
         static s16 bak_pred[N_C][MAX_CU_DIM];
+#endif
         int cu_size = 1 << (cu_width_log2 + cu_height_log2);
         for (i = U_C; i < N_C; i++)
         {
@@ -4049,6 +4074,9 @@ static double pinter_residue_rdo_no_mc(ENC_CTX *ctx, ENC_CORE *core, int bForceA
 #if SBT_FAST
     core->cost_best = min( cost_best, core->cost_best );
 #endif
+#endif
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
 #endif
     return cost_best;
 }
@@ -4673,6 +4701,11 @@ double pinter_residue_rdo_chroma(ENC_CTX *ctx, ENC_CORE *core
 #endif
 )
 {
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16 (*resi_t)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+#endif
     ENC_PINTER *pi = &ctx->pinter;
     COM_MODE *mod_info_curr = &core->mod_info_curr;
     s16(*coef)[MAX_CU_DIM] = mod_info_curr->coef;
@@ -4901,9 +4934,15 @@ double pinter_residue_rdo_chroma(ENC_CTX *ctx, ENC_CORE *core
         int cu_mode = mod_info_curr->cu_mode;
         com_mcpy(nnz_store, num_nz_coef, sizeof(int)* MAX_NUM_TB* N_C);
 
+#if SCRATCH_ARENA
+        s16 (*bak_2Nx2N_coef)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+        s16 (*bak_pred)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+        s16 (*bak_rec)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+#else
         static s16 bak_2Nx2N_coef[N_C][MAX_CU_DIM];
         static s16 bak_pred[N_C][MAX_CU_DIM];
         static s16 bak_rec[N_C][MAX_CU_DIM];
+#endif
         int cu_size = 1 << (cu_width_log2 + cu_height_log2);
         for (i = U_C; i < N_C; i++)
         {
@@ -5010,6 +5049,9 @@ double pinter_residue_rdo_chroma(ENC_CTX *ctx, ENC_CORE *core
         }
     }
 
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
     return cost_best;
 }
 #endif
@@ -5390,6 +5432,9 @@ static void analyze_direct_skip(ENC_CTX *ctx, ENC_CORE *core, double *cost_best)
     assert(num_rdo <= min(MAX_INTER_SKIP_RDO, TRADITIONAL_SKIP_NUM + ctx->info.sqh.num_of_hmvp_cand));
 #endif
 
+#if ENC_PRESET
+    num_rdo = COM_MIN(num_rdo, ctx->preset.skip_rdo_num);
+#endif
     make_cand_list(core, ctx, mode_list, cost_list, num_cands_woUMVE, num_cands_all, num_rdo, pmv_cands, refi_cands);
 
 #if IPC
@@ -5771,7 +5816,13 @@ static double GetCost_SATD(ENC_CTX *ctx, ENC_CORE *core)
         pel *p0, *p1, *dest;
 #endif 
         
+#if SCRATCH_ARENA
+        COM_ARENA *scratch = com_scratch();
+        int scratch_mark = com_arena_mark(scratch);
+        pel (*pred_snd)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(pel) * N_C * MAX_CU_DIM);
+#else
         static pel pred_snd[N_C][MAX_CU_DIM];
+#endif
         pel(*pred)[MAX_CU_DIM] = pred_buf;
 #if SIMD_MC
         int bidx = 0;
@@ -5896,6 +5947,9 @@ static double GetCost_SATD(ENC_CTX *ctx, ENC_CORE *core)
 #endif
 #if ASP
         ctx->info.skip_umve_asp = FALSE;
+#endif
+#if SCRATCH_ARENA
+        com_arena_release(scratch, scratch_mark);
 #endif
     }
     //dist
@@ -6554,7 +6608,7 @@ static void analyze_awp_merge(ENC_CTX *ctx, ENC_CORE *core, double *cost_best)
         awp_stad_num = COM_MIN(2, awp_stad_num); // Only 2 rdo process was allowed for P picture
     }
 #endif
-    for (awp_rdo_idx = 0; awp_rdo_idx < COM_MIN(AWP_RDO_NUM, awp_stad_num); awp_rdo_idx++)
+    for (awp_rdo_idx = 0; awp_rdo_idx < COM_MIN(ENC_AWP_RDO_NUM(ctx), awp_stad_num); awp_rdo_idx++)
     {
         mod_info_curr->awp_flag = 1;
         mod_info_curr->skip_idx = best_satd_awp_idx[awp_rdo_idx];
@@ -6817,6 +6871,9 @@ static void analyze_tm(ENC_CTX* ctx, ENC_CORE* core, double* cost_best)
         reduced_flag = num_cands_all < TM_CANDS ? 1 : 0;
         cands_adjustment(pmv_cands, refi_cands, &num_cands_all);
     }
+#if TM_COST_CACHE
+    com_tm_cache_reset();
+#endif
     pre_evaluation_cands(x, y, ctx->info.pic_width, ctx->info.pic_height, cu_width, cu_height, PIC_REC(ctx)->y, PIC_REC(ctx)->stride_luma, pi->refp, pmv_cands, refi_cands, &num_cands_all, bit_depth, is_simplified); 
     for (u8 cand_idx = 0; cand_idx < num_cands_all; cand_idx++)
     {
@@ -7845,13 +7902,22 @@ static void analyze_awp_merge_comb(ENC_CTX *ctx, ENC_CORE *core, double *cost_be
     }
 
 #if AWP_ENH
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    u8 (*dawp_check)[AWP_MVR_MAX_REFINE_NUM + 1][AWP_MV_LIST_LENGTH][AWP_MV_LIST_LENGTH] = com_arena_alloc(scratch, sizeof(u8) * (AWP_MVR_MAX_REFINE_NUM + 1) * (AWP_MVR_MAX_REFINE_NUM + 1) * AWP_MV_LIST_LENGTH * AWP_MV_LIST_LENGTH);
+    int (*dawp_inv_mode_list)[AWP_MVR_MAX_REFINE_NUM + 1][AWP_MV_LIST_LENGTH][AWP_MV_LIST_LENGTH][AWP_MODE_NUM] = com_arena_alloc(scratch, sizeof(int) * (AWP_MVR_MAX_REFINE_NUM + 1) * (AWP_MVR_MAX_REFINE_NUM + 1) * AWP_MV_LIST_LENGTH * AWP_MV_LIST_LENGTH * AWP_MODE_NUM);
+#else
     static u8 dawp_check[AWP_MVR_MAX_REFINE_NUM + 1][AWP_MVR_MAX_REFINE_NUM + 1][AWP_MV_LIST_LENGTH][AWP_MV_LIST_LENGTH] = { 0 };
+#endif
     const int check_len = (AWP_MVR_MAX_REFINE_NUM + 1) * (AWP_MVR_MAX_REFINE_NUM + 1)* AWP_MV_LIST_LENGTH * AWP_MV_LIST_LENGTH;
     memset(dawp_check, 0, check_len * sizeof(u8));
+#if !SCRATCH_ARENA
     static int dawp_inv_mode_list[AWP_MVR_MAX_REFINE_NUM + 1][AWP_MVR_MAX_REFINE_NUM + 1][AWP_MV_LIST_LENGTH][AWP_MV_LIST_LENGTH][AWP_MODE_NUM] = { 0 };
+#endif
 #endif
 
-    for (awp_rdo_idx = 0; awp_rdo_idx < COM_MIN(AWP_RDO_NUM, awp_satd_num); awp_rdo_idx++)  // 7 candidates
+    for (awp_rdo_idx = 0; awp_rdo_idx < COM_MIN(ENC_AWP_RDO_NUM(ctx), awp_satd_num); awp_rdo_idx++)  // 7 candidates
     {
         mod_info_curr->awp_flag = 1;
 #if AWP_ENH
@@ -7968,6 +8034,9 @@ static void analyze_awp_merge_comb(ENC_CTX *ctx, ENC_CORE *core, double *cost_be
     mod_info_curr->awp_flag = 0;
     mod_info_curr->awp_mvr_flag0 = 0;
     mod_info_curr->awp_mvr_flag1 = 0;
+#if AWP_ENH && SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
+#endif
 }
 #endif
 
@@ -11409,8 +11478,15 @@ double analyze_inter_cu(ENC_CTX *ctx, ENC_CORE *core)
     COM_MODE *bst_info = &core->mod_info_best;
     int bit_depth = ctx->info.bit_depth_internal;
     int i, j;
+#if SCRATCH_ARENA
+    COM_ARENA *scratch = com_scratch();
+    int scratch_mark = com_arena_mark(scratch);
+    s16 (*coef_blk)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+    s16 (*resi)[MAX_CU_DIM] = com_arena_alloc(scratch, sizeof(s16) * N_C * MAX_CU_DIM);
+#else
     static s16  coef_blk[N_C][MAX_CU_DIM];
     static s16  resi[N_C][MAX_CU_DIM];
+#endif
     double cost_best = MAX_COST;
     int cu_width_log2 = cur_info->cu_width_log2;
     int cu_height_log2 = cur_info->cu_height_log2;
@@ -11863,6 +11939,9 @@ double analyze_inter_cu(ENC_CTX *ctx, ENC_CORE *core)
     {
         core->bef_data[cu_width_log2 - 2][cu_height_log2 - 2][core->cup].lic_flag_history = bst_info->ipc_flag;
     }
+#endif
+#if SCRATCH_ARENA
+    com_arena_release(scratch, scratch_mark);
 #endif
     return cost_best;
 }
@@ -11873,6 +11952,16 @@ int pinter_set_complexity(ENC_CTX *ctx, int complexity)
     pi = &ctx->pinter;
     /* default values *************************************************/
     pi->max_search_range = ctx->param.max_b_frames == 0 ? SEARCH_RANGE_IPEL_LD : SEARCH_RANGE_IPEL_RA;
+#if ENC_PRESET
+    if (ctx->preset.search_range_shift > 0)
+    {
+        pi->max_search_range >>= ctx->preset.search_range_shift;
+    }
+    else
+    {
+        pi->max_search_range <<= -ctx->preset.search_range_shift;
+    }
+#endif
     pi->search_range_ipel[MV_X] = (s16)pi->max_search_range;
     pi->search_range_ipel[MV_Y] = (s16)pi->max_search_range;
     pi->search_range_spel[MV_X] = SEARCH_RANGE_SPEL;
@@ -1691,7 +1691,7 @@ static int make_ipred_list_fast(ENC_CTX *ctx, ENC_CORE *core, int width, int hei
 
     for (i = pred_cnt - 1; i >= 0; i--)
     {
-        if (rmd_cand_cost[i] > core->inter_satd * (1.2))
+        if (rmd_cand_cost[i] > core->inter_satd * (1.2 * ENC_ET_RATIO(ctx)))
         {
             pred_cnt--;
         }
@@ -1795,7 +1795,7 @@ static int make_ipred_list(ENC_CTX * ctx, ENC_CORE * core, int width, int height
     pred_cnt = ipd_rdo_cnt;
     for (i = ipd_rdo_cnt - 1; i >= 0; i--)
     {
-        if (cand_satd_cost[i] > core->inter_satd * (1.1))
+        if (cand_satd_cost[i] > core->inter_satd * (1.1 * ENC_ET_RATIO(ctx)))
         {
             pred_cnt--;
         }
@@ -2103,6 +2103,9 @@ double analyze_intra_cu(ENC_CTX *ctx, ENC_CORE *core)
 
 #if EIPM
                 }
+#endif
+#if ENC_PRESET
+                pred_cnt = COM_MIN(pred_cnt, ctx->preset.ipd_rdo_num);
 #endif
                 if (skip_ipd == 1)
                 {
@@ -3654,7 +3657,7 @@ double analyze_sawp_cu(ENC_CTX* ctx, ENC_CORE* core)
 #endif
 
                 /*  RDO process for selected candidates  */
-                for (int awp_rdo_idx = 0; awp_rdo_idx < COM_MIN(SAWP_RDO_NUM, awp_stad_num); awp_rdo_idx++)
+                for (int awp_rdo_idx = 0; awp_rdo_idx < COM_MIN(ENC_SAWP_RDO_NUM(ctx), awp_stad_num); awp_rdo_idx++)
                 {
                     //printf("\nRDO");
                     mod_info_curr->sawp_flag = 1;
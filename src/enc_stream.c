@@ -0,0 +1,310 @@
+/* ====================================================================================================================
+
+  The copyright in this software is being made available under the License included below.
+  This software may be subject to other third party and contributor rights, including patent rights, and no such
+  rights are granted under this license.
+
+  Copyright (c) 2018, HUAWEI TECHNOLOGIES CO., LTD. All rights reserved.
+  Copyright (c) 2018, SAMSUNG ELECTRONICS CO., LTD. All rights reserved.
+  Copyright (c) 2018, PEKING UNIVERSITY SHENZHEN GRADUATE SCHOOL. All rights reserved.
+  Copyright (c) 2018, PENGCHENG LABORATORY. All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, are permitted only for
+  the purpose of developing standards within Audio and Video Coding Standard Workgroup of China (AVS) and for testing and
+  promoting such standards. The following conditions are required to be met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+      the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+      the following disclaimer in the documentation and/or other materials provided with the distribution.
+    * The name of HUAWEI TECHNOLOGIES CO., LTD. or SAMSUNG ELECTRONICS CO., LTD. may not be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+* ====================================================================================================================
+*/
+
+#include "enc_stream.h"
+
+#if STREAM_API
+
+struct _ENC_STREAM
+{
+    ENC_STREAM_CB          cb;
+    ENC                    id;
+    COM_BITB               bitb;
+    u8                   * bs_buf;
+    u8                   * bs_buf2;
+#if LIBVC_ON
+    /* library picture state of an encoder the caller does not give its own */
+    LibVCData              libvc_data;
+#endif
+    int                    header;
+    /* a picture was pushed and its coding step has not run yet */
+    int                    pushed;
+    int                    pic_icnt;
+    int                    eos;
+    int                    done;
+};
+
+static void * enc_stream_alloc(const ENC_STREAM_CB * cb, size_t size)
+{
+    return cb->alloc ? cb->alloc(cb->opaque, size) : malloc(size);
+}
+
+static void enc_stream_free(const ENC_STREAM_CB * cb, void * ptr)
+{
+    if (ptr == NULL)
+    {
+        return;
+    }
+    if (cb->free)
+    {
+        cb->free(cb->opaque, ptr);
+    }
+    else
+    {
+        free(ptr);
+    }
+}
+
+ENC_STREAM * enc_stream_create(ENC_PARAM * param, const ENC_STREAM_CB * cb, int * err)
+{
+    ENC_STREAM * s;
+    int ret = COM_OK;
+
+    if (cb == NULL || cb->packet == NULL)
+    {
+        if (err) *err = COM_ERR_INVALID_ARGUMENT;
+        return NULL;
+    }
+    s = (ENC_STREAM *)enc_stream_alloc(cb, sizeof(ENC_STREAM));
+    if (s == NULL)
+    {
+        if (err) *err = COM_ERR_OUT_OF_MEMORY;
+        return NULL;
+    }
+    com_mset(s, 0, sizeof(ENC_STREAM));
+    s->cb = *cb;
+    s->bs_buf = (u8 *)enc_stream_alloc(cb, ENC_STREAM_BS_SIZE);
+    s->bs_buf2 = (u8 *)enc_stream_alloc(cb, ENC_STREAM_BS_SIZE);
+    if (s->bs_buf == NULL || s->bs_buf2 == NULL)
+    {
+        ret = COM_ERR_OUT_OF_MEMORY;
+        goto ERR;
+    }
+    s->bitb.addr = s->bs_buf;
+    s->bitb.addr2 = s->bs_buf2;
+    s->bitb.bsize = ENC_STREAM_BS_SIZE;
+    s->id = enc_create(param, &ret);
+    if (s->id == NULL)
+    {
+        goto ERR;
+    }
+#if LIBVC_ON
+    init_libvcdata(&s->libvc_data);
+    ((ENC_CTX *)s->id)->rpm.libvc_data = &s->libvc_data;
+#endif
+    if (err) *err = COM_OK;
+    return s;
+ERR:
+    enc_stream_free(cb, s->bs_buf);
+    enc_stream_free(cb, s->bs_buf2);
+    enc_stream_free(cb, s);
+    if (err) *err = ret == COM_OK ? COM_ERR : ret;
+    return NULL;
+}
+
+void enc_stream_delete(ENC_STREAM * s)
+{
+    ENC_STREAM_CB cb;
+    if (s == NULL)
+    {
+        return;
+    }
+    cb = s->cb;
+#if LIB_PIC_UPDATE
+    enc_delete(s->id, 1);
+#else
+    enc_delete(s->id);
+#endif
+#if LIBVC_ON
+    delete_libvcdata(&s->libvc_data);
+#endif
+    enc_stream_free(&cb, s->bs_buf);
+    enc_stream_free(&cb, s->bs_buf2);
+    enc_stream_free(&cb, s);
+}
+
+ENC enc_stream_encoder(ENC_STREAM * s)
+{
+    return s->id;
+}
+
+int enc_stream_header(ENC_STREAM * s)
+{
+    int ret;
+#if !REPEAT_SEQ_HEADER
+    ENC_STAT stat;
+#endif
+    if (s->header)
+    {
+        return COM_OK;
+    }
+    s->header = 1;
+    s->bitb.err = 0;
+#if REPEAT_SEQ_HEADER
+    /* the header goes out in front of every I picture */
+    ret = init_seq_header((ENC_CTX *)s->id, &s->bitb);
+#else
+    ret = enc_seq_header((ENC_CTX *)s->id, &s->bitb, &stat);
+    if (COM_SUCCEEDED(ret) && s->cb.packet(s->cb.opaque, s->bs_buf, stat.write, NULL, &stat) < 0)
+    {
+        ret = COM_ERR;
+    }
+#endif
+    return ret;
+}
+
+int enc_stream_push(ENC_STREAM * s, COM_IMGB * img)
+{
+    ENC_CTX * ctx = (ENC_CTX *)s->id;
+    COM_IMGB * imgb_enc;
+    u8 * src, * dst;
+    int ret, i, y;
+
+    ret = enc_stream_header(s);
+    if (COM_FAILED(ret))
+    {
+        return ret;
+    }
+    if (s->eos)
+    {
+        return COM_ERR_UNEXPECTED;
+    }
+    if (img == NULL)
+    {
+        /* bumping: the pictures left in the buffer are coded without waiting for a full GOP */
+        s->eos = 1;
+        enc_setup_bumping(ctx);
+        return COM_OK;
+    }
+    if (s->pushed)
+    {
+        return COM_ERR_UNEXPECTED;
+    }
+    ret = enc_picbuf_get_inbuf(ctx, &imgb_enc);
+    if (COM_FAILED(ret))
+    {
+        return ret;
+    }
+    /* the planes are copied row by row into the encoder's buffer, which has the coded picture size */
+    ret = img->np != imgb_enc->np || img->cs != imgb_enc->cs;
+    for (i = 0; i < img->np && !ret; i++)
+    {
+        ret = img->width[i] != imgb_enc->width[i] || img->height[i] != imgb_enc->height[i];
+    }
+    if (ret)
+    {
+        imgb_enc->release(imgb_enc);
+        return COM_ERR_INVALID_ARGUMENT;
+    }
+    for (i = 0; i < img->np; i++)
+    {
+        src = (u8 *)img->addr_plane[i];
+        dst = (u8 *)imgb_enc->addr_plane[i];
+        for (y = 0; y < img->height[i]; y++)
+        {
+            com_mcpy(dst, src, img->width[i] * sizeof(pel));
+            src += img->stride[i];
+            dst += imgb_enc->stride[i];
+        }
+    }
+    for (i = 0; i < 4; i++)
+    {
+        imgb_enc->ts[i] = img->ts[i];
+    }
+    if (s->cb.input && s->cb.input(s->cb.opaque, imgb_enc, s->pic_icnt) < 0)
+    {
+        imgb_enc->release(imgb_enc);
+        return COM_ERR;
+    }
+    ret = enc_push_frm(ctx, imgb_enc);
+    imgb_enc->release(imgb_enc);
+    if (COM_FAILED(ret))
+    {
+        return ret;
+    }
+    s->pic_icnt++;
+    s->pushed = 1;
+    return COM_OK;
+}
+
+int enc_stream_encode(ENC_STREAM * s)
+{
+    static const u8 video_sequence_end_code[4] = { 0x00, 0x00, 0x01, 0xB1 };
+    ENC_STAT stat;
+    COM_IMGB * rec;
+    int ret;
+
+    ret = enc_stream_header(s);
+    if (COM_FAILED(ret))
+    {
+        return ret;
+    }
+    s->pushed = 0;
+    if (s->done)
+    {
+        return COM_OK_NO_MORE_FRM;
+    }
+    ret = enc_encode(s->id, &s->bitb, &stat);
+    if (ret == COM_OK)
+    {
+        rec = PIC_REC((ENC_CTX *)s->id)->imgb;
+        rec->addref(rec);
+        if (s->cb.packet(s->cb.opaque, s->bs_buf, stat.write, rec, &stat) < 0)
+        {
+            ret = COM_ERR;
+        }
+        rec->release(rec);
+    }
+    else if (ret == COM_OK_NO_MORE_FRM)
+    {
+        s->done = 1;
+        com_mset(&stat, 0, sizeof(ENC_STAT));
+        stat.write = sizeof(video_sequence_end_code);
+        stat.ctype = COM_CT_SEQ_END;
+        if (s->cb.packet(s->cb.opaque, video_sequence_end_code, stat.write, NULL, &stat) < 0)
+        {
+            ret = COM_ERR;
+        }
+    }
+    return ret;
+}
+
+int enc_stream_flush(ENC_STREAM * s)
+{
+    int ret;
+    if (!s->eos)
+    {
+        ret = enc_stream_push(s, NULL);
+        if (COM_FAILED(ret))
+        {
+            return ret;
+        }
+    }
+    do
+    {
+        ret = enc_stream_encode(s);
+    } while (ret == COM_OK || ret == COM_OK_OUT_NOT_AVAILABLE);
+    return ret == COM_OK_NO_MORE_FRM ? COM_OK : ret;
+}
+
+#endif
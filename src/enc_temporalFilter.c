@@ -166,6 +166,7 @@ static TF_PIC_YUV * tf_pic_extend_border(TF_PIC_YUV * ptr)
     return ptr;
 }
 
+#if !TF_INPUT_RING
 static TF_PIC_YUV * tf_pic_read(TF_PIC_YUV * ptr, FILE * fid, uint8_t intputDepth, uint8_t internal_depth)
 {
     if (intputDepth == 8)
@@ -216,6 +217,7 @@ static TF_PIC_YUV * tf_pic_read(TF_PIC_YUV * ptr, FILE * fid, uint8_t intputDept
     printf("ssd: only supported 8 or 10 bit YUV420\n");
     return NULL;
 }
+#endif
 
 static TF_PIC_YUV * tf_pic_destroy(TF_PIC_YUV * ptr)
 {
@@ -332,6 +334,88 @@ static void tf_gen_pyramid_luma(TF_PIC_PRMD * ptr)
     return;
 }
 
+#if SIMD_TF
+/* taps 1 to 6 of the interpolation filter over height rows of width (multiple of 4) samples, unrounded */
+static void tf_interp_hor_sse(const pel_t * src, int src_stride, int * dst, int dst_stride, int width, int height, const int * filter)
+{
+    /* pairs of 16-bit taps for _mm_madd_epi16 */
+    const __m128i c12 = _mm_set1_epi32((int)(((unsigned)filter[2] << 16) | ((unsigned)filter[1] & 0xffff)));
+    const __m128i c34 = _mm_set1_epi32((int)(((unsigned)filter[4] << 16) | ((unsigned)filter[3] & 0xffff)));
+    const __m128i c56 = _mm_set1_epi32((int)(((unsigned)filter[6] << 16) | ((unsigned)filter[5] & 0xffff)));
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x += 8)
+        {
+            const pel_t * s = src + x;
+            __m128i s1 = _mm_loadu_si128((const __m128i *)(s + 1));
+            __m128i s2 = _mm_loadu_si128((const __m128i *)(s + 2));
+            __m128i s3 = _mm_loadu_si128((const __m128i *)(s + 3));
+            __m128i s4 = _mm_loadu_si128((const __m128i *)(s + 4));
+            __m128i s5 = _mm_loadu_si128((const __m128i *)(s + 5));
+            __m128i s6 = _mm_loadu_si128((const __m128i *)(s + 6));
+            __m128i lo = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(s1, s2), c12),
+                _mm_madd_epi16(_mm_unpacklo_epi16(s3, s4), c34)), _mm_madd_epi16(_mm_unpacklo_epi16(s5, s6), c56));
+            _mm_storeu_si128((__m128i *)(dst + x), lo);
+            if (x + 4 < width)
+            {
+                __m128i hi = _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(s1, s2), c12),
+                    _mm_madd_epi16(_mm_unpackhi_epi16(s3, s4), c34)), _mm_madd_epi16(_mm_unpackhi_epi16(s5, s6), c56));
+                _mm_storeu_si128((__m128i *)(dst + x + 4), hi);
+            }
+        }
+        src += src_stride;
+        dst += dst_stride;
+    }
+}
+
+/* taps 1 to 6 down the rows of tf_interp_hor_sse() output, rounded and clipped to [0, max_value] */
+static void tf_interp_ver_sse(const int * src, int src_stride, pel_t * dst, int dst_stride, int width, int height, const int * filter, int max_value)
+{
+    const __m128i round = _mm_set1_epi32(1 << 11);
+    const __m128i vmax = _mm_set1_epi32(max_value);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i c[7];
+    for (int k = 1; k <= 6; k++)
+    {
+        c[k] = _mm_set1_epi32(filter[k]);
+    }
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x += 4)
+        {
+            const int * s = src + x;
+            __m128i sum = round;
+            for (int k = 1; k <= 6; k++)
+            {
+                sum = _mm_add_epi32(sum, _mm_mullo_epi32(_mm_loadu_si128((const __m128i *)(s + k * src_stride)), c[k]));
+            }
+            sum = _mm_min_epi32(_mm_max_epi32(_mm_srai_epi32(sum, 12), zero), vmax);
+            _mm_storel_epi64((__m128i *)(dst + x), _mm_packus_epi32(sum, sum));
+        }
+        src += src_stride;
+        dst += dst_stride;
+    }
+}
+
+static int tf_ssd_sse(const pel_t * org, int org_stride, const pel_t * ref, int ref_stride, int block_size)
+{
+    __m128i sum = _mm_setzero_si128();
+    for (int y = 0; y < block_size; y++)
+    {
+        for (int x = 0; x < block_size; x += 8)
+        {
+            __m128i d = _mm_sub_epi16(_mm_loadu_si128((const __m128i *)(org + x)), _mm_loadu_si128((const __m128i *)(ref + x)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(d, d));
+        }
+        org += org_stride;
+        ref += ref_stride;
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
 static int tf_calc_ssd(const TF_PIC_PRMD * org_pyramid, const TF_PIC_PRMD * ref_pyramid, int * temp, int x, int y, int dx, int dy, const int block_size, const int max_value, const int level)
 {
     const pel_t * org = org_pyramid->pic[level].pic_org[COMP_Y];
@@ -345,6 +429,22 @@ static int tf_calc_ssd(const TF_PIC_PRMD * org_pyramid, const TF_PIC_PRMD * ref_
     dx = dx / subsample_ratio;
     dy = dy / subsample_ratio;
 
+#if SIMD_TF
+    if (((dx & 0xF) == 0) && ((dy & 0xF) == 0))
+    {
+        dx /= g_tf_motion_vector_factor;
+        dy /= g_tf_motion_vector_factor;
+        return tf_ssd_sse(org + y * org_stride + x, org_stride, ref + (y + dy) * ref_stride + (x + dx), ref_stride, block_size);
+    }
+    else
+    {
+        pel_t pred[16 * 16];
+        const pel_t * ref_line = ref + (y + (dy >> 4) - 2) * ref_stride + (x + (dx >> 4) - 3);
+        tf_interp_hor_sse(ref_line, ref_stride, temp + 64, 64, block_size, block_size + 6, g_tf_interpolation_filter[(dx & 0xF)]);
+        tf_interp_ver_sse(temp, 64, pred, block_size, block_size, block_size, g_tf_interpolation_filter[(dy & 0xF)], max_value);
+        return tf_ssd_sse(org + y * org_stride + x, org_stride, pred, block_size, block_size);
+    }
+#else
     int ssd = 0;
     if (((dx & 0xF) == 0) && ((dy & 0xF) == 0))
     {
@@ -431,6 +531,7 @@ static int tf_calc_ssd(const TF_PIC_PRMD * org_pyramid, const TF_PIC_PRMD * ref_
         }
     }
     return ssd;
+#endif
 }
 
 #define tf_me_search_point(pBest, block_size, cur, curX, curY, ref, ofsX, ofsY, temp, max_value, level) \
@@ -472,6 +573,157 @@ static void tf_motion_estimate_init(TF_MV * best, TF_MV_MAT *previous, const TF_
     return;
 }
 
+#if TF_PARALLEL
+typedef struct TF_ME_JOB
+{
+    TF_MV_MAT          * mvs;
+    TF_MV_MAT          * previous;
+    const TF_PIC_PRMD  * ref;
+    const TF_PIC_PRMD  * cur;
+    int                  refine;
+    int                  level;
+    int                  cols;
+    /* one entry per block, NULL when the rows run serially */
+    COM_THREAD_PROGRESS * done;
+} TF_ME_JOB;
+
+/* one row of blocks; a block waits for the block above it, whose vector it tries as a candidate */
+static void tf_motion_estimation_row(void * arg, int row)
+{
+    TF_ME_JOB * job = (TF_ME_JOB *)arg;
+    TF_MV_MAT * mvs = job->mvs;
+    TF_MV_MAT * previous = job->previous;
+    const TF_PIC_PRMD * ref = job->ref;
+    const TF_PIC_PRMD * cur = job->cur;
+    const int refine = job->refine;
+    const int level = job->level;
+    const int range = previous ? (refine ? 0 : 5) : 8;
+    const int block_size = tf_luma_block_size << (1 - refine);
+    const int step_size = block_size << level;
+    const int org_width = ref->pic[0].width[COMP_Y];
+    const int max_value = (1 << cur->pic[0].depth[CHAN_LUMA]) - 1;
+    const int real_block_size = block_size << level;
+    const int block_y = row * step_size;
+
+    int interp_buf[(64 + 8) * 64];
+
+    for (int block_x = 0; block_x + real_block_size <= org_width; block_x += step_size)
+    {
+        TF_MV best;
+        tf_mv_create(&best);
+        if (previous)
+        {
+            tf_motion_estimate_init(&best, previous, ref, cur, interp_buf, block_y, block_x, block_size, level);           
+        }
+        
+        TF_MV previous_best = best;
+        const int search_step = g_tf_motion_vector_factor << level;
+        tf_me_full_search((&best), block_size, cur, block_x, block_y, ref, previous_best.x, previous_best.y, range * search_step, search_step, interp_buf, max_value, level);
+        
+        if (refine)
+        {
+            previous_best = best;
+            tf_me_full_search((&best), block_size, cur, block_x, block_y, ref, previous_best.x, previous_best.y, 3 * 4, 4, interp_buf, max_value, level);
+
+            previous_best = best;
+            tf_me_full_search((&best), block_size, cur, block_x, block_y, ref, previous_best.x, previous_best.y, 3, 1, interp_buf, max_value, level);
+        }
+
+        if (block_y > 0)
+        {
+            TF_MV above_mv;
+            if (job->done)
+            {
+                com_thread_progress_wait(job->done, (row - 1) * job->cols + block_x / step_size);
+            }
+            above_mv = tf_mv_mat_getmv(mvs, block_x / tf_luma_block_size, (block_y - step_size) / tf_luma_block_size);
+            tf_me_search_point((&best), block_size, cur, block_x, block_y, ref, above_mv.x, above_mv.y, interp_buf, max_value, level);
+        }
+        
+        if (block_x > 0)
+        {
+            TF_MV left_mv;
+            left_mv = tf_mv_mat_getmv(mvs, (block_x - step_size) / tf_luma_block_size, block_y / tf_luma_block_size);
+            tf_me_search_point((&best), block_size, cur, block_x, block_y, ref, left_mv.x, left_mv.y, interp_buf, max_value, level);
+        }
+
+        if ((refine > 0) && (level == 0))
+        {
+            pel_t pix;
+            double avg = 0.0;
+            double variance = 0.0;
+            int32_t pix_stride = ref->pic[level].stride[COMP_Y];
+            pel_t * pix_line = ref->pic[level].pic_org[COMP_Y] + block_x + pix_stride * block_y;
+            
+            for (int y1 = 0; y1 < block_size; y1++)
+            {
+                for (int x1 = 0; x1 < block_size; x1++)
+                {
+                    pix = pix_line[x1];
+                    variance += (pix * pix);
+                    avg += pix;
+                }
+                pix_line += pix_stride;
+            }
+            variance -= (avg * avg / (block_size * block_size));
+            avg = avg / (block_size * block_size);
+            
+            best.ssd = (int) (20 * ((best.ssd + 5) / (variance + 5)) + (best.ssd / (block_size * block_size)) / 50);
+        }
+
+        int block_mat_pox_x = block_x / tf_luma_block_size;
+        int block_mat_pox_y = block_y / tf_luma_block_size;
+        
+        for (int idxX = 0; idxX < real_block_size / tf_luma_block_size; idxX ++)
+        {
+            for (int idxY = 0; idxY < real_block_size / tf_luma_block_size; idxY ++)
+            {
+                tf_mv_mat_setmv(mvs, &best, block_mat_pox_x + idxX, block_mat_pox_y + idxY);                        
+            }   
+        }
+        if (job->done)
+        {
+            com_thread_progress_set(job->done, row * job->cols + block_x / step_size);
+        }
+    }
+}
+
+static void tf_motion_estimation_luma(TF_MV_MAT * mvs, const TF_PIC_PRMD * ref, const TF_PIC_PRMD * cur, TF_MV_PRMD * mv_pyramid, const int refine, const int level, COM_THREAD_POOL * pool)
+{
+    const int step_size = (tf_luma_block_size << (1 - refine)) << level;
+    const int rows = cur->pic[0].height[COMP_Y] / step_size;
+    TF_ME_JOB job;
+
+    if (refine > 0)
+    {
+        job.previous = &(mv_pyramid->mvs[level]);
+    } 
+    else
+    { 
+        job.previous = (level == 2) ? (TF_MV_MAT *)NULL : &(mv_pyramid->mvs[level + 1]);
+        mvs = &(mv_pyramid->mvs[level]);
+    }
+    job.mvs = mvs;
+    job.ref = ref;
+    job.cur = cur;
+    job.refine = refine;
+    job.level = level;
+    job.cols = ref->pic[0].width[COMP_Y] / step_size;
+    job.done = NULL;
+
+    if (com_thread_pool_size(pool) > 1 && rows > 1)
+    {
+        job.done = com_thread_progress_create(rows * job.cols);
+        com_thread_pool_run(pool, tf_motion_estimation_row, &job, rows);
+        com_thread_progress_delete(job.done);
+        return;
+    }
+    for (int row = 0; row < rows; row++)
+    {
+        tf_motion_estimation_row(&job, row);
+    }
+}
+#else
 static void tf_motion_estimation_luma(TF_MV_MAT * mvs, const TF_PIC_PRMD * ref, const TF_PIC_PRMD * cur, TF_MV_PRMD * mv_pyramid, const int refine, const int level)
 {
     int range = refine ? 0 : 5;
@@ -572,9 +824,14 @@ static void tf_motion_estimation_luma(TF_MV_MAT * mvs, const TF_PIC_PRMD * ref,
         }
     }
 }
+#endif
 
 static void tf_motion_compensation(const TF_MV_MAT * mvs, const TF_PIC_YUV * input, TF_PIC_YUV * output,
-                                   const int uiComponentNum, const uint8_t depth[CHAN_NUM])
+                                   const int uiComponentNum, const uint8_t depth[CHAN_NUM]
+#if TF_PARALLEL
+                                   , const int row_begin, const int row_end
+#endif
+)
 {
     for(int c = COMP_Y; c < COMP_NUM; c++)
     {
@@ -596,7 +853,11 @@ static void tf_motion_compensation(const TF_MV_MAT * mvs, const TF_PIC_YUV * inp
         int interp_buf[(tf_luma_block_size + 8) * tf_luma_block_size];
         int tmp_stride = tf_luma_block_size; 
 
+#if TF_PARALLEL
+        for (int y = row_begin * block_size_y, blockNumY = row_begin; y + block_size_y <= height && blockNumY < row_end; y += block_size_y, blockNumY++)
+#else
         for (int y = 0, blockNumY = 0; y + block_size_y <= height; y += block_size_y, blockNumY++)
+#endif
         {
             for (int x = 0, blockNumX = 0; x + block_size_x <= width; x += block_size_x, blockNumX++)
             {
@@ -609,6 +870,10 @@ static void tf_motion_compensation(const TF_MV_MAT * mvs, const TF_PIC_YUV * inp
                 const int *filter_x = g_tf_interpolation_filter[((dx & 0xf))]; 
                 const int *filter_y = g_tf_interpolation_filter[((dy & 0xf))]; 
                 
+#if SIMD_TF
+                tf_interp_hor_sse(src_img + ((y + iy) - 2) * src_stride + ((x + ix) - 3), src_stride, interp_buf + tmp_stride, tmp_stride, block_size_x, block_size_x + 6, filter_x);
+                tf_interp_ver_sse(interp_buf, tmp_stride, dst_img + y * dst_stride + x, dst_stride, block_size_x, block_size_y, filter_y, max_value);
+#else
                 int interp; 
                 const pel_t * src_line = src_img;
                 src_line += (((y + iy) - 3) * src_stride);
@@ -653,11 +918,46 @@ static void tf_motion_compensation(const TF_MV_MAT * mvs, const TF_PIC_YUV * inp
                     }
                     dst_line += dst_stride;
                 }
+#endif
             }
         }
     }
 }
 
+#if TF_PARALLEL
+typedef struct TF_MC_JOB
+{
+    const TF_MV_MAT    * mvs;
+    const TF_PIC_YUV   * input;
+    TF_PIC_YUV         * output;
+    const uint8_t      * depth;
+} TF_MC_JOB;
+
+static void tf_motion_compensation_row(void * arg, int row)
+{
+    TF_MC_JOB * job = (TF_MC_JOB *)arg;
+    tf_motion_compensation(job->mvs, job->input, job->output, COMP_NUM, job->depth, row, row + 1);
+}
+
+/* luma block rows are independent, each job also compensates the matching chroma rows */
+static void tf_motion_compensation_frame(TF_CTX * h, TF_PIC_BUF * pic_buf)
+{
+    const int rows = pic_buf->org_pic.height[CHAN_LUMA] / tf_luma_block_size;
+    TF_MC_JOB job;
+
+    if (com_thread_pool_size(h->pool) > 1 && rows > 1)
+    {
+        job.mvs = &(pic_buf->mvs);
+        job.input = &(pic_buf->org_pic);
+        job.output = &(pic_buf->crt_pic);
+        job.depth = h->internal_depth;
+        com_thread_pool_run(h->pool, tf_motion_compensation_row, &job, rows);
+        return;
+    }
+    tf_motion_compensation(&(pic_buf->mvs), &(pic_buf->org_pic), &(pic_buf->crt_pic), COMP_NUM, h->internal_depth, 0, rows);
+}
+#endif
+
 static void tf_motion_estimation(TF_CTX * h, TF_PIC_BUF * pic_buf)
 {
     TF_MV_MAT * mat_mve = &(pic_buf->mvs); 
@@ -667,49 +967,83 @@ static void tf_motion_estimation(TF_CTX * h, TF_PIC_BUF * pic_buf)
     tf_pic_extend_border(&(h->pic_pyramid_b.pic[0]));
     tf_gen_pyramid_luma(&(h->pic_pyramid_b));
 
-    tf_motion_estimation_luma(NULL, &(h->pic_pyramid_a), &(h->pic_pyramid_b), &(h->mv_pyramid), 0, 2);
-    tf_motion_estimation_luma(NULL, &(h->pic_pyramid_a), &(h->pic_pyramid_b), &(h->mv_pyramid), 0, 1);
-    tf_motion_estimation_luma(NULL, &(h->pic_pyramid_a), &(h->pic_pyramid_b), &(h->mv_pyramid), 0, 0);
-    tf_motion_estimation_luma(mat_mve, &(h->pic_pyramid_a), &(h->pic_pyramid_b), &(h->mv_pyramid), 1, 0);
+    tf_motion_estimation_luma(NULL, &(h->pic_pyramid_a), &(h->pic_pyramid_b), &(h->mv_pyramid), 0, 2
+#if TF_PARALLEL
+        , h->pool
+#endif
+    );
+    tf_motion_estimation_luma(NULL, &(h->pic_pyramid_a), &(h->pic_pyramid_b), &(h->mv_pyramid), 0, 1
+#if TF_PARALLEL
+        , h->pool
+#endif
+    );
+    tf_motion_estimation_luma(NULL, &(h->pic_pyramid_a), &(h->pic_pyramid_b), &(h->mv_pyramid), 0, 0
+#if TF_PARALLEL
+        , h->pool
+#endif
+    );
+    tf_motion_estimation_luma(mat_mve, &(h->pic_pyramid_a), &(h->pic_pyramid_b), &(h->mv_pyramid), 1, 0
+#if TF_PARALLEL
+        , h->pool
+#endif
+    );
 
     return;
 }
 
-static void tf_bilateral_filter(TF_CTX * h, int8_t * src_idx, const uint8_t ref_num, double strength)
+static void tf_bilateral_filter(TF_CTX * h, int8_t * src_idx, const uint8_t ref_num, double strength
+#if TF_PARALLEL
+                                , const int row_begin, const int row_end
+#endif
+)
 {
     const TF_PIC_YUV * org_pic = h->org_pic;
     TF_PIC_YUV * newOrgPic = h->new_pic;
 
     const uint32_t source_width = h->source_width;
     const uint32_t source_height = h->source_height;
+#if !TF_PARALLEL
     const int qp = h->qp;
+#endif
 
     int ref_strength_idx = 
         (ref_num == FILTER_RANGE * 2) ? 0:
         (ref_num == FILTER_RANGE) ? 1 : 2;
 
+#if !TF_PARALLEL
     const double luma_sigma_square = (qp - g_tf_sigma_zero_point) * (qp - g_tf_sigma_zero_point) * g_tf_sigma_multiplier * 9.0 / 16.0;
     const double chroma_sigma_square = 30 * 30;
+#endif
     
     for(int c = COMP_Y; c < COMP_NUM; c++)
     {
         const int height = org_pic->height[COMP_TO_CHAN(c)];
         const int width  = org_pic->width[COMP_TO_CHAN(c)];
 
-        pel_t * src_line = org_pic->pic_org[c];
-        pel_t * dst_line = newOrgPic->pic_org[c];
-        
         const int src_stride = org_pic->stride[COMP_TO_CHAN(c)];      
         const int dst_stride = newOrgPic->stride[COMP_TO_CHAN(c)];
 
-        const double sigma_square = COMP_TO_CHAN(c) ? chroma_sigma_square : luma_sigma_square;
         const double weight_scale = strength * (COMP_TO_CHAN(c) ? g_tf_chroma_factor : 0.4);
         
         const pel_t max_sample_value = (1 << h->internal_depth[COMP_TO_CHAN(c)]) - 1;
-        const double depth_scale = (1 << (10 - h->internal_depth[COMP_TO_CHAN(c)]));
         const int block_size = tf_luma_block_size >> COMP_TO_CHAN(c);
+#if TF_PARALLEL
+        const double * weight_lut = h->weight_lut[COMP_TO_CHAN(c)];
+        const int y_end = tf_min(height, row_end * block_size);
+
+        pel_t * src_line = org_pic->pic_org[c] + row_begin * block_size * src_stride;
+        pel_t * dst_line = newOrgPic->pic_org[c] + row_begin * block_size * dst_stride;
+
+        for (int y = row_begin * block_size; y < y_end; y++)
+#else
+        pel_t * src_line = org_pic->pic_org[c];
+        pel_t * dst_line = newOrgPic->pic_org[c];
+
+        const double sigma_square = COMP_TO_CHAN(c) ? chroma_sigma_square : luma_sigma_square;
+        const double depth_scale = (1 << (10 - h->internal_depth[COMP_TO_CHAN(c)]));
 
         for (int y = 0; y < height; y++)
+#endif
         {            
             for (int x = 0; x < width; x++)
             {
@@ -759,9 +1093,11 @@ static void tf_bilateral_filter(TF_CTX * h, int8_t * src_idx, const uint8_t ref_
                     const int noise = tf_mv_mat_getmv(&(h->pic_bufs[src_idx[i]].mvs), x / block_size, y / block_size).noise;
                     
                     const int ref_value = (int)h->pic_bufs[src_idx[i]].crt_pic.pic_org[c][(y * h->pic_bufs[src_idx[i]].crt_pic.stride[COMP_TO_CHAN(c)] + x)];
+#if !TF_PARALLEL
                     double diff = (double)(ref_value - org_value);
                     diff *= depth_scale;
                     double diff_square = diff * diff;
+#endif
 
                     const int index = tf_min(3, tf_abs(h->pic_bufs[src_idx[i]].poc_offset) - 1);
                     
@@ -769,11 +1105,16 @@ static void tf_bilateral_filter(TF_CTX * h, int8_t * src_idx, const uint8_t ref_
                     adaptive_weight *= (ssd < 64) ? 1.2 : ((ssd > 128) ? 0.8 : 1);
                     adaptive_weight *= ((min_error + 1) / (ssd + 1));
 
+#if TF_PARALLEL
+                    const int sigma_class = ((noise < 50) ? 0 : 2) + ((ssd < 64) ? 0 : 1);
+                    const double weight = weight_scale * g_tf_ref_strengths[ref_strength_idx][index] * adaptive_weight * weight_lut[sigma_class * (max_sample_value + 1) + tf_abs(ref_value - org_value)];
+#else
                     double sigma_scale = (noise < 50) ? 1.3 : 0.8;
                     sigma_scale *= (ssd < 64) ? 1.3 : 1;
                     sigma_scale *= 2.0;
                     
                     const double weight = weight_scale * g_tf_ref_strengths[ref_strength_idx][index] * adaptive_weight * exp(-diff_square / (sigma_scale * sigma_square));
+#endif
                     new_value += weight * ref_value;
                     filter_weigth_sum += weight;
                 }
@@ -789,7 +1130,91 @@ static void tf_bilateral_filter(TF_CTX * h, int8_t * src_idx, const uint8_t ref_
     }
 }
 
+#if TF_PARALLEL
+typedef struct TF_BF_JOB
+{
+    TF_CTX             * h;
+    int8_t             * src_idx;
+    uint8_t              ref_num;
+    double               strength;
+} TF_BF_JOB;
+
+static void tf_bilateral_filter_row(void * arg, int row)
+{
+    TF_BF_JOB * job = (TF_BF_JOB *)arg;
+    tf_bilateral_filter(job->h, job->src_idx, job->ref_num, job->strength, row, row + 1);
+}
+
+/* a block row only touches its own row of the noise estimates, so rows can be filtered in any order */
+static void tf_bilateral_filter_frame(TF_CTX * h, int8_t * src_idx, const uint8_t ref_num, double strength)
+{
+    const int rows = (h->org_pic->height[CHAN_LUMA] + tf_luma_block_size - 1) / tf_luma_block_size;
+    TF_BF_JOB job;
+
+    if (com_thread_pool_size(h->pool) > 1 && rows > 1)
+    {
+        job.h = h;
+        job.src_idx = src_idx;
+        job.ref_num = ref_num;
+        job.strength = strength;
+        com_thread_pool_run(h->pool, tf_bilateral_filter_row, &job, rows);
+        return;
+    }
+    tf_bilateral_filter(h, src_idx, ref_num, strength, 0, rows);
+}
+
+/* exp() term of the sample weight for every absolute difference and the four sigma scales */
+static int tf_weight_lut_create(TF_CTX * h)
+{
+    const int qp = h->qp;
+    const double luma_sigma_square = (qp - g_tf_sigma_zero_point) * (qp - g_tf_sigma_zero_point) * g_tf_sigma_multiplier * 9.0 / 16.0;
+    const double chroma_sigma_square = 30 * 30;
+
+    for (int chan = CHAN_LUMA; chan < CHAN_NUM; chan++)
+    {
+        const int num = (1 << h->internal_depth[chan]);
+        const double sigma_square = chan ? chroma_sigma_square : luma_sigma_square;
+        const double depth_scale = (1 << (10 - h->internal_depth[chan]));
+
+        h->weight_lut[chan] = (double *)malloc(sizeof(double) * 4 * num);
+        if (h->weight_lut[chan] == NULL)
+        {
+            return -1;
+        }
+        for (int cls = 0; cls < 4; cls++)
+        {
+            double sigma_scale = (cls < 2) ? 1.3 : 0.8;
+            sigma_scale *= (cls & 1) ? 1 : 1.3;
+            sigma_scale *= 2.0;
+
+            for (int d = 0; d < num; d++)
+            {
+                double diff = (double)d;
+                diff *= depth_scale;
+                double diff_square = diff * diff;
+                h->weight_lut[chan][cls * num + d] = exp(-diff_square / (sigma_scale * sigma_square));
+            }
+        }
+    }
+    return 0;
+}
+#endif
+
+#if TF_INPUT_RING
+void tf_push_frame(TF_CTX * h, int frame_idx)
+{
+    TF_PIC_BUF * buf = &(h->pic_bufs[POC_TO_FILTER_IDX(frame_idx)]);
+    tf_pic_extend_border(&(buf->org_pic));
+    buf->is_used = 1;
+    buf->poc = frame_idx;
+}
+
+#endif
+#if TF_INPUT_RING
+int tf_prepare_frames(TF_CTX * h, int poc, int skip_frame
+#else
 int tf_prepare_frames(TF_CTX * h, int poc, int skip_frame, char * input_name
+#endif
 #if DQP_OPT
     , ENC_CTX *ctx
 #endif
@@ -799,7 +1224,9 @@ int tf_prepare_frames(TF_CTX * h, int poc, int skip_frame, char * input_name
     int first_frame = tf_max(poc + skip_offset - FILTER_RANGE, 0);
     int last_frame = poc + skip_offset + FILTER_RANGE;
 
+#if !TF_INPUT_RING
     FILE * yuv_frames = fopen(input_name, "rb");
+#endif
 
 #if DQP_OPT
     int width = h->org_pic->width[0];
@@ -811,6 +1238,18 @@ int tf_prepare_frames(TF_CTX * h, int poc, int skip_frame, char * input_name
     memset(ctx->pico_buf[curr_idx]->st_qpmap, 0, sizeof(int)*ctu_in_width);
 #endif
 
+#if TF_INPUT_RING
+    /* the caller has pushed the window as far as the input goes */
+    for (int frame_idx = first_frame; frame_idx <= last_frame; frame_idx++)
+    {
+        int filter_buf_idx = POC_TO_FILTER_IDX(frame_idx);
+        if (!h->pic_bufs[filter_buf_idx].is_used || (h->pic_bufs[filter_buf_idx].poc != frame_idx))
+        {
+            return 0;
+        }
+    }
+    return 1;
+#else
     for (int idx = 0; idx < tf_max(first_frame, 0); idx ++)
     {
         tf_pic_read(h->new_pic, yuv_frames, h->input_depth[0], h->internal_depth[0]);
@@ -845,9 +1284,10 @@ int tf_prepare_frames(TF_CTX * h, int poc, int skip_frame, char * input_name
     
     fclose(yuv_frames);
     return 1;
+#endif
 }
 
-void tf_init(TF_CTX * h, int qp, int width, int height, int input_depth, int internal_depth, double strength[FILTER_TYPE], int period[FILTER_TYPE], int lookahead)
+int tf_init(TF_CTX * h, int qp, int width, int height, int input_depth, int internal_depth, double strength[FILTER_TYPE], int period[FILTER_TYPE], int lookahead)
 {
     h->qp = qp;
     h->source_width = width;
@@ -890,6 +1330,18 @@ void tf_init(TF_CTX * h, int qp, int width, int height, int input_depth, int int
     tf_mv_mat_create(&(h->mv_pyramid.mvs[0]), h->source_width / tf_luma_block_size, h->source_height / tf_luma_block_size);
     tf_mv_mat_create(&(h->mv_pyramid.mvs[1]), h->source_width / tf_luma_block_size, h->source_height / tf_luma_block_size);
     tf_mv_mat_create(&(h->mv_pyramid.mvs[2]), h->source_width / tf_luma_block_size, h->source_height / tf_luma_block_size);
+#if TF_PARALLEL
+    h->pool = NULL;
+    for (int chan = CHAN_LUMA; chan < CHAN_NUM; chan++)
+    {
+        h->weight_lut[chan] = NULL;
+    }
+    if (tf_weight_lut_create(h))
+    {
+        return -1;
+    }
+#endif
+    return 0;
 }
 
 int tf_filter(TF_CTX * h, int frame_idx, int skip_frame
@@ -979,11 +1431,15 @@ int tf_filter(TF_CTX * h, int frame_idx, int skip_frame
             h->pic_bufs[filter_buf_idx].poc_offset = poc_offset;
             poc_offset++;
                 
+#if TF_PARALLEL
+            tf_motion_compensation_frame(h, &(h->pic_bufs[filter_buf_idx]));
+#else
             tf_motion_compensation(
                 &(h->pic_bufs[filter_buf_idx].mvs), 
                 &(h->pic_bufs[filter_buf_idx].org_pic), 
                 &(h->pic_bufs[filter_buf_idx].crt_pic), 
                 COMP_NUM, h->internal_depth);
+#endif
         }
 
         double strength = -1.0;
@@ -1189,7 +1645,11 @@ int tf_filter(TF_CTX * h, int frame_idx, int skip_frame
         }
 #endif
 
+#if TF_PARALLEL
+        tf_bilateral_filter_frame(h, src_pic_idx, src_num, strength);
+#else
         tf_bilateral_filter(h, src_pic_idx, src_num, strength);
+#endif
         return 1;
     }
     return 0;
@@ -1235,4 +1695,11 @@ void tf_uninit(TF_CTX * h)
     tf_mv_mat_destroy(&(h->mv_pyramid.mvs[0]));
     tf_mv_mat_destroy(&(h->mv_pyramid.mvs[1]));
     tf_mv_mat_destroy(&(h->mv_pyramid.mvs[2]));
+#if TF_PARALLEL
+    for (int chan = CHAN_LUMA; chan < CHAN_NUM; chan++)
+    {
+        free(h->weight_lut[chan]);
+        h->weight_lut[chan] = NULL;
+    }
+#endif
 }
@@ -85,4 +85,82 @@ void enc_diff_pred(int x, int y, int cu_width_log2, int cu_height_log2, COM_PIC
     /* V */
     buf = org->v  + (y * stride) + x;
     enc_diff_16b(cu_width_log2, cu_height_log2, buf, pred[V_C], stride, cu_width, cu_width, diff[V_C]);
-}
\ No newline at end of file
+}
+#if SBAC_CTX_JOURNAL
+/******************************************************************************
+ * journaled SBAC snapshots
+ ******************************************************************************/
+/* generation counter of the core running on this thread, see enc_sbac_gen_bind() */
+static COM_THREAD_LOCAL u64 *sbac_gen_cur;
+
+void enc_sbac_gen_bind(u64 *gen)
+{
+    sbac_gen_cur = gen;
+}
+
+static int sbac_ctz64(u64 v)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, v);
+    return (int)index;
+#else
+    return __builtin_ctzll(v);
+#endif
+}
+
+/* Copy src into dst. When dst was last copied from src and src has not been
+   overwritten since, both can only differ in the chunks either of them touched
+   afterwards, so only those chunks are copied. */
+void enc_sbac_copy(ENC_SBAC *dst, const ENC_SBAC *src)
+{
+    if (dst == src)
+    {
+        return;
+    }
+    dst->range           = src->range;
+    dst->code            = src->code;
+    dst->left_bits       = src->left_bits;
+    dst->stacked_ff      = src->stacked_ff;
+    dst->pending_byte    = src->pending_byte;
+    dst->is_pending_byte = src->is_pending_byte;
+    dst->bitcounter      = src->bitcounter;
+    dst->is_bitcount     = src->is_bitcount;
+#if SBAC_RATE_EST
+    dst->frac_bits       = src->frac_bits;
+#endif
+
+    if (dst->ctx_src == src && src->ctx_gen != 0 && dst->ctx_src_gen == src->ctx_gen)
+    {
+        const int num_models = sizeof(COM_SBAC_CTX) / sizeof(SBAC_CTX_MODEL);
+        SBAC_CTX_MODEL *d = (SBAC_CTX_MODEL *)&dst->ctx;
+        const SBAC_CTX_MODEL *s = (const SBAC_CTX_MODEL *)&src->ctx;
+        u64 mask = dst->ctx_dirty | src->ctx_dirty;
+        while (mask)
+        {
+            int chunk = sbac_ctz64(mask);
+            int pos = chunk << SBAC_CTX_CHUNK_LOG2;
+            int num = COM_MIN(1 << SBAC_CTX_CHUNK_LOG2, num_models - pos);
+            com_mcpy(d + pos, s + pos, num * sizeof(SBAC_CTX_MODEL));
+            mask &= mask - 1;
+        }
+    }
+    else
+    {
+        com_mcpy(&dst->ctx, &src->ctx, sizeof(COM_SBAC_CTX));
+    }
+    dst->ctx_dirty = 0;
+    dst->ctx_gen = ++(*sbac_gen_cur);
+    dst->ctx_src = src;
+    dst->ctx_src_gen = src->ctx_gen;
+}
+
+/* forget the snapshot history of sbac after its contexts were rewritten in place */
+void enc_sbac_ctx_reset(ENC_SBAC *sbac)
+{
+    sbac->ctx_dirty = 0;
+    sbac->ctx_gen = ++(*sbac_gen_cur);
+    sbac->ctx_src = NULL;
+    sbac->ctx_src_gen = 0;
+}
+#endif
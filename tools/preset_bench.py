@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+"""
+Speed/BD-rate benchmark of the encoder speed presets (--preset).
+
+Every preset is encoded at each QP; encoding time, bitrate and PSNR are read
+from the encoder log, and BD-rate (Y PSNR, cubic fit of log-rate) is
+reported against the 'medium' anchor as a markdown table.
+
+example:
+  tools/preset_bench.py --encoder build_cmake/app/app_encoder \
+      --config cfg/encode_RA.cfg -i City_1280x720_60.yuv -w 1280 -h 720 -z 60 -f 9
+"""
+
+import argparse
+import math
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+PRESETS = ["placebo", "slow", "medium", "fast", "veryfast", "ultrafast"]
+ANCHOR = "medium"
+
+
+def run_encoder(args, preset, qp, workdir):
+    out = os.path.join(workdir, "%s_%d.bin" % (preset, qp))
+    cmd = [args.encoder, "-i", args.input, "-w", str(args.width), "-h", str(args.height),
+           "-z", str(args.fps), "-f", str(args.frames), "-q", str(qp), "-o", out,
+           "-v", "1", "--preset", preset]
+    if args.config:
+        cmd += ["--config", args.config]
+    cmd += args.extra
+    log = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                         universal_newlines=True, check=True).stdout
+
+    def field(pattern):
+        m = re.search(pattern, log)
+        if m is None:
+            sys.exit("cannot find '%s' in the log of: %s" % (pattern, " ".join(cmd)))
+        return float(m.group(1))
+
+    return (field(r"bitrate\(kbps\)\s*:\s*([0-9.]+)"),
+            field(r"PSNR Y\(dB\)\s*:\s*([0-9.]+)"),
+            field(r"Total encoding time\s*=\s*([0-9.]+) msec"))
+
+
+def poly_fit3(x, y):
+    """least-squares cubic fit, returns coefficients c0..c3"""
+    n = 4
+    a = [[sum(xi ** (r + c) for xi in x) for c in range(n)] + [sum(yi * xi ** r for xi, yi in zip(x, y))]
+         for r in range(n)]
+    for col in range(n):
+        piv = max(range(col, n), key=lambda r: abs(a[r][col]))
+        a[col], a[piv] = a[piv], a[col]
+        for r in range(n):
+            if r != col:
+                f = a[r][col] / a[col][col]
+                a[r] = [vr - f * vc for vr, vc in zip(a[r], a[col])]
+    return [a[r][n] / a[r][r] for r in range(n)]
+
+
+def poly_int(c, lo, hi):
+    return sum(ci / (i + 1) * (hi ** (i + 1) - lo ** (i + 1)) for i, ci in enumerate(c))
+
+
+def bd_rate(anchor, test):
+    """Bjontegaard delta rate in percent; points are (kbps, psnr) tuples"""
+    ra = [math.log10(r) for r, _ in anchor]
+    rt = [math.log10(r) for r, _ in test]
+    pa = [p for _, p in anchor]
+    pt = [p for _, p in test]
+    # fit around a common origin to keep the normal equations well conditioned
+    org = sum(pa) / len(pa)
+    pa = [p - org for p in pa]
+    pt = [p - org for p in pt]
+    ca = poly_fit3(pa, ra)
+    ct = poly_fit3(pt, rt)
+    lo = max(min(pa), min(pt))
+    hi = min(max(pa), max(pt))
+    if hi <= lo:
+        return float("nan")
+    diff = (poly_int(ct, lo, hi) - poly_int(ca, lo, hi)) / (hi - lo)
+    return (10 ** diff - 1) * 100
+
+
+def main():
+    parser = argparse.ArgumentParser(description="speed/BD-rate table of the encoder presets", add_help=False)
+    parser.add_argument("--help", action="help", help="show this help message and exit")
+    parser.add_argument("--encoder", required=True, help="path of app_encoder")
+    parser.add_argument("--config", help="encoder config file")
+    parser.add_argument("-i", "--input", required=True, help="input yuv file")
+    parser.add_argument("-w", "--width", type=int, required=True)
+    parser.add_argument("-h", "--height", type=int, required=True)
+    parser.add_argument("-z", "--fps", type=int, default=30)
+    parser.add_argument("-f", "--frames", type=int, default=9)
+    parser.add_argument("--qps", default="27,32,38,45", help="comma separated QP list (4 points)")
+    parser.add_argument("--presets", default=",".join(PRESETS), help="comma separated preset list")
+    parser.add_argument("extra", nargs=argparse.REMAINDER, help="extra encoder arguments after '--'")
+    args = parser.parse_args()
+    if args.extra[:1] == ["--"]:
+        args.extra = args.extra[1:]
+    qps = [int(q) for q in args.qps.split(",")]
+    presets = args.presets.split(",")
+    if ANCHOR not in presets:
+        presets.insert(0, ANCHOR)
+
+    res = {}
+    with tempfile.TemporaryDirectory() as workdir:
+        for preset in presets:
+            res[preset] = [run_encoder(args, preset, qp, workdir) for qp in qps]
+            sys.stderr.write("%s done\n" % preset)
+
+    anchor_time = sum(t for _, _, t in res[ANCHOR])
+    print("| preset    | speed-up vs %s | BD-rate Y vs %s |" % (ANCHOR, ANCHOR))
+    print("|-----------|--------------------|---------------------|")
+    for preset in presets:
+        pts = [(r, p) for r, p, _ in res[preset]]
+        speed = anchor_time / sum(t for _, _, t in res[preset])
+        bd = 0.0 if preset == ANCHOR else bd_rate([(r, p) for r, p, _ in res[ANCHOR]], pts)
+        print("| %-9s | %17.2fx | %18.2f%% |" % (preset, speed, bd))
+
+
+if __name__ == "__main__":
+    main()